@@ -9,11 +9,19 @@
 
 #include "color/HeatMap.h"
 #include "math/RInterface.h"
+#include "math/GraphClustering.h"
+#include "math/PCA.h"
 
 #include "ui_analysisClustering.h"
 
+// the t-SNE embedding is published every snapshot_interval iterations and the plot
+// is updated with the last one every snapshot_refresh milliseconds
+static const int snapshot_interval = 10;
+static const int snapshot_refresh = 100;
+
 AnalysisClustering::AnalysisClustering(QWidget *parent, Qt::WindowFlags f)
     : QWidget(parent, f)
+    , m_estimated_clusters(0)
     , m_ui(new Ui::analysisClustering)
 {
     // setup UI
@@ -26,6 +34,8 @@ AnalysisClustering::AnalysisClustering(QWidget *parent, Qt::WindowFlags f)
             this, &AnalysisClustering::slotExportPlot);
     connect(m_ui->computeClusters, &QPushButton::clicked,
             this, &AnalysisClustering::slotComputeClusters);
+    connect(m_ui->stopClustering, &QPushButton::clicked,
+            this, &AnalysisClustering::slotStop);
     connect(m_ui->createSelections, &QPushButton::clicked,
             this, &AnalysisClustering::signalClusteringExportSelections);
     connect(&m_watcher_colors, &QFutureWatcher<void>::finished,
@@ -34,10 +44,21 @@ AnalysisClustering::AnalysisClustering(QWidget *parent, Qt::WindowFlags f)
             this, &AnalysisClustering::classesComputed);
     connect(m_ui->plot, &ChartView::signalLassoSelection,
             this, &AnalysisClustering::slotLassoSelection);
+    // the number of clusters is automatic with the graph clustering
+    connect(m_ui->graph, &QRadioButton::toggled,
+            m_ui->clusters, &QSpinBox::setDisabled);
+
+    m_snapshot_timer.setInterval(snapshot_refresh);
+    connect(&m_snapshot_timer, &QTimer::timeout,
+            this, &AnalysisClustering::slotUpdateSnapshot);
 }
 
 AnalysisClustering::~AnalysisClustering()
 {
+    // the workers use the members so they must finish before they are destroyed
+    m_tsne.stop();
+    m_watcher_colors.waitForFinished();
+    m_watcher_classes.waitForFinished();
 }
 
 void AnalysisClustering::clear()
@@ -52,6 +73,7 @@ void AnalysisClustering::clear()
     m_ui->progressBar->setTextVisible(true);
     m_ui->exportPlot->setEnabled(false);
     m_ui->runClustering->setEnabled(true);
+    m_ui->stopClustering->setEnabled(false);
     m_ui->createSelections->setEnabled(false);
     m_ui->tab->setCurrentIndex(0);
     m_ui->kmeans->setChecked(true);
@@ -65,6 +87,9 @@ void AnalysisClustering::clear()
     m_colors.clear();
     m_selected_spots.clear();
     m_reduced_coordinates.clear();
+    m_estimated_colors.clear();
+    m_estimated_spots.clear();
+    m_estimated_clusters = 0;
 }
 
 QMultiHash<unsigned, QString> AnalysisClustering::getClustersSpot() const
@@ -79,7 +104,7 @@ QMultiHash<unsigned, QString> AnalysisClustering::getClustersSpot() const
 QHash<QString, QColor> AnalysisClustering::getSpotClusters() const
 {
     QHash<QString, QColor> computed_colors;
-    Q_ASSERT(*std::min_element(std::begin(m_colors), std::end(m_colors))
+    Q_ASSERT(m_colors.empty() || *std::max_element(std::begin(m_colors), std::end(m_colors))
              < Color::color_list.size());
     for (unsigned i = 0; i < m_colors.size(); ++i) {
         computed_colors.insert(m_spots.at(i), Color::color_list.at(m_colors.at(i)));
@@ -96,13 +121,15 @@ void AnalysisClustering::loadData(const STData::STDataFrame &data)
 {
     // store the data
     m_data = data;
+    // previous estimations are not valid anymore
+    m_estimated_colors.clear();
+    m_estimated_spots.clear();
+    m_estimated_clusters = 0;
 }
 
 void AnalysisClustering::slotRun()
 {
     qDebug() << "Computing spot colors asynchronously";
-    // initialize progress bar
-    m_ui->progressBar->setRange(0,0);
     // disable controls
     m_ui->runClustering->setEnabled(false);
     m_ui->computeClusters->setEnabled(false);
@@ -110,6 +137,17 @@ void AnalysisClustering::slotRun()
     m_ui->createSelections->setEnabled(false);
     // clear the selected spots
     m_selected_spots.clear();
+    // the t-SNE progress is shown with its intermediate embeddings
+    if (m_ui->tab->currentIndex() == 0) {
+        m_tsne.reset();
+        m_ui->progressBar->setRange(0, m_ui->max_iter->value());
+        m_ui->progressBar->setValue(0);
+        m_ui->stopClustering->setEnabled(true);
+        initSnapshotPlot();
+        m_snapshot_timer.start();
+    } else {
+        m_ui->progressBar->setRange(0,0);
+    }
     // make the call
     QFuture<void> future = QtConcurrent::run(this, &AnalysisClustering::computeColorsAsync);
     m_watcher_colors.setFuture(future);
@@ -178,7 +216,10 @@ mat AnalysisClustering::filterMatrix()
 unsigned AnalysisClustering::computeClustersAsync()
 {
     const mat &A = filterMatrix();
-    return RInterface::computeSpotClasses(A);
+    // keep the estimated clusters so they can be reused by the clustering
+    m_estimated_clusters = GraphClustering::estimateClusters(A, m_estimated_colors);
+    m_estimated_spots = m_spots;
+    return m_estimated_clusters;
 }
 
 void AnalysisClustering::computeColorsAsync()
@@ -193,19 +234,47 @@ void AnalysisClustering::computeColorsAsync()
     const int max_iter = tsne_tab->findChild<QSpinBox *>("max_iter")->value();
     const int init_dim = tsne_tab->findChild<QSpinBox *>("init_dims")->value();
     const bool kmeans = m_ui->kmeans->isChecked();
+    const bool graph = m_ui->graph->isChecked();
     const int num_clusters = m_ui->clusters->value();
     const bool scale = pca_tab->findChild<QCheckBox *>("scale")->isChecked();
     const bool center = pca_tab->findChild<QCheckBox *>("center")->isChecked();
     const bool tsne = m_ui->tab->currentIndex() == 0;
 
     const mat &A = filterMatrix();
-    // Surprisingly it is much faster to call R's tsne/pca than to use C++ implementation....
-    RInterface::spotClassification(A, tsne, kmeans, num_clusters, init_dim, no_dims, perplexity,
-                                   max_iter, theta, scale, center, m_colors, m_reduced_coordinates);
+    m_colors.clear();
+
+    // the 2D coordinates (the t-SNE embedding is published while it converges)
+    const bool reduced = tsne
+            ? m_tsne.compute(A, init_dim, perplexity, theta, max_iter, snapshot_interval,
+                             m_reduced_coordinates)
+            : PCA::compute(A, no_dims, center, scale, m_reduced_coordinates);
+    if (!reduced) {
+        return;
+    }
+
+    if (graph) {
+        // the clusters are computed natively (at most as many as the spin box allows)
+        GraphClustering::graphClusters(A, m_ui->clusters->maximum(), m_colors);
+        return;
+    }
+
+    // the estimated clusters are used to initialize KMeans if they were computed
+    // for the same spots and number of clusters
+    std::vector<int> init_colors;
+    if (kmeans && m_estimated_spots == m_spots
+            && static_cast<int>(m_estimated_clusters) == num_clusters) {
+        init_colors = m_estimated_colors;
+    }
+
+    RInterface::spotClassification(m_reduced_coordinates, kmeans, num_clusters, init_colors,
+                                   m_colors);
 }
 
 void AnalysisClustering::colorsComputed()
 {
+    // stop the intermediate embeddings
+    m_snapshot_timer.stop();
+    m_ui->stopClustering->setEnabled(false);
     // stop progress bar
     m_ui->progressBar->setMaximum(10);
     // enable run button
@@ -223,36 +292,24 @@ void AnalysisClustering::colorsComputed()
         return;
     }
 
-    const int num_clusters = m_ui->clusters->value();
-    Q_ASSERT(*std::min_element(std::begin(m_colors), std::end(m_colors)) == 0
-             && *std::max_element(std::begin(m_colors), std::end(m_colors)) == (num_clusters - 1));
+    // the graph clustering determines the number of clusters
+    const int num_clusters = *std::max_element(std::begin(m_colors), std::end(m_colors)) + 1;
+    Q_ASSERT(*std::min_element(std::begin(m_colors), std::end(m_colors)) == 0);
     Q_ASSERT(m_colors.size() == m_spots.size());
+    m_ui->clusters->setValue(num_clusters);
 
-    // Create one serie for each different cluster (color)
-    m_series_vector.clear();
-    for (int k = 0; k < num_clusters; ++k) {
-        QScatterSeries *series = new QScatterSeries(this);
-        series->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-        series->setMarkerSize(10.0);
-        series->setColor(Color::color_list.at(k));
-        series->setUseOpenGL(false);
-        m_series_vector.push_back(series);
-    }
-
-    // add the respective spot (t-SNE coordinates) to the serie it belongs to
+    // all the spots (t-SNE coordinates) are drawn by one scatter plot colored by cluster
+    QVector<QPointF> points(m_colors.size());
+    QVector<QRgb> colors(m_colors.size());
     for (unsigned i = 0; i < m_colors.size(); ++i) {
-        const int k = m_colors.at(i);
-        const float x = m_reduced_coordinates.at(i,0);
-        const float y = m_reduced_coordinates.at(i,1);
-        m_series_vector[k]->append(x, y);
+        points[i] = QPointF(m_reduced_coordinates.at(i,0), m_reduced_coordinates.at(i,1));
+        colors[i] = Color::color_list.at(m_colors.at(i)).rgba();
     }
 
     // update the scatter plot
     m_ui->plot->setRenderHint(QPainter::Antialiasing);
     m_ui->plot->chart()->removeAllSeries();
-    for (auto series : m_series_vector) {
-        m_ui->plot->chart()->addSeries(series);
-    }
+    m_ui->plot->setScatterPoints(points, colors);
 
     const int min_x = m_reduced_coordinates.col(0).min();
     const int max_x = m_reduced_coordinates.col(0).max();
@@ -270,6 +327,10 @@ void AnalysisClustering::colorsComputed()
     m_ui->plot->chart()->axisY()->setLabelsVisible(true);
     m_ui->plot->chart()->axisY()->setRange(min_y - 1, max_y + 1);
     m_ui->plot->chart()->axisY()->setTitleText(tr("TSNE/PCA 2"));
+    // one legend entry for each cluster (color)
+    for (int k = 0; k < num_clusters; ++k) {
+        m_ui->plot->addLegendEntry(QString(), Color::color_list.at(k));
+    }
 
     // enable export controls
     m_ui->exportPlot->setEnabled(true);
@@ -299,26 +360,63 @@ void AnalysisClustering::classesComputed()
     }
 }
 
+void AnalysisClustering::slotStop()
+{
+    // the current embedding is used to compute the clusters
+    m_tsne.stop();
+    m_ui->stopClustering->setEnabled(false);
+}
+
+void AnalysisClustering::initSnapshotPlot()
+{
+    m_ui->plot->chart()->removeAllSeries();
+    m_ui->plot->chart()->setTitle("t-SNE embedding (computing clusters...)");
+}
+
+void AnalysisClustering::slotUpdateSnapshot()
+{
+    TSNE::Snapshot snapshot;
+    if (!m_tsne.snapshot(snapshot)) {
+        return;
+    }
+    m_ui->progressBar->setValue(snapshot.iteration);
+
+    const mat &coordinates = snapshot.embedding;
+    QVector<QPointF> points;
+    points.reserve(coordinates.n_rows);
+    for (uword i = 0; i < coordinates.n_rows; ++i) {
+        points.append(QPointF(coordinates.at(i,0), coordinates.at(i,1)));
+    }
+    // all the points are replaced at once (the axes are created with the first embedding)
+    const bool create_axes = m_ui->plot->chart()->series().empty();
+    m_ui->plot->setScatterPoints(points, QVector<QRgb>(points.size(), QColor(Qt::gray).rgba()));
+    if (create_axes) {
+        m_ui->plot->chart()->createDefaultAxes();
+        m_ui->plot->chart()->axisX()->setGridLineVisible(false);
+        m_ui->plot->chart()->axisX()->setTitleText(tr("TSNE 1"));
+        m_ui->plot->chart()->axisY()->setGridLineVisible(false);
+        m_ui->plot->chart()->axisY()->setTitleText(tr("TSNE 2"));
+    }
+
+    const int min_x = coordinates.col(0).min();
+    const int max_x = coordinates.col(0).max();
+    const int min_y = coordinates.col(1).min();
+    const int max_y = coordinates.col(1).max();
+    m_ui->plot->chart()->axisX()->setRange(min_x - 1, max_x + 1);
+    m_ui->plot->chart()->axisY()->setRange(min_y - 1, max_y + 1);
+}
+
 void AnalysisClustering::slotLassoSelection(const QPainterPath &path)
 {
-    QList<QPointF> selected_points;
-    for (const auto series : m_series_vector) {
-        for (const QPointF point : series->points()) {
-            const QPointF scene_point = m_ui->plot->chart()->mapToPosition(point, series);
-            const QPoint view_point = m_ui->plot->mapFromScene(scene_point);
-            if (path.contains(view_point)) {
-                selected_points.append(point);
-            }
-        }
+    // the spots can not be selected while they are being computed
+    if (m_watcher_colors.isRunning() || m_colors.empty()) {
+        return;
     }
 
+    // the points of the scatter plot are the spots
     m_selected_spots.clear();
-    for (unsigned i = 0; i < m_colors.size(); ++i) {
-        const float x = m_reduced_coordinates.at(i,0);
-        const float y = m_reduced_coordinates.at(i,1);
-        if (selected_points.contains(QPointF(x,y))) {
-            m_selected_spots.append(m_spots.at(i));
-        }
+    for (const int index : m_ui->plot->scatterPointsIn(path)) {
+        m_selected_spots.append(m_spots.at(index));
     }
 
     if (!m_selected_spots.empty()) {
@@ -3,9 +3,10 @@
 
 #include <QDialog>
 #include <QFutureWatcher>
-#include <QScatterSeries>
+#include <QTimer>
 
 #include "data/STData.h"
+#include "math/TSNE.h"
 
 namespace Ui {
 class analysisClustering;
@@ -52,7 +53,7 @@ private slots:
 
     // Performs a dimensionality reduction (t-SNE or PCA) on the data matrix and then
     // cluster the reduced coordinates (2D) using KMeans or HClust so to compute classes/colors
-    // for each spot
+    // for each spot (or cluster the spots natively using a shared nearest neighbours graph)
     void slotRun();
 
     // exports the scatter plot to a file
@@ -62,8 +63,15 @@ private slots:
     void slotLassoSelection(const QPainterPath &path);
 
     // when the user wants to estimate the number of clusters from the data
+    // (kNN graph + Louvain communities)
     void slotComputeClusters();
 
+    // when the user wants to stop the t-SNE optimization and keep the current embedding
+    void slotStop();
+
+    // shows the last intermediate t-SNE embedding (if any) while it is being computed
+    void slotUpdateSnapshot();
+
 private:
 
     // helper function to do the heavy computations on a different thread
@@ -79,6 +87,9 @@ private:
     // helper function to filter the matrix of counts
     mat filterMatrix();
 
+    // helper function to show all the spots while the clusters are computed
+    void initSnapshotPlot();
+
     // the data
     STData::STDataFrame m_data;
 
@@ -87,16 +98,22 @@ private:
     mat m_reduced_coordinates;
     QList<QString> m_spots;
 
+    // the estimated clusters (number, color of each spot and spots used)
+    unsigned m_estimated_clusters;
+    std::vector<int> m_estimated_colors;
+    QList<QString> m_estimated_spots;
+
     // the computational threads
     QFutureWatcher<void> m_watcher_colors;
     QFutureWatcher<unsigned> m_watcher_classes;
 
+    // the t-SNE engine and the timer to show its intermediate embeddings
+    TSNE m_tsne;
+    QTimer m_snapshot_timer;
+
     // the user selected spots
     QList<QString> m_selected_spots;
 
-    // the splot serie's
-    QList<QScatterSeries *> m_series_vector;
-
     // The UI object
     QScopedPointer<Ui::analysisClustering> m_ui;
 };
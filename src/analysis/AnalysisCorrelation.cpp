@@ -7,7 +7,8 @@
 #include <QCheckBox>
 #include <QSet>
 #include <QMessageBox>
-#include <QtMath>
+#include <QToolTip>
+#include <QCursor>
 
 #include "math/RInterface.h"
 
@@ -57,6 +58,10 @@ AnalysisCorrelation::AnalysisCorrelation(const STData::STDataFrame &data1,
                 this, &AnalysisCorrelation::slotUpdateData);
         connect(m_ui->exportPlot, &QPushButton::clicked,
                 this, &AnalysisCorrelation::slotExportPlot);
+        connect(m_ui->plot, &ChartView::signalScatterPointClicked,
+                this, &AnalysisCorrelation::slotClickedPoint);
+        connect(m_ui->plot, &ChartView::signalScatterPointHovered,
+                this, &AnalysisCorrelation::slotHoveredPoint);
 
         // Update the plots and data fields
         slotUpdateData();
@@ -97,21 +102,15 @@ void AnalysisCorrelation::slotUpdateData()
     m_ui->pearson->setText(QString::number(pearson));
     m_ui->spearman->setText(QString::number(spearman));
 
-    // create scatter plot
-    m_series.reset(new QScatterSeries());
-    m_series->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-    m_series->setMarkerSize(5.0);
-    m_series->setColor(Qt::blue);
-    m_series->setUseOpenGL(false);
+    // create scatter plot (the index of each point is the index of its gene)
+    QVector<QPointF> points(m_rowsumA.size());
     for (unsigned i = 0; i < m_rowsumA.size(); ++i) {
-        m_series->append(m_rowsumA.at(i), m_rowsumB.at(i));
+        points[i] = QPointF(m_rowsumA.at(i), m_rowsumB.at(i));
     }
-    connect(m_series.data(), &QScatterSeries::clicked,
-            this, &AnalysisCorrelation::slotClickedPoint);
 
     m_ui->plot->setRenderHint(QPainter::Antialiasing);
     m_ui->plot->chart()->removeAllSeries();
-    m_ui->plot->chart()->addSeries(m_series.data());
+    m_ui->plot->setScatterPoints(points, QVector<QRgb>(points.size(), QColor(Qt::blue).rgba()), 5.0);
     m_ui->plot->chart()->setTitle("Correlation Plot (Accumulated genes counts)");
     m_ui->plot->chart()->setDropShadowEnabled(false);
     m_ui->plot->chart()->legend()->hide();
@@ -129,38 +128,20 @@ void AnalysisCorrelation::slotExportPlot()
     m_ui->plot->slotExportPlot(tr("Correlation Plot"));
 }
 
-void AnalysisCorrelation::slotClickedPoint(const QPointF point)
+void AnalysisCorrelation::slotClickedPoint(const int index)
 {
-    // Find the closest point from the series
-    const QPointF clickedPoint = point;
-    float closest_x = INT_MAX;
-    float closest_y = INT_MAX;
-    float distance = INT_MAX;
-    for (const auto point : m_series->points()) {
-        const float currentDistance = qSqrt((point.x() - clickedPoint.x())
-                                            * (point.x() - clickedPoint.x())
-                                            + (point.y() - clickedPoint.y())
-                                            * (point.y() - clickedPoint.y()));
-        if (currentDistance < distance) {
-            distance = currentDistance;
-            closest_x = point.x();
-            closest_y = point.y();
-        }
-    }
-
-    // Find the spot corresponding to the clicked point
-    int spot_index = -1;
-    for (unsigned i = 0; i < m_rowsumA.size(); ++i) {
-        const float x = m_rowsumA.at(i);
-        const float y = m_rowsumB.at(i);
-        if (x == closest_x && y == closest_y) {
-            spot_index = i;
-            break;
-        }
+    // Update the field with the clicked gene
+    if (index >= 0 && index < m_genes.size()) {
+        m_ui->selected_gene->setText(m_genes.at(index));
     }
+}
 
-    // Update the fied if valid gene was found
-    if (spot_index != -1) {
-        m_ui->selected_gene->setText(m_genes.at(spot_index));
+void AnalysisCorrelation::slotHoveredPoint(const int index)
+{
+    // show the name of the gene under the mouse
+    if (index >= 0 && index < m_genes.size()) {
+        QToolTip::showText(QCursor::pos(), m_genes.at(index), m_ui->plot);
+    } else {
+        QToolTip::hideText();
     }
 }
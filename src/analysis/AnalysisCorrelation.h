@@ -2,7 +2,6 @@
 #define ANALYSISCORRELATION_H
 
 #include <QWidget>
-#include <QScatterSeries>
 
 #include "data/STData.h"
 
@@ -38,7 +37,10 @@ private slots:
     void slotExportPlot();
 
     // when the user clicks a point in the plot
-    void slotClickedPoint(const QPointF point);
+    void slotClickedPoint(const int index);
+
+    // when the mouse moves over a point in the plot
+    void slotHoveredPoint(const int index);
 
 private:
 
@@ -56,9 +58,6 @@ private:
     std::vector<double> m_rowsumB;
     QList<QString> m_genes;
 
-    // store the plotting series to allow interaction with the plot
-    QScopedPointer<QScatterSeries> m_series;
-
     Q_DISABLE_COPY(AnalysisCorrelation)
 };
 
@@ -5,7 +5,6 @@
 #include <QMessageBox>
 #include <QStandardItemModel>
 #include <QChartView>
-#include <QScatterSeries>
 #include <QFuture>
 #include <QtConcurrent>
 
@@ -142,44 +141,32 @@ void AnalysisDEA::slotGeneSelected(QModelIndex index)
 
 void AnalysisDEA::updatePlot()
 {
-    QScatterSeries *series1 = new QScatterSeries();
-    QScatterSeries *series2 = new QScatterSeries();
-
-    series1->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-    series1->setMarkerSize(5.0);
-    series1->setColor(Qt::gray);
-    series1->setUseOpenGL(false);
-
-    series2->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-    series2->setMarkerSize(5.0);
-    series2->setColor(Qt::red);
-    series2->setUseOpenGL(false);
-
-    // populate
+    // all the genes are drawn by one scatter plot (the significant ones in red)
+    QVector<QPointF> points;
+    QVector<QRgb> colors;
+    points.reserve(m_results.n_rows);
+    colors.reserve(m_results.n_rows);
+    const QRgb color_gray = QColor(Qt::gray).rgba();
+    const QRgb color_red = QColor(Qt::red).rgba();
     for (uword i = 0; i < m_results.n_rows; ++i) {
         const double fdr = m_results.at(i, 5);
         const double pvalue = -log10(m_results.at(i, 4) + std::numeric_limits<double>::epsilon());
         const double foldchange = m_results.at(i, 1);
-        if (fdr <= m_ui->fdr->value() && std::abs(foldchange) >= m_ui->foldchange->value()) {
-            series2->append(foldchange, pvalue);
-        } else {
-            series1->append(foldchange, pvalue);
-        }
+        const bool significant =
+                fdr <= m_ui->fdr->value() && std::abs(foldchange) >= m_ui->foldchange->value();
+        points.append(QPointF(foldchange, pvalue));
+        colors.append(significant ? color_red : color_gray);
     }
 
     m_ui->plot->setRenderHint(QPainter::Antialiasing);
     m_ui->plot->chart()->removeAllSeries();
-    m_ui->plot->chart()->addSeries(series1);
-    m_ui->plot->chart()->addSeries(series2);
+    m_ui->plot->setScatterPoints(points, colors, 5.0);
 
+    // the highlighted gene has its own marker (drawn on top of the scatter plot)
     if (!m_gene_highlight.isNull()) {
-        QScatterSeries *series3 = new QScatterSeries();
-        series3->setMarkerSize(8.0);
-        series3->setMarkerShape(QScatterSeries::MarkerShapeRectangle);
-        series3->setColor(Qt::darkMagenta);
-        series3->setUseOpenGL(false);
-        *series3 << m_gene_highlight;
-        m_ui->plot->chart()->addSeries(series3);
+        m_ui->plot->setScatterHighlight(m_gene_highlight, Qt::darkMagenta, 8.0);
+    } else {
+        m_ui->plot->clearScatterHighlight();
     }
 
     m_ui->plot->chart()->setTitle("Volcano plot");
@@ -1,10 +1,11 @@
 #include "AnalysisPCA.h"
 
 #include <QChartView>
-#include <QScatterSeries>
+#include <QMessageBox>
+#include <QtConcurrent>
 
 #include "color/HeatMap.h"
-#include "math/RInterface.h"
+#include "math/PCA.h"
 
 #include "ui_AnalysisPCA.h"
 
@@ -12,74 +13,151 @@ AnalysisPCA::AnalysisPCA(const QList<STData::STDataFrame> &datasets,
                          const QList<QString> &names,
                          QWidget *parent, Qt::WindowFlags f)
     : QWidget(parent, f)
+    , m_datasets(datasets)
+    , m_names(names)
+    , m_per_spot(false)
     , m_ui(new Ui::AnalysisPCA)
 {
     m_ui->setupUi(this);
 
-    QSet<QString> merged_genes;
-    for (unsigned i = 0; i < datasets.size(); ++i) {
-        const auto data = datasets.at(i);
-        merged_genes += data.genes.toSet();
+    connect(m_ui->exportPlot, &QPushButton::clicked, this, &AnalysisPCA::slotExportPlot);
+    connect(m_ui->perSpot, &QCheckBox::toggled, this, &AnalysisPCA::slotRun);
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &AnalysisPCA::resultsComputed);
+
+    slotRun();
+}
+
+AnalysisPCA::~AnalysisPCA()
+{
+    m_watcher.waitForFinished();
+}
+
+void AnalysisPCA::slotRun()
+{
+    qDebug() << "Computing PCA asynchronously";
+    // initialize progress bar
+    m_ui->progressBar->setRange(0,0);
+    // disable controls
+    m_ui->perSpot->setEnabled(false);
+    m_ui->exportPlot->setEnabled(false);
+    m_per_spot = m_ui->perSpot->isChecked();
+    // make the call
+    QFuture<void> future = QtConcurrent::run(this, &AnalysisPCA::computePCAAsync);
+    m_watcher.setFuture(future);
+}
+
+void AnalysisPCA::computePCAAsync()
+{
+    // merge the genes of all the selections (gene to column index)
+    QHash<QString, uword> gene_index;
+    for (const auto &data : m_datasets) {
+        for (const auto &gene : data.genes) {
+            if (!gene_index.contains(gene)) {
+                gene_index.insert(gene, gene_index.size());
+            }
+        }
     }
-    QList<QString> genes = merged_genes.toList();
-
-    const unsigned n_rows = datasets.size();
-    const unsigned n_cols = merged_genes.size();
-    mat merged(n_rows, n_cols);
-    merged.fill(0.0);
-
-    for (unsigned d = 0; d < datasets.size(); ++d) {
-        const auto data = datasets.at(d);
-        const rowvec colsums = sum(data.counts, 0);
-        for (uword j = 0; j < n_cols; ++j) {
-            const auto &gene = genes.at(j);
-            const int index = data.genes.indexOf(gene);
-            if (index != -1) {
-                merged.at(d, j) = colsums.at(index);
+    const uword n_cols = gene_index.size();
+
+    m_labels.clear();
+    if (!m_per_spot) {
+        // one row per selection with the aggregated counts of each gene
+        mat merged(m_datasets.size(), n_cols, fill::zeros);
+        for (int d = 0; d < m_datasets.size(); ++d) {
+            const auto &data = m_datasets.at(d);
+            const rowvec colsums = sum(data.counts, 0);
+            for (int j = 0; j < data.genes.size(); ++j) {
+                merged.at(d, gene_index.value(data.genes.at(j))) = colsums.at(j);
             }
+            m_labels.append(d);
         }
+        PCA::compute(merged, 2, true, false, m_results);
+    } else {
+        // one row per spot with the log counts (sparse so the matrix is never densified)
+        uword n_rows = 0;
+        uword n_values = 0;
+        for (const auto &data : m_datasets) {
+            n_rows += data.counts.n_rows;
+            n_values += accu(data.counts != 0);
+        }
+        umat locations(2, n_values);
+        vec values(n_values);
+        uword row_offset = 0;
+        uword k = 0;
+        for (int d = 0; d < m_datasets.size(); ++d) {
+            const auto &data = m_datasets.at(d);
+            for (uword j = 0; j < data.counts.n_cols; ++j) {
+                const uword column = gene_index.value(data.genes.at(j));
+                for (uword i = 0; i < data.counts.n_rows; ++i) {
+                    const double value = data.counts.at(i, j);
+                    if (value != 0) {
+                        locations.at(0, k) = row_offset + i;
+                        locations.at(1, k) = column;
+                        values.at(k) = std::log1p(value);
+                        ++k;
+                    }
+                }
+            }
+            m_labels += QVector<int>(data.counts.n_rows, d);
+            row_offset += data.counts.n_rows;
+        }
+        const sp_mat spots(locations, values, n_rows, n_cols);
+        PCA::compute(spots, 2, true, false, m_results);
+    }
+}
+
+void AnalysisPCA::resultsComputed()
+{
+    // stop progress bar
+    m_ui->progressBar->setMaximum(10);
+    // enable controls
+    m_ui->perSpot->setEnabled(true);
+
+    if (m_results.empty()) {
+        QMessageBox::critical(this,
+                              tr("PCA"),
+                              tr("There was an error computing the PCA"));
+        return;
     }
+    Q_ASSERT(m_results.n_rows == static_cast<uword>(m_labels.size()));
 
-    mat results;
-    RInterface::PCA(merged, false, true, results);
-
-    for (unsigned d = 0; d < datasets.size(); ++d) {
-        QScatterSeries *series = new QScatterSeries(this);
-        series->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-        series->setMarkerSize(10.0);
-        series->setColor(Color::color_list.at(d));
-        series->setUseOpenGL(false);
-        series->setName(names.at(d));
-        const float x = results.at(d,0);
-        const float y = results.at(d,1);
-        series->append(x, y);
-        m_ui->plot->chart()->addSeries(series);
+    // all the points are drawn by one scatter plot colored by selection
+    QVector<QPointF> points(m_labels.size());
+    QVector<QRgb> colors(m_labels.size());
+    for (int i = 0; i < m_labels.size(); ++i) {
+        points[i] = QPointF(m_results.at(i,0), m_results.at(i,1));
+        colors[i] = Color::color_list.at(m_labels.at(i)).rgba();
     }
 
-    const int min_x = results.col(0).min();
-    const int max_x = results.col(0).max();
-    const int min_y = results.col(1).min();
-    const int max_y = results.col(1).max();
+    m_ui->plot->chart()->removeAllSeries();
+    m_ui->plot->setScatterPoints(points, colors, m_per_spot ? 5.0 : 10.0);
+
+    const double min_x = m_results.col(0).min();
+    const double max_x = m_results.col(0).max();
+    const double min_y = m_results.col(1).min();
+    const double max_y = m_results.col(1).max();
+    const double offset_x = std::max(1.0, (max_x - min_x) * 0.05);
+    const double offset_y = std::max(1.0, (max_y - min_y) * 0.05);
 
     m_ui->plot->setRenderHint(QPainter::Antialiasing);
-    m_ui->plot->chart()->setTitle("PCA selections");
+    m_ui->plot->chart()->setTitle(m_per_spot ? tr("PCA spots") : tr("PCA selections"));
     m_ui->plot->chart()->setDropShadowEnabled(false);
     m_ui->plot->chart()->legend()->show();
     m_ui->plot->chart()->createDefaultAxes();
     m_ui->plot->chart()->axisX()->setGridLineVisible(false);
     m_ui->plot->chart()->axisX()->setLabelsVisible(true);
-    m_ui->plot->chart()->axisX()->setRange(min_x - 5, max_x + 5);
+    m_ui->plot->chart()->axisX()->setRange(min_x - offset_x, max_x + offset_x);
     m_ui->plot->chart()->axisX()->setTitleText(tr("PCA 1"));
     m_ui->plot->chart()->axisY()->setGridLineVisible(false);
     m_ui->plot->chart()->axisY()->setLabelsVisible(true);
-    m_ui->plot->chart()->axisY()->setRange(min_y - 5, max_y + 5);
+    m_ui->plot->chart()->axisY()->setRange(min_y - offset_y, max_y + offset_y);
     m_ui->plot->chart()->axisY()->setTitleText(tr("PCA 2"));
+    // one legend entry for each selection
+    for (int d = 0; d < m_datasets.size(); ++d) {
+        m_ui->plot->addLegendEntry(m_names.at(d), Color::color_list.at(d));
+    }
 
-    connect(m_ui->exportPlot, &QPushButton::clicked, this, &AnalysisPCA::slotExportPlot);
-}
-
-AnalysisPCA::~AnalysisPCA()
-{
+    m_ui->exportPlot->setEnabled(true);
 }
 
 void AnalysisPCA::slotExportPlot()
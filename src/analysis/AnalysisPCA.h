@@ -2,6 +2,7 @@
 #define ANALYSISPCA_H
 
 #include <QWidget>
+#include <QFutureWatcher>
 
 #include "data/STData.h"
 
@@ -9,6 +10,10 @@ namespace Ui {
 class AnalysisPCA;
 }
 
+// A Widget that shows a PCA plot of a list of selections
+// The PCA can be computed on the aggregated counts of each selection (one point per selection)
+// or on the individual spots of all the selections (one point per spot)
+// The computation is native and performed in a different thread
 class AnalysisPCA : public QWidget
 {
     Q_OBJECT
@@ -25,8 +30,31 @@ private slots:
     // to save the plot to a file
     void slotExportPlot();
 
+    // computes the PCA (selections or spots) asynchronously
+    void slotRun();
+
 private:
 
+    // helper function to do the heavy computations on a different thread
+    void computePCAAsync();
+
+    // function to update the plot once the PCA has been computed
+    void resultsComputed();
+
+    // the selections
+    QList<STData::STDataFrame> m_datasets;
+    QList<QString> m_names;
+
+    // true to compute the PCA of the individual spots
+    bool m_per_spot;
+
+    // the results (one row per selection or spot) and the selection each row belongs to
+    mat m_results;
+    QVector<int> m_labels;
+
+    // the computational thread
+    QFutureWatcher<void> m_watcher;
+
     // GUI object
     QScopedPointer<Ui::AnalysisPCA> m_ui;
 
@@ -2,9 +2,9 @@
 
 #include <QChartView>
 #include <QValueAxis>
-#include <QScatterSeries>
 
 #include "color/HeatMap.h"
+#include "color/ColorMap.h"
 
 #include "ui_analysisScatter.h"
 
@@ -24,32 +24,23 @@ AnalysisScatter::AnalysisScatter(const STData::STDataFrame &data,
     const float max_reads = spot_reads.max();
     const float min_genes = spot_genes.min();
     const float max_genes = spot_genes.max();
-    for (unsigned i = 0; i < num_spots; ++i) {
-        QScatterSeries *series_reads = new QScatterSeries(this);
-        QScatterSeries *series_genes = new QScatterSeries(this);
-        series_reads->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-        series_reads->setMarkerSize(10.0);
-        series_reads->setUseOpenGL(false);
-
-        series_genes->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-        series_genes->setMarkerSize(10.0);
-        series_genes->setUseOpenGL(false);
 
-        const auto &spot = Spot::getCoordinates(data.spots.at(i));
-        const float value_reads = spot_reads.at(i);
-        const float value_genes = spot_genes.at(i);
-        const QColor color_reads = Color::createCMapColor(value_reads, min_reads,
-                                                          max_reads, Color::ColorGradients::gpHot);
-        const QColor color_genes = Color::createCMapColor(value_genes, min_genes,
-                                                          max_genes, Color::ColorGradients::gpHot);
-        series_reads->setColor(color_reads);
-        series_reads->append(spot.first, spot.second * -1);
-        m_ui->plotReads->chart()->addSeries(series_reads);
+    // the colors of all the spots are computed at once
+    const auto &color_map = Color::ColorMap::get(Color::ColorGradients::gpHot);
+    const colvec genes_values = conv_to<colvec>::from(spot_genes);
+    QVector<QRgb> colors_reads(num_spots);
+    QVector<QRgb> colors_genes(num_spots);
+    color_map.map(spot_reads.memptr(), num_spots, min_reads, max_reads, colors_reads.data());
+    color_map.map(genes_values.memptr(), num_spots, min_genes, max_genes, colors_genes.data());
 
-        series_genes->setColor(color_genes);
-        series_genes->append(spot.first, spot.second * -1);
-        m_ui->plotGenes->chart()->addSeries(series_genes);
+    // all the spots are drawn by one scatter plot (one color per spot)
+    QVector<QPointF> points(num_spots);
+    for (unsigned i = 0; i < num_spots; ++i) {
+        const auto &spot = SpotStore::getCoordinates(data.spots.at(i));
+        points[i] = QPointF(spot.first, spot.second * -1);
     }
+    m_ui->plotReads->setScatterPoints(points, colors_reads);
+    m_ui->plotGenes->setScatterPoints(points, colors_genes);
 
     m_ui->plotReads->chart()->setTitle(tr("Spots colored by expression (transcripts)"));
     m_ui->plotReads->chart()->setDropShadowEnabled(false);
@@ -5,6 +5,12 @@
 #include <QFileDialog>
 #include <QPdfWriter>
 #include <QMessageBox>
+#include <QLegendMarker>
+#include <QMetaMethod>
+
+#include <algorithm>
+
+#include "ScatterPlotItem.h"
 
 static const QColor lasso_color = QColor(0,0,255,90);
 
@@ -12,9 +18,19 @@ ChartView::ChartView(QWidget *parent)
     : QChartView(parent)
     , m_panning(false)
     , m_lassoSelection(false)
+    , m_scatter(nullptr)
+    , m_scatter_series()
+    , m_scatter_index()
+    , m_scatter_index_valid(false)
+    , m_hovered(-1)
 {
     setChart(new QChart());
     setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+    setMouseTracking(true);
+
+    // the scatter plot item is owned by the chart
+    m_scatter = new ScatterPlotItem(chart());
+    connect(chart(), &QChart::geometryChanged, this, [=]() { m_scatter->updateGeometry(); });
 }
 
 ChartView::~ChartView()
@@ -34,6 +50,7 @@ void ChartView::mousePressEvent(QMouseEvent *event)
     if (is_left) {
         m_panning = true;
         m_originPanning = event->pos();
+        m_originClick = event->pos();
         setCursor(Qt::ClosedHandCursor);
     } else if (is_right) {
         m_lassoSelection = true;
@@ -58,6 +75,12 @@ void ChartView::mouseMoveEvent(QMouseEvent *event)
             m_originLasso = new_point;
             chart()->update(chart()->plotArea());
         }
+    } else if (isSignalConnected(QMetaMethod::fromSignal(&ChartView::signalScatterPointHovered))) {
+        const int index = scatterPointAt(event->pos());
+        if (index != m_hovered) {
+            m_hovered = index;
+            emit signalScatterPointHovered(index);
+        }
     }
     QChartView::mouseMoveEvent(event);
 }
@@ -67,6 +90,13 @@ void ChartView::mouseReleaseEvent(QMouseEvent *event)
     if (m_panning) {
         unsetCursor();
         m_panning = false;
+        // a click (without panning) on a point of the scatter plot
+        if ((event->pos() - m_originClick).manhattanLength() <= 2) {
+            const int index = scatterPointAt(event->pos());
+            if (index != -1) {
+                emit signalScatterPointClicked(index);
+            }
+        }
     } else if (m_lassoSelection) {
         emit signalLassoSelection(m_lasso);
         m_lasso = QPainterPath();
@@ -110,6 +140,125 @@ void ChartView::keyPressEvent(QKeyEvent *event)
     }
 }
 
+void ChartView::setScatterPoints(const QVector<QPointF> &points,
+                                 const QVector<QRgb> &colors,
+                                 const qreal marker_size)
+{
+    if (points.empty()) {
+        clearScatterPoints();
+        return;
+    }
+
+    // the hidden series spans the bounding box of the points
+    qreal min_x = points.first().x();
+    qreal max_x = min_x;
+    qreal min_y = points.first().y();
+    qreal max_y = min_y;
+    for (const QPointF &point : points) {
+        min_x = std::min(min_x, point.x());
+        max_x = std::max(max_x, point.x());
+        min_y = std::min(min_y, point.y());
+        max_y = std::max(max_y, point.y());
+    }
+    const QVector<QPointF> corners = {QPointF(min_x, min_y), QPointF(max_x, max_y)};
+    // the series (and its axes) is kept if the points are replaced
+    if (m_scatter_series.isNull()) {
+        QScatterSeries *series = new QScatterSeries(this);
+        series->setMarkerSize(0.0);
+        series->setColor(Qt::transparent);
+        series->setBorderColor(Qt::transparent);
+        series->replace(corners);
+        chart()->addSeries(series);
+        for (QLegendMarker *marker : chart()->legend()->markers(series)) {
+            marker->setVisible(false);
+        }
+        m_scatter_series = series;
+    } else {
+        m_scatter_series->replace(corners);
+    }
+
+    m_scatter->setMarkerSize(marker_size);
+    m_scatter->setPoints(points, colors);
+    m_scatter->setSeries(m_scatter_series);
+    m_scatter_index_valid = false;
+    m_hovered = -1;
+}
+
+void ChartView::clearScatterPoints()
+{
+    if (!m_scatter_series.isNull()) {
+        chart()->removeSeries(m_scatter_series);
+        delete m_scatter_series;
+    }
+    m_scatter->setSeries(nullptr);
+    m_scatter->clear();
+    m_scatter->clearHighlight();
+    m_scatter_index.clear();
+    m_scatter_index_valid = false;
+    m_hovered = -1;
+}
+
+void ChartView::setScatterHighlight(const QPointF &point, const QColor &color, const qreal size)
+{
+    m_scatter->setHighlight(point, color, size);
+}
+
+void ChartView::clearScatterHighlight()
+{
+    m_scatter->clearHighlight();
+}
+
+void ChartView::addLegendEntry(const QString &name, const QColor &color)
+{
+    // an empty series (not attached to the axes) only shows its marker
+    QScatterSeries *series = new QScatterSeries(this);
+    series->setMarkerShape(QScatterSeries::MarkerShapeCircle);
+    series->setColor(color);
+    series->setName(name);
+    chart()->addSeries(series);
+}
+
+QVector<int> ChartView::scatterPointsIn(const QPainterPath &path) const
+{
+    QVector<int> indexes;
+    QTransform transform;
+    if (!m_scatter->dataTransform(transform) || !transform.isInvertible()) {
+        return indexes;
+    }
+    // the path in chart coordinates, only the points in its bounding box are tested
+    const QPainterPath chart_path = chart()->mapFromScene(mapToScene(path));
+    const QRectF bounds = transform.inverted().mapRect(chart_path.boundingRect());
+    const QVector<QPointF> &points = m_scatter->points();
+    for (const int index : scatterIndex().pointsIn(bounds)) {
+        if (chart_path.contains(transform.map(points.at(index)))) {
+            indexes.push_back(index);
+        }
+    }
+    return indexes;
+}
+
+int ChartView::scatterPointAt(const QPoint &pos) const
+{
+    QTransform transform;
+    if (!m_scatter->dataTransform(transform) || !transform.isInvertible()) {
+        return -1;
+    }
+    // the distance to the points is measured in pixels
+    const QPointF chart_pos = chart()->mapFromScene(mapToScene(pos));
+    const qreal radius = std::max(m_scatter->markerSize() / 2.0, 2.0);
+    return scatterIndex().nearest(transform.inverted().map(chart_pos), radius,
+                                  transform.m11(), transform.m22());
+}
+
+const PointIndex &ChartView::scatterIndex() const
+{
+    if (!m_scatter_index_valid) {
+        m_scatter_index.build(m_scatter->points());
+        m_scatter_index_valid = true;
+    }
+    return m_scatter_index;
+}
+
 void ChartView::drawForeground(QPainter *painter, const QRectF &rect)
 {
     if (!m_lasso.isEmpty()) {
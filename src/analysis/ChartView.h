@@ -4,10 +4,21 @@
 #include <QChartView>
 #include <QChart>
 #include <QRubberBand>
+#include <QPointer>
+#include <QScatterSeries>
+
+#include "math/PointIndex.h"
 
 QT_CHARTS_USE_NAMESPACE
 
+class ScatterPlotItem;
+
 // A simple wrapper around QChartView to allow zooming and mouse events
+// It can also show a high-volume scatter plot (see ScatterPlotItem) with all
+// the points in one buffer and a color per point, the axes of the chart are attached
+// to a hidden series that spans the points so zooming and panning work as usual
+// The points are indexed (see PointIndex) so the lasso, click and hover queries
+// only test the points near the query and the points keep their index (row)
 class ChartView : public QChartView
 {
     Q_OBJECT
@@ -17,9 +28,36 @@ public:
     explicit ChartView(QWidget *parent = nullptr);
     virtual ~ChartView();
 
+    // sets the points of the scatter plot (data coordinates) and the color of each point,
+    // the axes must be created afterwards (QChart::createDefaultAxes()) the first time
+    // the points are removed with clearScatterPoints() or QChart::removeAllSeries()
+    void setScatterPoints(const QVector<QPointF> &points,
+                          const QVector<QRgb> &colors,
+                          const qreal marker_size = 10.0);
+    void clearScatterPoints();
+
+    // highlights one point (data coordinates) of the scatter plot with a square marker
+    // drawn on top of all the points, it is removed with clearScatterPoints()
+    void setScatterHighlight(const QPointF &point, const QColor &color, const qreal size = 8.0);
+    void clearScatterHighlight();
+
+    // adds an entry to the legend of the chart (for the colors of the scatter plot)
+    // it must be called after the axes are created
+    void addLegendEntry(const QString &name, const QColor &color);
+
+    // the indexes of the scatter points inside the path (view coordinates)
+    QVector<int> scatterPointsIn(const QPainterPath &path) const;
+    // the index of the closest scatter point whose marker is under the position
+    // (view coordinates) or -1 if there is none
+    int scatterPointAt(const QPoint &pos) const;
+
 signals:
 
     void signalLassoSelection(QPainterPath);
+    // the user clicked on a point of the scatter plot
+    void signalScatterPointClicked(int index);
+    // the mouse moved over a point of the scatter plot (-1 when it leaves the point)
+    void signalScatterPointHovered(int index);
 
 
 public slots:
@@ -39,11 +77,21 @@ protected:
 
 private:
 
+    // the spatial index of the scatter points (data coordinates) built when it is needed
+    const PointIndex &scatterIndex() const;
+
     bool m_panning;
     bool m_lassoSelection;
     QPoint m_originPanning;
+    QPoint m_originClick;
     QPoint m_originLasso;
     QPainterPath m_lasso;
+    // the scatter plot and the series that spans its points
+    ScatterPlotItem *m_scatter;
+    QPointer<QScatterSeries> m_scatter_series;
+    mutable PointIndex m_scatter_index;
+    mutable bool m_scatter_index_valid;
+    int m_hovered;
 };
 
 #endif // CHARTVIEW_H
@@ -0,0 +1,237 @@
+#include "ScatterPlotItem.h"
+
+#include <QPainter>
+#include <QPaintDevice>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+// multiplies the four channels of the color by alpha (0-255)
+inline QRgb multiplyChannels(const QRgb color, const uint alpha)
+{
+    uint rb = (color & 0xff00ff) * alpha;
+    rb = ((rb + ((rb >> 8) & 0xff00ff) + 0x800080) >> 8) & 0xff00ff;
+    uint ag = ((color >> 8) & 0xff00ff) * alpha;
+    ag = (ag + ((ag >> 8) & 0xff00ff) + 0x800080) & 0xff00ff00;
+    return ag | rb;
+}
+
+}
+
+ScatterPlotItem::ScatterPlotItem(QChart *chart)
+    : QGraphicsItem(chart)
+    , m_chart(chart)
+    , m_series()
+    , m_points()
+    , m_colors()
+    , m_marker_size(10.0)
+    , m_cache()
+    , m_cache_valid(false)
+    , m_cache_area()
+    , m_cache_transform()
+    , m_cache_ratio(1.0)
+    , m_has_highlight(false)
+    , m_highlight()
+    , m_highlight_color()
+    , m_highlight_size(8.0)
+{
+    // above the plot area, the grid and the axes
+    setZValue(5);
+}
+
+ScatterPlotItem::~ScatterPlotItem()
+{
+}
+
+void ScatterPlotItem::setPoints(const QVector<QPointF> &points, const QVector<QRgb> &colors)
+{
+    Q_ASSERT(points.size() == colors.size());
+    m_points = points;
+    m_colors = colors;
+    m_cache_valid = false;
+    update();
+}
+
+const QVector<QPointF> &ScatterPlotItem::points() const
+{
+    return m_points;
+}
+
+const QVector<QRgb> &ScatterPlotItem::colors() const
+{
+    return m_colors;
+}
+
+void ScatterPlotItem::clear()
+{
+    m_points.clear();
+    m_colors.clear();
+    m_cache = QImage();
+    m_cache_valid = false;
+    update();
+}
+
+void ScatterPlotItem::setMarkerSize(const qreal size)
+{
+    m_marker_size = size;
+    m_cache_valid = false;
+    update();
+}
+
+qreal ScatterPlotItem::markerSize() const
+{
+    return m_marker_size;
+}
+
+void ScatterPlotItem::setHighlight(const QPointF &point, const QColor &color, const qreal size)
+{
+    m_has_highlight = true;
+    m_highlight = point;
+    m_highlight_color = color;
+    m_highlight_size = size;
+    update();
+}
+
+void ScatterPlotItem::clearHighlight()
+{
+    m_has_highlight = false;
+    update();
+}
+
+void ScatterPlotItem::setSeries(QAbstractSeries *series)
+{
+    m_series = series;
+    m_cache_valid = false;
+    update();
+}
+
+bool ScatterPlotItem::dataTransform(QTransform &transform) const
+{
+    if (m_series.isNull() || m_series->chart() != m_chart || m_series->attachedAxes().empty()) {
+        return false;
+    }
+    // the axes are linear so two points define the transformation
+    const QPointF origin = m_chart->mapToPosition(QPointF(0.0, 0.0), m_series);
+    const QPointF unit = m_chart->mapToPosition(QPointF(1.0, 1.0), m_series);
+    transform = QTransform(unit.x() - origin.x(), 0.0, 0.0, unit.y() - origin.y(),
+                           origin.x(), origin.y());
+    return true;
+}
+
+void ScatterPlotItem::updateGeometry()
+{
+    prepareGeometryChange();
+}
+
+QRectF ScatterPlotItem::boundingRect() const
+{
+    return QRectF(QPointF(0.0, 0.0), m_chart->size());
+}
+
+void ScatterPlotItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                            QWidget *widget)
+{
+    Q_UNUSED(option)
+    Q_UNUSED(widget)
+
+    QTransform transform;
+    if (m_points.empty() || !dataTransform(transform)) {
+        return;
+    }
+
+    // the points are only rasterized again if the plot changed
+    const QRectF area = m_chart->plotArea();
+    const qreal ratio = painter->device()->devicePixelRatioF();
+    if (!m_cache_valid || m_cache_area != area || m_cache_transform != transform
+            || m_cache_ratio != ratio) {
+        const QSize size = (area.size() * ratio).toSize();
+        if (size.isEmpty()) {
+            return;
+        }
+        m_cache = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        m_cache.fill(Qt::transparent);
+        const QTransform to_image = transform
+                * QTransform::fromTranslate(-area.left(), -area.top())
+                * QTransform::fromScale(ratio, ratio);
+        rasterize(m_cache, m_points, m_colors, to_image, m_marker_size * ratio);
+        m_cache.setDevicePixelRatio(ratio);
+        m_cache_area = area;
+        m_cache_transform = transform;
+        m_cache_ratio = ratio;
+        m_cache_valid = true;
+    }
+
+    painter->save();
+    painter->setClipRect(area);
+    painter->drawImage(area.topLeft(), m_cache);
+    // the highlighted point is drawn last so it is never hidden by the other points
+    if (m_has_highlight) {
+        const qreal half = m_highlight_size / 2.0;
+        const QPointF center = transform.map(m_highlight);
+        painter->fillRect(QRectF(center.x() - half, center.y() - half,
+                                 m_highlight_size, m_highlight_size),
+                          m_highlight_color);
+    }
+    painter->restore();
+}
+
+void ScatterPlotItem::rasterize(QImage &image,
+                                const QVector<QPointF> &points,
+                                const QVector<QRgb> &colors,
+                                const QTransform &transform,
+                                const qreal size)
+{
+    Q_ASSERT(image.format() == QImage::Format_ARGB32_Premultiplied);
+    Q_ASSERT(points.size() == colors.size());
+
+    // the coverage of each pixel of a marker (the edge is anti-aliased)
+    const int diameter = std::max(1, qCeil(size));
+    const qreal center = diameter / 2.0;
+    const qreal radius = size / 2.0;
+    std::vector<uchar> coverage(diameter * diameter);
+    for (int y = 0; y < diameter; ++y) {
+        for (int x = 0; x < diameter; ++x) {
+            const qreal distance = std::hypot(x + 0.5 - center, y + 0.5 - center);
+            const qreal value = qBound(0.0, radius + 0.5 - distance, 1.0);
+            coverage[y * diameter + x] = static_cast<uchar>(qRound(value * 255));
+        }
+    }
+
+    const int width = image.width();
+    const int height = image.height();
+    const int stride = image.bytesPerLine() / sizeof(QRgb);
+    QRgb *pixels = reinterpret_cast<QRgb *>(image.bits());
+    for (int i = 0; i < points.size(); ++i) {
+        const QPointF point = transform.map(points.at(i));
+        const int left = qFloor(point.x() - center + 0.5);
+        const int top = qFloor(point.y() - center + 0.5);
+        if (left >= width || top >= height || left + diameter <= 0 || top + diameter <= 0) {
+            continue;
+        }
+        const QRgb color = colors.at(i);
+        const uint alpha = qAlpha(color);
+        const QRgb opaque = color | 0xff000000;
+        const int first_x = std::max(0, -left);
+        const int last_x = std::min(diameter, width - left);
+        const int last_y = std::min(diameter, height - top);
+        for (int y = std::max(0, -top); y < last_y; ++y) {
+            const uchar *mask = coverage.data() + y * diameter;
+            QRgb *line = pixels + (top + y) * stride + left;
+            for (int x = first_x; x < last_x; ++x) {
+                const uint source_alpha = (mask[x] * alpha + 127) / 255;
+                if (source_alpha == 0) {
+                    continue;
+                }
+                // source over destination (premultiplied)
+                const QRgb source = multiplyChannels(opaque, source_alpha);
+                line[x] = source_alpha == 255
+                        ? source : source + multiplyChannels(line[x], 255 - source_alpha);
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef SCATTERPLOTITEM_H
+#define SCATTERPLOTITEM_H
+
+#include <QGraphicsItem>
+#include <QPointer>
+#include <QImage>
+#include <QChart>
+#include <QAbstractSeries>
+
+QT_CHARTS_USE_NAMESPACE
+
+// A scatter plot item for charts with many points (hundreds of thousands)
+// All the points are stored in one buffer (data coordinates) with one color per point
+// and they are rasterized into an image that is cached until the points, the plot area
+// or the range of the axes change (repaints that do not change them, e.g. the lasso or
+// the hovering, only draw the image again while zooming and panning rasterize the points)
+// The points are mapped with the axes of a series of the chart (see ChartView)
+// One point can be highlighted, it is drawn on top of the points with its own marker
+class ScatterPlotItem : public QGraphicsItem
+{
+
+public:
+    explicit ScatterPlotItem(QChart *chart);
+    virtual ~ScatterPlotItem();
+
+    // the points (data coordinates) and their colors
+    void setPoints(const QVector<QPointF> &points, const QVector<QRgb> &colors);
+    const QVector<QPointF> &points() const;
+    const QVector<QRgb> &colors() const;
+    void clear();
+
+    // the size (diameter in pixels) of the markers
+    void setMarkerSize(const qreal size);
+    qreal markerSize() const;
+
+    // the highlighted point (data coordinates) drawn as a square of the given size
+    // (in pixels) and color on top of all the points
+    void setHighlight(const QPointF &point, const QColor &color, const qreal size);
+    void clearHighlight();
+
+    // the series whose axes are used to map the points (nothing is drawn without it)
+    void setSeries(QAbstractSeries *series);
+
+    // the transformation from data coordinates to chart coordinates
+    // it returns false if the points can not be mapped (no series)
+    bool dataTransform(QTransform &transform) const;
+
+    // to be called when the geometry of the chart changes
+    void updateGeometry();
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+
+    // draws the points as anti-aliased discs of the given size in the image
+    // (ARGB32 premultiplied), the transformation maps the points to image coordinates
+    static void rasterize(QImage &image,
+                          const QVector<QPointF> &points,
+                          const QVector<QRgb> &colors,
+                          const QTransform &transform,
+                          const qreal size);
+
+private:
+    QChart *m_chart;
+    QPointer<QAbstractSeries> m_series;
+    QVector<QPointF> m_points;
+    QVector<QRgb> m_colors;
+    qreal m_marker_size;
+
+    // the rasterized points and what they were rasterized with
+    QImage m_cache;
+    bool m_cache_valid;
+    QRectF m_cache_area;
+    QTransform m_cache_transform;
+    qreal m_cache_ratio;
+
+    // the highlighted point (not cached)
+    bool m_has_highlight;
+    QPointF m_highlight;
+    QColor m_highlight_color;
+    qreal m_highlight_size;
+
+    Q_DISABLE_COPY(ScatterPlotItem)
+};
+
+#endif // SCATTERPLOTITEM_H
@@ -0,0 +1,72 @@
+#include "Benchmark.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+
+#include <algorithm>
+#include <numeric>
+
+Benchmark::Benchmark(const int repeat)
+    : m_repeat(std::max(1, repeat))
+    , m_results()
+{
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+void Benchmark::run(const QString &name, const std::function<void()> &function)
+{
+    QElapsedTimer timer;
+    for (int i = 0; i < m_repeat; ++i) {
+        timer.start();
+        function();
+        add(name, timer.nsecsElapsed() / 1e6);
+    }
+    const auto &times = result(name).times;
+    qDebug() << "Benchmark" << name << "min" << *std::min_element(times.begin(), times.end())
+             << "ms";
+}
+
+void Benchmark::add(const QString &name, const double time_ms)
+{
+    result(name).times.push_back(time_ms);
+}
+
+Benchmark::Result &Benchmark::result(const QString &name)
+{
+    for (auto &item : m_results) {
+        if (item.name == name) {
+            return item;
+        }
+    }
+    m_results.push_back({name, QVector<double>()});
+    return m_results.last();
+}
+
+QJsonObject Benchmark::results() const
+{
+    QJsonObject results;
+    for (const auto &result : m_results) {
+        QVector<double> times = result.times;
+        std::sort(times.begin(), times.end());
+        const int middle = times.size() / 2;
+        const double median = times.size() % 2 == 1
+                ? times.at(middle) : (times.at(middle - 1) + times.at(middle)) / 2.0;
+        const double mean = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+        QJsonObject object;
+        object["count"] = times.size();
+        object["min_ms"] = times.first();
+        object["median_ms"] = median;
+        object["mean_ms"] = mean;
+        QJsonArray recorded;
+        for (const double time : result.times) {
+            recorded.append(time);
+        }
+        object["times_ms"] = recorded;
+        results[result.name] = object;
+    }
+    return results;
+}
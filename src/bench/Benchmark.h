@@ -0,0 +1,43 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+// Times functions and reports the results as JSON
+// Each function is run a number of times and the minimum, median and mean wall
+// times (in milliseconds) are reported (the minimum is the most stable between runs)
+// Times measured elsewhere (for instance the frames of a view) can also be added
+class Benchmark
+{
+
+public:
+    explicit Benchmark(const int repeat);
+    ~Benchmark();
+
+    // runs the function the number of times and records its times with the name
+    void run(const QString &name, const std::function<void()> &function);
+
+    // records a time (in milliseconds) with the name
+    void add(const QString &name, const double time_ms);
+
+    // the results: {"name": {"count": n, "min_ms": x, "median_ms": y, "mean_ms": z,
+    // "times_ms": [x, ...]}, ...} (the times are in the order they were recorded)
+    QJsonObject results() const;
+
+private:
+    struct Result {
+        QString name;
+        QVector<double> times;
+    };
+
+    Result &result(const QString &name);
+
+    int m_repeat;
+    QVector<Result> m_results;
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,80 @@
+#include "SyntheticData.h"
+
+#include <QPainter>
+#include <QRadialGradient>
+#include <QtMath>
+
+#include <algorithm>
+#include <random>
+
+STData::STDataFrame SyntheticData::generate(const int spots,
+                                            const int genes,
+                                            const double sparsity,
+                                            const unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    // the counts of the expressed genes (most of them are low)
+    std::geometric_distribution<int> counts(0.3);
+
+    STData::STDataFrame data;
+    const int width = qCeil(qSqrt(spots));
+    for (int i = 0; i < spots; ++i) {
+        data.spots.append(QString::number(i % width + 1) + "x" + QString::number(i / width + 1));
+    }
+    for (int j = 0; j < genes; ++j) {
+        data.genes.append(QString("Gene%1").arg(j));
+    }
+
+    data.counts = mat(spots, genes, fill::zeros);
+    for (int j = 0; j < genes; ++j) {
+        double *column = data.counts.colptr(j);
+        for (int i = 0; i < spots; ++i) {
+            if (uniform(generator) >= sparsity) {
+                column[i] = 1 + counts(generator);
+            }
+        }
+        // every gene is expressed in at least one spot
+        column[j % spots] = std::max(column[j % spots], 1.0);
+    }
+    // every spot expresses at least one gene
+    for (int i = 0; i < spots; ++i) {
+        data.counts.at(i, i % genes) = std::max(data.counts.at(i, i % genes), 1.0);
+    }
+    return data;
+}
+
+QImage SyntheticData::tissueImage(const QSize &size, const unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(QColor(240, 235, 240));
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(Qt::NoPen);
+    // the section
+    const QRectF tissue = QRectF(image.rect()).adjusted(size.width() * 0.1, size.height() * 0.1,
+                                                        -size.width() * 0.1, -size.height() * 0.1);
+    QRadialGradient gradient(tissue.center(), std::max(tissue.width(), tissue.height()) / 2);
+    gradient.setColorAt(0.0, QColor(200, 120, 180));
+    gradient.setColorAt(1.0, QColor(225, 170, 210));
+    painter.setBrush(gradient);
+    painter.drawEllipse(tissue);
+    // the nuclei of the cells
+    const int cells = size.width() * size.height() / 400;
+    const qreal radius = std::max(1.0, std::min(size.width(), size.height()) / 500.0);
+    painter.setBrush(QColor(90, 60, 150));
+    for (int i = 0; i < cells; ++i) {
+        const QPointF center(tissue.left() + uniform(generator) * tissue.width(),
+                             tissue.top() + uniform(generator) * tissue.height());
+        const QPointF offset = (center - tissue.center());
+        const qreal x = offset.x() / (tissue.width() / 2);
+        const qreal y = offset.y() / (tissue.height() / 2);
+        if (x * x + y * y <= 1.0) {
+            painter.drawEllipse(center, radius, radius);
+        }
+    }
+    return image;
+}
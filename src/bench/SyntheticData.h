@@ -0,0 +1,29 @@
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include <QImage>
+
+#include "data/STData.h"
+
+// Generates synthetic ST data frames for the benchmarks
+// The spots are laid out on a square grid (named XxY like the spots of the arrays)
+// and the counts are small integers, each one is zero with the probability sparsity
+// Every spot and every gene have at least one count so none of them is filtered out
+// when the data frame is loaded
+// The tissue images are a stained section (a large blob of cells) on a light background
+class SyntheticData
+{
+
+public:
+    static STData::STDataFrame generate(const int spots,
+                                        const int genes,
+                                        const double sparsity,
+                                        const unsigned seed);
+
+    static QImage tissueImage(const QSize &size, const unsigned seed);
+
+private:
+    SyntheticData() = delete;
+};
+
+#endif // SYNTHETICDATA_H
@@ -0,0 +1,176 @@
+// Benchmarks of the data pipeline of the viewer (load, filter, normalize, render and select)
+// The datasets are generated (see SyntheticData) so the runs can be reproduced and
+// compared between versions with the same parameters, the results are written as JSON
+// Usage: stviewer_bench [--spots N] [--genes N] [--sparsity S] [--repeat N] [--seed N]
+//                       [--output results.json]
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainterPath>
+#include <QTemporaryDir>
+
+#include "Benchmark.h"
+#include "SyntheticData.h"
+#include "data/STData.h"
+#include "data/UserSelection.h"
+#include "options_cmake.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+
+// the settings of the viewer when a dataset is opened (with a normalization that
+// does not need R so the benchmark runs everywhere)
+SettingsWidget::Rendering renderingSettings()
+{
+    SettingsWidget::Rendering settings;
+    settings.reads_threshold = 0;
+    settings.genes_threshold = 0;
+    settings.spots_threshold = 0;
+    settings.ind_reads_threshold = 0;
+    settings.legend_min = 0;
+    settings.legend_max = 1;
+    settings.intensity = 1.0;
+    settings.size = 1.0;
+    settings.visual_mode = SettingsWidget::HeatMap;
+    settings.normalization_mode = SettingsWidget::TPM;
+    settings.visual_type_mode = SettingsWidget::Reads;
+    settings.gene_cutoff = false;
+    settings.spike_in = false;
+    settings.size_factors = false;
+    return settings;
+}
+
+int intOption(const QCommandLineParser &parser, const QString &name)
+{
+    bool ok = false;
+    const int value = parser.value(name).toInt(&ok);
+    if (!ok || value <= 0) {
+        qCritical() << "Invalid value of" << name << parser.value(name);
+        ::exit(1);
+    }
+    return value;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("stviewer_bench");
+    app.setApplicationVersion(QString("%1.%2.%3").arg(MAJOR).arg(MINOR).arg(PATCH));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks of the data pipeline of the ST Viewer");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption({"spots", "Number of spots of the dataset.", "N", "1000"});
+    parser.addOption({"genes", "Number of genes of the dataset.", "N", "15000"});
+    parser.addOption({"sparsity", "Fraction of zero counts.", "S", "0.9"});
+    parser.addOption({"repeat", "Number of runs of each benchmark.", "N", "5"});
+    parser.addOption({"seed", "Seed of the generated counts.", "N", "1"});
+    parser.addOption({"output", "File to write the results to (stdout by default).", "file"});
+    parser.process(app);
+
+    const int n_spots = intOption(parser, "spots");
+    const int n_genes = intOption(parser, "genes");
+    const int repeat = intOption(parser, "repeat");
+    const unsigned seed = parser.value("seed").toUInt();
+    bool ok = false;
+    const double sparsity = parser.value("sparsity").toDouble(&ok);
+    if (!ok || sparsity < 0.0 || sparsity >= 1.0) {
+        qCritical() << "Invalid value of sparsity" << parser.value("sparsity");
+        return 1;
+    }
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        qCritical() << "The temporary directory could not be created";
+        return 1;
+    }
+    const QString tsv_file = dir.filePath("dataset.tsv");
+    const QString binary_file = dir.filePath("dataset.stdf");
+
+    Benchmark benchmark(repeat);
+    try {
+        const STData::STDataFrame generated =
+                SyntheticData::generate(n_spots, n_genes, sparsity, seed);
+
+        // load
+        benchmark.run("save_tsv", [&] { STData::save(tsv_file, generated); });
+        benchmark.run("save_binary", [&] { STData::save(binary_file, generated); });
+        benchmark.run("read_tsv", [&] { STData::read(tsv_file); });
+        benchmark.run("read_binary", [&] { STData::read(binary_file); });
+        STData dataset;
+        benchmark.run("init", [&] { dataset.init(tsv_file); });
+
+        // filter and normalize
+        const STData::STDataFrame data = dataset.data();
+        STData::STDataFrame filtered;
+        benchmark.run("filter", [&] { filtered = STData::filterDataFrame(data, 1, 10, 5, 5); });
+        benchmark.run("normalize_tpm", [&] {
+            STData::normalizeCounts(filtered, rowvec(), rowvec(), SettingsWidget::TPM);
+        });
+
+        // render (all the genes are visible like after selecting all of them)
+        QVector<int> all_genes(dataset.genes().size());
+        std::iota(all_genes.begin(), all_genes.end(), 0);
+        dataset.genes().setVisible(all_genes, true);
+        SettingsWidget::Rendering settings = renderingSettings();
+        benchmark.run("rendering_input", [&] { dataset.renderingInput(settings); });
+        const STData::RenderingInput input = dataset.renderingInput(settings);
+        benchmark.run("rendering_compute", [&] { dataset.computeRenderingData(input); });
+
+        // select (half of the spots, the ones on the left half of the array)
+        const QRectF border = dataset.getBorder();
+        QPainterPath path;
+        path.addRect(QRectF(border.topLeft(), QSizeF(border.width() / 2, border.height())));
+        const SelectionEvent event(path);
+        benchmark.run("select_lasso", [&] { dataset.selectSpots(event); });
+        QList<QString> spots;
+        for (int i = 0; i < dataset.spots().size(); i += 2) {
+            spots.append(dataset.spots().name(i));
+        }
+        benchmark.run("select_names", [&] { dataset.selectSpots(spots); });
+
+        // slice and aggregate the selections
+        benchmark.run("slice_spots", [&] { STData::sliceDataFrameSpots(data, spots); });
+        const auto shared = dataset.sharedData();
+        benchmark.run("selection_view", [&] { UserSelection(shared, spots).data(); });
+        const STData::STDataFrame slice = STData::sliceDataFrameSpots(data, spots);
+        benchmark.run("aggregate", [&] { STData::aggregate({slice, slice}); });
+    } catch (const std::exception &e) {
+        qCritical() << "Error running the benchmarks:" << e.what();
+        return 1;
+    }
+
+    QJsonObject parameters;
+    parameters["spots"] = n_spots;
+    parameters["genes"] = n_genes;
+    parameters["sparsity"] = sparsity;
+    parameters["repeat"] = repeat;
+    parameters["seed"] = static_cast<qint64>(seed);
+    QJsonObject report;
+    report["version"] = app.applicationVersion();
+    report["parameters"] = parameters;
+    report["results"] = benchmark.results();
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet("output")) {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            qCritical() << "The results could not be written to" << file.fileName();
+            return 1;
+        }
+    } else {
+        std::cout << json.constData();
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+// Benchmark of the rendering of the cell view (the tissue image, the spots and the legend)
+// A synthetic dataset and tissue image are loaded into a CellGLView that is rendered
+// offscreen (QOpenGLWidget renders into a framebuffer object of an offscreen surface)
+// and scripted sequences of zooming, panning and selections are played. The time of
+// paintGL() and of the draw() of each node is recorded for every frame (see
+// CellGLView::setFrameTimingEnabled()) and written as JSON
+// By default it uses the offscreen platform and Mesa's software OpenGL so it runs
+// without a display (QT_QPA_PLATFORM and LIBGL_ALWAYS_SOFTWARE can be set to override it)
+// Usage: stviewer_render_bench [--spots N] [--genes N] [--sparsity S] [--seed N]
+//                              [--image N] [--width N] [--height N] [--frames N]
+//                              [--output results.json]
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMouseEvent>
+#include <QResizeEvent>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QtMath>
+
+#include "Benchmark.h"
+#include "SyntheticData.h"
+#include "data/STData.h"
+#include "viewRenderer/CellGLView.h"
+#include "viewRenderer/GeneRendererGL.h"
+#include "viewRenderer/HeatMapLegendGL.h"
+#include "viewRenderer/ImageTextureGL.h"
+#include "options_cmake.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+
+// the maximum time to wait for the rendering data to be computed
+const int RENDERING_DATA_TIMEOUT_MS = 60000;
+
+int intOption(const QCommandLineParser &parser, const QString &name)
+{
+    bool ok = false;
+    const int value = parser.value(name).toInt(&ok);
+    if (!ok || value <= 0) {
+        qCritical() << "Invalid value of" << name << parser.value(name);
+        ::exit(1);
+    }
+    return value;
+}
+
+// the settings of the viewer with the spots colored by their normalized counts
+SettingsWidget::Rendering renderingSettings()
+{
+    SettingsWidget::Rendering settings;
+    settings.reads_threshold = 0;
+    settings.genes_threshold = 0;
+    settings.spots_threshold = 0;
+    settings.ind_reads_threshold = 0;
+    settings.legend_min = 0;
+    settings.legend_max = 1;
+    settings.intensity = 1.0;
+    settings.size = 1.0;
+    settings.visual_mode = SettingsWidget::HeatMap;
+    settings.normalization_mode = SettingsWidget::TPM;
+    settings.visual_type_mode = SettingsWidget::Reads;
+    settings.gene_cutoff = false;
+    settings.spike_in = false;
+    settings.size_factors = false;
+    return settings;
+}
+
+// the view with the nodes of the cell view page and the functions to script it
+class RenderBenchmark
+{
+
+public:
+    RenderBenchmark(const int frames, Benchmark &benchmark)
+        : m_frames(frames)
+        , m_benchmark(benchmark)
+        , m_settings(renderingSettings())
+        , m_view()
+        , m_image(new ImageTextureGL())
+        , m_genes(new GeneRendererGL(m_settings))
+        , m_legend(new HeatMapLegendGL(m_settings))
+        , m_names({"ImageTextureGL", "GeneRendererGL", "HeatMapLegendGL"})
+    {
+        m_view.setAttribute(Qt::WA_DontShowOnScreen, true);
+        m_view.addRenderingNode(m_image);
+        m_view.addRenderingNode(m_genes);
+        m_view.addRenderingNode(m_legend);
+        QObject::connect(m_genes.data(), &GeneRendererGL::signalRenderingDataComputed,
+                         m_legend.data(), &HeatMapLegendGL::slotUpdate);
+    }
+
+    ~RenderBenchmark()
+    {
+        // the textures are destroyed in the context of the view
+        m_view.makeCurrent();
+        m_image->clearData();
+        m_view.doneCurrent();
+    }
+
+    // loads the dataset and the image (as in CellViewPage::loadDataset())
+    bool load(const QSize &size, QSharedPointer<STData> data, const QString &image_file,
+              const int grid)
+    {
+        // the OpenGL context is created with the first frame and resizeGL() is only
+        // called for the resizes made after it (the view is never shown on a screen)
+        m_view.resize(size);
+        m_view.grabFramebuffer();
+        QResizeEvent resize(size, size);
+        QCoreApplication::sendEvent(&m_view, &resize);
+
+        // the textures are created in the context of the view
+        m_view.makeCurrent();
+        const bool loaded = m_image->createTiles(image_file);
+        m_view.doneCurrent();
+        if (!loaded) {
+            return false;
+        }
+        m_view.setScene(m_image->boundingRect());
+
+        // all the genes are visible like after selecting all of them
+        QVector<int> all_genes(data->genes().size());
+        std::iota(all_genes.begin(), all_genes.end(), 0);
+        data->genes().setVisible(all_genes, true);
+        m_genes->attachData(data);
+        // the spots of the grid cover the image
+        const qreal scale_x = m_image->boundingRect().width() / grid;
+        const qreal scale_y = m_image->boundingRect().height() / grid;
+        m_genes->setTransform(QTransform(scale_x, 0, 0, scale_y, -scale_x / 2, -scale_y / 2));
+        return waitForRenderingData();
+    }
+
+    // renders a frame and records its times with the name of the sequence
+    void frame(const QString &sequence)
+    {
+        m_view.grabFramebuffer();
+        const CellGLView::FrameTiming &timing = m_view.lastFrameTiming();
+        m_benchmark.add(sequence + "/paintGL", timing.paint_ns / 1e6);
+        for (int i = 0; i < timing.nodes_ns.size() && i < m_names.size(); ++i) {
+            m_benchmark.add(sequence + "/" + m_names.at(i), timing.nodes_ns.at(i) / 1e6);
+        }
+    }
+
+    void run()
+    {
+        m_view.setFrameTimingEnabled(true);
+        const QPointF center = QRectF(m_view.rect()).center();
+
+        for (int i = 0; i < m_frames; ++i) {
+            frame("static");
+        }
+
+        for (int i = 0; i < m_frames; ++i) {
+            m_view.zoomIn();
+            frame("zoom");
+        }
+
+        // panning (zoomed in) in a circle
+        mouse(QEvent::MouseButtonPress, center, Qt::LeftButton);
+        for (int i = 0; i < m_frames; ++i) {
+            const qreal angle = 2 * M_PI * i / m_frames;
+            mouse(QEvent::MouseMove,
+                  center + QPointF(std::cos(angle), std::sin(angle)) * m_view.height() / 4,
+                  Qt::NoButton);
+            frame("pan");
+        }
+        mouse(QEvent::MouseButtonRelease, center, Qt::LeftButton);
+
+        for (int i = 0; i < m_frames; ++i) {
+            m_view.zoomOut();
+            frame("zoom");
+        }
+
+        // rubber band selections of growing areas (the selected spots are drawn
+        // with other colors, the rendering data is computed again for each one)
+        m_view.setSelectionMode(true);
+        for (int i = 0; i < m_frames; ++i) {
+            const QPointF corner = center * (1.0 - (i + 1.0) / m_frames);
+            mouse(QEvent::MouseButtonPress, corner, Qt::LeftButton);
+            mouse(QEvent::MouseMove, 2 * center - corner, Qt::NoButton);
+            mouse(QEvent::MouseButtonRelease, 2 * center - corner, Qt::LeftButton);
+            if (!waitForRenderingData()) {
+                qWarning() << "The rendering data of the selection was not computed";
+            }
+            frame("select");
+        }
+        m_view.setSelectionMode(false);
+        m_view.setFrameTimingEnabled(false);
+    }
+
+private:
+    // sends a mouse event to the view (the buttons are pressed during the moves)
+    void mouse(const QEvent::Type type, const QPointF &pos, const Qt::MouseButton button)
+    {
+        QMouseEvent event(type, pos, m_view.mapToGlobal(pos.toPoint()), button,
+                          type == QEvent::MouseButtonRelease ? Qt::NoButton : Qt::LeftButton,
+                          Qt::NoModifier);
+        QCoreApplication::sendEvent(&m_view, &event);
+    }
+
+    // waits until the renderer has the rendering data of the current selection and settings
+    bool waitForRenderingData()
+    {
+        QEventLoop loop;
+        bool updated = false;
+        QObject::connect(m_genes.data(), &GraphicItemGL::updated, &loop, [&] {
+            updated = true;
+            loop.quit();
+        });
+        QTimer::singleShot(RENDERING_DATA_TIMEOUT_MS, &loop, &QEventLoop::quit);
+        m_genes->slotUpdate();
+        loop.exec();
+        return updated;
+    }
+
+    const int m_frames;
+    Benchmark &m_benchmark;
+    SettingsWidget::Rendering m_settings;
+    CellGLView m_view;
+    QSharedPointer<ImageTextureGL> m_image;
+    QSharedPointer<GeneRendererGL> m_genes;
+    QSharedPointer<HeatMapLegendGL> m_legend;
+    // the names of the nodes in the rendering order
+    const QStringList m_names;
+
+    Q_DISABLE_COPY(RenderBenchmark)
+};
+
+}
+
+int main(int argc, char **argv)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE")) {
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+    }
+    // the OpenGL widgets can be rendered without a top level window
+    QApplication::setAttribute(Qt::AA_ShareOpenGLContexts, true);
+    QApplication::setAttribute(Qt::AA_UseDesktopOpenGL, true);
+
+    QApplication app(argc, argv);
+    app.setApplicationName("stviewer_render_bench");
+    app.setApplicationVersion(QString("%1.%2.%3").arg(MAJOR).arg(MINOR).arg(PATCH));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark of the rendering of the ST Viewer cell view");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption({"spots", "Number of spots of the dataset.", "N", "1000"});
+    parser.addOption({"genes", "Number of genes of the dataset.", "N", "5000"});
+    parser.addOption({"sparsity", "Fraction of zero counts.", "S", "0.9"});
+    parser.addOption({"seed", "Seed of the generated counts and image.", "N", "1"});
+    parser.addOption({"image", "Size of the (square) tissue image.", "N", "4000"});
+    parser.addOption({"width", "Width of the view.", "N", "1280"});
+    parser.addOption({"height", "Height of the view.", "N", "960"});
+    parser.addOption({"frames", "Number of frames of each sequence.", "N", "30"});
+    parser.addOption({"output", "File to write the results to (stdout by default).", "file"});
+    parser.process(app);
+
+    const int n_spots = intOption(parser, "spots");
+    const int n_genes = intOption(parser, "genes");
+    const int image_size = intOption(parser, "image");
+    const QSize view_size(intOption(parser, "width"), intOption(parser, "height"));
+    const int frames = intOption(parser, "frames");
+    const unsigned seed = parser.value("seed").toUInt();
+    bool ok = false;
+    const double sparsity = parser.value("sparsity").toDouble(&ok);
+    if (!ok || sparsity < 0.0 || sparsity >= 1.0) {
+        qCritical() << "Invalid value of sparsity" << parser.value("sparsity");
+        return 1;
+    }
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        qCritical() << "The temporary directory could not be created";
+        return 1;
+    }
+    const QString data_file = dir.filePath("dataset.tsv");
+    const QString image_file = dir.filePath("image.jpg");
+
+    Benchmark benchmark(1);
+    try {
+        STData::save(data_file, SyntheticData::generate(n_spots, n_genes, sparsity, seed));
+        if (!SyntheticData::tissueImage(QSize(image_size, image_size), seed).save(image_file)) {
+            qCritical() << "The tissue image could not be written";
+            return 1;
+        }
+        QSharedPointer<STData> data(new STData());
+        data->init(data_file);
+
+        RenderBenchmark render(frames, benchmark);
+        const int grid = static_cast<int>(std::ceil(std::sqrt(n_spots))) + 1;
+        if (!render.load(view_size, data, image_file, grid)) {
+            qCritical() << "The dataset and the image could not be loaded";
+            return 1;
+        }
+        render.run();
+    } catch (const std::exception &e) {
+        qCritical() << "Error running the benchmark:" << e.what();
+        return 1;
+    }
+
+    QJsonObject parameters;
+    parameters["spots"] = n_spots;
+    parameters["genes"] = n_genes;
+    parameters["sparsity"] = sparsity;
+    parameters["seed"] = static_cast<qint64>(seed);
+    parameters["image"] = image_size;
+    parameters["width"] = view_size.width();
+    parameters["height"] = view_size.height();
+    parameters["frames"] = frames;
+    QJsonObject report;
+    report["version"] = app.applicationVersion();
+    report["parameters"] = parameters;
+    report["results"] = benchmark.results();
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet("output")) {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            qCritical() << "The results could not be written to" << file.fileName();
+            return 1;
+        }
+    } else {
+        std::cout << json.constData();
+    }
+    return 0;
+}
@@ -0,0 +1,484 @@
+#include "Pipeline.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+
+#include "data/STData.h"
+#include "math/RInterface.h"
+#include "math/GraphClustering.h"
+#include "math/PCA.h"
+#include "math/TSNE.h"
+#include "profiling/Profiler.h"
+
+#include <stdexcept>
+
+namespace
+{
+
+QJsonObject readJSON(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("The file could not be opened: " + filename.toStdString());
+    }
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        throw std::runtime_error("The file is not a valid JSON object: " + filename.toStdString()
+                                 + " " + error.errorString().toStdString());
+    }
+    return document.object();
+}
+
+bool writeJSON(const QString &filename, const QJsonObject &object)
+{
+    QFile file(filename);
+    const QByteArray json = QJsonDocument(object).toJson(QJsonDocument::Indented);
+    return file.open(QIODevice::WriteOnly) && file.write(json) == json.size();
+}
+
+// the path relative to the base folder (empty if it is not given)
+QString path(const QJsonObject &object, const QString &key, const QDir &base)
+{
+    const QString value = object.value(key).toString();
+    return value.isEmpty() ? QString() : QDir::cleanPath(base.absoluteFilePath(value));
+}
+
+int intValue(const QJsonObject &object, const QString &key, const int value, const int min)
+{
+    if (!object.contains(key)) {
+        return value;
+    }
+    const QJsonValue json = object.value(key);
+    if (!json.isDouble() || json.toDouble() != json.toInt() || json.toInt() < min) {
+        throw std::runtime_error("Invalid value of the setting " + key.toStdString());
+    }
+    return json.toInt();
+}
+
+double doubleValue(const QJsonObject &object, const QString &key, const double value)
+{
+    if (!object.contains(key)) {
+        return value;
+    }
+    const QJsonValue json = object.value(key);
+    if (!json.isDouble() || json.toDouble() < 0) {
+        throw std::runtime_error("Invalid value of the setting " + key.toStdString());
+    }
+    return json.toDouble();
+}
+
+bool boolValue(const QJsonObject &object, const QString &key, const bool value)
+{
+    if (!object.contains(key)) {
+        return value;
+    }
+    const QJsonValue json = object.value(key);
+    if (!json.isBool()) {
+        throw std::runtime_error("Invalid value of the setting " + key.toStdString());
+    }
+    return json.toBool();
+}
+
+// the value of the setting among the choices (case insensitive)
+template <typename T>
+T choiceValue(const QJsonObject &object,
+              const QString &key,
+              const T value,
+              const QMap<QString, T> &choices)
+{
+    if (!object.contains(key)) {
+        return value;
+    }
+    const QString choice = object.value(key).toString().toLower();
+    if (!choices.contains(choice)) {
+        throw std::runtime_error("Invalid value of the setting " + key.toStdString());
+    }
+    return choices.value(choice);
+}
+
+Pipeline::Input parseInput(const QJsonObject &object, const QDir &base)
+{
+    // the files of an info.json are relative to it and the other keys override it
+    QJsonObject dataset = object;
+    QDir dataset_base = base;
+    if (object.contains("info")) {
+        const QString info = path(object, "info", base);
+        dataset = readJSON(info);
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            dataset.insert(it.key(), it.value());
+        }
+        dataset.remove("info");
+        dataset_base = QFileInfo(info).absoluteDir();
+    }
+
+    Pipeline::Input input;
+    input.data = path(dataset, "data", dataset_base);
+    if (input.data.isEmpty()) {
+        throw std::runtime_error("A dataset has no data file");
+    }
+    input.name = dataset.value("name").toString(QFileInfo(input.data).baseName());
+    input.coordinates = path(dataset, "coordinates", dataset_base);
+    input.image = path(dataset, "image", dataset_base);
+    // the meta files of the viewer spell it aligment
+    input.alignment = path(dataset, dataset.contains("alignment") ? "alignment" : "aligment",
+                           dataset_base);
+    input.spike_ins = path(dataset, "spike_ins", dataset_base);
+    input.size_factors = path(dataset, "size_factors", dataset_base);
+    input.species = dataset.value("species").toString();
+    input.tissue = dataset.value("tissue").toString();
+    input.comments = dataset.value("comments").toString();
+    return input;
+}
+
+// the meta file of the cache (see DatasetImporter), the data is the cache and the
+// rest of the files are the original ones
+QJsonObject infoJSON(const Pipeline::Input &input, const QString &cache)
+{
+    QJsonObject info;
+    info["name"] = input.name;
+    info["species"] = input.species;
+    info["tissue"] = input.tissue;
+    info["comments"] = input.comments;
+    info["data"] = cache;
+    const QList<QPair<QString, QString>> files = {{"image", input.image},
+                                                  {"aligment", input.alignment},
+                                                  {"coordinates", input.coordinates},
+                                                  {"spike_ins", input.spike_ins},
+                                                  {"size_factors", input.size_factors}};
+    for (const auto &file : files) {
+        if (!file.second.isEmpty()) {
+            info[file.first] = file.second;
+        }
+    }
+    return info;
+}
+
+void writeClusters(const QString &filename,
+                   const QList<QString> &spots,
+                   const std::vector<int> &labels,
+                   const mat &coordinates)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        throw std::runtime_error("The file could not be opened for writing: "
+                                 + filename.toStdString());
+    }
+    QTextStream stream(&file);
+    stream << "spot\tcluster\tx\ty\n";
+    for (int i = 0; i < spots.size(); ++i) {
+        stream << spots.at(i) << "\t" << labels.at(i) << "\t"
+               << coordinates.at(i, 0) << "\t" << coordinates.at(i, 1) << "\n";
+    }
+    stream.flush();
+    if (stream.status() != QTextStream::Ok) {
+        throw std::runtime_error("The file could not be written: " + filename.toStdString());
+    }
+}
+
+}
+
+Pipeline::Settings::Settings()
+    : inputs()
+    , output()
+    , threads(0)
+    , ind_reads_threshold(0)
+    , reads_threshold(0)
+    , genes_threshold(5)
+    , spots_threshold(5)
+    , normalization(SettingsWidget::RAW)
+    , log_scale(false)
+    , clustering(NoClustering)
+    , reduction(TSNEReduction)
+    , clusters(5)
+    , perplexity(30)
+    , theta(0.5)
+    , max_iter(1000)
+    , init_dims(50)
+    , center(false)
+    , scale(false)
+    , export_cache(true)
+    , export_normalized(true)
+    , export_selections(true)
+{
+}
+
+Pipeline::Settings Pipeline::parseConfig(const QString &filename)
+{
+    return parseConfig(readJSON(filename), QFileInfo(filename).absoluteDir());
+}
+
+Pipeline::Settings Pipeline::parseConfig(const QJsonObject &config, const QDir &base)
+{
+    Settings settings;
+    settings.output = path(config, "output", base);
+    if (settings.output.isEmpty()) {
+        throw std::runtime_error("The output folder is not given");
+    }
+    settings.threads = intValue(config, "threads", settings.threads, 0);
+
+    const QJsonArray datasets = config.value("datasets").toArray();
+    if (datasets.isEmpty()) {
+        throw std::runtime_error("There are no datasets to process");
+    }
+    QSet<QString> names;
+    for (const QJsonValue &dataset : datasets) {
+        if (!dataset.isObject()) {
+            throw std::runtime_error("A dataset is not a JSON object");
+        }
+        const Input input = parseInput(dataset.toObject(), base);
+        // the name is the folder of the results
+        if (input.name.isEmpty() || names.contains(input.name)) {
+            throw std::runtime_error("The dataset names must be unique: "
+                                     + input.name.toStdString());
+        }
+        names.insert(input.name);
+        settings.inputs.push_back(input);
+    }
+
+    const QJsonObject filter = config.value("filter").toObject();
+    settings.ind_reads_threshold = intValue(filter, "individual_reads_threshold",
+                                            settings.ind_reads_threshold, 0);
+    settings.reads_threshold = intValue(filter, "reads_threshold", settings.reads_threshold, 0);
+    settings.genes_threshold = intValue(filter, "genes_threshold", settings.genes_threshold, 0);
+    settings.spots_threshold = intValue(filter, "spots_threshold", settings.spots_threshold, 0);
+
+    const QMap<QString, SettingsWidget::NormalizationMode> normalizations
+            = {{"raw", SettingsWidget::RAW},
+               {"rel", SettingsWidget::REL},
+               {"tpm", SettingsWidget::TPM},
+               {"deseq", SettingsWidget::DESEQ},
+               {"scran", SettingsWidget::SCRAN}};
+    settings.normalization = choiceValue(config, "normalization", settings.normalization,
+                                         normalizations);
+    settings.log_scale = boolValue(config, "log_scale", settings.log_scale);
+
+    if (config.value("clustering").isObject()) {
+        const QJsonObject clustering = config.value("clustering").toObject();
+        const QMap<QString, Clustering> methods
+                = {{"kmeans", KMeans}, {"hclust", HClust}, {"graph", Graph}};
+        const QMap<QString, Reduction> reductions
+                = {{"tsne", TSNEReduction}, {"pca", PCAReduction}};
+        settings.clustering = choiceValue(clustering, "method", KMeans, methods);
+        settings.reduction = choiceValue(clustering, "reduction", settings.reduction,
+                                         reductions);
+        settings.clusters = intValue(clustering, "clusters", settings.clusters, 1);
+        settings.perplexity = intValue(clustering, "perplexity", settings.perplexity, 1);
+        settings.theta = doubleValue(clustering, "theta", settings.theta);
+        settings.max_iter = intValue(clustering, "max_iter", settings.max_iter, 1);
+        settings.init_dims = intValue(clustering, "init_dims", settings.init_dims, 2);
+        settings.center = boolValue(clustering, "center", settings.center);
+        settings.scale = boolValue(clustering, "scale", settings.scale);
+    }
+
+    const QJsonObject exports = config.value("export").toObject();
+    settings.export_cache = boolValue(exports, "cache", settings.export_cache);
+    settings.export_normalized = boolValue(exports, "normalized", settings.export_normalized);
+    settings.export_selections = boolValue(exports, "selections", settings.export_selections);
+    return settings;
+}
+
+Pipeline::Pipeline(const Settings &settings)
+    : m_settings(settings)
+{
+}
+
+Pipeline::~Pipeline()
+{
+}
+
+bool Pipeline::needsR() const
+{
+    return m_settings.normalization == SettingsWidget::DESEQ
+            || m_settings.normalization == SettingsWidget::SCRAN
+            || m_settings.clustering == KMeans
+            || m_settings.clustering == HClust;
+}
+
+QJsonArray Pipeline::run(const std::function<void(const QString &)> &log)
+{
+    if (!QDir().mkpath(m_settings.output)) {
+        throw std::runtime_error("The output folder could not be created: "
+                                 + m_settings.output.toStdString());
+    }
+    if (m_settings.threads > 0) {
+        QThreadPool::globalInstance()->setMaxThreadCount(m_settings.threads);
+    }
+
+    // the datasets are processed in parallel (the matrix operations use more cores)
+    const std::function<QJsonObject(const Input &)> process = [=](const Input &input) {
+        return runDataset(input, log);
+    };
+    const QList<QJsonObject> reports
+            = QtConcurrent::blockingMapped<QList<QJsonObject>>(m_settings.inputs, process);
+
+    QJsonArray datasets;
+    for (const QJsonObject &report : reports) {
+        datasets.append(report);
+    }
+    const QString filename = QDir(m_settings.output).filePath("report.json");
+    if (!writeJSON(filename, QJsonObject{{"datasets", datasets}})) {
+        throw std::runtime_error("The file could not be written: " + filename.toStdString());
+    }
+    return datasets;
+}
+
+QJsonObject Pipeline::runDataset(const Input &input,
+                                 const std::function<void(const QString &)> &log) const
+{
+    ST_PROFILE_SCOPE("Pipeline::runDataset");
+    QJsonObject report;
+    QJsonObject times;
+    report["name"] = input.name;
+    QElapsedTimer timer;
+    timer.start();
+    try {
+        const QDir dir(QDir(m_settings.output).filePath(input.name));
+        if (!dir.mkpath("processed") || !dir.mkpath("selections")) {
+            throw std::runtime_error("The output folder could not be created: "
+                                     + dir.path().toStdString());
+        }
+
+        // the spots outside the spots map and the spots/genes without counts are removed
+        log(QString("%1: loading %2").arg(input.name).arg(input.data));
+        STData data;
+        data.init(input.data, input.coordinates);
+        const STData::STDataFrame raw = data.data();
+        report["spots"] = raw.spots.size();
+        report["genes"] = raw.genes.size();
+        times["load"] = timer.restart();
+
+        if (m_settings.export_cache) {
+            const QString cache = dir.filePath(input.name + ".stdf");
+            if (!STData::save(cache, raw)
+                    || !writeJSON(dir.filePath("info.json"), infoJSON(input, cache))) {
+                throw std::runtime_error("The cache could not be written: "
+                                         + cache.toStdString());
+            }
+            report["cache"] = cache;
+            times["cache"] = timer.restart();
+        }
+
+        log(QString("%1: filtering and normalizing").arg(input.name));
+        const STData::STDataFrame filtered = STData::filterDataFrame(raw,
+                                                                     m_settings.ind_reads_threshold,
+                                                                     m_settings.reads_threshold,
+                                                                     m_settings.genes_threshold,
+                                                                     m_settings.spots_threshold);
+        if (filtered.spots.empty() || filtered.genes.empty()) {
+            throw std::runtime_error("There are no spots or genes left after filtering");
+        }
+        report["filtered_spots"] = filtered.spots.size();
+        report["filtered_genes"] = filtered.genes.size();
+        times["filter"] = timer.restart();
+
+        rowvec deseq_size_factors;
+        rowvec scran_size_factors;
+        if (m_settings.normalization == SettingsWidget::DESEQ
+                || m_settings.normalization == SettingsWidget::SCRAN) {
+            rowvec &factors = m_settings.normalization == SettingsWidget::DESEQ
+                    ? deseq_size_factors : scran_size_factors;
+            factors = m_settings.normalization == SettingsWidget::DESEQ
+                    ? RInterface::computeDESeqFactors(filtered.counts)
+                    : RInterface::computeScranFactors(filtered.counts, true);
+            if (factors.n_elem != filtered.counts.n_rows) {
+                throw std::runtime_error("Error computing the size factors");
+            }
+        }
+        STData::STDataFrame normalized = STData::normalizeCounts(filtered,
+                                                                 deseq_size_factors,
+                                                                 scran_size_factors,
+                                                                 m_settings.normalization);
+        if (m_settings.log_scale) {
+            normalized.counts = arma::log(normalized.counts + 1.0);
+        }
+        times["normalize"] = timer.restart();
+
+        if (m_settings.export_normalized) {
+            const QString filename = dir.filePath("processed/normalized.stdf");
+            if (!STData::save(filename, normalized)) {
+                throw std::runtime_error("The file could not be written: "
+                                         + filename.toStdString());
+            }
+            report["normalized"] = filename;
+            times["export"] = timer.restart();
+        }
+
+        if (m_settings.clustering != NoClustering) {
+            log(QString("%1: clustering %2 spots").arg(input.name).arg(normalized.spots.size()));
+            // the same steps as the Clustering widget
+            mat coordinates;
+            TSNE tsne;
+            const bool reduced = m_settings.reduction == TSNEReduction
+                    ? tsne.compute(normalized.counts, m_settings.init_dims,
+                                   m_settings.perplexity, m_settings.theta,
+                                   m_settings.max_iter, m_settings.max_iter, coordinates)
+                    : PCA::compute(normalized.counts, 2, m_settings.center,
+                                   m_settings.scale, coordinates);
+            if (!reduced) {
+                throw std::runtime_error("Error computing the 2D coordinates "
+                                         "(perhaps too high perplexity?)");
+            }
+            times["reduction"] = timer.restart();
+
+            std::vector<int> labels;
+            if (m_settings.clustering == Graph) {
+                // the number of clusters is the maximum with the graph clustering
+                GraphClustering::graphClusters(normalized.counts, m_settings.clusters, labels);
+            } else {
+                RInterface::spotClassification(coordinates, m_settings.clustering == KMeans,
+                                               m_settings.clusters, std::vector<int>(),
+                                               labels);
+            }
+            if (labels.size() != static_cast<size_t>(normalized.spots.size())) {
+                throw std::runtime_error("Error computing the clusters");
+            }
+            const QString clusters_file = dir.filePath("processed/clusters.tsv");
+            writeClusters(clusters_file, normalized.spots, labels, coordinates);
+            report["clusters_file"] = clusters_file;
+            times["clustering"] = timer.restart();
+
+            // one selection of the original counts for each cluster (see CellViewPage)
+            QMap<int, QList<QString>> clusters;
+            for (size_t i = 0; i < labels.size(); ++i) {
+                clusters[labels.at(i)].push_back(normalized.spots.at(i));
+            }
+            report["clusters"] = clusters.size();
+            if (m_settings.export_selections) {
+                const auto shared = data.sharedData();
+                QJsonArray selections;
+                for (auto it = clusters.constBegin(); it != clusters.constEnd(); ++it) {
+                    uvec rows;
+                    uvec cols;
+                    STData::sliceIndexesSpots(*shared, it.value(), rows, cols);
+                    const QString filename
+                            = dir.filePath(QString("selections/%1_%2.stdf")
+                                           .arg(input.name).arg(it.key()));
+                    if (!STData::save(filename, STData::sliceDataFrame(*shared, rows, cols))) {
+                        throw std::runtime_error("The file could not be written: "
+                                                 + filename.toStdString());
+                    }
+                    selections.append(filename);
+                }
+                report["selections"] = selections;
+                times["selections"] = timer.restart();
+            }
+        }
+        log(QString("%1: done").arg(input.name));
+    } catch (const std::exception &e) {
+        report["error"] = QString(e.what());
+        log(QString("%1: error %2").arg(input.name).arg(e.what()));
+    }
+    report["times_ms"] = times;
+    return report;
+}
@@ -0,0 +1,118 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <QString>
+#include <QList>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "viewPages/SettingsWidget.h"
+
+#include <functional>
+
+class QDir;
+
+// Pipeline runs the processing of the viewer without the GUI (see stviewer-cli)
+// Each dataset is loaded, filtered, normalized and (optionally) clustered with the
+// same functions and defaults as the Clustering widget and the results are written to
+// the output folder (one folder per dataset):
+// <name>.stdf and info.json: the binary cache of the dataset (the spots of the spots
+// map with counts) and the meta file to open it in the viewer (Datasets -> Import)
+// processed/normalized.stdf: the filtered and normalized counts
+// processed/clusters.tsv: the cluster and the 2D coordinates of each spot
+// selections/<name>_<cluster>.stdf: one selection per cluster (Selections -> Import)
+// The datasets are processed in parallel (the steps that call R are serialized)
+class Pipeline
+{
+
+public:
+    enum Clustering {
+        NoClustering = 0,
+        KMeans = 1,
+        HClust = 2,
+        Graph = 3
+    };
+
+    enum Reduction {
+        TSNEReduction = 0,
+        PCAReduction = 1
+    };
+
+    // the files of a dataset (the keys of the info.json file of the viewer)
+    struct Input {
+        QString name;
+        QString data;
+        QString coordinates;
+        QString image;
+        QString alignment;
+        QString spike_ins;
+        QString size_factors;
+        QString species;
+        QString tissue;
+        QString comments;
+    };
+
+    struct Settings {
+        Settings();
+        QList<Input> inputs;
+        QString output;
+        // the number of threads (0 means one per core)
+        int threads;
+        int ind_reads_threshold;
+        int reads_threshold;
+        int genes_threshold;
+        int spots_threshold;
+        SettingsWidget::NormalizationMode normalization;
+        bool log_scale;
+        Clustering clustering;
+        Reduction reduction;
+        int clusters;
+        int perplexity;
+        double theta;
+        int max_iter;
+        int init_dims;
+        bool center;
+        bool scale;
+        bool export_cache;
+        bool export_normalized;
+        bool export_selections;
+    };
+
+    // Parses the settings from a JSON config file (the paths are relative to the file)
+    // {"output": "folder", "threads": 0,
+    //  "datasets": [{"name": "", "data": "", "coordinates": "", "image": "", "aligment": "",
+    //                "spike_ins": "", "size_factors": "", "species": "", "tissue": "",
+    //                "comments": ""} or {"info": "info.json"}, ...],
+    //  "filter": {"individual_reads_threshold": 0, "reads_threshold": 0,
+    //             "genes_threshold": 5, "spots_threshold": 5},
+    //  "normalization": "raw|rel|tpm|deseq|scran", "log_scale": false,
+    //  "clustering": {"method": "kmeans|hclust|graph", "reduction": "tsne|pca",
+    //                 "clusters": 5, "perplexity": 30, "theta": 0.5, "max_iter": 1000,
+    //                 "init_dims": 50, "center": false, "scale": false},
+    //  "export": {"cache": true, "normalized": true, "selections": true}}
+    // It throws std::runtime_error if the file or a setting is not valid
+    static Settings parseConfig(const QString &filename);
+    static Settings parseConfig(const QJsonObject &config, const QDir &base);
+
+    explicit Pipeline(const Settings &settings);
+    ~Pipeline();
+
+    // true if a step calls R (RInside must be created before running the pipeline)
+    bool needsR() const;
+
+    // Runs the pipeline of all the datasets and writes report.json to the output folder
+    // log is called with the progress (from any thread)
+    // It returns the report of each dataset (the datasets that failed have an "error")
+    // It throws std::runtime_error if the output folder or the report cannot be written
+    QJsonArray run(const std::function<void(const QString &)> &log);
+
+private:
+    QJsonObject runDataset(const Input &input,
+                           const std::function<void(const QString &)> &log) const;
+
+    Settings m_settings;
+
+    Q_DISABLE_COPY(Pipeline)
+};
+
+#endif // PIPELINE_H
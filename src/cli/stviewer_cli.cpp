@@ -0,0 +1,123 @@
+// Headless processing of datasets with the pipeline of the viewer (see cli/Pipeline.h)
+// The datasets are loaded, filtered, normalized, clustered and exported as binary caches
+// and selections that the viewer opens directly, the settings are read from a JSON file
+// (the options override them) and the report of each dataset is written as JSON
+// Usage: stviewer-cli config.json [--output folder] [--threads N] [--report report.json]
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDir>
+
+#include "cli/Pipeline.h"
+#include "options_cmake.h"
+
+// RcppArmadillo must be included before RInside
+#include "RcppArmadillo.h"
+#include "RInside.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("stviewer-cli");
+    app.setApplicationVersion(QString("%1.%2.%3").arg(MAJOR).arg(MINOR).arg(PATCH));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Processes datasets with the pipeline of the ST Viewer "
+                                     "without the GUI");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("config", "The JSON file with the datasets and the settings.");
+    parser.addOption({"output", "Folder to write the results to (overrides the config).",
+                      "folder"});
+    parser.addOption({"threads", "Number of threads (one per core by default).", "N"});
+    parser.addOption({"report", "File to write the report to (stdout by default).", "file"});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    Pipeline::Settings settings;
+    try {
+        settings = Pipeline::parseConfig(parser.positionalArguments().first());
+    } catch (const std::exception &e) {
+        qCritical() << "Error parsing the config:" << e.what();
+        return EXIT_FAILURE;
+    }
+    if (parser.isSet("output")) {
+        settings.output = QDir(parser.value("output")).absolutePath();
+    }
+    if (parser.isSet("threads")) {
+        bool ok = false;
+        settings.threads = parser.value("threads").toInt(&ok);
+        if (!ok || settings.threads <= 0) {
+            qCritical() << "Invalid value of threads" << parser.value("threads");
+            return EXIT_FAILURE;
+        }
+    }
+
+    Pipeline pipeline(settings);
+
+    // R is only initialized when a step needs it (it must be created in the main thread)
+    std::unique_ptr<RInside> R;
+    if (pipeline.needsR()) {
+        try {
+            R.reset(new RInside());
+        } catch (const std::exception &e) {
+            qCritical() << "Error initializing R:" << e.what();
+            return EXIT_FAILURE;
+        } catch (...) {
+            qCritical() << "Unknown error initializing R";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // the progress of the datasets is logged from the worker threads
+    QMutex log_mutex;
+    const auto log = [&log_mutex](const QString &message) {
+        QMutexLocker locker(&log_mutex);
+        std::cerr << message.toStdString() << std::endl;
+    };
+
+    QJsonArray datasets;
+    try {
+        datasets = pipeline.run(log);
+    } catch (const std::exception &e) {
+        qCritical() << "Error running the pipeline:" << e.what();
+        return EXIT_FAILURE;
+    }
+
+    QJsonObject report;
+    report["version"] = app.applicationVersion();
+    report["output"] = settings.output;
+    report["datasets"] = datasets;
+    const QByteArray json = QJsonDocument(report).toJson();
+    if (parser.isSet("report")) {
+        QFile file(parser.value("report"));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            qCritical() << "The report could not be written to" << file.fileName();
+            return EXIT_FAILURE;
+        }
+    } else {
+        std::cout << json.constData();
+    }
+
+    // the run fails if any of the datasets failed
+    for (const QJsonValue &dataset : datasets) {
+        if (dataset.toObject().contains("error")) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
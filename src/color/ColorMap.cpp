@@ -0,0 +1,98 @@
+#include "ColorMap.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Color
+{
+
+// the presets of QCPColorGradient (gpGrayscale to gpHues)
+static const int num_presets = QCPColorGradient::gpHues + 1;
+
+// the table index of a scaled value, the same as QCPColorGradient::color() (truncated and
+// clamped, NaN values give the first color)
+static inline int levelIndex(const double level)
+{
+    return level > 0.0 ? static_cast<int>(std::min(level, ColorMap::levels - 1.0)) : 0;
+}
+
+// the level of value in the range min-max (the operations are made in the same order
+// as QCPColorGradient::color() so the values at the bounds of the levels give the same
+// colors), empty ranges give the first color
+static inline double level(const double value, const double min, const double max)
+{
+    return max > min ? (value - min) * (ColorMap::levels - 1) / (max - min) : 0.0;
+}
+
+ColorMap::ColorMap(const QCPColorGradient::GradientPreset preset)
+{
+    QCPColorGradient gradient(preset);
+    gradient.setLevelCount(levels);
+    // the position i of the range 0 to levels - 1 is exactly the level i
+    const QCPRange range(0, levels - 1);
+    for (int i = 0; i < levels; ++i) {
+        m_table[i] = gradient.color(i, range);
+    }
+}
+
+const ColorMap &ColorMap::get(const QCPColorGradient::GradientPreset preset)
+{
+    static const std::vector<ColorMap> color_maps = [] {
+        std::vector<ColorMap> maps;
+        maps.reserve(num_presets);
+        for (int i = 0; i < num_presets; ++i) {
+            maps.push_back(ColorMap(static_cast<QCPColorGradient::GradientPreset>(i)));
+        }
+        return maps;
+    }();
+    return color_maps.at(preset);
+}
+
+QRgb ColorMap::color(const double value, const double min, const double max) const
+{
+    return m_table[levelIndex(level(value, min, max))];
+}
+
+void ColorMap::map(const double *values,
+                   const int count,
+                   const double min,
+                   const double max,
+                   QRgb *colors) const
+{
+    int i = 0;
+#ifdef __SSE2__
+    // four values per iteration (two per register), NaN values give the first color
+    // as max_pd returns its second operand when any of them is NaN
+    // (empty ranges give the first color as the values are multiplied by 0)
+    const bool empty = !(max > min);
+    const __m128d offset = _mm_set1_pd(min);
+    const __m128d factor = _mm_set1_pd(empty ? 0.0 : levels - 1.0);
+    const __m128d range = _mm_set1_pd(empty ? 1.0 : max - min);
+    const __m128d lowest = _mm_setzero_pd();
+    const __m128d highest = _mm_set1_pd(levels - 1.0);
+    int indexes[4];
+    for (; i + 4 <= count; i += 4) {
+        const __m128d first = _mm_div_pd(
+                    _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(values + i), offset), factor), range);
+        const __m128d second = _mm_div_pd(
+                    _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(values + i + 2), offset), factor), range);
+        const __m128i low = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(first, lowest), highest));
+        const __m128i high = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(second, lowest), highest));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(indexes), _mm_unpacklo_epi64(low, high));
+        // there is no gather in SSE2, the table is small enough to stay in cache
+        colors[i] = m_table[indexes[0]];
+        colors[i + 1] = m_table[indexes[1]];
+        colors[i + 2] = m_table[indexes[2]];
+        colors[i + 3] = m_table[indexes[3]];
+    }
+#endif
+    for (; i < count; ++i) {
+        colors[i] = m_table[levelIndex(level(values[i], min, max))];
+    }
+}
+
+} // namespace Color
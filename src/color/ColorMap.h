@@ -0,0 +1,44 @@
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include <QRgb>
+
+#include "qcustomplot.h"
+
+namespace Color
+{
+
+// A color map (QCPColorGradient preset) baked into a lookup table of RGBA colors
+// so mapping a value to a color is an index computation instead of building
+// and evaluating a gradient
+class ColorMap
+{
+
+public:
+    // number of colors of each table (the default number of levels of a QCPColorGradient
+    // so the colors are the same ones)
+    static const int levels = 350;
+
+    // The color map of the given preset, the tables of all the presets are built
+    // the first time (thread safe)
+    static const ColorMap &get(const QCPColorGradient::GradientPreset preset);
+
+    // The color of value in the range min-max (out of range values are clamped)
+    QRgb color(const double value, const double min, const double max) const;
+
+    // Maps count values in the range min-max to colors (SIMD when available)
+    void map(const double *values,
+             const int count,
+             const double min,
+             const double max,
+             QRgb *colors) const;
+
+private:
+    explicit ColorMap(const QCPColorGradient::GradientPreset preset);
+
+    QRgb m_table[levels];
+};
+
+} // namespace Color
+
+#endif // COLORMAP_H
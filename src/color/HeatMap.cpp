@@ -2,6 +2,9 @@
 
 #include <QImage>
 #include <QColor>
+#include <QVector>
+
+#include "color/ColorMap.h"
 
 namespace Color
 {
@@ -13,18 +16,23 @@ void createLegend(QImage &image, const float lowerbound,
     const int height = image.height();
     const int width = image.width();
 
+    // get the color of each line of the image as the heatmap
+    // color normalized to the lower and upper bound of the image
+    QVector<double> values(height);
     for (int y = 0; y < height; ++y) {
-        // get the color of each line of the image as the heatmap
-        // color normalized to the lower and upper bound of the image
         const int value = height - y - 1;
-        const float adjusted_value
-                = STMath::linearConversion<float, float>(static_cast<float>(value),
-                                                       0.0,
-                                                       static_cast<float>(height),
-                                                       lowerbound,
-                                                       upperbound);
-        const QColor color = Color::createCMapColor(adjusted_value, lowerbound, upperbound, cmap);
-        const QRgb rgb_color = color.rgb();
+        values[y] = STMath::linearConversion<float, float>(static_cast<float>(value),
+                                                           0.0,
+                                                           static_cast<float>(height),
+                                                           lowerbound,
+                                                           upperbound);
+    }
+    QVector<QRgb> colors(height);
+    ColorMap::get(cmap).map(values.constData(), height, lowerbound, upperbound, colors.data());
+
+    for (int y = 0; y < height; ++y) {
+        // opaque colors (the same as QColor::rgb())
+        const QRgb rgb_color = qRgb(qRed(colors.at(y)), qGreen(colors.at(y)), qBlue(colors.at(y)));
         for (int x = 0; x < width; ++x) {
             image.setPixel(x, y, rgb_color);
         }
@@ -121,17 +129,19 @@ QColor createRangeColor(const float value, const float min, const float max,
 
 QColor createCMapColorGpHot(const float value, const float min, const float max)
 {
-    const QCPRange range(min,max);
-    QCPColorGradient cmap(QCPColorGradient::gpHot);
-    return QColor(cmap.color(value, range));
+    return QColor(ColorMap::get(QCPColorGradient::gpHot).color(value, min, max));
 }
 
 QColor createCMapColor(const float value, const float min,
                        const float max, const ColorGradients cmap)
 {
-    const QCPRange range(min, max);
-    QCPColorGradient cmapper(cmap);
-    return QColor(cmapper.color(value, range));
+    return QColor(ColorMap::get(cmap).color(value, min, max));
+}
+
+ColorGradients visualModeColorMap(const SettingsWidget::VisualMode mode)
+{
+    return mode == SettingsWidget::VisualMode::ColorRange ?
+                Color::ColorGradients::gpHot : Color::ColorGradients::gpSpectrum;
 }
 
 QColor adjustVisualMode(const QColor merged_color,
@@ -148,13 +158,10 @@ QColor adjustVisualMode(const QColor merged_color,
         color = Color::createDynamicRangeColor(merged_value, min_reads,
                                                max_reads, merged_color);
     } break;
-    case (SettingsWidget::VisualMode::HeatMap): {
-        color = Color::createCMapColor(merged_value, min_reads,
-                                       max_reads, Color::ColorGradients::gpSpectrum);
-    } break;
+    case (SettingsWidget::VisualMode::HeatMap):
     case (SettingsWidget::VisualMode::ColorRange): {
         color = Color::createCMapColor(merged_value, min_reads,
-                                       max_reads, Color::ColorGradients::gpHot);
+                                       max_reads, visualModeColorMap(mode));
     }
     }
     return color;
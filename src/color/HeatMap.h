@@ -37,9 +37,13 @@ QColor createRangeColor(const float value, const float min, const float max,
                         const QColor init, const QColor end);
 
 // Functions to create a color from a pre-set color map
+// (the color maps are precomputed, see ColorMap to map many values at once)
 QColor createCMapColor(const float value, const float min, const float max,
                        const ColorGradients cmap);
 
+// the color map used by the given visual mode (ColorRange or HeatMap)
+ColorGradients visualModeColorMap(const SettingsWidget::VisualMode mode);
+
 // helper fuctions to adjust a spot's color according to the rendering settings
 QColor adjustVisualMode(const QColor merged_color,
                         const float &merged_value,
@@ -0,0 +1,156 @@
+#include "AttributeStore.h"
+
+AttributeStore::AttributeStore(const QColor &default_color)
+    : m_default_color(default_color.rgba())
+    , m_names()
+    , m_index()
+    , m_colors()
+    , m_totals()
+    , m_visible()
+    , m_selected()
+    , m_revision(0)
+{
+}
+
+AttributeStore::~AttributeStore()
+{
+}
+
+void AttributeStore::clear()
+{
+    m_names.clear();
+    m_index.clear();
+    m_colors.clear();
+    m_totals.clear();
+    m_visible.clear();
+    m_selected.clear();
+    touch();
+}
+
+int AttributeStore::size() const
+{
+    return m_names.size();
+}
+
+bool AttributeStore::empty() const
+{
+    return m_names.isEmpty();
+}
+
+int AttributeStore::indexOf(const QString &name) const
+{
+    return m_index.value(name, -1);
+}
+
+const QString &AttributeStore::name(const int index) const
+{
+    return m_names.at(index);
+}
+
+const QVector<QString> &AttributeStore::names() const
+{
+    return m_names;
+}
+
+QColor AttributeStore::color(const int index) const
+{
+    return QColor::fromRgba(m_colors.at(index));
+}
+
+QRgb AttributeStore::rgba(const int index) const
+{
+    return m_colors.at(index);
+}
+
+void AttributeStore::setColor(const int index, const QColor &color)
+{
+    m_colors[index] = color.rgba();
+    touch();
+}
+
+void AttributeStore::setColor(const QVector<int> &indexes, const QColor &color)
+{
+    const QRgb rgba = color.rgba();
+    for (const int index : indexes) {
+        m_colors[index] = rgba;
+    }
+    touch();
+}
+
+bool AttributeStore::visible(const int index) const
+{
+    return m_visible.testBit(index);
+}
+
+void AttributeStore::setVisible(const int index, const bool visible)
+{
+    m_visible.setBit(index, visible);
+    touch();
+}
+
+void AttributeStore::setVisible(const QVector<int> &indexes, const bool visible)
+{
+    for (const int index : indexes) {
+        m_visible.setBit(index, visible);
+    }
+    touch();
+}
+
+bool AttributeStore::selected(const int index) const
+{
+    return m_selected.testBit(index);
+}
+
+void AttributeStore::setSelected(const int index, const bool selected)
+{
+    m_selected.setBit(index, selected);
+    touch();
+}
+
+const QBitArray &AttributeStore::selectedBits() const
+{
+    return m_selected;
+}
+
+void AttributeStore::setSelected(const QBitArray &selected)
+{
+    Q_ASSERT(selected.size() == m_selected.size());
+    if (selected != m_selected) {
+        m_selected = selected;
+        touch();
+    }
+}
+
+void AttributeStore::clearSelection()
+{
+    m_selected.fill(false);
+    touch();
+}
+
+float AttributeStore::totalCount(const int index) const
+{
+    return m_totals.at(index);
+}
+
+quint64 AttributeStore::revision() const
+{
+    return m_revision;
+}
+
+void AttributeStore::touch()
+{
+    ++m_revision;
+}
+
+int AttributeStore::append(const QString &name, const float total_count)
+{
+    const int index = m_names.size();
+    m_names.append(name);
+    m_index.insert(name, index);
+    m_colors.append(m_default_color);
+    m_totals.append(total_count);
+    m_visible.resize(index + 1);
+    m_selected.resize(index + 1);
+    touch();
+    return index;
+}
@@ -0,0 +1,81 @@
+#ifndef ATTRIBUTESTORE_H
+#define ATTRIBUTESTORE_H
+
+#include <QBitArray>
+#include <QColor>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Columnar storage of the attributes shared by the spots and the genes of a dataset
+// Each attribute is stored in its own array (names, colors and total counts) or bitset
+// (visible and selected) so changing the state of many items touches contiguous memory
+// The items are referred to by their index (the row/column of the matrix of counts),
+// the index of an item can be obtained from its name with indexOf()
+// Every change increases the revision of the store so the users of the attributes
+// (for instance the rendering data) know when they must be computed again
+class AttributeStore
+{
+
+public:
+    explicit AttributeStore(const QColor &default_color);
+    ~AttributeStore();
+
+    // removes all the items
+    void clear();
+
+    // number of items
+    int size() const;
+    bool empty() const;
+
+    // the index of the item with the given name (-1 if there is no such item)
+    int indexOf(const QString &name) const;
+
+    // the name of each item
+    const QString &name(const int index) const;
+    const QVector<QString> &names() const;
+
+    // the color of each item
+    QColor color(const int index) const;
+    QRgb rgba(const int index) const;
+    void setColor(const int index, const QColor &color);
+    void setColor(const QVector<int> &indexes, const QColor &color);
+
+    // true if the item is visible
+    bool visible(const int index) const;
+    void setVisible(const int index, const bool visible);
+    void setVisible(const QVector<int> &indexes, const bool visible);
+
+    // true if the item is selected
+    bool selected(const int index) const;
+    void setSelected(const int index, const bool selected);
+    const QBitArray &selectedBits() const;
+    // replaces the selection of all the items (one bit per item)
+    void setSelected(const QBitArray &selected);
+    // unselects all the items
+    void clearSelection();
+
+    // the total number of transcripts of the item in the dataset
+    float totalCount(const int index) const;
+
+    // the number of changes made to the store
+    quint64 revision() const;
+
+protected:
+    // adds an item with the default attributes, it returns its index
+    int append(const QString &name, const float total_count);
+    // to be called by the subclasses when they change their own attributes
+    void touch();
+
+private:
+    QRgb m_default_color;
+    QVector<QString> m_names;
+    QHash<QString, int> m_index;
+    QVector<QRgb> m_colors;
+    QVector<float> m_totals;
+    QBitArray m_visible;
+    QBitArray m_selected;
+    quint64 m_revision;
+};
+
+#endif // ATTRIBUTESTORE_H
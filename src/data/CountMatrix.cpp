@@ -0,0 +1,130 @@
+#include "CountMatrix.h"
+
+#include <cmath>
+#include <limits>
+
+CountMatrix::CountMatrix()
+    : m_storage(Double)
+    , m_u16()
+    , m_u32()
+    , m_float()
+    , m_double()
+{
+}
+
+CountMatrix::CountMatrix(const mat &counts)
+    : CountMatrix(counts, storageFor(counts))
+{
+}
+
+CountMatrix::CountMatrix(const mat &counts, const Storage storage)
+    : m_storage(storage)
+    , m_u16()
+    , m_u32()
+    , m_float()
+    , m_double()
+{
+    switch (m_storage) {
+    case UInt16:
+        m_u16 = conv_to<Mat<u16>>::from(counts);
+        break;
+    case UInt32:
+        m_u32 = conv_to<Mat<u32>>::from(counts);
+        break;
+    case Float:
+        m_float = conv_to<fmat>::from(counts);
+        break;
+    case Double:
+        m_double = counts;
+        break;
+    }
+}
+
+CountMatrix::~CountMatrix()
+{
+}
+
+CountMatrix::Storage CountMatrix::storage() const
+{
+    return m_storage;
+}
+
+uword CountMatrix::n_rows() const
+{
+    return apply([](const auto &matrix) { return matrix.n_rows; });
+}
+
+uword CountMatrix::n_cols() const
+{
+    return apply([](const auto &matrix) { return matrix.n_cols; });
+}
+
+size_t CountMatrix::memoryUsage() const
+{
+    return apply([](const auto &matrix) {
+        return static_cast<size_t>(matrix.n_elem) * sizeof(matrix.at(0));
+    });
+}
+
+mat CountMatrix::toMat() const
+{
+    return apply([](const auto &matrix) { return conv_to<mat>::from(matrix); });
+}
+
+mat CountMatrix::submat(const uvec &rows, const uvec &cols) const
+{
+    return apply([&](const auto &matrix) { return submat(matrix, rows, cols); });
+}
+
+mat CountMatrix::columns(const uvec &cols) const
+{
+    return apply([&](const auto &matrix) { return columns(matrix, cols); });
+}
+
+rowvec CountMatrix::sumColumns() const
+{
+    return apply([](const auto &matrix) { return sumColumns(matrix); });
+}
+
+colvec CountMatrix::sumRows(const double min_value) const
+{
+    return apply([=](const auto &matrix) { return sumRows(matrix, min_value); });
+}
+
+urowvec CountMatrix::nonZeroColumns(const double min_value) const
+{
+    return apply([=](const auto &matrix) { return nonZeroColumns(matrix, min_value); });
+}
+
+ucolvec CountMatrix::nonZeroRows(const double min_value) const
+{
+    return apply([=](const auto &matrix) { return nonZeroRows(matrix, min_value); });
+}
+
+uvec CountMatrix::columnsWithCounts(const uvec &rows) const
+{
+    return apply([&](const auto &matrix) { return columnsWithCounts(matrix, rows); });
+}
+
+CountMatrix::Storage CountMatrix::storageFor(const mat &counts)
+{
+    bool integers = true;
+    bool floats = true;
+    double max_value = 0.0;
+    for (const double value : counts) {
+        if (integers && (value < 0.0 || value != std::floor(value))) {
+            integers = false;
+        }
+        if (floats && static_cast<double>(static_cast<float>(value)) != value) {
+            floats = false;
+        }
+        max_value = std::max(max_value, value);
+    }
+    if (integers && max_value <= std::numeric_limits<u16>::max()) {
+        return UInt16;
+    }
+    if (integers && max_value <= std::numeric_limits<u32>::max()) {
+        return UInt32;
+    }
+    return floats ? Float : Double;
+}
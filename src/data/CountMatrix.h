@@ -0,0 +1,189 @@
+#ifndef COUNTMATRIX_H
+#define COUNTMATRIX_H
+
+#include <armadillo>
+
+#include <algorithm>
+#include <vector>
+
+using namespace arma;
+
+// The matrix of counts of a data frame (spots as rows and genes as columns) stored
+// with the smallest element type that holds all its values exactly
+// Raw counts are small integers so they take 2 (or 4) bytes per value instead of the
+// 8 bytes of a double, the values are only promoted to double when a submatrix is taken
+// for the normalization and the statistics (that is after slicing and filtering)
+// The kernels (sums, non-zero counts, slicing) are templates on the element type so they
+// work with any storage and with the matrices of doubles of the data frames
+class CountMatrix
+{
+
+public:
+    enum Storage {
+        UInt16,
+        UInt32,
+        Float,
+        Double
+    };
+
+    CountMatrix();
+    // stores the counts with the smallest exact storage (see storageFor())
+    explicit CountMatrix(const mat &counts);
+    // stores the counts with the given storage (the values are converted)
+    CountMatrix(const mat &counts, const Storage storage);
+    ~CountMatrix();
+
+    Storage storage() const;
+    uword n_rows() const;
+    uword n_cols() const;
+    // the number of bytes used by the values
+    size_t memoryUsage() const;
+
+    // the counts promoted to double
+    mat toMat() const;
+    mat submat(const uvec &rows, const uvec &cols) const;
+    mat columns(const uvec &cols) const;
+
+    rowvec sumColumns() const;
+    colvec sumRows(const double min_value = -datum::inf) const;
+    urowvec nonZeroColumns(const double min_value = 0) const;
+    ucolvec nonZeroRows(const double min_value = 0) const;
+    uvec columnsWithCounts(const uvec &rows) const;
+
+    // the smallest storage that holds the counts exactly (unsigned integers that fit in
+    // 16 or 32 bits, values that are exact as floats or doubles)
+    static Storage storageFor(const mat &counts);
+
+    // the sum of each column
+    template <typename eT>
+    static rowvec sumColumns(const Mat<eT> &matrix)
+    {
+        rowvec sums(matrix.n_cols);
+        for (uword j = 0; j < matrix.n_cols; ++j) {
+            const eT *column = matrix.colptr(j);
+            double sum = 0.0;
+            for (uword i = 0; i < matrix.n_rows; ++i) {
+                sum += column[i];
+            }
+            sums.at(j) = sum;
+        }
+        return sums;
+    }
+
+    // the sum of the values greater than min_value of each row
+    template <typename eT>
+    static colvec sumRows(const Mat<eT> &matrix, const double min_value = -datum::inf)
+    {
+        colvec sums(matrix.n_rows, fill::zeros);
+        for (uword j = 0; j < matrix.n_cols; ++j) {
+            const eT *column = matrix.colptr(j);
+            for (uword i = 0; i < matrix.n_rows; ++i) {
+                if (column[i] > min_value) {
+                    sums.at(i) += column[i];
+                }
+            }
+        }
+        return sums;
+    }
+
+    // the number of values greater than min_value of each column
+    template <typename eT>
+    static urowvec nonZeroColumns(const Mat<eT> &matrix, const double min_value = 0)
+    {
+        urowvec counts(matrix.n_cols);
+        for (uword j = 0; j < matrix.n_cols; ++j) {
+            const eT *column = matrix.colptr(j);
+            uword count = 0;
+            for (uword i = 0; i < matrix.n_rows; ++i) {
+                count += column[i] > min_value;
+            }
+            counts.at(j) = count;
+        }
+        return counts;
+    }
+
+    // the number of values greater than min_value of each row
+    template <typename eT>
+    static ucolvec nonZeroRows(const Mat<eT> &matrix, const double min_value = 0)
+    {
+        ucolvec counts(matrix.n_rows, fill::zeros);
+        for (uword j = 0; j < matrix.n_cols; ++j) {
+            const eT *column = matrix.colptr(j);
+            for (uword i = 0; i < matrix.n_rows; ++i) {
+                counts.at(i) += column[i] > min_value;
+            }
+        }
+        return counts;
+    }
+
+    // the columns with a non-zero value in any of the rows
+    template <typename eT>
+    static uvec columnsWithCounts(const Mat<eT> &matrix, const uvec &rows)
+    {
+        std::vector<uword> cols;
+        for (uword j = 0; j < matrix.n_cols; ++j) {
+            const eT *column = matrix.colptr(j);
+            for (const uword i : rows) {
+                if (column[i] != 0) {
+                    cols.push_back(j);
+                    break;
+                }
+            }
+        }
+        return uvec(cols);
+    }
+
+    // the values of the rows and columns promoted to double
+    template <typename eT>
+    static mat submat(const Mat<eT> &matrix, const uvec &rows, const uvec &cols)
+    {
+        mat result(rows.n_elem, cols.n_elem);
+        for (uword j = 0; j < cols.n_elem; ++j) {
+            const eT *column = matrix.colptr(cols.at(j));
+            double *out = result.colptr(j);
+            for (uword i = 0; i < rows.n_elem; ++i) {
+                out[i] = column[rows.at(i)];
+            }
+        }
+        return result;
+    }
+
+    // the values of the columns (all the rows) promoted to double
+    template <typename eT>
+    static mat columns(const Mat<eT> &matrix, const uvec &cols)
+    {
+        mat result(matrix.n_rows, cols.n_elem);
+        for (uword j = 0; j < cols.n_elem; ++j) {
+            const eT *column = matrix.colptr(cols.at(j));
+            std::copy(column, column + matrix.n_rows, result.colptr(j));
+        }
+        return result;
+    }
+
+private:
+    // calls the function with the matrix of the storage
+    template <typename Function>
+    auto apply(Function function) const
+    {
+        switch (m_storage) {
+        case UInt16:
+            return function(m_u16);
+        case UInt32:
+            return function(m_u32);
+        case Float:
+            return function(m_float);
+        case Double:
+        default:
+            return function(m_double);
+        }
+    }
+
+    Storage m_storage;
+    // only the matrix of the storage has values
+    Mat<u16> m_u16;
+    Mat<u32> m_u32;
+    fmat m_float;
+    mat m_double;
+};
+
+#endif // COUNTMATRIX_H
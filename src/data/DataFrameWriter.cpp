@@ -0,0 +1,260 @@
+#include "DataFrameWriter.h"
+
+#include <QByteArray>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+
+// the size of the blocks written to the file
+const size_t BUFFER_SIZE = 4 * 1024 * 1024;
+// the spots are transposed and formatted in blocks (the matrix is column major)
+const uword ROWS_BLOCK = 256;
+// the maximum size of a formatted cell (separator and number)
+const size_t CELL_SIZE = 33;
+
+}
+
+const char DataFrameWriter::MAGIC[4] = {'S', 'T', 'D', 'F'};
+
+DataFrameWriter::DataFrameWriter(const QString &filename, const Format format)
+    : m_file(filename)
+    , m_format(format)
+    , m_progress()
+    , m_buffer(BUFFER_SIZE)
+    , m_size(0)
+    , m_cancelled(false)
+{
+}
+
+DataFrameWriter::~DataFrameWriter()
+{
+}
+
+void DataFrameWriter::setProgress(const Progress &progress)
+{
+    m_progress = progress;
+}
+
+DataFrameWriter::Format DataFrameWriter::format(const QString &filename)
+{
+    return QFileInfo(filename).suffix().compare("stdf", Qt::CaseInsensitive) == 0 ? Binary : TSV;
+}
+
+bool DataFrameWriter::write(const STData::STDataFrame &data)
+{
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("The file could not be opened for writing: "
+                                 + m_file.errorString().toStdString());
+    }
+    m_size = 0;
+    m_cancelled = false;
+    if (m_format == Binary) {
+        writeBinary(data);
+    } else {
+        writeTSV(data);
+    }
+    if (m_cancelled) {
+        m_file.cancelWriting();
+        m_file.commit();
+        return false;
+    }
+    flush();
+    if (!m_file.commit()) {
+        throw std::runtime_error("The file could not be written: "
+                                 + m_file.errorString().toStdString());
+    }
+    return true;
+}
+
+void DataFrameWriter::writeTSV(const STData::STDataFrame &data)
+{
+    const uword n_rows = data.counts.n_rows;
+    const uword n_cols = data.counts.n_cols;
+    // write genes (1st row)
+    for (const auto &gene : data.genes) {
+        const QByteArray name = gene.toUtf8();
+        append('\t');
+        append(name.constData(), name.size());
+    }
+    append('\n');
+    // write spots (1st column and the rest of the rows (counts))
+    for (uword first = 0; first < n_rows; first += ROWS_BLOCK) {
+        const uword last = std::min(n_rows, first + ROWS_BLOCK);
+        // the rows of the block are the columns of the transposed block (contiguous)
+        const mat block = data.counts.rows(first, last - 1).t();
+        for (uword i = first; i < last; ++i) {
+            const QByteArray spot = data.spots.at(i).toUtf8();
+            append(spot.constData(), spot.size());
+            const double *values = block.colptr(i - first);
+            for (uword j = 0; j < n_cols; ++j) {
+                reserve(CELL_SIZE);
+                char *out = m_buffer.data() + m_size;
+                out[0] = '\t';
+                // most of the counts are zero
+                if (values[j] == 0.0) {
+                    out[1] = '0';
+                    m_size += 2;
+                } else {
+                    m_size += 1 + formatNumber(values[j], out + 1);
+                }
+            }
+            append('\n');
+        }
+        if (!reportProgress(static_cast<int>(last))) {
+            return;
+        }
+    }
+}
+
+void DataFrameWriter::writeBinary(const STData::STDataFrame &data)
+{
+    const uword n_rows = data.counts.n_rows;
+    const uword n_cols = data.counts.n_cols;
+    append(MAGIC, sizeof(MAGIC));
+    appendUInt32(VERSION);
+    appendUInt32(static_cast<quint32>(n_rows));
+    appendUInt32(static_cast<quint32>(n_cols));
+    for (const auto &gene : data.genes) {
+        appendName(gene);
+    }
+    for (const auto &spot : data.spots) {
+        appendName(spot);
+    }
+    std::vector<quint32> columns;
+    std::vector<float> values;
+    columns.reserve(n_cols);
+    values.reserve(n_cols);
+    for (uword first = 0; first < n_rows; first += ROWS_BLOCK) {
+        const uword last = std::min(n_rows, first + ROWS_BLOCK);
+        const mat block = data.counts.rows(first, last - 1).t();
+        for (uword i = first; i < last; ++i) {
+            // only the non-zero counts are stored
+            const double *row = block.colptr(i - first);
+            columns.clear();
+            values.clear();
+            for (uword j = 0; j < n_cols; ++j) {
+                if (row[j] != 0.0) {
+                    columns.push_back(static_cast<quint32>(j));
+                    values.push_back(static_cast<float>(row[j]));
+                }
+            }
+            appendUInt32(static_cast<quint32>(columns.size()));
+            for (const quint32 column : columns) {
+                appendUInt32(column);
+            }
+            for (const float value : values) {
+                appendFloat(value);
+            }
+        }
+        if (!reportProgress(static_cast<int>(last))) {
+            return;
+        }
+    }
+}
+
+int DataFrameWriter::formatNumber(const double value, char *out)
+{
+    // integers (the counts) are formatted exactly without floating point formatting
+    if (std::abs(value) < 1e15 && value == std::floor(value)) {
+        qint64 integer = static_cast<qint64>(value);
+        int size = 0;
+        if (integer < 0) {
+            out[size++] = '-';
+            integer = -integer;
+        }
+        char digits[20];
+        int n_digits = 0;
+        do {
+            digits[n_digits++] = static_cast<char>('0' + integer % 10);
+            integer /= 10;
+        } while (integer > 0);
+        while (n_digits > 0) {
+            out[size++] = digits[--n_digits];
+        }
+        return size;
+    }
+    // the shortest representation that is parsed back to the same float
+    // (9 significant digits are always enough for a float)
+    const float expected = static_cast<float>(value);
+    QByteArray number;
+    for (int precision = 6; precision <= 9; ++precision) {
+        number = QByteArray::number(value, 'g', precision);
+        if (number.toFloat() == expected) {
+            break;
+        }
+    }
+    const int size = std::min(number.size(), static_cast<int>(CELL_SIZE) - 1);
+    std::memcpy(out, number.constData(), size);
+    return size;
+}
+
+void DataFrameWriter::reserve(const size_t size)
+{
+    if (m_size + size > m_buffer.size()) {
+        flush();
+        if (size > m_buffer.size()) {
+            m_buffer.resize(size);
+        }
+    }
+}
+
+void DataFrameWriter::append(const char *data, const size_t size)
+{
+    reserve(size);
+    std::memcpy(m_buffer.data() + m_size, data, size);
+    m_size += size;
+}
+
+void DataFrameWriter::append(const char c)
+{
+    reserve(1);
+    m_buffer[m_size++] = c;
+}
+
+void DataFrameWriter::appendUInt32(const quint32 value)
+{
+    reserve(sizeof(value));
+    qToLittleEndian(value, reinterpret_cast<uchar *>(m_buffer.data() + m_size));
+    m_size += sizeof(value);
+}
+
+void DataFrameWriter::appendFloat(const float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendUInt32(bits);
+}
+
+void DataFrameWriter::appendName(const QString &name)
+{
+    const QByteArray bytes = name.toUtf8();
+    appendUInt32(static_cast<quint32>(bytes.size()));
+    append(bytes.constData(), bytes.size());
+}
+
+void DataFrameWriter::flush()
+{
+    if (m_size == 0) {
+        return;
+    }
+    if (m_file.write(m_buffer.data(), m_size) != static_cast<qint64>(m_size)) {
+        throw std::runtime_error("The file could not be written: "
+                                 + m_file.errorString().toStdString());
+    }
+    m_size = 0;
+}
+
+bool DataFrameWriter::reportProgress(const int rows)
+{
+    if (m_progress && !m_progress(rows)) {
+        m_cancelled = true;
+    }
+    return !m_cancelled;
+}
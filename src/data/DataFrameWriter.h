@@ -0,0 +1,81 @@
+#ifndef DATAFRAMEWRITER_H
+#define DATAFRAMEWRITER_H
+
+#include <QString>
+#include <QSaveFile>
+
+#include "data/STData.h"
+
+#include <functional>
+#include <vector>
+
+// Writes a data frame (counts matrix with the spot and gene names) to a file
+// The output is formatted into a large buffer that is written in big blocks
+// (instead of one small write and a flush per cell/row) and the counts are formatted
+// without a stream (integers and zeros have a fast path), so writing is bound by the disk
+// The data frame can be written as TSV (spots as rows and genes as columns)
+// or in a binary format that only stores the non-zero counts of each spot:
+// magic "STDF", version, number of spots, number of genes (32 bits, little endian),
+// the gene names and the spot names (length and UTF-8 bytes) and then for each spot
+// the number of non-zero counts, their columns (32 bits) and their values (32 bits floats)
+// The file is written to a temporary file that only replaces the destination when
+// everything has been written (a cancelled or failed export leaves no partial file)
+class DataFrameWriter
+{
+
+public:
+    enum Format {
+        TSV,
+        Binary
+    };
+
+    // called with the number of spots written so far, writing stops if it returns false
+    typedef std::function<bool(int)> Progress;
+
+    static const char MAGIC[4];
+    static const quint32 VERSION = 1;
+
+    explicit DataFrameWriter(const QString &filename, const Format format = TSV);
+    ~DataFrameWriter();
+
+    // the function called to report the progress (and to cancel)
+    void setProgress(const Progress &progress);
+
+    // writes the data frame, it returns false if it was cancelled
+    // it throws std::runtime_error if the file can not be written
+    bool write(const STData::STDataFrame &data);
+
+    // the format of the file given its extension (.stdf is binary, anything else TSV)
+    static Format format(const QString &filename);
+
+    // formats the value in out (at least 32 chars) and returns the number of chars
+    // integers are formatted exactly, other values with the shortest representation
+    // that is parsed back to the same float (the precision of STData::read())
+    static int formatNumber(const double value, char *out);
+
+private:
+    void writeTSV(const STData::STDataFrame &data);
+    void writeBinary(const STData::STDataFrame &data);
+
+    // makes sure that there is room for size bytes in the buffer
+    void reserve(const size_t size);
+    void append(const char *data, const size_t size);
+    void append(const char c);
+    void appendUInt32(const quint32 value);
+    void appendFloat(const float value);
+    void appendName(const QString &name);
+    // writes the buffer to the file
+    void flush();
+    bool reportProgress(const int rows);
+
+    QSaveFile m_file;
+    Format m_format;
+    Progress m_progress;
+    std::vector<char> m_buffer;
+    size_t m_size;
+    bool m_cancelled;
+
+    Q_DISABLE_COPY(DataFrameWriter)
+};
+
+#endif // DATAFRAMEWRITER_H
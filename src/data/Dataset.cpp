@@ -2,6 +2,7 @@
 #include <QDebug>
 #include "STData.h"
 #include "DatasetImporter.h"
+#include "profiling/Profiler.h"
 
 Dataset::Dataset()
     : m_name()
@@ -153,7 +154,7 @@ const QString Dataset::spikeinFile() const
 
 const QString Dataset::sizeFactorsFile() const
 {
-    return m_spots_file;
+    return m_size_factors_file;
 }
 
 void Dataset::name(const QString &name)
@@ -218,16 +219,17 @@ void Dataset::sizeFactorsFile(const QString &sizeFactorsFile)
 
 void Dataset::load_data()
 {
-    // Parse ST Data file and spot coordinates (if any)
-    m_data = QSharedPointer<STData>(new STData());
-    try {
-        m_data->init(m_data_file, m_spots_file);
-    } catch (const std::exception &e) {
-        qDebug() << "Error parsing data matrix or spot coordinates " << e.what();
-        throw;
-    }
+    load_data(parse_data());
+}
+
+void Dataset::load_data(const QSharedPointer<STData> &data)
+{
+    ST_PROFILE_SCOPE("Dataset::load_data");
+    Q_ASSERT(!data.isNull());
+    m_data = data;
 
     // Parse image alignment
+    m_alignment = QTransform();
     if (!m_alignment_file.isEmpty()) {
         const bool parsed = load_imageAligment();
         if (!parsed) {
@@ -236,9 +238,25 @@ void Dataset::load_data()
         }
     }
 
+    // account the memory of the data under the name of the dataset
+    m_data->accountMemory(m_name);
+}
+
+QSharedPointer<STData> Dataset::parse_data() const
+{
+    ST_PROFILE_SCOPE("Dataset::parse_data");
+    // Parse ST Data file and spot coordinates (if any)
+    QSharedPointer<STData> data(new STData());
+    try {
+        data->init(m_data_file, m_spots_file);
+    } catch (const std::exception &e) {
+        qDebug() << "Error parsing data matrix or spot coordinates " << e.what();
+        throw;
+    }
+
     // Parse spike-ins
     if (!m_spikein_file.isEmpty()) {
-        const bool parsed = m_data->parseSpikeIn(m_spikein_file);
+        const bool parsed = data->parseSpikeIn(m_spikein_file);
         if (!parsed) {
             qDebug() << "Error parsing Spike-in file";
             throw std::runtime_error("Error parsing Spike-in file");
@@ -247,12 +265,14 @@ void Dataset::load_data()
 
     // Parse size-factors
     if (!m_size_factors_file.isEmpty()) {
-        const bool parsed = m_data->parseSizeFactors(m_size_factors_file);
+        const bool parsed = data->parseSizeFactors(m_size_factors_file);
         if (!parsed) {
             qDebug() << "Error parsing Size Factors file";
             throw std::runtime_error("Error parsing Size Factors file");
         }
     }
+
+    return data;
 }
 
 bool Dataset::load_imageAligment()
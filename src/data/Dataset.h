@@ -57,6 +57,15 @@ public:
     //          spots-file (if any) and spike-in (if any)
     // throws exception if parsing is something went wrong
     void load_data();
+    // the same with a STData object already parsed by parse_data() (e.g. cached)
+    void load_data(const QSharedPointer<STData> &data);
+
+    // creates a STData object with the files of the dataset without changing the dataset
+    // (it can be called from any thread)
+    // Parses : matrix of counts, size factors (if any), spots-file (if any)
+    //          and spike-in (if any)
+    // throws exception if parsing is something went wrong
+    QSharedPointer<STData> parse_data() const;
 
 private:
 
@@ -0,0 +1,210 @@
+#include "DatasetCache.h"
+
+#include <QDebug>
+#include <QtConcurrent>
+
+#include "data/STData.h"
+#include "profiling/MemoryAccounting.h"
+#include "profiling/Profiler.h"
+
+#include <stdexcept>
+
+namespace
+{
+
+// the name of the entries in the memory accounting
+const QString DATASET_CACHE = QStringLiteral("Dataset");
+
+// the files the data and the image are loaded from (the alignment is parsed when
+// the dataset is opened)
+bool sameFiles(const Dataset &dataset, const Dataset &other)
+{
+    return dataset.dataFile() == other.dataFile()
+            && dataset.spotsFile() == other.spotsFile()
+            && dataset.spikeinFile() == other.spikeinFile()
+            && dataset.sizeFactorsFile() == other.sizeFactorsFile()
+            && dataset.imageFile() == other.imageFile();
+}
+
+}
+
+DatasetCache::DatasetCache(QObject *parent)
+    : QObject(parent)
+    , m_entries()
+    , m_open()
+{
+}
+
+DatasetCache::~DatasetCache()
+{
+    for (const auto &cached : m_entries) {
+        MemoryAccounting::instance().release(cached.data());
+    }
+}
+
+DatasetCache::Loaded DatasetCache::open(const Dataset &dataset)
+{
+    ST_PROFILE_SCOPE("DatasetCache::open");
+    close();
+    removeEvicted();
+
+    m_open = dataset.name();
+    QSharedPointer<Entry> cached = entry(dataset);
+    if (cached.isNull()) {
+        qDebug() << "Loading dataset " << dataset.name();
+        cached = addEntry(dataset);
+        cached->loaded = load(dataset);
+    } else if (cached->loading) {
+        qDebug() << "Waiting for the dataset being loaded " << dataset.name();
+        cached->watcher.waitForFinished();
+        finishLoading(*cached);
+    }
+
+    if (cached->loaded.data.isNull()) {
+        // the files may be fixed so the error is not cached
+        const QString error = cached->loaded.error;
+        m_open.clear();
+        remove(dataset.name());
+        throw std::runtime_error(error.toStdString());
+    }
+    // the image of the open dataset may have been evicted
+    if (cached->loaded.image.image.isNull() && !dataset.imageFile().isEmpty()) {
+        cached->loaded.image = ImageTextureGL::readImage(dataset.imageFile());
+    }
+    // the data of the open dataset is not measured as a cache
+    MemoryAccounting::instance().updateCache(cached.data(), DATASET_CACHE);
+    return cached->loaded;
+}
+
+void DatasetCache::close()
+{
+    const auto it = m_entries.constFind(m_open);
+    m_open.clear();
+    if (it != m_entries.constEnd() && !(*it)->loaded.data.isNull()) {
+        // the data is a cache again (it is not accounted as a dataset anymore)
+        MemoryAccounting::instance().release((*it)->loaded.data.data());
+        MemoryAccounting::instance().updateCache(it->data(), DATASET_CACHE);
+    }
+}
+
+void DatasetCache::prefetch(const QList<Dataset> &datasets)
+{
+    removeEvicted();
+    for (const Dataset &dataset : datasets) {
+        if (contains(dataset)) {
+            continue;
+        }
+        qDebug() << "Prefetching dataset " << dataset.name();
+        QSharedPointer<Entry> added = addEntry(dataset);
+        added->loading = true;
+        Entry *loading = added.data();
+        connect(&added->watcher, &QFutureWatcher<Loaded>::finished,
+                this, [=]() { finishLoading(*loading); });
+        added->watcher.setFuture(QtConcurrent::run([dataset]() { return load(dataset); }));
+    }
+}
+
+void DatasetCache::remove(const QString &name)
+{
+    const auto it = m_entries.find(name);
+    if (it == m_entries.end()) {
+        return;
+    }
+    // a load in progress finishes in the background and its result is discarded
+    MemoryAccounting::instance().release(it->data());
+    m_entries.erase(it);
+}
+
+bool DatasetCache::contains(const Dataset &dataset) const
+{
+    return !entry(dataset).isNull();
+}
+
+DatasetCache::Loaded DatasetCache::load(const Dataset &dataset)
+{
+    ST_PROFILE_SCOPE("DatasetCache::load");
+    Loaded loaded;
+    try {
+        loaded.data = dataset.parse_data();
+    } catch (const std::exception &e) {
+        loaded.error = QString::fromStdString(e.what());
+        return loaded;
+    }
+    loaded.image = ImageTextureGL::readImage(dataset.imageFile());
+    return loaded;
+}
+
+QSharedPointer<DatasetCache::Entry> DatasetCache::entry(const Dataset &dataset) const
+{
+    const auto it = m_entries.constFind(dataset.name());
+    if (it == m_entries.constEnd() || !sameFiles((*it)->dataset, dataset)) {
+        return QSharedPointer<Entry>();
+    }
+    // the entries that were evicted or failed have no data
+    if (!(*it)->loading && (*it)->loaded.data.isNull()) {
+        return QSharedPointer<Entry>();
+    }
+    return *it;
+}
+
+QSharedPointer<DatasetCache::Entry> DatasetCache::addEntry(const Dataset &dataset)
+{
+    const QString name = dataset.name();
+    remove(name);
+
+    QSharedPointer<Entry> added(new Entry());
+    added->dataset = dataset;
+    m_entries.insert(name, added);
+
+    // the entry is registered as a cache until it is removed (the accounting measures
+    // it in the thread of the cache)
+    Entry *cached = added.data();
+    const auto size = [=]() { return cacheMemoryUsage(*cached); };
+    const auto evict = [=]() {
+        // the textures of the open dataset have been created from its image
+        if (cached->dataset.name() == m_open) {
+            cached->loaded.image = ImageTextureGL::Image();
+        } else {
+            cached->loaded = Loaded();
+        }
+    };
+    MemoryAccounting::instance().registerCache(cached, name, DATASET_CACHE, size, evict);
+    return added;
+}
+
+void DatasetCache::finishLoading(Entry &entry)
+{
+    if (!entry.loading) {
+        return;
+    }
+    entry.loading = false;
+    entry.loaded = entry.watcher.result();
+    if (entry.loaded.data.isNull()) {
+        qDebug() << "Error prefetching dataset " << entry.dataset.name() << entry.loaded.error;
+    }
+    // the loaded entry is the most recently used one (and it is measured again)
+    MemoryAccounting::instance().updateCache(&entry, DATASET_CACHE);
+}
+
+void DatasetCache::removeEvicted()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        const Entry &cached = **it;
+        if (!cached.loading && cached.loaded.data.isNull() && cached.dataset.name() != m_open) {
+            MemoryAccounting::instance().release(it->data());
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+qint64 DatasetCache::cacheMemoryUsage(const Entry &entry) const
+{
+    const QImage &image = entry.loaded.image.image;
+    qint64 bytes = static_cast<qint64>(image.bytesPerLine()) * image.height();
+    if (!entry.loaded.data.isNull() && entry.dataset.name() != m_open) {
+        bytes += entry.loaded.data->memoryUsage();
+    }
+    return bytes;
+}
@@ -0,0 +1,86 @@
+#ifndef DATASETCACHE_H
+#define DATASETCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+
+#include "data/Dataset.h"
+#include "viewRenderer/ImageTextureGL.h"
+
+class STData;
+
+// DatasetCache keeps the recently opened datasets (the parsed data and the tissue image
+// read into memory) so they are not parsed from disk when they are opened again, and it
+// loads the datasets that are likely to be opened next in background threads.
+// The datasets are cached by name and they are loaded again when their files change.
+// The cached datasets are recomputable caches of the memory accounting (see MemoryAccounting)
+// so the least recently used ones are evicted when the caches exceed their budget
+// (the data of the open dataset is accounted as a dataset, only its image is a cache).
+// The data keeps its state (e.g. the selected spots) while it is cached
+class DatasetCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // the data and the image of a dataset
+    struct Loaded {
+        QSharedPointer<STData> data;
+        ImageTextureGL::Image image;
+        // the error if the data could not be parsed
+        QString error;
+    };
+
+    explicit DatasetCache(QObject *parent = 0);
+    virtual ~DatasetCache();
+
+    // the data and the image of the dataset, it becomes the open dataset
+    // (it waits for it if it is being loaded and it loads it now if it is not cached)
+    // throws std::runtime_error if the data could not be parsed
+    Loaded open(const Dataset &dataset);
+    // the open dataset has been closed (it stays in the cache)
+    void close();
+
+    // loads the datasets in background threads (the ones cached or being loaded are skipped)
+    void prefetch(const QList<Dataset> &datasets);
+
+    // removes the dataset from the cache (the open dataset must be closed first)
+    void remove(const QString &name);
+
+    // true if the dataset is cached or being loaded (with the same files)
+    bool contains(const Dataset &dataset) const;
+
+private:
+    struct Entry {
+        // the dataset (files) the entry was loaded from
+        Dataset dataset;
+        Loaded loaded;
+        // the load in a background thread (while loading is true)
+        QFutureWatcher<Loaded> watcher;
+        bool loading = false;
+    };
+
+    // parses the data and reads the image of the dataset (in any thread)
+    static Loaded load(const Dataset &dataset);
+
+    // the entry of the dataset (null if it is not cached or its files changed)
+    QSharedPointer<Entry> entry(const Dataset &dataset) const;
+    // creates the entry of the dataset (replacing the previous one) and registers it
+    QSharedPointer<Entry> addEntry(const Dataset &dataset);
+    // takes the result of the background load of the entry (in the thread of the cache)
+    void finishLoading(Entry &entry);
+    // removes the entries evicted by the memory accounting
+    void removeEvicted();
+
+    // the memory of the entry that is accounted as a cache (bytes)
+    qint64 cacheMemoryUsage(const Entry &entry) const;
+
+    QHash<QString, QSharedPointer<Entry>> m_entries;
+    // the name of the open dataset (its data is not a cache)
+    QString m_open;
+
+    Q_DISABLE_COPY(DatasetCache)
+};
+
+#endif // DATASETCACHE_H
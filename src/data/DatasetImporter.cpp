@@ -124,7 +124,7 @@ void DatasetImporter::slotLoadSTDataFile()
             = QFileDialog::getOpenFileName(this,
                                            tr("Open ST Data File"),
                                            QDir::homePath(),
-                                           QString("%1").arg(tr("TSV Files (*.tsv)")));
+                                           tr("ST Data Files (*.tsv *.stdf)"));
     // early out
     if (filename.isEmpty()) {
         return;
@@ -282,7 +282,8 @@ void DatasetImporter::slotParseFolder()
         while (it.hasNext()) {
             const QString file = it.next();
             qDebug() << "Parsing dataset file from folder " << file;
-            if (file.contains(".tsv")) {
+            // the binary caches of stviewer-cli are .stdf files
+            if (file.contains(".tsv") || file.endsWith(".stdf")) {
                 m_ui->stDataFile->setText(file);
             } else if (file.contains(".jpg")) {
                 m_ui->mainImageFile->setText(file);
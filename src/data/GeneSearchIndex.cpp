@@ -0,0 +1,250 @@
+#include "GeneSearchIndex.h"
+
+#include "profiling/MemoryAccounting.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+
+// compares the suffix of the name starting at offset (truncated to the length of text)
+// with the text, it returns <0, 0 or >0 like strcmp
+int compareSuffix(const QString &name, const int offset, const QString &text)
+{
+    const int suffix_size = name.size() - offset;
+    const int size = std::min(suffix_size, text.size());
+    const QChar *suffix = name.constData() + offset;
+    for (int i = 0; i < size; ++i) {
+        if (suffix[i] != text[i]) {
+            return suffix[i] < text[i] ? -1 : 1;
+        }
+    }
+    return suffix_size < text.size() ? -1 : 0;
+}
+
+// sorts and removes the duplicated genes
+QVector<int> uniqueGenes(std::vector<int> &genes)
+{
+    std::sort(genes.begin(), genes.end());
+    genes.erase(std::unique(genes.begin(), genes.end()), genes.end());
+    QVector<int> unique_genes;
+    unique_genes.reserve(static_cast<int>(genes.size()));
+    for (const int gene : genes) {
+        unique_genes.push_back(gene);
+    }
+    return unique_genes;
+}
+
+bool isWildcard(const QRegExp &regexp)
+{
+    return regexp.patternSyntax() == QRegExp::Wildcard
+            || regexp.patternSyntax() == QRegExp::WildcardUnix;
+}
+
+}
+
+GeneSearchIndex::GeneSearchIndex()
+    : m_names()
+    , m_lower()
+    , m_suffixes()
+{
+}
+
+GeneSearchIndex::~GeneSearchIndex()
+{
+}
+
+void GeneSearchIndex::build(const QVector<QString> &names)
+{
+    clear();
+    m_names = names;
+    m_lower.reserve(names.size());
+    for (int i = 0; i < names.size(); ++i) {
+        const QString name = names.at(i).toLower();
+        m_lower.push_back(name);
+        for (int offset = 0; offset < name.size(); ++offset) {
+            m_suffixes.push_back({i, offset});
+        }
+    }
+    std::sort(m_suffixes.begin(), m_suffixes.end(),
+              [&] (const Suffix &lhs, const Suffix &rhs) {
+        const QString &lhs_name = m_lower.at(lhs.gene);
+        const QString &rhs_name = m_lower.at(rhs.gene);
+        return std::lexicographical_compare(lhs_name.constBegin() + lhs.offset, lhs_name.constEnd(),
+                                            rhs_name.constBegin() + rhs.offset, rhs_name.constEnd());
+    });
+}
+
+void GeneSearchIndex::clear()
+{
+    // the memory is released too (the index can be evicted and built again)
+    m_names = QVector<QString>();
+    m_lower = QVector<QString>();
+    std::vector<Suffix>().swap(m_suffixes);
+}
+
+int GeneSearchIndex::size() const
+{
+    return m_names.size();
+}
+
+qint64 GeneSearchIndex::memoryUsage() const
+{
+    // the names are shared with the gene store, the lower case names are copies
+    return m_names.capacity() * sizeof(QString)
+            + MemoryAccounting::stringsMemoryUsage(m_lower)
+            + m_suffixes.capacity() * sizeof(Suffix);
+}
+
+std::pair<GeneSearchIndex::SuffixIterator, GeneSearchIndex::SuffixIterator>
+GeneSearchIndex::suffixRange(const QString &text) const
+{
+    const auto first = std::lower_bound(m_suffixes.begin(), m_suffixes.end(), text,
+                                        [&] (const Suffix &suffix, const QString &value) {
+        return compareSuffix(m_lower.at(suffix.gene), suffix.offset, value) < 0;
+    });
+    const auto last = std::upper_bound(first, m_suffixes.end(), text,
+                                       [&] (const QString &value, const Suffix &suffix) {
+        return compareSuffix(m_lower.at(suffix.gene), suffix.offset, value) > 0;
+    });
+    return std::make_pair(first, last);
+}
+
+QVector<int> GeneSearchIndex::findPrefix(const QString &text) const
+{
+    std::vector<int> genes;
+    if (text.isEmpty()) {
+        genes.resize(m_names.size());
+        std::iota(genes.begin(), genes.end(), 0);
+        return uniqueGenes(genes);
+    }
+    const auto range = suffixRange(text.toLower());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->offset == 0) {
+            genes.push_back(it->gene);
+        }
+    }
+    return uniqueGenes(genes);
+}
+
+QVector<int> GeneSearchIndex::findSubstring(const QString &text) const
+{
+    if (text.isEmpty()) {
+        return findPrefix(text);
+    }
+    std::vector<int> genes;
+    const auto range = suffixRange(text.toLower());
+    for (auto it = range.first; it != range.second; ++it) {
+        genes.push_back(it->gene);
+    }
+    return uniqueGenes(genes);
+}
+
+QVector<int> GeneSearchIndex::findMatches(const QRegExp &regexp) const
+{
+    QVector<int> genes;
+    if (!regexp.isValid()) {
+        return genes;
+    }
+    // the candidates contain the literal part of the pattern (ignoring the case)
+    const bool use_substring = isWildcard(regexp) || regexp.patternSyntax() == QRegExp::FixedString;
+    const QVector<int> candidates = use_substring ? findSubstring(literalSubstring(regexp))
+                                                  : findPrefix(literalPrefix(regexp));
+    for (const int gene : candidates) {
+        if (regexp.exactMatch(m_names.at(gene))) {
+            genes.push_back(gene);
+        }
+    }
+    return genes;
+}
+
+QString GeneSearchIndex::literalPrefix(const QRegExp &regexp)
+{
+    const QString pattern = regexp.pattern();
+    QString prefix;
+    switch (regexp.patternSyntax()) {
+    case QRegExp::FixedString:
+        return pattern;
+    case QRegExp::Wildcard:
+    case QRegExp::WildcardUnix:
+        for (int i = 0; i < pattern.size(); ++i) {
+            const QChar c = pattern.at(i);
+            if (c == '*' || c == '?' || c == '[') {
+                break;
+            }
+            if (c == '\\') {
+                if (regexp.patternSyntax() == QRegExp::Wildcard || i + 1 == pattern.size()) {
+                    break;
+                }
+                prefix.append(pattern.at(++i));
+            } else {
+                prefix.append(c);
+            }
+        }
+        return prefix;
+    case QRegExp::RegExp:
+    case QRegExp::RegExp2:
+    {
+        // an alternative anywhere in the pattern can change the prefix
+        if (pattern.contains('|')) {
+            return prefix;
+        }
+        static const QString special(".^$|()[]{}*+?\\");
+        int i = pattern.startsWith('^') ? 1 : 0;
+        while (i < pattern.size()) {
+            QChar c = pattern.at(i);
+            if (c == '\\' && i + 1 < pattern.size() && !pattern.at(i + 1).isLetterOrNumber()) {
+                // escaped special character
+                c = pattern.at(++i);
+            } else if (special.contains(c)) {
+                break;
+            }
+            ++i;
+            // the character is optional if it is followed by a quantifier
+            if (i < pattern.size()
+                    && (pattern.at(i) == '*' || pattern.at(i) == '?' || pattern.at(i) == '{')) {
+                break;
+            }
+            prefix.append(c);
+        }
+        return prefix;
+    }
+    default:
+        return prefix;
+    }
+}
+
+QString GeneSearchIndex::literalSubstring(const QRegExp &regexp)
+{
+    if (!isWildcard(regexp)) {
+        return literalPrefix(regexp);
+    }
+    // the longest run of literal characters of the wildcard
+    const QString pattern = regexp.pattern();
+    QString longest;
+    QString current;
+    for (int i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern.at(i);
+        if (c == '[' || (c == '\\' && regexp.patternSyntax() == QRegExp::Wildcard)) {
+            // stop at the first set of characters
+            break;
+        }
+        if (c == '*' || c == '?') {
+            current.clear();
+            continue;
+        }
+        if (c == '\\') {
+            if (i + 1 == pattern.size()) {
+                break;
+            }
+            current.append(pattern.at(++i));
+        } else {
+            current.append(c);
+        }
+        if (current.size() > longest.size()) {
+            longest = current;
+        }
+    }
+    return longest;
+}
@@ -0,0 +1,61 @@
+#ifndef GENESEARCHINDEX_H
+#define GENESEARCHINDEX_H
+
+#include <QVector>
+#include <QString>
+#include <QRegExp>
+
+#include <vector>
+
+// Search index for the gene names of a dataset (built once when the dataset is loaded)
+// The index is a sorted suffix array of the lower case names so prefix and
+// substring queries are two binary searches.
+// Reg-exp queries use the literal part of the pattern (a prefix for reg-exps or the longest
+// literal for wildcards) to find the candidate genes and only those are matched.
+// All the functions return the indexes of the genes (as given in build()) in ascending order
+class GeneSearchIndex
+{
+
+public:
+    GeneSearchIndex();
+    ~GeneSearchIndex();
+
+    // builds the index from the genes names (the index of each name is its gene index)
+    void build(const QVector<QString> &names);
+    void clear();
+
+    // number of genes in the index
+    int size() const;
+    // an estimate of the memory used by the index (bytes)
+    qint64 memoryUsage() const;
+
+    // genes whose name starts with the text (case insensitive)
+    QVector<int> findPrefix(const QString &text) const;
+    // genes whose name contains the text (case insensitive)
+    QVector<int> findSubstring(const QString &text) const;
+    // genes whose name is exactly matched by the reg-exp
+    QVector<int> findMatches(const QRegExp &regexp) const;
+
+    // the literal text that any name matched by the reg-exp must start with
+    // (empty if the pattern does not start with a literal)
+    static QString literalPrefix(const QRegExp &regexp);
+    // the longest literal text that any name matched by the reg-exp must contain
+    static QString literalSubstring(const QRegExp &regexp);
+
+private:
+    struct Suffix {
+        int gene;
+        int offset;
+    };
+
+    typedef std::vector<Suffix>::const_iterator SuffixIterator;
+
+    // the range of suffixes that start with the (lower case) text
+    std::pair<SuffixIterator, SuffixIterator> suffixRange(const QString &text) const;
+
+    QVector<QString> m_names;
+    QVector<QString> m_lower;
+    std::vector<Suffix> m_suffixes;
+};
+
+#endif // GENESEARCHINDEX_H
@@ -0,0 +1,34 @@
+#include "GeneStore.h"
+
+GeneStore::GeneStore()
+    : AttributeStore(Qt::red)
+    , m_cutoffs()
+{
+}
+
+GeneStore::~GeneStore()
+{
+}
+
+void GeneStore::clear()
+{
+    AttributeStore::clear();
+    m_cutoffs.clear();
+}
+
+int GeneStore::append(const QString &name, const float total_count)
+{
+    m_cutoffs.append(0);
+    return AttributeStore::append(name, total_count);
+}
+
+float GeneStore::cut_off(const int index) const
+{
+    return m_cutoffs.at(index);
+}
+
+void GeneStore::setCutOff(const int index, const float cutoff)
+{
+    m_cutoffs[index] = cutoff;
+    touch();
+}
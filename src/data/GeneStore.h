@@ -0,0 +1,30 @@
+#ifndef GENESTORE_H
+#define GENESTORE_H
+
+#include "data/AttributeStore.h"
+
+// The genes of a dataset stored by columns (see AttributeStore)
+// Besides the shared attributes each gene has a cut-off (reads) that is used
+// to discard the counts of the gene below it
+class GeneStore : public AttributeStore
+{
+
+public:
+    GeneStore();
+    ~GeneStore();
+
+    // removes all the genes
+    void clear();
+
+    // adds a gene, it returns its index
+    int append(const QString &name, const float total_count);
+
+    // the gene's cut-off
+    float cut_off(const int index) const;
+    void setCutOff(const int index, const float cutoff);
+
+private:
+    QVector<float> m_cutoffs;
+};
+
+#endif // GENESTORE_H
@@ -0,0 +1,98 @@
+#include "RenderingBuffer.h"
+
+RenderingBuffer::RenderingBuffer()
+    : m_x()
+    , m_y()
+    , m_colors()
+    , m_values()
+    , m_visible()
+    , m_selected()
+    , m_spot_color()
+{
+}
+
+RenderingBuffer::~RenderingBuffer()
+{
+}
+
+void RenderingBuffer::resize(const int size)
+{
+    m_x.resize(size);
+    m_y.resize(size);
+    m_colors.resize(size);
+    m_values.resize(size);
+    m_visible.resize(size);
+    m_selected.resize(size);
+    m_spot_color.resize(size);
+}
+
+int RenderingBuffer::size() const
+{
+    return m_x.size();
+}
+
+const QVector<float> &RenderingBuffer::x() const
+{
+    return m_x;
+}
+
+const QVector<float> &RenderingBuffer::y() const
+{
+    return m_y;
+}
+
+void RenderingBuffer::setCoordinates(const int index, const float x, const float y)
+{
+    m_x[index] = x;
+    m_y[index] = y;
+}
+
+const QVector<QRgb> &RenderingBuffer::colors() const
+{
+    return m_colors;
+}
+
+void RenderingBuffer::setColor(const int index, const QRgb color)
+{
+    m_colors[index] = color;
+}
+
+const QVector<double> &RenderingBuffer::values() const
+{
+    return m_values;
+}
+
+void RenderingBuffer::setValue(const int index, const double value)
+{
+    m_values[index] = value;
+}
+
+bool RenderingBuffer::visible(const int index) const
+{
+    return m_visible.testBit(index);
+}
+
+bool RenderingBuffer::selected(const int index) const
+{
+    return m_selected.testBit(index);
+}
+
+bool RenderingBuffer::spotColor(const int index) const
+{
+    return m_spot_color.testBit(index);
+}
+
+void RenderingBuffer::setFlags(const int index,
+                               const bool visible,
+                               const bool selected,
+                               const bool spot_color)
+{
+    m_visible.setBit(index, visible);
+    m_selected.setBit(index, selected);
+    m_spot_color.setBit(index, spot_color);
+}
+
+void RenderingBuffer::clearVisible()
+{
+    m_visible.fill(false);
+}
@@ -0,0 +1,58 @@
+#ifndef RENDERINGBUFFER_H
+#define RENDERINGBUFFER_H
+
+#include <QBitArray>
+#include <QColor>
+#include <QVector>
+
+// The rendering data of the spots stored as packed arrays (struct of arrays)
+// The renderer reads contiguous memory instead of dereferencing the spot objects
+// and the arrays can be uploaded as they are to the GPU: the coordinates as floats and
+// the colors as RGBA8 (QRgb, that is 0xAARRGGBB or GL_BGRA on little endian)
+// The flags (visible, selected...) are stored as bits
+class RenderingBuffer
+{
+
+public:
+    RenderingBuffer();
+    ~RenderingBuffer();
+
+    // resizes the arrays (the new spots are not visible)
+    void resize(const int size);
+    int size() const;
+
+    // the (adjusted) coordinates of each spot
+    const QVector<float> &x() const;
+    const QVector<float> &y() const;
+    void setCoordinates(const int index, const float x, const float y);
+
+    // the color of each spot
+    const QVector<QRgb> &colors() const;
+    void setColor(const int index, const QRgb color);
+
+    // the value (reads or genes) of each spot
+    const QVector<double> &values() const;
+    void setValue(const int index, const double value);
+
+    // true if the spot has expression (or its own color) and must be drawn
+    bool visible(const int index) const;
+    // true if the spot is selected
+    bool selected(const int index) const;
+    // true if the spot has its own color (the values are not used to color it)
+    bool spotColor(const int index) const;
+    void setFlags(const int index, const bool visible, const bool selected, const bool spot_color);
+
+    // sets all the spots to not visible
+    void clearVisible();
+
+private:
+    QVector<float> m_x;
+    QVector<float> m_y;
+    QVector<QRgb> m_colors;
+    QVector<double> m_values;
+    QBitArray m_visible;
+    QBitArray m_selected;
+    QBitArray m_spot_color;
+};
+
+#endif // RENDERINGBUFFER_H
@@ -1,14 +1,38 @@
 #include "STData.h"
 #include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QSet>
 #include <QMessageBox>
 #include <QtConcurrent>
+#include <QtEndian>
+#include "data/DataFrameWriter.h"
 #include "math/Common.h"
 #include "color/HeatMap.h"
 #include "math/RInterface.h"
+#include "profiling/Profiler.h"
+#include "profiling/MemoryAccounting.h"
+
+#include <cstring>
 
 static const int ROW = 1;
 static const int COLUMN = 0;
 
+// the names of the recomputable caches in the memory accounting
+static const QString SIZE_FACTORS_CACHE = QStringLiteral("Normalization size factors");
+static const QString GENE_SEARCH_CACHE = QStringLiteral("Gene search index");
+
+STData::RenderingResult::RenderingResult()
+    : cancelled(false)
+    , settings()
+    , buffer()
+    , selected_spots()
+    , size_factors_computed(false)
+    , deseq_size_factors()
+    , scran_size_factors()
+{
+}
+
 STData::STData()
     : m_data()
     , m_reads_threshold(-1)
@@ -21,19 +45,111 @@ STData::STData()
     , m_size_factors()
     , m_spots()
     , m_genes()
+    , m_gene_search()
+    , m_revision(0)
 {
 
 }
 
 STData::~STData()
 {
+    MemoryAccounting::instance().release(this);
+}
 
+// parses a data frame in the binary format (see DataFrameWriter)
+static STData::STDataFrame readBinary(QFile &file)
+{
+    const qint64 size = file.size();
+    const uchar *bytes = file.map(0, size);
+    if (bytes == nullptr) {
+        throw std::runtime_error("The file could not be read");
+    }
+    qint64 offset = sizeof(DataFrameWriter::MAGIC);
+    const auto readUInt32 = [&]() {
+        if (offset + 4 > size) {
+            throw std::runtime_error("The file does not contain a valid matrix");
+        }
+        const quint32 value = qFromLittleEndian<quint32>(bytes + offset);
+        offset += 4;
+        return value;
+    };
+    const auto readName = [&]() {
+        const quint32 length = readUInt32();
+        if (offset + length > size) {
+            throw std::runtime_error("The file does not contain a valid matrix");
+        }
+        const QString name = QString::fromUtf8(reinterpret_cast<const char *>(bytes + offset),
+                                               static_cast<int>(length));
+        offset += length;
+        return name;
+    };
+
+    STData::STDataFrame data;
+    if (readUInt32() != DataFrameWriter::VERSION) {
+        throw std::runtime_error("The version of the file is not supported");
+    }
+    const quint32 n_rows = readUInt32();
+    const quint32 n_cols = readUInt32();
+    // the genes already read (to find the duplicated ones)
+    QSet<QString> genes;
+    for (quint32 j = 0; j < n_cols; ++j) {
+        const QString gene = readName();
+        if (genes.contains(gene)) {
+            throw std::runtime_error("The matrix contains duplicated genes!");
+        }
+        genes.insert(gene);
+        data.genes.append(gene);
+    }
+    for (quint32 i = 0; i < n_rows; ++i) {
+        data.spots.append(readName());
+    }
+    data.counts.zeros(n_rows, n_cols);
+    for (quint32 i = 0; i < n_rows; ++i) {
+        // the columns and then the values of the non-zero counts
+        const quint32 n_values = readUInt32();
+        const qint64 columns = offset;
+        const qint64 values = offset + 4 * static_cast<qint64>(n_values);
+        offset = values + 4 * static_cast<qint64>(n_values);
+        if (n_values > n_cols || offset > size) {
+            throw std::runtime_error("The file does not contain a valid matrix");
+        }
+        for (quint32 k = 0; k < n_values; ++k) {
+            const quint32 column = qFromLittleEndian<quint32>(bytes + columns + 4 * k);
+            const quint32 bits = qFromLittleEndian<quint32>(bytes + values + 4 * k);
+            if (column >= n_cols) {
+                throw std::runtime_error("The file does not contain a valid matrix");
+            }
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            data.counts.at(i, column) = value;
+        }
+    }
+    file.unmap(const_cast<uchar *>(bytes));
+    return data;
 }
 
 STData::STDataFrame STData::read(const QString &filename)
 {
+    ST_PROFILE_SCOPE("STData::read");
+    // binary files start with the magic of the format
+    QFile file(filename);
+    if (file.open(QIODevice::ReadOnly)) {
+        const QByteArray magic = file.peek(sizeof(DataFrameWriter::MAGIC));
+        if (magic == QByteArray(DataFrameWriter::MAGIC, sizeof(DataFrameWriter::MAGIC))) {
+            qDebug() << "Opening binary ST Data file " << filename;
+            STDataFrame data = readBinary(file);
+            if (data.spots.empty() || data.genes.empty()) {
+                throw std::runtime_error("The file does not contain a valid matrix");
+            }
+            return data;
+        }
+        file.close();
+    }
+
     STDataFrame data;
     std::vector<std::vector<float>> values;
+    // the genes already read (to find the duplicated ones)
+    QSet<QString> genes;
 
     // Open file
     std::ifstream f(filename.toStdString());
@@ -52,10 +168,11 @@ STData::STDataFrame STData::read(const QString &filename)
         while(std::getline(iss, token, sep)) {
             if (row_number == 0) {
                 const QString gene = QString::fromStdString(token).trimmed();
-                if (data.genes.contains(gene)) {
+                if (genes.contains(gene)) {
                     throw std::runtime_error("The matrix contains duplicated genes!");
                 }
                 if (!gene.isEmpty() && !gene.isNull()) {
+                    genes.insert(gene);
                     data.genes.append(gene);
                 }
             } else if (col_number == 0) {
@@ -96,16 +213,18 @@ STData::STDataFrame STData::read(const QString &filename)
 }
 
 void STData::init(const QString &filename, const QString &spots_coordinates) {
+    ST_PROFILE_SCOPE("STData::init");
 
     // First parse the matrix with counts
+    STDataFrame data;
     try {
-        m_data = read(filename);
+        data = read(filename);
     } catch (const std::exception &e) {
         throw;
     }
 
     // parse the spot coordinates file (if any)
-    QMap<QString, QString> spots_dict;
+    QHash<SpotStore::SpotKey, SpotStore::SpotType> spots_dict;
     if (!spots_coordinates.isNull() && !spots_coordinates.isEmpty()) {
         try {
             spots_dict = parseSpotsMap(spots_coordinates);
@@ -121,31 +240,30 @@ void STData::init(const QString &filename, const QString &spots_coordinates) {
     // Create the spot object (if spot coordinates have been given only the spots
     // there will be added), compute the total sum of the spot to add it to the spot objects
     // and if the total sum == 0 the spot is discarded
-    colvec row_sum = sum(m_data.counts, ROW);
+    colvec row_sum = sum(data.counts, ROW);
     std::vector<uword> to_keep_spots;
     QList<QString> spots;
-    m_spot_index.clear();
-    for (uword i = 0; i < m_data.counts.n_rows; ++i) {
-        const auto &spot = m_data.spots.at(i);
-        auto adj_spot = spot;
-        if (!spots_dict.empty() && spots_dict.contains(spot)) {
-            adj_spot = spots_dict[spot];
-        } else if (!spots_dict.empty()) {
-            continue;
+    for (uword i = 0; i < data.counts.n_rows; ++i) {
+        const auto &spot = data.spots.at(i);
+        // the name of the spot is only parsed here, the spots map is joined by coordinates
+        const auto coordinates = SpotStore::getCoordinates(spot);
+        auto adj_coordinates = coordinates;
+        if (!spots_dict.empty()) {
+            const auto it = spots_dict.constFind(SpotStore::key(coordinates));
+            if (it == spots_dict.constEnd()) {
+                continue;
+            }
+            adj_coordinates = it.value();
         }
         const double row_sum_value = row_sum.at(i);
         if (row_sum_value > 0) {
             to_keep_spots.push_back(i);
-            auto spot_obj = SpotObjectType(new Spot(spot));
-            spot_obj->adj_coordinates(Spot::getCoordinates(adj_spot));
-            spot_obj->totalCount(row_sum_value);
-            m_spots.push_back(spot_obj);
+            m_spots.append(spot, coordinates, adj_coordinates, row_sum_value);
             spots.push_back(spot);
-            m_spot_index.insert(spot, m_spots.size() - 1);
         }
     }
-    m_data.spots = spots;
-    m_data.counts = m_data.counts.rows(uvec(to_keep_spots));
+    data.spots = spots;
+    data.counts = data.counts.rows(uvec(to_keep_spots));
 
     if (m_spots.empty()) {
         qDebug() << "No valid spots could be found in the file.";
@@ -154,76 +272,174 @@ void STData::init(const QString &filename, const QString &spots_coordinates) {
 
     // Create the gene object and compute the total sums to add them to the gene objects
     // if total sum is == 0 then the gene is discarded
-    rowvec col_sum = sum(m_data.counts, COLUMN);
+    rowvec col_sum = sum(data.counts, COLUMN);
     std::vector<uword> to_keep_genes;
     QList<QString> genes;
-    m_gene_index.clear();
-    for (uword j = 0; j < m_data.counts.n_cols; ++j) {
+    for (uword j = 0; j < data.counts.n_cols; ++j) {
         const double col_sum_value = col_sum.at(j);
         if (col_sum_value > 0) {
-            const auto &gene = m_data.genes.at(j);
-            auto gene_obj = GeneObjectType(new Gene(gene));
-            gene_obj->totalCount(col_sum_value);
+            const auto &gene = data.genes.at(j);
+            m_genes.append(gene, col_sum_value);
             genes.push_back(gene);
             to_keep_genes.push_back(j);
-            m_genes.push_back(gene_obj);
-            m_gene_index.insert(gene, m_genes.size() - 1);
         }
     }
-    m_data.genes = genes;
-    m_data.counts = m_data.counts.cols(uvec(to_keep_genes));
+    data.genes = genes;
+    data.counts = data.counts.cols(uvec(to_keep_genes));
 
     if (m_genes.empty()) {
         qDebug() << "No valid genes could be found in the file.";
         throw std::runtime_error("No valid genes could be found in the file.");
     }
+    // the data frame does not change anymore so it can be shared (see sharedData())
+    // and the counts are stored with the smallest exact element type
+    m_data = QSharedPointer<const CountDataFrame>(
+                new CountDataFrame{CountMatrix(data.counts), data.genes, data.spots});
+    m_gene_search.build(m_genes.names());
+
+    // the coordinates of the spots do not change so they are stored only once
+    m_rendering.resize(m_spots.size());
+    for (int i = 0; i < m_spots.size(); ++i) {
+        const auto coordinates = m_spots.adj_coordinates(i);
+        m_rendering.setCoordinates(i, coordinates.first, coordinates.second);
+    }
+}
 
-    m_rendering_colors.resize(m_spots.size());
-    m_rendering_selected.resize(m_spots.size());
-    m_rendering_visible.resize(m_spots.size());
-    m_rendering_values.resize(m_spots.size());
+bool STData::save(const QString &filename,
+                  const STData::STDataFrame &data,
+                  const std::function<bool(int)> &progress)
+{
+    DataFrameWriter writer(filename, DataFrameWriter::format(filename));
+    writer.setProgress(progress);
+    return writer.write(data);
 }
 
-void STData::save(const QString &filename, const STData::STDataFrame &data)
+STData::STDataFrame STData::data() const
 {
-    QFile file(filename);
-    if (file.open(QIODevice::WriteOnly)) {
-        QTextStream stream(&file);
-        // write genes (1st row)
-        for (const auto gene : data.genes) {
-            stream << "\t" << gene;
-        }
-        stream << endl;
-        // write spots (1st column and the rest of the rows (counts))
-        for (uword i = 0; i < data.counts.n_rows; ++i) {
-            const auto spot = data.spots.at(i);
-            stream <<  spot;
-            for (uword j = 0; j < data.counts.n_cols; ++j) {
-                stream << "\t" << data.counts(i,j);
-            }
-            stream << endl;
-        }
+    if (m_data.isNull()) {
+        return STDataFrame();
     }
+    return STDataFrame{m_data->counts.toMat(), m_data->genes, m_data->spots};
 }
 
-STData::STDataFrame STData::data() const
+QSharedPointer<const STData::CountDataFrame> STData::sharedData() const
 {
     return m_data;
 }
 
-const STData::GeneListType &STData::genes() const
+const GeneStore &STData::genes() const
 {
     return m_genes;
 }
 
-const STData::SpotListType &STData::spots() const
+GeneStore &STData::genes()
+{
+    return m_genes;
+}
+
+const SpotStore &STData::spots() const
 {
     return m_spots;
 }
 
+SpotStore &STData::spots()
+{
+    return m_spots;
+}
+
+const GeneSearchIndex &STData::geneSearchIndex() const
+{
+    if (m_gene_search.size() == 0 && !m_genes.empty()) {
+        m_gene_search.build(m_genes.names());
+        MemoryAccounting::instance().updateCache(this, GENE_SEARCH_CACHE);
+    } else {
+        MemoryAccounting::instance().touchCache(this, GENE_SEARCH_CACHE);
+    }
+    return m_gene_search;
+}
+
+qint64 STData::memoryUsage() const
+{
+    if (m_data.isNull()) {
+        return 0;
+    }
+    // the names of the stores are shared with the data frame
+    const qint64 rendering_bytes = static_cast<qint64>(m_rendering.size())
+            * (2 * sizeof(float) + sizeof(QRgb) + sizeof(double));
+    return static_cast<qint64>(m_data->counts.memoryUsage())
+            + MemoryAccounting::stringsMemoryUsage(m_data->genes)
+            + MemoryAccounting::stringsMemoryUsage(m_data->spots)
+            + rendering_bytes
+            + static_cast<qint64>(m_spike_in.n_elem + m_size_factors.n_elem) * sizeof(double);
+}
+
+void STData::accountMemory(const QString &name)
+{
+    MemoryAccounting &accounting = MemoryAccounting::instance();
+    accounting.release(this);
+    accounting.account(this, MemoryAccounting::Datasets, name,
+                       MemoryAccounting::Usage(memoryUsage()));
+    // the size factors are computed again when the thresholds change
+    const auto size_factors_size = [this]() {
+        return static_cast<qint64>(m_deseq_size_factors.n_elem + m_scran_size_factors.n_elem)
+                * static_cast<qint64>(sizeof(double));
+    };
+    const auto evict_size_factors = [this]() {
+        m_deseq_size_factors.reset();
+        m_scran_size_factors.reset();
+        m_reads_threshold = -1;
+        m_genes_threshold = -1;
+        m_ind_reads_treshold = -1;
+        m_spots_threshold = -1;
+    };
+    accounting.registerCache(this, name, SIZE_FACTORS_CACHE,
+                             size_factors_size, evict_size_factors);
+    // the search index is built again when it is used
+    accounting.registerCache(this, name, GENE_SEARCH_CACHE,
+                             [this]() { return m_gene_search.memoryUsage(); },
+                             [this]() { m_gene_search.clear(); });
+}
+
+quint64 STData::revision() const
+{
+    return m_revision + m_spots.revision() + m_genes.revision();
+}
+
 void STData::computeRenderingData(SettingsWidget::Rendering &rendering_settings)
 {
-    Q_ASSERT(m_data.counts.size() > 0);
+    applyRenderingData(computeRenderingData(renderingInput(rendering_settings)),
+                       rendering_settings);
+}
+
+STData::RenderingInput STData::renderingInput(const SettingsWidget::Rendering &rendering_settings) const
+{
+    RenderingInput input;
+    input.settings = rendering_settings;
+    input.genes = m_genes;
+    input.spots = m_spots;
+    input.spike_in = m_spike_in;
+    input.size_factors = m_size_factors;
+    input.deseq_size_factors = m_deseq_size_factors;
+    input.scran_size_factors = m_scran_size_factors;
+    input.reads_threshold = m_reads_threshold;
+    input.genes_threshold = m_genes_threshold;
+    input.ind_reads_treshold = m_ind_reads_treshold;
+    input.spots_threshold = m_spots_threshold;
+    input.buffer = m_rendering;
+    MemoryAccounting::instance().touchCache(this, SIZE_FACTORS_CACHE);
+    return input;
+}
+
+STData::RenderingResult STData::computeRenderingData(const RenderingInput &input,
+                                                     const std::function<bool()> &cancelled) const
+{
+    Q_ASSERT(!m_data.isNull() && m_data->counts.n_rows() > 0);
+    ST_PROFILE_SCOPE("STData::computeRenderingData");
+
+    const SettingsWidget::Rendering &rendering_settings = input.settings;
+    const GeneStore &genes_store = input.genes;
+    const SpotStore &spots_store = input.spots;
+    const auto is_cancelled = [&cancelled]() { return cancelled && cancelled(); };
 
     const bool use_genes =
             rendering_settings.visual_type_mode == SettingsWidget::VisualTypeMode::Genes ||
@@ -238,39 +454,47 @@ void STData::computeRenderingData(SettingsWidget::Rendering &rendering_settings)
     const bool recompute_size_factors =
             (rendering_settings.normalization_mode == SettingsWidget::NormalizationMode::DESEQ
              || rendering_settings.normalization_mode == SettingsWidget::NormalizationMode::SCRAN)
-            && (m_reads_threshold != rendering_settings.ind_reads_threshold
-            || m_genes_threshold != rendering_settings.genes_threshold
-            || m_ind_reads_treshold != rendering_settings.ind_reads_threshold
-            || m_spots_threshold != rendering_settings.spots_threshold);
+            && (input.reads_threshold != rendering_settings.ind_reads_threshold
+            || input.genes_threshold != rendering_settings.genes_threshold
+            || input.ind_reads_treshold != rendering_settings.ind_reads_threshold
+            || input.spots_threshold != rendering_settings.spots_threshold);
+
+    // The result is computed in a copy of the rendering data (back buffer)
+    RenderingResult result;
+    result.settings = rendering_settings;
+    result.buffer = input.buffer;
+    result.selected_spots = spots_store.selectedBits();
+    result.deseq_size_factors = input.deseq_size_factors;
+    result.scran_size_factors = input.scran_size_factors;
 
     // Set visible to false for all the spots
-    QtConcurrent::blockingMap(m_rendering_visible, [] (auto &visible) { visible = false; });
+    result.buffer.clearVisible();
 
-    // Create copy of the data frame so to reduce and normalize it
-    STDataFrame data = m_data;
+    // Copy the counts of the visible genes (promoted to double) to reduce and normalize them
+    std::vector<uword> to_keep_genes;
+    STDataFrame data;
+    data.spots = m_data->spots;
+    for (int i = 0; i < m_data->genes.size(); ++i) {
+        const QString &gene = m_data->genes.at(i);
+        if (genes_store.visible(genes_store.indexOf(gene))) {
+            data.genes.push_back(gene);
+            to_keep_genes.push_back(i);
+        }
+    }
+    data.counts = m_data->counts.columns(uvec(to_keep_genes));
 
     // Apply spike-ins and size factors if indicated by the user
-    if (rendering_settings.spike_in && m_spike_in.size() == data.counts.n_rows) {
-        data.counts.each_col() /= m_spike_in.t();
+    if (rendering_settings.spike_in && input.spike_in.size() == data.counts.n_rows) {
+        data.counts.each_col() /= input.spike_in.t();
     }
-    if (rendering_settings.size_factors && m_size_factors.size() == data.counts.n_rows) {
-        data.counts.each_col() /= m_size_factors.t();
+    if (rendering_settings.size_factors && input.size_factors.size() == data.counts.n_rows) {
+        data.counts.each_col() /= input.size_factors.t();
     }
 
-    // Remove genes that are not visible
-    std::vector<uword> to_keep_genes;
-    QList<QString> genes;
-    for (uword i = 0; i < data.counts.n_cols; ++i) {
-        const QString &gene = data.genes.at(i);
-        const uword gene_index = m_gene_index.value(gene);
-        const auto gene_obj = m_genes.at(gene_index);
-        if (gene_obj->visible()) {
-            genes.push_back(gene);
-            to_keep_genes.push_back(i);
-        }
+    if (is_cancelled()) {
+        result.cancelled = true;
+        return result;
     }
-    data.genes = genes;
-    data.counts = data.counts.cols(uvec(to_keep_genes));
 
     // Slice the data frame with the thresholds
     data = filterDataFrame(data,
@@ -281,32 +505,45 @@ void STData::computeRenderingData(SettingsWidget::Rendering &rendering_settings)
 
     // Early out
     if (data.spots.empty() && data.genes.empty()) {
-        return;
+        return result;
+    }
+
+    if (is_cancelled()) {
+        result.cancelled = true;
+        return result;
     }
 
     // Check if we need to compute normalization factors and normalize the data
     if (do_values) {
         if (recompute_size_factors) {
-            m_reads_threshold = rendering_settings.ind_reads_threshold;
-            m_genes_threshold = rendering_settings.genes_threshold;
-            m_ind_reads_treshold = rendering_settings.ind_reads_threshold;
-            m_spots_threshold = rendering_settings.spots_threshold;
-            m_deseq_size_factors = RInterface::computeDESeqFactors(data.counts);
-            m_scran_size_factors = RInterface::computeScranFactors(data.counts, false);
+            result.size_factors_computed = true;
+            result.deseq_size_factors = RInterface::computeDESeqFactors(data.counts);
+            result.scran_size_factors = RInterface::computeScranFactors(data.counts, false);
         }
         // Normalize the data
-        data = normalizeCounts(data, m_deseq_size_factors, m_scran_size_factors,
+        data = normalizeCounts(data, result.deseq_size_factors, result.scran_size_factors,
                                rendering_settings.normalization_mode);
     }
 
+    // Look up the genes of the matrix only once
+    std::vector<int> genes_indexes(data.counts.n_cols);
+    for (uword j = 0; j < data.counts.n_cols; ++j) {
+        genes_indexes[j] = genes_store.indexOf(data.genes.at(j));
+        Q_ASSERT(genes_indexes[j] != -1);
+    }
+
     // Iterate the spots and genes in the matrix to compute the rendering colors
     double min_value = 10e6;
     double max_value = -10e6;
     //TODO make this paralell
     for (uword i = 0; i < data.counts.n_rows; ++ i) {
-        const int spot_index = m_spot_index.value(data.spots.at(i), -1);
+        // a newer request makes this computation stale
+        if (i % 256 == 0 && is_cancelled()) {
+            result.cancelled = true;
+            return result;
+        }
+        const int spot_index = spots_store.indexOf(data.spots.at(i));
         Q_ASSERT(spot_index != -1);
-        const auto spot_obj = m_spots.at(spot_index);
         bool visible = false;
         double merged_value = 0.0;
         double num_genes = 0.0;
@@ -314,24 +551,22 @@ void STData::computeRenderingData(SettingsWidget::Rendering &rendering_settings)
         QColor merged_color;
         // Iterate the genes in the spot to compute the sum of values and color
         for (uword j = 0; j < data.counts.n_cols; ++j) {
-            const int gene_index = m_gene_index.value(data.genes.at(j), -1);
-            Q_ASSERT(gene_index != -1);
-            const auto gene_obj = m_genes.at(gene_index);
+            const int gene_index = genes_indexes[j];
             const double value = data.counts.at(i,j);
             if (value <= 0
-                    || (rendering_settings.gene_cutoff && gene_obj->cut_off() >= value)) {
+                    || (rendering_settings.gene_cutoff && genes_store.cut_off(gene_index) >= value)) {
                 continue;
             }
             ++num_genes;
             merged_value += value;
             if (do_color) {
-                merged_color = STMath::lerp(1.0 / num_genes, merged_color, gene_obj->color());
+                merged_color = STMath::lerp(1.0 / num_genes, merged_color, genes_store.color(gene_index));
             }
-            any_gene_selected |= gene_obj->selected();
+            any_gene_selected |= genes_store.selected(gene_index);
         }
         // Update the color of the spot
-        if (spot_obj->visible()) {
-            merged_color = spot_obj->color();
+        if (spots_store.visible(spot_index)) {
+            merged_color = spots_store.color(spot_index);
             visible = true;
         } else if (merged_value > 0.0) {
             // Use number of genes or total reads in the spot depending on settings
@@ -343,57 +578,90 @@ void STData::computeRenderingData(SettingsWidget::Rendering &rendering_settings)
             }
             visible = true;
         }
-        spot_obj->selected(visible && (spot_obj->selected() || any_gene_selected));
-        m_rendering_colors[spot_index] = merged_color;
-        m_rendering_selected[spot_index] = spot_obj->selected();
-        m_rendering_values[spot_index] = merged_value;
-        m_rendering_visible[spot_index] = visible;
+        const bool selected = visible && (spots_store.selected(spot_index) || any_gene_selected);
+        result.selected_spots.setBit(spot_index, selected);
+        result.buffer.setColor(spot_index, merged_color.rgba());
+        result.buffer.setValue(spot_index, merged_value);
+        result.buffer.setFlags(spot_index, visible, selected, spots_store.visible(spot_index));
     }
-    rendering_settings.legend_min = min_value;
-    rendering_settings.legend_max = max_value;
+    result.settings.legend_min = min_value;
+    result.settings.legend_max = max_value;
+    return result;
 }
 
-const QVector<bool> &STData::renderingVisible() const
+void STData::applyRenderingData(const RenderingResult &result,
+                                SettingsWidget::Rendering &rendering_settings)
 {
-    return m_rendering_visible;
-}
-
-const QVector<QColor> &STData::renderingColors() const
-{
-    return m_rendering_colors;
-}
-
-const QVector<bool> &STData::renderingSelected() const
-{
-    return m_rendering_selected;
+    Q_ASSERT(!result.cancelled);
+    Q_ASSERT(result.buffer.size() == m_rendering.size());
+
+    // swap the rendering data (the old arrays are released if nobody else uses them)
+    m_rendering = result.buffer;
+    m_spots.setSelected(result.selected_spots);
+    if (result.size_factors_computed) {
+        m_reads_threshold = result.settings.ind_reads_threshold;
+        m_genes_threshold = result.settings.genes_threshold;
+        m_ind_reads_treshold = result.settings.ind_reads_threshold;
+        m_spots_threshold = result.settings.spots_threshold;
+        m_deseq_size_factors = result.deseq_size_factors;
+        m_scran_size_factors = result.scran_size_factors;
+        MemoryAccounting::instance().updateCache(this, SIZE_FACTORS_CACHE);
+    }
+    rendering_settings.legend_min = result.settings.legend_min;
+    rendering_settings.legend_max = result.settings.legend_max;
 }
 
-const QVector<double> &STData::renderingValues() const
+const RenderingBuffer &STData::renderingBuffer() const
 {
-    return m_rendering_values;
+    return m_rendering;
 }
 
-QMap<QString, QString> STData::parseSpotsMap(const QString &spots_file)
+QHash<SpotStore::SpotKey, SpotStore::SpotType> STData::parseSpotsMap(const QString &spots_file)
 {
     qDebug() << "Parsing spots file " << spots_file;
-    QMap<QString, QString> spotMap;
+    QHash<SpotStore::SpotKey, SpotStore::SpotType> spotMap;
     QFile file(spots_file);
-    // Parse the spots map = old_spot -> new_spot
+    // Parse the spots map = old_spot -> new_spot (x, y, new_x, new_y[, pixel_x, pixel_y])
+    // the lines are tokenized in place and the spots are keyed by their coordinates
     if (file.open(QIODevice::ReadOnly)) {
-        QTextStream in(&file);
-        QString line;
-        QStringList fields;
+        const QByteArray content = file.readAll();
+        const char *it = content.constData();
+        const char *content_end = it + content.size();
         bool parsed = true;
-        while (!in.atEnd()) {
-            line = in.readLine();
-            if (!line.contains("x")) {
-                fields = line.split("\t");
-                if (fields.length() != 4 && fields.length() != 6) {
-                    parsed = false;
-                    break;
+        while (parsed && it < content_end) {
+            const char *line_end = static_cast<const char *>(
+                        std::memchr(it, '\n', content_end - it));
+            if (line_end == nullptr) {
+                line_end = content_end;
+            }
+            const char *line = it;
+            it = line_end + 1;
+            // the header contains the x of the column names
+            if (line_end - line <= 1 || std::memchr(line, 'x', line_end - line) != nullptr) {
+                continue;
+            }
+            float fields[4];
+            int n_fields = 0;
+            for (const char *field = line; field <= line_end; ++n_fields) {
+                const char *field_end = static_cast<const char *>(
+                            std::memchr(field, '\t', line_end - field));
+                if (field_end == nullptr) {
+                    field_end = line_end;
+                }
+                if (n_fields < 4) {
+                    const char *pos = field;
+                    if (!SpotStore::parseNumber(pos, field_end, fields[n_fields])) {
+                        parsed = false;
+                    }
                 }
-                spotMap.insert(fields.at(0) + "x" + fields.at(1),
-                               fields.at(2) + "x" + fields.at(3));
+                field = field_end + 1;
+            }
+            if (n_fields != 4 && n_fields != 6) {
+                parsed = false;
+            }
+            if (parsed) {
+                spotMap.insert(SpotStore::key(SpotStore::SpotType(fields[0], fields[1])),
+                               SpotStore::SpotType(fields[2], fields[3]));
             }
         }
 
@@ -454,6 +722,7 @@ bool STData::parseSpikeIn(const QString &spikeInFile)
         parsed = false;
     } else {
         m_spike_in = rowvec(spike_ins);
+        ++m_revision;
     }
 
     return parsed;
@@ -500,6 +769,7 @@ bool STData::parseSizeFactors(const QString &sizefactors)
         parsed = false;
     } else {
         m_size_factors = rowvec(size_factors);
+        ++m_revision;
     }
 
     return parsed;
@@ -510,6 +780,7 @@ STData::STDataFrame STData::normalizeCounts(const STDataFrame &data,
                                             const rowvec scran_size_factors,
                                             SettingsWidget::NormalizationMode mode)
 {
+    ST_PROFILE_SCOPE("STData::normalizeCounts");
     STDataFrame norm_counts = data;
     switch (mode) {
     case (SettingsWidget::NormalizationMode::RAW): {
@@ -541,39 +812,67 @@ STData::STDataFrame STData::normalizeCounts(const STDataFrame &data,
     return norm_counts;
 }
 
-STData::STDataFrame STData::sliceDataFrameSpots(const STDataFrame &data,
-                                                const QList<QString> &spots)
+// the rows of the spots in the data frame (the spots that are not present are left out)
+static uvec spotsRows(const QList<QString> &data_spots, const QList<QString> &spots)
 {
-    STDataFrame sliced_data = data;
-
-    // Keep only the spots given in the list
-    sliced_data.spots.clear();
-    uvec to_keep_rows(spots.size());
-    for (uword i = 0; i < spots.size(); ++i) {
-        const auto &spot = spots.at(i);
-        const int spot_index = data.spots.indexOf(spot);
-        if (spot_index != -1) {
-            to_keep_rows.at(i) = spot_index;
-            sliced_data.spots.push_back(spot);
+    QHash<QString, uword> spot_index;
+    spot_index.reserve(data_spots.size());
+    for (int i = 0; i < data_spots.size(); ++i) {
+        spot_index.insert(data_spots.at(i), i);
+    }
+    std::vector<uword> to_keep_rows;
+    to_keep_rows.reserve(spots.size());
+    for (const auto &spot : spots) {
+        const auto it = spot_index.constFind(spot);
+        if (it != spot_index.constEnd()) {
+            to_keep_rows.push_back(it.value());
         }
     }
-    sliced_data.counts = sliced_data.counts.rows(to_keep_rows);
+    return uvec(to_keep_rows);
+}
 
-    // Remove non present genes (total count == 0 after removing spots)
-    rowvec gene_counts = sum(sliced_data.counts, COLUMN);
-    std::vector<uword> to_keep_cols;
-    QList<QString> new_genes;
-    for (uword j = 0; j < sliced_data.counts.n_cols; ++j) {
-        if (gene_counts.at(j) > 0) {
-            const auto &gene = sliced_data.genes.at(j);
-            to_keep_cols.push_back(j);
-            new_genes.push_back(gene);
-        }
+// the names at the given indexes
+static QList<QString> namesAt(const QList<QString> &names, const uvec &indexes)
+{
+    QList<QString> sliced_names;
+    sliced_names.reserve(static_cast<int>(indexes.n_elem));
+    for (const uword index : indexes) {
+        sliced_names.push_back(names.at(index));
     }
-    sliced_data.genes = new_genes;
-    sliced_data.counts = sliced_data.counts.cols(uvec(to_keep_cols));
+    return sliced_names;
+}
 
-    // Return the sliced data frame
+void STData::sliceIndexesSpots(const CountDataFrame &data,
+                               const QList<QString> &spots,
+                               uvec &rows,
+                               uvec &cols)
+{
+    // Keep only the spots given in the list
+    rows = spotsRows(data.spots, spots);
+    // Remove non present genes (total count == 0 in the spots kept)
+    cols = data.counts.columnsWithCounts(rows);
+}
+
+STData::STDataFrame STData::sliceDataFrameSpots(const STDataFrame &data,
+                                                const QList<QString> &spots)
+{
+    const uvec rows = spotsRows(data.spots, spots);
+    const uvec cols = CountMatrix::columnsWithCounts(data.counts, rows);
+    STDataFrame sliced_data;
+    sliced_data.counts = data.counts.submat(rows, cols);
+    sliced_data.spots = namesAt(data.spots, rows);
+    sliced_data.genes = namesAt(data.genes, cols);
+    return sliced_data;
+}
+
+STData::STDataFrame STData::sliceDataFrame(const CountDataFrame &data,
+                                           const uvec &rows,
+                                           const uvec &cols)
+{
+    STDataFrame sliced_data;
+    sliced_data.counts = data.counts.submat(rows, cols);
+    sliced_data.spots = namesAt(data.spots, rows);
+    sliced_data.genes = namesAt(data.genes, cols);
     return sliced_data;
 }
 
@@ -619,6 +918,7 @@ STData::STDataFrame STData::filterDataFrame(const STDataFrame &data,
                                             const int min_genes_spot,
                                             const int min_spots_gene)
 {
+    ST_PROFILE_SCOPE("STData::filterDataFrame");
     STDataFrame sliced_data = data;
 
     // Filter out genes
@@ -639,9 +939,9 @@ STData::STDataFrame STData::filterDataFrame(const STDataFrame &data,
     const ucolvec gene_counts = computeNonZeroRows(sliced_data.counts, min_exp_value);
     std::vector<uword> to_keep_spots;
     QList<QString> new_spots;
+    const colvec reads_counts = CountMatrix::sumRows(sliced_data.counts, min_exp_value);
     for (uword i = 0; i < sliced_data.counts.n_rows; ++i) {
-        const rowvec row = sliced_data.counts.row(i);
-        const double row_sum = sum(row.elem(find(row > min_exp_value)));
+        const double row_sum = reads_counts.at(i);
         if (row_sum > min_reads_spot && gene_counts.at(i) > min_genes_spot) {
             const auto &spot = sliced_data.spots.at(i);
             to_keep_spots.push_back(i);
@@ -712,18 +1012,18 @@ STData::STDataFrame STData::aggregate(const QList<STDataFrame> &datasets)
 
 urowvec STData::computeNonZeroColumns(const mat &matrix, const int min_value)
 {
-    return sum(matrix > min_value, COLUMN);
+    return CountMatrix::nonZeroColumns(matrix, min_value);
 }
 
 ucolvec STData::computeNonZeroRows(const mat &matrix, const int min_value)
 {
-    return sum(matrix > min_value, ROW);
+    return CountMatrix::nonZeroRows(matrix, min_value);
 }
 
 void STData::clearSelection()
 {
-    QtConcurrent::blockingMap(m_spots, [] (auto spot) { spot->selected(false); });
-    QtConcurrent::blockingMap(m_genes, [] (auto gene) { gene->selected(false); });
+    m_spots.clearSelection();
+    m_genes.clearSelection();
 }
 
 void STData::selectSpots(const SelectionEvent &event)
@@ -737,10 +1037,10 @@ void STData::selectSpots(const SelectionEvent &event)
 
     // update selection
     const bool remove = (mode == SelectionEvent::SelectionMode::ExcludeSelection);
-    for (auto spot : m_spots) {
-        const auto &coord = spot->coordinates();
+    for (int i = 0; i < m_spots.size(); ++i) {
+        const auto coord = m_spots.coordinates(i);
         if (path.contains(QPointF(coord.first, coord.second))) {
-            spot->selected(!remove);
+            m_spots.setSelected(i, !remove);
         }
     }
 }
@@ -749,9 +1049,9 @@ void STData::selectSpots(const QList<QString> &spots)
 {
     clearSelection();
     for (const auto &spot : spots) {
-        const int spot_index = m_spot_index.value(spot, -1);
+        const int spot_index = m_spots.indexOf(spot);
         if (spot_index != -1) {
-            m_spots.at(spot_index)->selected(true);
+            m_spots.setSelected(spot_index, true);
         }
     }
 }
@@ -761,7 +1061,7 @@ void STData::selectSpots(const QList<int> &spots_indexes)
     clearSelection();
     for (const auto index : spots_indexes) {
         if (index > 0 and index < m_spots.size()) {
-            m_spots.at(index)->selected(true);
+            m_spots.setSelected(index, true);
         }
     }
 }
@@ -769,10 +1069,9 @@ void STData::selectSpots(const QList<int> &spots_indexes)
 void STData::selectGenes(const QRegExp &regexp, const bool force)
 {
     clearSelection();
-    for (auto gene : m_genes) {
-        const bool selected = regexp.exactMatch(gene->name());
-        gene->selected(selected);
-        gene->visible(gene->visible() || (force && selected));
+    for (const int gene_index : geneSearchIndex().findMatches(regexp)) {
+        m_genes.setSelected(gene_index, true);
+        m_genes.setVisible(gene_index, m_genes.visible(gene_index) || force);
     }
 }
 
@@ -780,10 +1079,10 @@ void STData::selectGenes(const QList<QString> &genes)
 {
     clearSelection();
     for (const auto &gene : genes) {
-        const int gene_index = m_gene_index.value(gene, -1);
+        const int gene_index = m_genes.indexOf(gene);
         if (gene_index != -1) {
-            m_genes.at(gene_index)->selected(true);
-            m_genes.at(gene_index)->visible(true);
+            m_genes.setSelected(gene_index, true);
+            m_genes.setVisible(gene_index, true);
         }
     }
 }
@@ -794,10 +1093,10 @@ void STData::loadSpotColors(const QHash<QString, QColor> &colors)
     while (it != colors.constEnd()) {
         const auto &spot = it.key();
         const QColor color = it.value();
-        const int spot_index = m_spot_index.value(spot, -1);
+        const int spot_index = m_spots.indexOf(spot);
         if (spot_index != -1) {
-            m_spots.at(spot_index)->color(color);
-            m_spots.at(spot_index)->visible(true);
+            m_spots.setColor(spot_index, color);
+            m_spots.setVisible(spot_index, true);
         }
         ++it;
     }
@@ -809,10 +1108,10 @@ void STData::loadGeneColors(const QHash<QString, QColor> &colors)
     while (it != colors.constEnd()) {
         const auto &gene = it.key();
         const QColor color = it.value();
-        const int gene_index = m_gene_index.value(gene);
+        const int gene_index = m_genes.indexOf(gene);
         if (gene_index != -1) {
-            m_genes.at(gene_index)->color(color);
-            m_genes.at(gene_index)->visible(true);
+            m_genes.setColor(gene_index, color);
+            m_genes.setVisible(gene_index, true);
         }
         ++it;
     }
@@ -820,17 +1119,15 @@ void STData::loadGeneColors(const QHash<QString, QColor> &colors)
 
 const QRectF STData::getBorder() const
 {
-    const auto mm_x = std::minmax_element(m_spots.begin(), m_spots.end(),
-                                          [] (const auto lhs, const auto rhs) {
-        return lhs->coordinates().first < rhs->coordinates().first;});
-
-    const auto mm_y = std::minmax_element(m_spots.begin(), m_spots.end(),
-                                          [] (const auto lhs, const auto rhs) {
-        return lhs->coordinates().second < rhs->coordinates().second;});
-
-    const auto min_x = (*mm_x.first)->coordinates().first;
-    const auto min_y = (*mm_y.first)->coordinates().second;
-    const auto max_x = (*mm_x.second)->coordinates().first;
-    const auto max_y = (*mm_y.second)->coordinates().second;
-    return QRectF(QPointF(min_x, min_y), QPointF(max_x, max_y));
+    Q_ASSERT(!m_spots.empty());
+    auto min = m_spots.coordinates(0);
+    auto max = min;
+    for (int i = 1; i < m_spots.size(); ++i) {
+        const auto coord = m_spots.coordinates(i);
+        min.first = std::min(min.first, coord.first);
+        min.second = std::min(min.second, coord.second);
+        max.first = std::max(max.first, coord.first);
+        max.second = std::max(max.second, coord.second);
+    }
+    return QRectF(QPointF(min.first, min.second), QPointF(max.first, max.second));
 }
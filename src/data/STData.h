@@ -8,13 +8,18 @@
 #include <QVector4D>
 #include <QColor>
 
-#include "data/Gene.h"
-#include "data/Spot.h"
+#include "data/GeneStore.h"
+#include "data/SpotStore.h"
+#include "data/GeneSearchIndex.h"
+#include "data/RenderingBuffer.h"
+#include "data/CountMatrix.h"
 #include "viewPages/SettingsWidget.h"
 #include "viewRenderer/SelectionEvent.h"
 
 #include <armadillo>
 
+#include <functional>
+
 using namespace arma;
 
 class STData
@@ -22,17 +27,56 @@ class STData
 
 public:
 
-    typedef QSharedPointer<Spot> SpotObjectType;
-    typedef QSharedPointer<Gene> GeneObjectType;
-    typedef QList<SpotObjectType> SpotListType;
-    typedef QList<GeneObjectType> GeneListType;
-
     struct STDataFrame {
         mat counts;
         QList<QString> genes;
         QList<QString> spots;
     };
 
+    // The data frame of a dataset with the counts in their compact storage
+    // (the counts are promoted to double when the data frame is sliced)
+    struct CountDataFrame {
+        CountMatrix counts;
+        QList<QString> genes;
+        QList<QString> spots;
+    };
+
+    // A snapshot of everything the computation of the rendering data needs
+    // (the stores and the buffer share their arrays with the data, so it is cheap to take)
+    // so the rendering data can be computed in another thread while the data changes
+    struct RenderingInput {
+        SettingsWidget::Rendering settings;
+        GeneStore genes;
+        SpotStore spots;
+        rowvec spike_in;
+        rowvec size_factors;
+        // the cached normalization size factors and the thresholds used to compute them
+        rowvec deseq_size_factors;
+        rowvec scran_size_factors;
+        int reads_threshold;
+        int genes_threshold;
+        int ind_reads_treshold;
+        int spots_threshold;
+        // the current rendering data (the coordinates are shared)
+        RenderingBuffer buffer;
+    };
+
+    // The rendering data computed from a snapshot (the back buffer)
+    struct RenderingResult {
+        RenderingResult();
+        // true if the computation was cancelled (the result must be discarded)
+        bool cancelled;
+        // the settings with the legend range of the values
+        SettingsWidget::Rendering settings;
+        RenderingBuffer buffer;
+        // the selected spots (visible spots that are selected or express a selected gene)
+        QBitArray selected_spots;
+        // true if the normalization size factors were computed again
+        bool size_factors_computed;
+        rowvec deseq_size_factors;
+        rowvec scran_size_factors;
+    };
+
     STData();
     ~STData();
 
@@ -40,27 +84,63 @@ public:
     void init(const QString &filename, const QString &spots_coordinates = QString());
 
     // Functions to import/export the data
+    // the files are TSV (spots as rows) or binary (.stdf, see DataFrameWriter)
     static STDataFrame read(const QString &filename);
-    static void save(const QString &filename, const STDataFrame &data);
+    // the progress function is called with the number of spots written so far and
+    // the export stops if it returns false (the function returns false if it stopped)
+    static bool save(const QString &filename,
+                     const STDataFrame &data,
+                     const std::function<bool(int)> &progress = {});
 
     // Retrieves the original data frame (without filtering using the tresholds)
     STDataFrame data() const;
-
-    // Returns the spot/gene objects corresponding to the data frame
-    const GeneListType &genes() const;
-    const SpotListType &spots() const;
-
-    // Rendering functions
+    // The same data frame shared instead of copied (it does not change after init())
+    QSharedPointer<const CountDataFrame> sharedData() const;
+
+    // Returns the spot/gene attributes corresponding to the data frame
+    // (the index of a spot/gene in its store is its row/column in the data frame)
+    const GeneStore &genes() const;
+    GeneStore &genes();
+    const SpotStore &spots() const;
+    SpotStore &spots();
+
+    // Returns the search index of the gene names (built when the data is parsed and
+    // built again if it has been evicted)
+    const GeneSearchIndex &geneSearchIndex() const;
+
+    // an estimate of the memory held by the data (bytes), the counts, the names,
+    // the rendering data and the user loaded factors (the caches are not included)
+    qint64 memoryUsage() const;
+    // accounts the memory of the data and registers its recomputable caches (the size
+    // factors and the search index) in the memory accounting under the name of the dataset
+    // (see MemoryAccounting), they are released when the data is destroyed
+    void accountMemory(const QString &name);
+
+    // the number of changes made to the data (spots/genes attributes, spike-ins and size factors)
+    // the rendering data only needs to be computed again when it changes
+    quint64 revision() const;
+
+    // Rendering functions (the rendering data of the spots is stored in packed arrays)
+    // computes the rendering data in place (in the calling thread)
     void computeRenderingData(SettingsWidget::Rendering &rendering_settings);
-    const QVector<bool> &renderingVisible() const;
-    const QVector<QColor> &renderingColors() const;
-    const QVector<bool> &renderingSelected() const;
-    const QVector<double> &renderingValues() const;
+    const RenderingBuffer &renderingBuffer() const;
+
+    // The rendering data can be computed in a worker thread in three steps:
+    // renderingInput() takes a snapshot of the data (in the thread that owns the data),
+    // computeRenderingData() computes the rendering data of the snapshot without changing
+    // the data (it can run in any thread and it stops early when cancelled returns true)
+    // and applyRenderingData() swaps the computed rendering data in (in the owner's thread)
+    RenderingInput renderingInput(const SettingsWidget::Rendering &rendering_settings) const;
+    RenderingResult computeRenderingData(const RenderingInput &input,
+                                         const std::function<bool()> &cancelled
+                                         = std::function<bool()>()) const;
+    void applyRenderingData(const RenderingResult &result,
+                            SettingsWidget::Rendering &rendering_settings);
 
     // to parse a file with spots coordinates old_spot -> new_spot
-    // It returns a map of old_spots -> new_spots
+    // It returns the new coordinates of the spots keyed by their old coordinates
     // It throws exceptions when errors during parsing or empty file
-    QMap<QString, QString> parseSpotsMap(const QString &spots_file);
+    QHash<SpotStore::SpotKey, SpotStore::SpotType> parseSpotsMap(const QString &spots_file);
 
     // to parse a file with spike-in factors (one per spot)
     // it returns bool if the parsing was okay and the number of factors is the same as rows
@@ -75,6 +155,15 @@ public:
                                            const QList<QString> &spots);
     static STDataFrame sliceDataFrameSpots(const STDataFrame &data,
                                            const QList<QString> &genes);
+    // the rows of the spots and the columns of the genes kept by sliceDataFrameSpots()
+    static void sliceIndexesSpots(const CountDataFrame &data,
+                                  const QList<QString> &spots,
+                                  uvec &rows,
+                                  uvec &cols);
+    // the data frame with the given rows (spots) and columns (genes)
+    static STDataFrame sliceDataFrame(const CountDataFrame &data,
+                                      const uvec &rows,
+                                      const uvec &cols);
 
     // helper function to filter out a data frame using thresholds
     static STDataFrame filterDataFrame(const STDataFrame &data,
@@ -117,7 +206,7 @@ public:
 private:
 
     // The matrix with the counts (spots are rows and genes are columns)
-    STDataFrame m_data;
+    QSharedPointer<const CountDataFrame> m_data;
 
     // cache the thresholds settings to not re-compute always
     int m_reads_threshold;
@@ -135,21 +224,19 @@ private:
     // user loaded size factors
     rowvec m_size_factors;
 
-    // store gene/spots objects for the matrix (columns and rows)
-    // each index in each vector correspond to a row index or column index in the matrix
-    SpotListType m_spots;
-    GeneListType m_genes;
+    // store gene/spots attributes for the matrix (columns and rows)
+    // each index in each store correspond to a row index or column index in the matrix
+    SpotStore m_spots;
+    GeneStore m_genes;
 
-    // use hash tables for look-ups (spot and gene to matrix index)
-    // so to not have to search the QLists
-    QHash<QString, int> m_spot_index;
-    QHash<QString, int> m_gene_index;
+    // search index of the genes names (it is a cache that can be evicted)
+    mutable GeneSearchIndex m_gene_search;
 
     // rendering data
-    QVector<bool> m_rendering_selected;
-    QVector<bool> m_rendering_visible;
-    QVector<QColor> m_rendering_colors;
-    QVector<double> m_rendering_values;
+    RenderingBuffer m_rendering;
+
+    // changes made to the data that are not in the spots/genes stores
+    quint64 m_revision;
 
     Q_DISABLE_COPY(STData)
 };
@@ -0,0 +1,211 @@
+#include "SpotStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+
+inline ushort code(const QChar c)
+{
+    return c.unicode();
+}
+
+inline ushort code(const char c)
+{
+    return static_cast<uchar>(c);
+}
+
+inline bool isDigit(const ushort c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isSpace(const ushort c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// the numbers are accumulated as an integer and scaled once (no strings are created)
+template <typename Char>
+bool parseNumber(const Char *&it, const Char *end, float &value)
+{
+    const Char *pos = it;
+    bool negative = false;
+    if (pos != end && (code(*pos) == '-' || code(*pos) == '+')) {
+        negative = code(*pos) == '-';
+        ++pos;
+    }
+    quint64 mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; pos != end && isDigit(code(*pos)); ++pos, ++digits) {
+        // the digits that do not fit in the mantissa only change the exponent
+        if (mantissa < 1000000000000000000ULL) {
+            mantissa = mantissa * 10 + (code(*pos) - '0');
+        } else {
+            ++exponent;
+        }
+    }
+    if (pos != end && code(*pos) == '.') {
+        for (++pos; pos != end && isDigit(code(*pos)); ++pos, ++digits) {
+            if (mantissa < 1000000000000000000ULL) {
+                mantissa = mantissa * 10 + (code(*pos) - '0');
+                --exponent;
+            }
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+    if (pos != end && (code(*pos) == 'e' || code(*pos) == 'E')) {
+        const Char *exponent_pos = pos + 1;
+        bool negative_exponent = false;
+        if (exponent_pos != end && (code(*exponent_pos) == '-' || code(*exponent_pos) == '+')) {
+            negative_exponent = code(*exponent_pos) == '-';
+            ++exponent_pos;
+        }
+        if (exponent_pos != end && isDigit(code(*exponent_pos))) {
+            int explicit_exponent = 0;
+            for (; exponent_pos != end && isDigit(code(*exponent_pos)); ++exponent_pos) {
+                explicit_exponent = std::min(explicit_exponent * 10
+                                             + (code(*exponent_pos) - '0'), 1000);
+            }
+            exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+            pos = exponent_pos;
+        }
+    }
+    double number = static_cast<double>(mantissa);
+    if (exponent > 0) {
+        number *= std::pow(10.0, exponent);
+    } else if (exponent < 0) {
+        number /= std::pow(10.0, -exponent);
+    }
+    value = static_cast<float>(negative ? -number : number);
+    it = pos;
+    return true;
+}
+
+}
+
+SpotStore::SpotStore()
+    : AttributeStore(Qt::white)
+    , m_x()
+    , m_y()
+    , m_adj_x()
+    , m_adj_y()
+{
+}
+
+SpotStore::~SpotStore()
+{
+}
+
+void SpotStore::clear()
+{
+    AttributeStore::clear();
+    m_x.clear();
+    m_y.clear();
+    m_adj_x.clear();
+    m_adj_y.clear();
+}
+
+int SpotStore::append(const QString &name, const SpotType &adj_coordinates, const float total_count)
+{
+    return append(name, getCoordinates(name), adj_coordinates, total_count);
+}
+
+int SpotStore::append(const QString &name,
+                      const SpotType &coordinates,
+                      const SpotType &adj_coordinates,
+                      const float total_count)
+{
+    m_x.append(coordinates.first);
+    m_y.append(coordinates.second);
+    m_adj_x.append(adj_coordinates.first);
+    m_adj_y.append(adj_coordinates.second);
+    return AttributeStore::append(name, total_count);
+}
+
+SpotStore::SpotType SpotStore::coordinates(const int index) const
+{
+    return SpotType(m_x.at(index), m_y.at(index));
+}
+
+SpotStore::SpotType SpotStore::adj_coordinates(const int index) const
+{
+    return SpotType(m_adj_x.at(index), m_adj_y.at(index));
+}
+
+SpotStore::SpotKey SpotStore::key(const SpotType &coordinates)
+{
+    // adding 0 turns -0 into 0 so both have the same key
+    const float x = coordinates.first + 0.0f;
+    const float y = coordinates.second + 0.0f;
+    quint32 x_bits;
+    quint32 y_bits;
+    std::memcpy(&x_bits, &x, sizeof(x_bits));
+    std::memcpy(&y_bits, &y, sizeof(y_bits));
+    return (static_cast<SpotKey>(x_bits) << 32) | y_bits;
+}
+
+bool SpotStore::parseCoordinates(const QString &spot, SpotType &coordinates)
+{
+    const QChar *it = spot.constData();
+    const QChar *end = it + spot.size();
+    while (it != end && isSpace(code(*it))) {
+        ++it;
+    }
+    float x;
+    float y;
+    if (!parseNumber(it, end, x)) {
+        return false;
+    }
+    // the prefix of the merged selections (N_)
+    if (it != end && *it == QLatin1Char('_')) {
+        ++it;
+        if (!parseNumber(it, end, x)) {
+            return false;
+        }
+    }
+    if (it == end || *it != QLatin1Char('x')) {
+        return false;
+    }
+    ++it;
+    if (!parseNumber(it, end, y)) {
+        return false;
+    }
+    while (it != end && isSpace(code(*it))) {
+        ++it;
+    }
+    if (it != end) {
+        return false;
+    }
+    coordinates = SpotType(x, y);
+    return true;
+}
+
+SpotStore::SpotType SpotStore::getCoordinates(const QString &spot)
+{
+    SpotType coordinates(0.0f, 0.0f);
+    const bool parsed = parseCoordinates(spot, coordinates);
+    Q_ASSERT(parsed);
+    Q_UNUSED(parsed);
+    return coordinates;
+}
+
+QString SpotStore::getSpot(const SpotStore::SpotType &spot)
+{
+    return QString::number(spot.first) + "x" + QString::number(spot.second);
+}
+
+bool SpotStore::parseNumber(const QChar *&it, const QChar *end, float &value)
+{
+    return ::parseNumber(it, end, value);
+}
+
+bool SpotStore::parseNumber(const char *&it, const char *end, float &value)
+{
+    return ::parseNumber(it, end, value);
+}
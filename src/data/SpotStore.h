@@ -0,0 +1,61 @@
+#ifndef SPOTSTORE_H
+#define SPOTSTORE_H
+
+#include <QPair>
+
+#include "data/AttributeStore.h"
+
+// The spots of a dataset stored by columns (see AttributeStore)
+// Each spot is defined by two float coordinates (parsed from its name XxY) and
+// its adjusted coordinates (only useful for plotting)
+// The names are only parsed once, the coordinates can then be compared by their key
+// (both coordinates packed in 64 bits) without going through the names
+class SpotStore : public AttributeStore
+{
+
+public:
+    typedef QPair<float, float> SpotType;
+    typedef quint64 SpotKey;
+
+    SpotStore();
+    ~SpotStore();
+
+    // removes all the spots
+    void clear();
+
+    // adds a spot, it returns its index
+    int append(const QString &name, const SpotType &adj_coordinates, const float total_count);
+    // adds a spot whose coordinates have already been parsed from its name
+    int append(const QString &name,
+               const SpotType &coordinates,
+               const SpotType &adj_coordinates,
+               const float total_count);
+
+    // the spot's coordinates
+    SpotType coordinates(const int index) const;
+    // the spot's adjusted coordinates
+    SpotType adj_coordinates(const int index) const;
+
+    // the key of the coordinates (equal coordinates have equal keys)
+    static SpotKey key(const SpotType &coordinates);
+    // helper method to parse the coordinates (x,y) of a spot (XxY), the merged
+    // selections prefix the name with the index of the selection (N_XxY)
+    // it returns false if the name is not valid (nothing is allocated)
+    static bool parseCoordinates(const QString &spot, SpotType &coordinates);
+    // helper method to get coordinates (x,y) from a spot
+    static SpotType getCoordinates(const QString &spot);
+    // helper method to get a string representation (XxY) of a spot
+    static QString getSpot(const SpotType &spot);
+    // helper methods to parse a decimal number (with optional sign, fraction and exponent)
+    // at the position it, it is moved after the number (it returns false if there is none)
+    static bool parseNumber(const QChar *&it, const QChar *end, float &value);
+    static bool parseNumber(const char *&it, const char *end, float &value);
+
+private:
+    QVector<float> m_x;
+    QVector<float> m_y;
+    QVector<float> m_adj_x;
+    QVector<float> m_adj_y;
+};
+
+#endif // SPOTSTORE_H
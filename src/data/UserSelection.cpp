@@ -1,9 +1,34 @@
 #include "UserSelection.h"
 
+#include "profiling/MemoryAccounting.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// the indexes as an armadillo vector (without copying them)
+uvec toIndexes(const QVector<uword> &indexes)
+{
+    return uvec(const_cast<uword *>(indexes.constData()), indexes.size(), false, true);
+}
+
+QVector<uword> fromIndexes(const uvec &indexes)
+{
+    QVector<uword> vector(static_cast<int>(indexes.n_elem));
+    std::copy(indexes.begin(), indexes.end(), vector.begin());
+    return vector;
+}
+
+}
+
 UserSelection::UserSelection()
     : m_name()
     , m_dataset()
     , m_data()
+    , m_rows()
+    , m_cols()
+    , m_view(false)
     , m_comment()
 {
 }
@@ -11,11 +36,32 @@ UserSelection::UserSelection()
 UserSelection::UserSelection(const STData::STDataFrame &data)
     : m_name()
     , m_dataset()
-    , m_data(data)
+    , m_data(new STData::CountDataFrame{CountMatrix(data.counts), data.genes, data.spots})
+    , m_rows()
+    , m_cols()
+    , m_view(false)
     , m_comment()
 {
 }
 
+UserSelection::UserSelection(const QSharedPointer<const STData::CountDataFrame> &dataset,
+                             const QList<QString> &spots)
+    : m_name()
+    , m_dataset()
+    , m_data(dataset)
+    , m_rows()
+    , m_cols()
+    , m_view(true)
+    , m_comment()
+{
+    Q_ASSERT(!dataset.isNull());
+    uvec rows;
+    uvec cols;
+    STData::sliceIndexesSpots(*dataset, spots, rows, cols);
+    m_rows = fromIndexes(rows);
+    m_cols = fromIndexes(cols);
+}
+
 UserSelection::~UserSelection()
 {
 }
@@ -25,6 +71,9 @@ UserSelection::UserSelection(const UserSelection &other)
     m_name = other.m_name;
     m_dataset = other.m_dataset;
     m_data = other.m_data;
+    m_rows = other.m_rows;
+    m_cols = other.m_cols;
+    m_view = other.m_view;
     m_comment = other.m_comment;
 }
 
@@ -33,18 +82,23 @@ UserSelection &UserSelection::operator=(const UserSelection &other)
     m_name = other.m_name;
     m_dataset = other.m_dataset;
     m_data = other.m_data;
+    m_rows = other.m_rows;
+    m_cols = other.m_cols;
+    m_view = other.m_view;
     m_comment = other.m_comment;
     return (*this);
 }
 
 bool UserSelection::operator==(const UserSelection &other) const
 {
+    // copies of a selection share the data so the names are only compared otherwise
+    const bool same_data = m_data == other.m_data && m_view == other.m_view
+            && m_rows == other.m_rows && m_cols == other.m_cols;
     return (m_name == other.m_name
             && m_dataset == other.m_dataset
             //TODO gotta fix the == for the Matrix type
             //&& m_data.counts == other.m_data.counts
-            && m_data.genes == other.m_data.genes
-            && m_data.spots == other.m_data.spots
+            && (same_data || (genes() == other.genes() && spots() == other.spots()))
             && m_comment == other.m_comment);
 }
 
@@ -58,9 +112,47 @@ const QString UserSelection::dataset() const
     return m_dataset;
 }
 
-const STData::STDataFrame &UserSelection::data() const
+STData::STDataFrame UserSelection::data() const
+{
+    if (m_data.isNull()) {
+        return STData::STDataFrame();
+    }
+    if (!m_view) {
+        return STData::STDataFrame{m_data->counts.toMat(), m_data->genes, m_data->spots};
+    }
+    return STData::sliceDataFrame(*m_data, toIndexes(m_rows), toIndexes(m_cols));
+}
+
+QList<QString> UserSelection::spots() const
+{
+    if (m_data.isNull()) {
+        return QList<QString>();
+    }
+    if (!m_view) {
+        return m_data->spots;
+    }
+    QList<QString> spots;
+    spots.reserve(m_rows.size());
+    for (const uword i : m_rows) {
+        spots.push_back(m_data->spots.at(i));
+    }
+    return spots;
+}
+
+QList<QString> UserSelection::genes() const
 {
-    return m_data;
+    if (m_data.isNull()) {
+        return QList<QString>();
+    }
+    if (!m_view) {
+        return m_data->genes;
+    }
+    QList<QString> genes;
+    genes.reserve(m_cols.size());
+    for (const uword j : m_cols) {
+        genes.push_back(m_data->genes.at(j));
+    }
+    return genes;
 }
 
 const QString UserSelection::comment() const
@@ -70,12 +162,36 @@ const QString UserSelection::comment() const
 
 int UserSelection::totalGenes() const
 {
-    return m_data.genes.size();
+    if (m_data.isNull()) {
+        return 0;
+    }
+    return m_view ? m_cols.size() : m_data->genes.size();
 }
 
 int UserSelection::totalSpots() const
 {
-    return m_data.spots.size();
+    if (m_data.isNull()) {
+        return 0;
+    }
+    return m_view ? m_rows.size() : m_data->spots.size();
+}
+
+qint64 UserSelection::memoryUsage() const
+{
+    if (m_data.isNull()) {
+        return 0;
+    }
+    if (m_view) {
+        return static_cast<qint64>(m_rows.capacity() + m_cols.capacity()) * sizeof(uword);
+    }
+    return static_cast<qint64>(m_data->counts.memoryUsage())
+            + MemoryAccounting::stringsMemoryUsage(m_data->genes)
+            + MemoryAccounting::stringsMemoryUsage(m_data->spots);
+}
+
+bool UserSelection::isView() const
+{
+    return m_view;
 }
 
 void UserSelection::name(const QString &name)
@@ -95,6 +211,10 @@ void UserSelection::comment(const QString &comment)
 
 void UserSelection::data(const STData::STDataFrame &data)
 {
-    m_data = data;
+    // the other copies keep the previous data
+    m_data = QSharedPointer<const STData::CountDataFrame>(
+                new STData::CountDataFrame{CountMatrix(data.counts), data.genes, data.spots});
+    m_rows.clear();
+    m_cols.clear();
+    m_view = false;
 }
-
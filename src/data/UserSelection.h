@@ -2,11 +2,18 @@
 #define USERSELECTION_H
 
 #include <QString>
+#include <QVector>
+#include <QSharedPointer>
 #include "STData.h"
 
 // UserSelection represents a selection of spots made by the user trough the UI.
 // Users can select spots manually (lazo, rubberband ..) or by using the selection search
 // box with specific gene names (reg-exp).
+// A selection made in a dataset is a view of the dataset: it shares the data frame of
+// the dataset and only stores the rows (spots) and columns (genes) of the selection, the
+// counts are copied only when data() is called. Selections that are not made in a dataset
+// (imported from a file or merged) own their data frame, which is shared by the copies.
+// Copying a selection is cheap and setting new data only changes that copy.
 class UserSelection
 {
 
@@ -16,6 +23,10 @@ public:
 
     UserSelection();
     explicit UserSelection(const STData::STDataFrame &data);
+    // the selection of the spots of the dataset (the genes without counts
+    // in the spots are left out, see STData::sliceDataFrameSpots())
+    UserSelection(const QSharedPointer<const STData::CountDataFrame> &dataset,
+                  const QList<QString> &spots);
     UserSelection(const UserSelection &other);
     ~UserSelection();
 
@@ -26,8 +37,12 @@ public:
     const QString name() const;
     // the name of the dataset where the selection has been made
     const QString dataset() const;
-    // the data matrix of counts
-    const STData::STDataFrame &data() const;
+    // the data matrix of counts (the counts of a view are copied from the dataset
+    // on every call so the result should be kept while it is used)
+    STData::STDataFrame data() const;
+    // the names of the spots and the genes (without copying the counts)
+    QList<QString> spots() const;
+    QList<QString> genes() const;
     // some meta-data
     const QString comment() const;
 
@@ -35,6 +50,12 @@ public:
     int totalGenes() const;
     int totalSpots() const;
 
+    // an estimate of the memory held by the selection (bytes), a view only holds
+    // its rows and columns (the counts belong to the dataset)
+    qint64 memoryUsage() const;
+    // true if the selection is a view of the data frame of a dataset
+    bool isView() const;
+
     // Setters
     void name(const QString &name);
     void dataset(const QString &dataset);
@@ -44,7 +65,13 @@ public:
 private:
     QString m_name;
     QString m_dataset;
-    STData::STDataFrame m_data;
+    // the data frame of the dataset (view) or of the selection, it is never modified
+    // (the counts of the selection are also stored in the compact storage)
+    QSharedPointer<const STData::CountDataFrame> m_data;
+    // the rows and the columns of the dataset in the selection (only in views)
+    QVector<uword> m_rows;
+    QVector<uword> m_cols;
+    bool m_view;
     QString m_comment;
 };
 
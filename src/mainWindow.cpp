@@ -29,12 +29,17 @@
 #include "viewPages/UserSelectionsPage.h"
 #include "viewPages/GenesWidget.h"
 #include "viewPages/SpotsWidget.h"
+#include "viewPages/ProfilerWidget.h"
 #include "config/Configuration.h"
+#include "data/DatasetCache.h"
+#include "profiling/MemoryAccounting.h"
 #include "SettingsStyle.h"
 
 using namespace Style;
 static const QString SettingsGeometry = QStringLiteral("Geometry");
 static const QString SettingsState = QStringLiteral("State");
+// the number of datasets on each side of the open one in the list that are prefetched
+static const int PREFETCH_NEIGHBOURS = 1;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -50,6 +55,8 @@ MainWindow::MainWindow(QWidget *parent)
     , m_user_selections(nullptr)
     , m_genes(nullptr)
     , m_spots(nullptr)
+    , m_profiler(nullptr)
+    , m_dataset_cache(nullptr)
 {
     setUnifiedTitleAndToolBarOnMac(true);
 
@@ -64,6 +71,10 @@ MainWindow::MainWindow(QWidget *parent)
     Q_ASSERT(m_user_selections);
     m_cellview.reset(new CellViewPage(m_spots, m_genes, m_user_selections));
     Q_ASSERT(m_cellview);
+    m_profiler.reset(new ProfilerWidget());
+    Q_ASSERT(m_profiler);
+    m_dataset_cache.reset(new DatasetCache());
+    Q_ASSERT(m_dataset_cache);
 }
 
 MainWindow::~MainWindow()
@@ -206,6 +217,16 @@ void MainWindow::setupUi()
     menuViews->addAction(dock_spots->toggleViewAction());
     addDockWidget(Qt::LeftDockWidgetArea, dock_spots);
 
+    // add the performance panel as dock widget (hidden until the user opens it)
+    QDockWidget *dock_profiler = new QDockWidget(tr("Performance"), this);
+    m_profiler->setObjectName("Performance");
+    dock_profiler->setWidget(m_profiler.data());
+    dock_profiler->setObjectName("PerformanceDock");
+    dock_profiler->setAllowedAreas(Qt::AllDockWidgetAreas);
+    menuViews->addAction(dock_profiler->toggleViewAction());
+    addDockWidget(Qt::RightDockWidgetArea, dock_profiler);
+    dock_profiler->hide();
+
     // App's name
     statusBar()->showMessage(tr("Spatial Transcriptomics Research Viewer"));
 }
@@ -240,7 +261,10 @@ void MainWindow::slotClearCache()
                                             QMessageBox::No | QMessageBox::Escape);
 
     if (answer == QMessageBox::Yes) {
-        //NOTE nothing for now
+        // the recomputable caches of the datasets are built again when they are needed
+        const qint64 released = MemoryAccounting::instance().evictCaches();
+        statusBar()->showMessage(tr("Cache cleared (%1 released)")
+                                 .arg(MemoryAccounting::formatBytes(released)));
     }
 }
 
@@ -299,6 +323,14 @@ void MainWindow::createConnections()
             &DatasetPage::signalDatasetRemoved,
             this,
             &MainWindow::slotDatasetRemoved);
+    // warn the user when the memory exceeds a budget (the caches have been evicted)
+    connect(&MemoryAccounting::instance(), &MemoryAccounting::budgetExceeded, this,
+            [=](MemoryAccounting::Category category, qint64 bytes, qint64 budget) {
+        statusBar()->showMessage(tr("%1 use %2 of memory (the budget is %3)")
+                                 .arg(MemoryAccounting::categoryName(category))
+                                 .arg(MemoryAccounting::formatBytes(bytes))
+                                 .arg(MemoryAccounting::formatBytes(budget)));
+    });
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
@@ -313,6 +345,8 @@ void MainWindow::loadSettings()
     // Retrieve the geometry and state of the main window
     restoreGeometry(settings.value(SettingsGeometry).toByteArray());
     restoreState(settings.value(SettingsState).toByteArray());
+    // the memory budgets
+    MemoryAccounting::instance().loadBudgets(settings);
     // TODO load global settings (menus and status)
 }
 
@@ -324,6 +358,8 @@ void MainWindow::saveSettings() const
     settings.setValue(SettingsGeometry, geometry);
     QByteArray state = saveState();
     settings.setValue(SettingsState, state);
+    // the memory budgets (they can be edited in the settings)
+    MemoryAccounting::instance().saveBudgets(settings);
     // TODO save global settings (menus and status)
 }
 
@@ -332,10 +368,13 @@ void MainWindow::slotDatasetOpen(const QString &datasetname)
     QGuiApplication::setOverrideCursor(Qt::WaitCursor);
     auto dataset = m_datasets->getCurrentDataset();
     try {
-        // first load the dataset
-        dataset->load_data();
+        // first load the dataset (it is only parsed if it is not cached)
+        const DatasetCache::Loaded loaded = m_dataset_cache->open(*dataset);
+        dataset->load_data(loaded.data);
         qDebug() << "Dataset opened " << datasetname;
-        m_cellview->loadDataset(*(dataset.data()));
+        m_cellview->loadDataset(*(dataset.data()), loaded.image);
+        // the datasets next to it in the list are likely to be opened next
+        m_dataset_cache->prefetch(m_datasets->neighbourDatasets(*dataset, PREFETCH_NEIGHBOURS));
     } catch (const std::exception &e) {
         const QString ex_message = QString::fromStdString(e.what());
         const QString message = "Error opening ST Dataset " + ex_message;
@@ -347,6 +386,7 @@ void MainWindow::slotDatasetOpen(const QString &datasetname)
 void MainWindow::slotDatasetUpdated(const QString &datasetname)
 {
     //NOTE we re-open the dataset even if it is just being updated
+    // (the cached data is reused if the files of the data and the image did not change)
     qDebug() << "Dataset updated " << datasetname;
     slotDatasetOpen(datasetname);
 }
@@ -354,6 +394,8 @@ void MainWindow::slotDatasetUpdated(const QString &datasetname)
 void MainWindow::slotDatasetRemoved(const QString &datasetname)
 {
     qDebug() << "Dataset removed " << datasetname;
+    m_dataset_cache->close();
+    m_dataset_cache->remove(datasetname);
     m_genes->clear();
     m_spots->clear();
     m_cellview->clear();
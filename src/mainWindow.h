@@ -15,6 +15,8 @@ class CellViewPage;
 class UserSelectionsPage;
 class SpotsWidget;
 class GenesWidget;
+class ProfilerWidget;
+class DatasetCache;
 
 // This class represents the main window of the application
 // it is composed of a tool bar, the cell main view and the gene tables
@@ -83,6 +85,9 @@ private:
     QSharedPointer<UserSelectionsPage> m_user_selections;
     QSharedPointer<GenesWidget> m_genes;
     QSharedPointer<SpotsWidget> m_spots;
+    QScopedPointer<ProfilerWidget> m_profiler;
+    // the recently opened and the prefetched datasets
+    QScopedPointer<DatasetCache> m_dataset_cache;
 };
 
 #endif // MAINWINDOW_H
@@ -6,6 +6,9 @@
 #include <QtCore/qmath.h>
 #include <QSizeF>
 #include <QColor>
+#include <QPair>
+#include <QThread>
+#include <QVector>
 #include <vector>
 
 #include <cmath>
@@ -196,6 +199,20 @@ inline T tpmNormalization(const T reads, const T totalReads)
     return static_cast<T>((reads * 10e6) / totalReads);
 }
 
+// Splits the range [0, size) into contiguous blocks of at least min_size elements
+// (about four blocks per thread) so they can be processed concurrently
+template <typename T>
+inline QVector<QPair<T, T>> splitRange(const T size, const T min_size)
+{
+    const T tasks = static_cast<T>(std::max(1, QThread::idealThreadCount() * 4));
+    const T block_size = std::max(std::max(min_size, T(1)), (size + tasks - 1) / tasks);
+    QVector<QPair<T, T>> blocks;
+    for (T begin = 0; begin < size; begin += block_size) {
+        blocks.append(qMakePair(begin, std::min(begin + block_size, size)));
+    }
+    return blocks;
+}
+
 } // end name space
 
 #endif // COMMON_H //
@@ -0,0 +1,805 @@
+#include "GraphClustering.h"
+
+#include "math/Common.h"
+#include "math/PCA.h"
+
+#include <QDebug>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <utility>
+
+namespace
+{
+
+// number of principal components and neighbours used to build the graphs
+const uword reduced_dimensions = 10;
+const uword graph_neighbours = 10;
+const uword snn_neighbours = 20;
+// shared nearest neighbours edges with a lower Jaccard index are removed
+const double snn_prune = 1.0 / 15.0;
+// below this number of points the nearest neighbours are computed exactly
+const uword exact_neighbours_limit = 5000;
+// random projection trees and refinement iterations for the approximate neighbours
+const unsigned projection_trees = 8;
+const uword min_leaf_size = 32;
+const int refinement_iterations = 2;
+// only the closest neighbours of each neighbour are candidates in the refinement
+// (so it stays linear on k when many neighbours are requested, e.g. t-SNE)
+const uword refinement_neighbours = 10;
+// limits of the Louvain/Leiden iterations
+const int max_levels = 20;
+const int max_passes = 100;
+// randomness of the Leiden refinement
+const double leiden_theta = 0.01;
+// fixed seed so the same data always gives the same communities
+const unsigned random_seed = 42;
+
+// renumbers the labels 0..k-1 (biggest community first) and returns k
+unsigned renumber(std::vector<int> &labels)
+{
+    std::vector<uword> sizes;
+    for (const int label : labels) {
+        if (static_cast<uword>(label) >= sizes.size()) {
+            sizes.resize(label + 1, 0);
+        }
+        ++sizes[label];
+    }
+    std::vector<int> order;
+    for (uword c = 0; c < sizes.size(); ++c) {
+        if (sizes[c] > 0) {
+            order.push_back(c);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&sizes](const int a, const int b) { return sizes[a] > sizes[b]; });
+    std::vector<int> mapping(sizes.size(), -1);
+    for (uword c = 0; c < order.size(); ++c) {
+        mapping[order[c]] = c;
+    }
+    for (int &label : labels) {
+        label = mapping[label];
+    }
+    return order.size();
+}
+
+// the strength (sum of weights) of each node, returns the total weight of the graph
+double nodeStrengths(const GraphClustering::Graph &graph, std::vector<double> &strength)
+{
+    const uword n = graph.size();
+    strength.assign(n, 0.0);
+    double total_weight = 0.0;
+    for (uword node = 0; node < n; ++node) {
+        for (uword e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+            strength[node] += graph.weights[e];
+        }
+        total_weight += strength[node];
+    }
+    return total_weight;
+}
+
+// moves each node to the neighbouring community with the biggest modularity gain
+// until no node can be moved (a node is only visited again when one of its neighbours
+// changes community), communities contains the initial community (0..n-1) of each node
+// returns true if any node was moved
+bool moveNodes(const GraphClustering::Graph &graph,
+               const double resolution,
+               std::vector<int> &communities)
+{
+    const uword n = graph.size();
+    std::vector<double> strength;
+    const double total_weight = nodeStrengths(graph, strength);
+    if (total_weight <= 0.0) {
+        return false;
+    }
+    std::vector<double> total(n, 0.0);
+    for (uword node = 0; node < n; ++node) {
+        total[communities[node]] += strength[node];
+    }
+
+    // nodes are visited in random order
+    std::vector<uword> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(random_seed));
+    std::deque<uword> queue(order.begin(), order.end());
+    std::vector<char> queued(n, 1);
+
+    // weights from the current node to its neighbouring communities (-1 if not a neighbour)
+    std::vector<double> links(n, -1.0);
+    std::vector<int> neighbour_communities;
+
+    bool moved = false;
+    uword visits = 0;
+    const uword max_visits = static_cast<uword>(max_passes) * n;
+    while (!queue.empty() && visits++ < max_visits) {
+        const uword node = queue.front();
+        queue.pop_front();
+        queued[node] = 0;
+
+        const int current = communities[node];
+        links[current] = 0.0;
+        neighbour_communities.push_back(current);
+        for (uword e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+            const uword target = graph.targets[e];
+            if (target == node) {
+                continue;
+            }
+            const int community = communities[target];
+            if (links[community] < 0.0) {
+                links[community] = 0.0;
+                neighbour_communities.push_back(community);
+            }
+            links[community] += graph.weights[e];
+        }
+
+        // remove the node from its community and find the best one to insert it
+        total[current] -= strength[node];
+        const double factor = resolution * strength[node] / total_weight;
+        int best = current;
+        double best_gain = links[current] - total[current] * factor;
+        for (const int community : neighbour_communities) {
+            const double gain = links[community] - total[community] * factor;
+            if (gain > best_gain) {
+                best = community;
+                best_gain = gain;
+            }
+        }
+        total[best] += strength[node];
+
+        if (best != current) {
+            communities[node] = best;
+            moved = true;
+            // the neighbours outside the new community may want to follow
+            for (uword e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+                const uword target = graph.targets[e];
+                if (!queued[target] && communities[target] != best) {
+                    queue.push_back(target);
+                    queued[target] = 1;
+                }
+            }
+        }
+
+        for (const int community : neighbour_communities) {
+            links[community] = -1.0;
+        }
+        neighbour_communities.clear();
+    }
+    return moved;
+}
+
+// Leiden refinement: each community is split into well connected sub communities
+// starting from singletons, nodes are merged randomly (favouring the biggest gains)
+// returns the refined community (0..n-1) of each node
+std::vector<int> refine(const GraphClustering::Graph &graph,
+                        const double resolution,
+                        const std::vector<int> &communities,
+                        std::mt19937 &generator)
+{
+    const uword n = graph.size();
+    std::vector<double> strength;
+    const double total_weight = nodeStrengths(graph, strength);
+    std::vector<double> community_total(n, 0.0);
+    for (uword node = 0; node < n; ++node) {
+        community_total[communities[node]] += strength[node];
+    }
+
+    // refined communities start as singletons, for each one we keep its strength,
+    // size and the weight of its links to the rest of its community
+    std::vector<int> refined(n);
+    std::iota(refined.begin(), refined.end(), 0);
+    std::vector<double> refined_total = strength;
+    std::vector<uword> refined_size(n, 1);
+    std::vector<double> refined_external(n, 0.0);
+    for (uword node = 0; node < n; ++node) {
+        for (uword e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+            const uword target = graph.targets[e];
+            if (target != node && communities[target] == communities[node]) {
+                refined_external[node] += graph.weights[e];
+            }
+        }
+    }
+    if (total_weight <= 0.0) {
+        return refined;
+    }
+
+    std::vector<uword> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), generator);
+
+    std::vector<double> links(n, -1.0);
+    std::vector<int> candidates;
+    std::vector<double> gains;
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (const uword node : order) {
+        // only singletons that are well connected to their community are merged
+        const int community = communities[node];
+        const int current = refined[node];
+        if (refined_size[current] != 1
+                || refined_external[current] < resolution * strength[node]
+                   * (community_total[community] - strength[node]) / total_weight) {
+            continue;
+        }
+
+        links[current] = 0.0;
+        candidates.push_back(current);
+        for (uword e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+            const uword target = graph.targets[e];
+            if (target == node || communities[target] != community) {
+                continue;
+            }
+            const int sub_community = refined[target];
+            if (links[sub_community] < 0.0) {
+                links[sub_community] = 0.0;
+                candidates.push_back(sub_community);
+            }
+            links[sub_community] += graph.weights[e];
+        }
+
+        // gains of the well connected candidates (negative gains are not allowed)
+        const double factor = resolution * strength[node] / total_weight;
+        double max_gain = 0.0;
+        for (const int candidate : candidates) {
+            double gain = -1.0;
+            if (candidate == current) {
+                gain = 0.0;
+            } else if (refined_external[candidate] >= resolution * refined_total[candidate]
+                       * (community_total[community] - refined_total[candidate])
+                       / total_weight) {
+                gain = links[candidate] - refined_total[candidate] * factor;
+            }
+            gains.push_back(gain);
+            max_gain = std::max(max_gain, gain);
+        }
+
+        // choose randomly with probability proportional to exp(gain / theta)
+        const double scale = leiden_theta * total_weight / 2.0;
+        double sum = 0.0;
+        for (double &gain : gains) {
+            gain = gain >= 0.0 ? std::exp((gain - max_gain) / scale) : 0.0;
+            sum += gain;
+        }
+        int chosen = current;
+        double threshold = uniform(generator) * sum;
+        for (uword c = 0; c < candidates.size(); ++c) {
+            threshold -= gains[c];
+            if (gains[c] > 0.0 && threshold <= 0.0) {
+                chosen = candidates[c];
+                break;
+            }
+        }
+
+        if (chosen != current) {
+            refined[node] = chosen;
+            refined_size[current] = 0;
+            ++refined_size[chosen];
+            refined_total[chosen] += strength[node];
+            refined_external[chosen] += refined_external[current] - 2.0 * links[chosen];
+        }
+
+        for (const int candidate : candidates) {
+            links[candidate] = -1.0;
+        }
+        candidates.clear();
+        gains.clear();
+    }
+    return refined;
+}
+
+// creates a graph where each node is a community of the given graph
+GraphClustering::Graph aggregate(const GraphClustering::Graph &graph,
+                                 const std::vector<int> &communities,
+                                 const unsigned n_communities)
+{
+    std::vector<std::vector<uword>> members(n_communities);
+    for (uword node = 0; node < communities.size(); ++node) {
+        members[communities[node]].push_back(node);
+    }
+
+    GraphClustering::Graph result;
+    result.offsets.reserve(n_communities + 1);
+    result.offsets.push_back(0);
+    std::vector<double> links(n_communities, -1.0);
+    std::vector<int> neighbour_communities;
+    for (unsigned c = 0; c < n_communities; ++c) {
+        for (const uword node : members[c]) {
+            for (uword e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+                const int community = communities[graph.targets[e]];
+                if (links[community] < 0.0) {
+                    links[community] = 0.0;
+                    neighbour_communities.push_back(community);
+                }
+                links[community] += graph.weights[e];
+            }
+        }
+        // the internal weight becomes a self loop
+        std::sort(neighbour_communities.begin(), neighbour_communities.end());
+        for (const int community : neighbour_communities) {
+            result.targets.push_back(community);
+            result.weights.push_back(links[community]);
+            links[community] = -1.0;
+        }
+        neighbour_communities.clear();
+        result.offsets.push_back(result.targets.size());
+    }
+    return result;
+}
+
+// the squared euclidean distance between two points
+inline double squaredDistance(const double *a, const double *b, const uword dims)
+{
+    double distance = 0.0;
+    for (uword d = 0; d < dims; ++d) {
+        const double diff = a[d] - b[d];
+        distance += diff * diff;
+    }
+    return distance;
+}
+
+// stores the k closest candidates (closest first) in neighbours
+// (the candidates must contain at least k different points)
+void keepClosest(std::vector<std::pair<double, uword>> &candidates,
+                 const uword k,
+                 uword *neighbours)
+{
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (uword l = 0; l < k; ++l) {
+        neighbours[l] = candidates[l].second;
+    }
+    candidates.clear();
+}
+
+// A random projection tree, the points are split recursively by random hyperplanes
+// until each leaf contains at most leaf_size points
+struct ProjectionTree {
+    unsigned seed;
+    // the points (sorted by leaf), the range of each leaf and the leaf of each point
+    std::vector<uword> order;
+    std::vector<std::pair<uword, uword>> leaves;
+    std::vector<uword> leaf_of;
+};
+
+void buildProjectionTree(const mat &columns, const uword leaf_size, ProjectionTree &tree)
+{
+    const uword n = columns.n_cols;
+    const uword dims = columns.n_rows;
+    tree.order.resize(n);
+    std::iota(tree.order.begin(), tree.order.end(), 0);
+    tree.leaf_of.resize(n);
+    tree.leaves.clear();
+
+    std::mt19937 generator(tree.seed);
+    std::vector<double> normal(dims);
+    std::vector<std::pair<uword, uword>> ranges(1, std::make_pair(uword(0), n));
+    while (!ranges.empty()) {
+        const auto range = ranges.back();
+        ranges.pop_back();
+        const uword size = range.second - range.first;
+        if (size <= leaf_size) {
+            for (uword i = range.first; i < range.second; ++i) {
+                tree.leaf_of[tree.order[i]] = tree.leaves.size();
+            }
+            tree.leaves.push_back(range);
+            continue;
+        }
+
+        // hyperplane equidistant to two random points of the range
+        std::uniform_int_distribution<uword> pick(range.first, range.second - 1);
+        const double *a = columns.colptr(tree.order[pick(generator)]);
+        const double *b = columns.colptr(tree.order[pick(generator)]);
+        double offset = 0.0;
+        for (uword d = 0; d < dims; ++d) {
+            normal[d] = a[d] - b[d];
+            offset += normal[d] * (a[d] + b[d]) / 2.0;
+        }
+        const auto middle = std::partition(tree.order.begin() + range.first,
+                                           tree.order.begin() + range.second,
+                                           [&](const uword point) {
+            const double *x = columns.colptr(point);
+            double projection = 0.0;
+            for (uword d = 0; d < dims; ++d) {
+                projection += normal[d] * x[d];
+            }
+            return projection < offset;
+        });
+        uword split = middle - tree.order.begin();
+        // degenerate splits (duplicated points) are split in half
+        if (split == range.first || split == range.second) {
+            split = range.first + size / 2;
+        }
+        ranges.push_back(std::make_pair(range.first, split));
+        ranges.push_back(std::make_pair(split, range.second));
+    }
+}
+
+} // namespace
+
+namespace GraphClustering
+{
+
+umat nearestNeighbours(const mat &points, const uword k)
+{
+    // one column per point so the coordinates are contiguous
+    const mat columns = points.t();
+    const uword n = columns.n_cols;
+    const uword dims = columns.n_rows;
+    const uword n_neighbours = n > 0 ? std::min(k, n - 1) : 0;
+    umat neighbours(n_neighbours, n);
+    if (n_neighbours == 0) {
+        return neighbours;
+    }
+
+    // brute force in parallel (each task only needs memory for one row of distances)
+    const auto blocks = STMath::splitRange<uword>(n, 16);
+    QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+        std::vector<std::pair<double, uword>> distances(n);
+        for (uword i = block.first; i < block.second; ++i) {
+            const double *a = columns.colptr(i);
+            for (uword j = 0; j < n; ++j) {
+                const double *b = columns.colptr(j);
+                double distance = 0.0;
+                for (uword d = 0; d < dims; ++d) {
+                    const double diff = a[d] - b[d];
+                    distance += diff * diff;
+                }
+                distances[j] = std::make_pair(distance, j);
+            }
+            distances[i].first = std::numeric_limits<double>::infinity();
+            std::partial_sort(distances.begin(), distances.begin() + n_neighbours,
+                              distances.end());
+            for (uword l = 0; l < n_neighbours; ++l) {
+                neighbours.at(l, i) = distances[l].second;
+            }
+        }
+    });
+    return neighbours;
+}
+
+umat approximateNeighbours(const mat &points, const uword k)
+{
+    const uword n = points.n_rows;
+    if (n <= exact_neighbours_limit) {
+        return nearestNeighbours(points, k);
+    }
+
+    // one column per point so the coordinates are contiguous
+    const mat columns = points.t();
+    const uword dims = columns.n_rows;
+    const uword n_neighbours = std::min(k, n - 1);
+    const uword leaf_size = std::max(min_leaf_size, 3 * n_neighbours);
+
+    // the random projection trees are built concurrently
+    QVector<ProjectionTree> trees(projection_trees);
+    for (int t = 0; t < trees.size(); ++t) {
+        trees[t].seed = random_seed + t;
+    }
+    QtConcurrent::blockingMap(trees, [&](ProjectionTree &tree) {
+        buildProjectionTree(columns, leaf_size, tree);
+    });
+
+    // the initial candidates are the points sharing a leaf in any of the trees
+    umat neighbours(n_neighbours, n);
+    const auto blocks = STMath::splitRange<uword>(n, 64);
+    QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+        std::vector<std::pair<double, uword>> candidates;
+        for (uword i = block.first; i < block.second; ++i) {
+            const double *a = columns.colptr(i);
+            for (const auto &tree : trees) {
+                const auto &leaf = tree.leaves[tree.leaf_of[i]];
+                for (uword l = leaf.first; l < leaf.second; ++l) {
+                    const uword point = tree.order[l];
+                    if (point != i) {
+                        candidates.push_back(
+                            std::make_pair(squaredDistance(a, columns.colptr(point), dims), point));
+                    }
+                }
+            }
+            // small leaves are completed with consecutive points
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            for (uword j = (i + 1) % n; candidates.size() < n_neighbours; j = (j + 1) % n) {
+                const auto found = std::find_if(candidates.begin(), candidates.end(),
+                                                [j](const std::pair<double, uword> &candidate) {
+                    return candidate.second == j;
+                });
+                if (j != i && found == candidates.end()) {
+                    candidates.push_back(
+                        std::make_pair(squaredDistance(a, columns.colptr(j), dims), j));
+                }
+            }
+            keepClosest(candidates, n_neighbours, neighbours.colptr(i));
+        }
+    });
+
+    // refinement, the neighbours of the neighbours are also candidates
+    // (each iteration reads the previous neighbours so no locking is needed)
+    const uword expanded = std::min(n_neighbours, refinement_neighbours);
+    for (int iteration = 0; iteration < refinement_iterations; ++iteration) {
+        umat refined(n_neighbours, n);
+        QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+            std::vector<std::pair<double, uword>> candidates;
+            // the last point each candidate was computed for (to skip duplicates)
+            std::vector<uword> visited(n, n);
+            for (uword i = block.first; i < block.second; ++i) {
+                const double *a = columns.colptr(i);
+                visited[i] = i;
+                for (uword l = 0; l < n_neighbours; ++l) {
+                    const uword neighbour = neighbours.at(l, i);
+                    if (visited[neighbour] != i) {
+                        visited[neighbour] = i;
+                        candidates.push_back(
+                            std::make_pair(squaredDistance(a, columns.colptr(neighbour), dims),
+                                           neighbour));
+                    }
+                    for (uword m = 0; m < expanded; ++m) {
+                        const uword point = neighbours.at(m, neighbour);
+                        if (visited[point] != i) {
+                            visited[point] = i;
+                            candidates.push_back(
+                                std::make_pair(squaredDistance(a, columns.colptr(point), dims),
+                                               point));
+                        }
+                    }
+                }
+                keepClosest(candidates, n_neighbours, refined.colptr(i));
+            }
+        });
+        neighbours.swap(refined);
+    }
+    return neighbours;
+}
+
+Graph neighboursGraph(const umat &neighbours)
+{
+    const uword n = neighbours.n_cols;
+    std::vector<std::vector<uword>> adjacency(n);
+    for (uword i = 0; i < n; ++i) {
+        for (uword l = 0; l < neighbours.n_rows; ++l) {
+            const uword j = neighbours.at(l, i);
+            adjacency[i].push_back(j);
+            adjacency[j].push_back(i);
+        }
+    }
+
+    Graph graph;
+    graph.offsets.reserve(n + 1);
+    graph.offsets.push_back(0);
+    for (auto &targets : adjacency) {
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+        graph.targets.insert(graph.targets.end(), targets.begin(), targets.end());
+        graph.offsets.push_back(graph.targets.size());
+        std::vector<uword>().swap(targets);
+    }
+    graph.weights.assign(graph.targets.size(), 1.0);
+    return graph;
+}
+
+Graph sharedNeighboursGraph(const umat &neighbours)
+{
+    const Graph knn = neighboursGraph(neighbours);
+    const uword n = neighbours.n_cols;
+    const uword set_size = neighbours.n_rows + 1;
+
+    // the sorted neighbours of each point (including itself)
+    umat sets(set_size, n);
+    for (uword i = 0; i < n; ++i) {
+        uword *set = sets.colptr(i);
+        std::copy(neighbours.colptr(i), neighbours.colptr(i) + neighbours.n_rows, set);
+        set[set_size - 1] = i;
+        std::sort(set, set + set_size);
+    }
+
+    // the weight of each edge is the Jaccard index of the neighbours of its nodes
+    std::vector<double> weights(knn.targets.size(), 0.0);
+    const auto blocks = STMath::splitRange<uword>(n, 256);
+    QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+        for (uword i = block.first; i < block.second; ++i) {
+            const uword *a = sets.colptr(i);
+            for (uword e = knn.offsets[i]; e < knn.offsets[i + 1]; ++e) {
+                const uword *b = sets.colptr(knn.targets[e]);
+                uword shared = 0;
+                for (uword x = 0, y = 0; x < set_size && y < set_size;) {
+                    if (a[x] < b[y]) {
+                        ++x;
+                    } else if (b[y] < a[x]) {
+                        ++y;
+                    } else {
+                        ++shared;
+                        ++x;
+                        ++y;
+                    }
+                }
+                const double jaccard = static_cast<double>(shared) / (2 * set_size - shared);
+                weights[e] = jaccard >= snn_prune ? jaccard : 0.0;
+            }
+        }
+    });
+
+    // the pruned edges are removed
+    Graph graph;
+    graph.offsets.reserve(n + 1);
+    graph.offsets.push_back(0);
+    for (uword i = 0; i < n; ++i) {
+        for (uword e = knn.offsets[i]; e < knn.offsets[i + 1]; ++e) {
+            if (weights[e] > 0.0) {
+                graph.targets.push_back(knn.targets[e]);
+                graph.weights.push_back(weights[e]);
+            }
+        }
+        graph.offsets.push_back(graph.targets.size());
+    }
+    return graph;
+}
+
+unsigned louvain(const Graph &graph, const double resolution, std::vector<int> &labels)
+{
+    const uword n = graph.size();
+    labels.resize(n);
+    std::iota(labels.begin(), labels.end(), 0);
+    if (n == 0) {
+        return 0;
+    }
+
+    // move nodes and aggregate the communities until nothing changes
+    Graph current = graph;
+    for (int level = 0; level < max_levels; ++level) {
+        std::vector<int> communities(current.size());
+        std::iota(communities.begin(), communities.end(), 0);
+        if (!moveNodes(current, resolution, communities)) {
+            break;
+        }
+        const unsigned n_communities = renumber(communities);
+        for (int &label : labels) {
+            label = communities[label];
+        }
+        if (n_communities == current.size()) {
+            break;
+        }
+        current = aggregate(current, communities, n_communities);
+    }
+    return renumber(labels);
+}
+
+unsigned leiden(const Graph &graph, const double resolution, std::vector<int> &labels)
+{
+    const uword n = graph.size();
+    labels.resize(n);
+    std::iota(labels.begin(), labels.end(), 0);
+    if (n == 0) {
+        return 0;
+    }
+
+    // labels maps each node to a node of the current (aggregated) graph
+    std::mt19937 generator(random_seed);
+    Graph current = graph;
+    std::vector<int> communities(n);
+    std::iota(communities.begin(), communities.end(), 0);
+    for (int level = 0; level < max_levels; ++level) {
+        moveNodes(current, resolution, communities);
+        const unsigned n_communities = renumber(communities);
+        if (n_communities == current.size()) {
+            break;
+        }
+
+        // the graph is aggregated by the refined communities, the communities
+        // are used as the initial partition of the aggregated graph
+        std::vector<int> refined = refine(current, resolution, communities, generator);
+        const unsigned n_refined = renumber(refined);
+        if (n_refined == current.size()) {
+            break;
+        }
+        std::vector<int> initial(n_refined);
+        for (uword node = 0; node < current.size(); ++node) {
+            initial[refined[node]] = communities[node];
+        }
+        for (int &label : labels) {
+            label = refined[label];
+        }
+        current = aggregate(current, refined, n_refined);
+        communities.swap(initial);
+    }
+
+    for (int &label : labels) {
+        label = communities[label];
+    }
+    return renumber(labels);
+}
+
+unsigned mergeSmallCommunities(const Graph &graph,
+                               const unsigned min_size,
+                               const unsigned max_communities,
+                               std::vector<int> &labels)
+{
+    unsigned n_communities = renumber(labels);
+    while (n_communities > 1) {
+        std::vector<unsigned> sizes(n_communities, 0);
+        for (const int label : labels) {
+            ++sizes[label];
+        }
+
+        // the smallest community (too small or too many) connected to others is merged
+        // into the community it is most connected to
+        bool merged = false;
+        for (int c = n_communities - 1;
+             c >= 0 && (sizes[c] < min_size || n_communities > max_communities) && !merged;
+             --c) {
+            std::vector<double> links(n_communities, 0.0);
+            for (uword node = 0; node < labels.size(); ++node) {
+                if (labels[node] != c) {
+                    continue;
+                }
+                for (uword e = graph.offsets[node]; e < graph.offsets[node + 1]; ++e) {
+                    links[labels[graph.targets[e]]] += graph.weights[e];
+                }
+            }
+            links[c] = 0.0;
+            const auto best = std::max_element(links.begin(), links.end());
+            if (*best > 0.0) {
+                const int target = std::distance(links.begin(), best);
+                std::replace(labels.begin(), labels.end(), c, target);
+                merged = true;
+            }
+        }
+        if (!merged) {
+            // the communities left are not connected to others (e.g. isolated spots or
+            // components split by the pruning) so the smallest one is merged into
+            // the biggest one while the limits are not met
+            const int c = n_communities - 1;
+            if (sizes[c] >= min_size && n_communities <= max_communities) {
+                break;
+            }
+            std::replace(labels.begin(), labels.end(), c, 0);
+        }
+        n_communities = renumber(labels);
+    }
+    return n_communities;
+}
+
+unsigned estimateClusters(const mat &counts, std::vector<int> &labels)
+{
+    labels.clear();
+    if (counts.n_rows < 2 || counts.n_cols == 0) {
+        return 0;
+    }
+
+    mat reduced;
+    const uword dims = std::min(reduced_dimensions, counts.n_cols);
+    if (!PCA::compute(counts, dims, true, false, reduced)) {
+        return 0;
+    }
+    const Graph graph = neighboursGraph(approximateNeighbours(reduced, graph_neighbours));
+    louvain(graph, 1.0, labels);
+    // as in scran's quickCluster clusters must contain at least a tenth of the spots
+    const unsigned clusters = mergeSmallCommunities(graph, counts.n_rows / 10,
+                                                    std::numeric_limits<unsigned>::max(),
+                                                    labels);
+    qDebug() << "Estimated number of clusters " << clusters;
+    return clusters;
+}
+
+unsigned graphClusters(const mat &counts, const unsigned max_clusters, std::vector<int> &labels)
+{
+    labels.clear();
+    if (counts.n_rows < 2 || counts.n_cols == 0) {
+        return 0;
+    }
+
+    mat reduced;
+    const uword dims = std::min(reduced_dimensions, counts.n_cols);
+    if (!PCA::compute(counts, dims, true, false, reduced)) {
+        return 0;
+    }
+    const Graph graph = sharedNeighboursGraph(approximateNeighbours(reduced, snn_neighbours));
+    leiden(graph, 1.0, labels);
+    const unsigned clusters = mergeSmallCommunities(graph, 0, max_clusters, labels);
+    qDebug() << "Computed graph clusters " << clusters;
+    return clusters;
+}
+
+} // namespace GraphClustering
@@ -0,0 +1,81 @@
+#ifndef GRAPHCLUSTERING_H
+#define GRAPHCLUSTERING_H
+
+#include <vector>
+
+#include <armadillo>
+
+using namespace arma;
+
+// Native graph based clustering of spots
+// The spots are reduced with PCA, linked to their nearest neighbours and the
+// communities of the resulting graph are detected with modularity optimization
+namespace GraphClustering
+{
+
+// An undirected weighted graph stored as compressed rows
+// (both directions of each edge are stored, self loops only once)
+struct Graph {
+    std::vector<uword> offsets;
+    std::vector<uword> targets;
+    std::vector<double> weights;
+
+    // number of nodes
+    uword size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+};
+
+// Computes the k nearest neighbours (euclidean) of each row of points
+// the result has one column per point with the indexes of its neighbours (closest first)
+umat nearestNeighbours(const mat &points, const uword k);
+
+// Approximate k nearest neighbours of each row of points (same layout as above)
+// Candidates are taken from the leaves of random projection trees and refined with the
+// neighbours of the neighbours, the memory used is linear on the number of points
+// Small inputs are computed exactly
+umat approximateNeighbours(const mat &points, const uword k);
+
+// Creates an undirected graph linking each point to its nearest neighbours
+Graph neighboursGraph(const umat &neighbours);
+
+// Creates an undirected graph linking each point to its nearest neighbours where each
+// edge is weighted by the Jaccard index of the neighbours of its points (shared
+// nearest neighbours), weak edges are removed
+Graph sharedNeighboursGraph(const umat &neighbours);
+
+// Detects the communities of the graph with the Louvain method
+// labels will contain the community (0..n-1, biggest first) of each node
+// It returns the number of communities
+unsigned louvain(const Graph &graph, const double resolution, std::vector<int> &labels);
+
+// Detects the communities of the graph with the Leiden method (Louvain with a
+// refinement step that guarantees well connected communities)
+// labels will contain the community (0..n-1, biggest first) of each node
+// It returns the number of communities
+unsigned leiden(const Graph &graph, const double resolution, std::vector<int> &labels);
+
+// Merges the communities smaller than min_size (and the smallest ones while there are
+// more than max_communities) into the community they are most connected to, the ones
+// not connected to any other community are merged into the biggest one
+// (labels are renumbered biggest first)
+// It returns the number of communities
+unsigned mergeSmallCommunities(const Graph &graph,
+                               const unsigned min_size,
+                               const unsigned max_communities,
+                               std::vector<int> &labels);
+
+// Estimates the number of clusters of the matrix of counts (spots are rows)
+// PCA -> nearest neighbours graph -> Louvain communities
+// labels will contain the cluster (0..k-1) of each spot so they can be reused
+// It returns the estimated number of clusters (0 if there was an error)
+unsigned estimateClusters(const mat &counts, std::vector<int> &labels);
+
+// Clusters the matrix of counts (spots are rows)
+// PCA -> approximate nearest neighbours -> shared neighbours graph -> Leiden communities
+// the smallest clusters are merged so there are at most max_clusters
+// labels will contain the cluster (0..k-1) of each spot
+// It returns the number of clusters (0 if there was an error)
+unsigned graphClusters(const mat &counts, const unsigned max_clusters, std::vector<int> &labels);
+
+} // namespace GraphClustering
+
+#endif // GRAPHCLUSTERING_H
@@ -0,0 +1,261 @@
+#include "PCA.h"
+
+#include "math/Common.h"
+
+#include <QDebug>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+
+// extra random vectors and power iterations used by the randomized SVD
+const uword oversampling = 10;
+const int power_iterations = 3;
+// fixed seed so the same data always gives the same scores
+const unsigned random_seed = 42;
+
+// X * B and X^T * B for dense matrices (BLAS)
+mat product(const mat &X, const mat &B)
+{
+    return X * B;
+}
+
+mat transposedProduct(const mat &X, const mat &B)
+{
+    return X.t() * B;
+}
+
+// X * B for sparse matrices, in parallel over the columns of B
+mat product(const sp_mat &X, const mat &B)
+{
+    mat result(X.n_rows, B.n_cols, fill::zeros);
+    const auto blocks = STMath::splitRange<uword>(B.n_cols, 1);
+    QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+        for (uword l = block.first; l < block.second; ++l) {
+            double *out = result.colptr(l);
+            const double *in = B.colptr(l);
+            for (uword c = 0; c < X.n_cols; ++c) {
+                const double factor = in[c];
+                if (factor == 0.0) {
+                    continue;
+                }
+                for (uword i = X.col_ptrs[c]; i < X.col_ptrs[c + 1]; ++i) {
+                    out[X.row_indices[i]] += X.values[i] * factor;
+                }
+            }
+        }
+    });
+    return result;
+}
+
+// X^T * B for sparse matrices, in parallel over the columns of X
+mat transposedProduct(const sp_mat &X, const mat &B)
+{
+    mat result(X.n_cols, B.n_cols, fill::zeros);
+    const auto blocks = STMath::splitRange<uword>(X.n_cols, 64);
+    QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+        for (uword c = block.first; c < block.second; ++c) {
+            for (uword l = 0; l < B.n_cols; ++l) {
+                const double *in = B.colptr(l);
+                double value = 0.0;
+                for (uword i = X.col_ptrs[c]; i < X.col_ptrs[c + 1]; ++i) {
+                    value += X.values[i] * in[X.row_indices[i]];
+                }
+                result.at(c, l) = value;
+            }
+        }
+    });
+    return result;
+}
+
+// the mean and standard deviation of each column
+void columnStatistics(const mat &X, rowvec &mean, rowvec &sd)
+{
+    mean = arma::mean(X, 0);
+    sd = stddev(X, 0, 0);
+}
+
+void columnStatistics(const sp_mat &X, rowvec &mean, rowvec &sd)
+{
+    const double n = static_cast<double>(X.n_rows);
+    mean.zeros(X.n_cols);
+    sd.zeros(X.n_cols);
+    for (uword c = 0; c < X.n_cols; ++c) {
+        double sum = 0.0;
+        double sum_squares = 0.0;
+        for (uword i = X.col_ptrs[c]; i < X.col_ptrs[c + 1]; ++i) {
+            sum += X.values[i];
+            sum_squares += X.values[i] * X.values[i];
+        }
+        mean.at(c) = sum / n;
+        if (X.n_rows > 1) {
+            const double variance = (sum_squares - n * mean.at(c) * mean.at(c)) / (n - 1.0);
+            sd.at(c) = std::sqrt(std::max(variance, 0.0));
+        }
+    }
+}
+
+// A = (X - 1 * mean) * diag(1 / sd) represented implicitly so X is never copied
+// or densified, only the products of A with thin dense matrices are computed
+template <typename MatType>
+class CenteredMatrix
+{
+public:
+    CenteredMatrix(const MatType &X, const bool center, const bool scale)
+        : m_X(X)
+    {
+        rowvec mean;
+        rowvec sd;
+        columnStatistics(X, mean, sd);
+        m_mean = center ? mean : rowvec(X.n_cols, fill::zeros);
+        m_inv_sd.ones(X.n_cols);
+        if (scale) {
+            // constant columns are left unscaled
+            for (uword c = 0; c < X.n_cols; ++c) {
+                if (sd.at(c) > 0.0) {
+                    m_inv_sd.at(c) = 1.0 / sd.at(c);
+                }
+            }
+        }
+    }
+
+    uword n_rows() const { return m_X.n_rows; }
+    uword n_cols() const { return m_X.n_cols; }
+
+    // A * B
+    mat times(const mat &B) const
+    {
+        mat scaled = B;
+        scaled.each_col() %= m_inv_sd.t();
+        mat result = product(m_X, scaled);
+        result.each_row() -= m_mean * scaled;
+        return result;
+    }
+
+    // A^T * B
+    mat transposedTimes(const mat &B) const
+    {
+        mat result = transposedProduct(m_X, B);
+        result -= m_mean.t() * sum(B, 0);
+        result.each_col() %= m_inv_sd.t();
+        return result;
+    }
+
+    // A as a dense matrix (only for small matrices)
+    mat dense() const
+    {
+        mat A(m_X);
+        A.each_row() -= m_mean;
+        A.each_row() %= m_inv_sd;
+        return A;
+    }
+
+private:
+    const MatType &m_X;
+    rowvec m_mean;
+    rowvec m_inv_sd;
+};
+
+// truncated SVD of A with l components (A ~ U * diag(s) * V^T)
+template <typename MatType>
+bool randomizedSVD(const CenteredMatrix<MatType> &A, const uword l, mat &U, vec &s, mat &V)
+{
+    std::mt19937 generator(random_seed);
+    std::normal_distribution<double> normal;
+    mat omega(A.n_cols(), l);
+    omega.imbue([&]() { return normal(generator); });
+
+    // orthonormal basis of the range of A refined with power iterations
+    mat Q;
+    mat R;
+    if (!qr_econ(Q, R, A.times(omega))) {
+        return false;
+    }
+    for (int i = 0; i < power_iterations; ++i) {
+        if (!qr_econ(Q, R, A.transposedTimes(Q)) || !qr_econ(Q, R, A.times(Q))) {
+            return false;
+        }
+    }
+
+    // B = Q^T * A is small (l x p), B^T = V * diag(s) * Ub^T so A ~ (Q * Ub) * diag(s) * V^T
+    mat Ub;
+    if (!svd_econ(V, s, Ub, A.transposedTimes(Q))) {
+        return false;
+    }
+    U = Q * Ub;
+    return true;
+}
+
+template <typename MatType>
+bool computePCA(const MatType &counts,
+                const int no_components,
+                const bool center,
+                const bool scale,
+                mat &results)
+{
+    results.clear();
+    if (counts.n_rows == 0 || counts.n_cols == 0 || no_components <= 0) {
+        return false;
+    }
+
+    const CenteredMatrix<MatType> A(counts, center, scale);
+    const uword rank = std::min(counts.n_rows, counts.n_cols);
+    const uword k = std::min(static_cast<uword>(no_components), rank);
+    const uword l = std::min(k + oversampling, rank);
+
+    mat U;
+    vec s;
+    mat V;
+    bool ok = false;
+    try {
+        // small matrices are decomposed exactly
+        ok = l == rank ? svd_econ(U, s, V, A.dense()) : randomizedSVD(A, l, U, s, V);
+    } catch (const std::exception &e) {
+        qDebug() << "Error computing PCA " << e.what();
+    }
+    if (!ok) {
+        qDebug() << "PCA decomposition failed";
+        return false;
+    }
+
+    // scores are U * diag(s), the sign of each component is fixed so the largest
+    // loading is positive (components that could not be computed are left to zero)
+    results.zeros(counts.n_rows, no_components);
+    const uword computed = std::min(k, static_cast<uword>(s.n_elem));
+    for (uword j = 0; j < computed; ++j) {
+        const vec loadings = abs(V.col(j));
+        uword index = 0;
+        loadings.max(index);
+        const double sign = V.at(index, j) < 0.0 ? -1.0 : 1.0;
+        results.col(j) = U.col(j) * (s.at(j) * sign);
+    }
+    return true;
+}
+
+} // namespace
+
+namespace PCA
+{
+
+bool compute(const mat &counts,
+             const int no_components,
+             const bool center,
+             const bool scale,
+             mat &results)
+{
+    return computePCA(counts, no_components, center, scale, results);
+}
+
+bool compute(const sp_mat &counts,
+             const int no_components,
+             const bool center,
+             const bool scale,
+             mat &results)
+{
+    return computePCA(counts, no_components, center, scale, results);
+}
+
+} // namespace PCA
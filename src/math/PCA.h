@@ -0,0 +1,34 @@
+#ifndef PCA_H
+#define PCA_H
+
+#include <armadillo>
+
+using namespace arma;
+
+// Native (in-process) principal component analysis
+// The scores are computed with a truncated randomized SVD (Halko et al.) so only
+// a few passes over the data are needed. Centering and scaling are applied implicitly
+// so sparse matrices are never densified and the matrix products run in parallel
+namespace PCA
+{
+
+// Computes the first no_components principal component scores of the matrix of counts
+// (rows are observations, columns are variables), the same as prcomp() + predict() in R
+// results will have one row per observation and no_components columns
+// It returns false if the decomposition failed
+bool compute(const mat &counts,
+             const int no_components,
+             const bool center,
+             const bool scale,
+             mat &results);
+
+// The same as above for sparse matrices (centering is done implicitly)
+bool compute(const sp_mat &counts,
+             const int no_components,
+             const bool center,
+             const bool scale,
+             mat &results);
+
+} // namespace PCA
+
+#endif // PCA_H
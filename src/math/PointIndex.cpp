@@ -0,0 +1,134 @@
+#include "PointIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+PointIndex::PointIndex()
+    : m_nodes()
+{
+}
+
+PointIndex::~PointIndex()
+{
+}
+
+void PointIndex::build(const QVector<QPointF> &points)
+{
+    m_nodes.clear();
+    m_nodes.reserve(points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        m_nodes.push_back({points.at(i).x(), points.at(i).y(), i});
+    }
+    build(0, static_cast<int>(m_nodes.size()), 0);
+}
+
+void PointIndex::clear()
+{
+    m_nodes.clear();
+}
+
+int PointIndex::size() const
+{
+    return static_cast<int>(m_nodes.size());
+}
+
+void PointIndex::build(const int first, const int last, const int depth)
+{
+    if (last - first <= 1) {
+        return;
+    }
+    const int middle = first + (last - first) / 2;
+    const bool by_x = depth % 2 == 0;
+    std::nth_element(m_nodes.begin() + first, m_nodes.begin() + middle, m_nodes.begin() + last,
+                     [by_x] (const Node &lhs, const Node &rhs) {
+        return by_x ? lhs.x < rhs.x : lhs.y < rhs.y;
+    });
+    build(first, middle, depth + 1);
+    build(middle + 1, last, depth + 1);
+}
+
+QVector<int> PointIndex::pointsIn(const QRectF &rect) const
+{
+    std::vector<int> indexes;
+    pointsIn(rect.normalized(), 0, size(), 0, indexes);
+    std::sort(indexes.begin(), indexes.end());
+    QVector<int> points;
+    points.reserve(static_cast<int>(indexes.size()));
+    for (const int index : indexes) {
+        points.push_back(index);
+    }
+    return points;
+}
+
+void PointIndex::pointsIn(const QRectF &rect, const int first, const int last,
+                          const int depth, std::vector<int> &indexes) const
+{
+    if (first >= last) {
+        return;
+    }
+    const int middle = first + (last - first) / 2;
+    const Node &node = m_nodes[middle];
+    if (node.x >= rect.left() && node.x <= rect.right()
+            && node.y >= rect.top() && node.y <= rect.bottom()) {
+        indexes.push_back(node.index);
+    }
+    // the left sub-tree has the values lower or equal than the node and the right
+    // sub-tree the values greater or equal
+    const bool by_x = depth % 2 == 0;
+    const qreal value = by_x ? node.x : node.y;
+    const qreal min = by_x ? rect.left() : rect.top();
+    const qreal max = by_x ? rect.right() : rect.bottom();
+    if (min <= value) {
+        pointsIn(rect, first, middle, depth + 1, indexes);
+    }
+    if (max >= value) {
+        pointsIn(rect, middle + 1, last, depth + 1, indexes);
+    }
+}
+
+int PointIndex::nearest(const QPointF &pos,
+                        const qreal max_distance,
+                        const qreal scale_x,
+                        const qreal scale_y) const
+{
+    qreal best_distance = max_distance * max_distance;
+    int best = -1;
+    nearest(pos, std::abs(scale_x), std::abs(scale_y), 0, size(), 0, best_distance, best);
+    return best;
+}
+
+void PointIndex::nearest(const QPointF &pos, const qreal scale_x, const qreal scale_y,
+                         const int first, const int last, const int depth,
+                         qreal &best_distance, int &best) const
+{
+    if (first >= last) {
+        return;
+    }
+    const int middle = first + (last - first) / 2;
+    const Node &node = m_nodes[middle];
+    const qreal dx = (node.x - pos.x()) * scale_x;
+    const qreal dy = (node.y - pos.y()) * scale_y;
+    const qreal distance = dx * dx + dy * dy;
+    // ties go to the lowest index so the result does not depend on the tree
+    if (distance <= best_distance
+            && (best == -1 || distance < best_distance || node.index < best)) {
+        best_distance = distance;
+        best = node.index;
+    }
+    // the closest side first, the other side only if it can contain a closer point
+    const bool by_x = depth % 2 == 0;
+    const qreal delta = by_x ? dx : dy;
+    const bool left_first = delta >= 0;
+    if (left_first) {
+        nearest(pos, scale_x, scale_y, first, middle, depth + 1, best_distance, best);
+    } else {
+        nearest(pos, scale_x, scale_y, middle + 1, last, depth + 1, best_distance, best);
+    }
+    if (delta * delta <= best_distance) {
+        if (left_first) {
+            nearest(pos, scale_x, scale_y, middle + 1, last, depth + 1, best_distance, best);
+        } else {
+            nearest(pos, scale_x, scale_y, first, middle, depth + 1, best_distance, best);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef POINTINDEX_H
+#define POINTINDEX_H
+
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+
+#include <vector>
+
+// Spatial index of a set of 2D points (for instance the points of a scatter plot)
+// The index is a k-d tree stored in one array (built once in O(n log n)) so
+// rectangle queries and nearest point queries only visit the branches that can
+// contain the result instead of all the points.
+// The points are referred to by their index in the vector given in build()
+class PointIndex
+{
+
+public:
+    PointIndex();
+    ~PointIndex();
+
+    // builds the index of the points (the index of each point is its position in the vector)
+    void build(const QVector<QPointF> &points);
+    void clear();
+
+    // number of points in the index
+    int size() const;
+
+    // the points inside the rectangle (borders included) in ascending order
+    QVector<int> pointsIn(const QRectF &rect) const;
+
+    // the closest point to the position within max_distance (-1 if there is none)
+    // the distances are computed after scaling the axes by scale_x and scale_y
+    // (for instance to measure them in pixels when the points are in data coordinates)
+    int nearest(const QPointF &pos,
+                const qreal max_distance,
+                const qreal scale_x = 1.0,
+                const qreal scale_y = 1.0) const;
+
+private:
+    struct Node {
+        qreal x;
+        qreal y;
+        int index;
+    };
+
+    void build(const int first, const int last, const int depth);
+    void pointsIn(const QRectF &rect, const int first, const int last,
+                  const int depth, std::vector<int> &indexes) const;
+    void nearest(const QPointF &pos, const qreal scale_x, const qreal scale_y,
+                 const int first, const int last, const int depth,
+                 qreal &best_distance, int &best) const;
+
+    // the nodes of the tree, the node of a range is in the middle and the left and
+    // right halves are its sub-trees (split by x on even depths and by y on odd depths)
+    std::vector<Node> m_nodes;
+};
+
+#endif // POINTINDEX_H
@@ -3,20 +3,34 @@
 
 #include <string>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
 
 //RcppArmadillo must be included before RInside
 #include "RcppArmadillo.h"
 #include "RInside.h"
 
 #include "viewPages/SettingsWidget.h"
+#include "profiling/Profiler.h"
 
 namespace RInterface {
 
+// R is not thread safe, every function locks this mutex so the calls from the widgets,
+// the workers and the command line pipeline run one at a time
+// (inline so all the translation units share the same mutex)
+inline QMutex &mutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
 // Computes correlation between two vectors (method can be : pearson, spearman and kendall)
 static double computeCorrelation(const std::vector<double> &A,
                                  const std::vector<double> &B,
                                  const std::string &method)
 {
+    ST_PROFILE_SCOPE("RInterface::computeCorrelation");
+    QMutexLocker locker(&mutex());
     RInside *R = RInside::instancePtr();
     Q_ASSERT(R != nullptr);
     Q_ASSERT(A.size() == B.size());
@@ -45,6 +59,8 @@ static std::vector<unsigned> computeInterpolation(const std::vector<double> &x1,
                                                   const std::vector<double> &y2,
                                                   const std::vector<unsigned> &values)
 {
+    ST_PROFILE_SCOPE("RInterface::computeInterpolation");
+    QMutexLocker locker(&mutex());
     RInside *R = RInside::instancePtr();
     Q_ASSERT(R != nullptr);
     Q_ASSERT(x1.size() == y1.size());
@@ -83,6 +99,8 @@ static void computeDEA(const mat &data,
                        std::vector<std::string> &rows,
                        std::vector<std::string> &cols)
 {
+    ST_PROFILE_SCOPE("RInterface::computeDEA");
+    QMutexLocker locker(&mutex());
     RInside *R = RInside::instancePtr();
     Q_ASSERT(R != nullptr);
     try {
@@ -135,125 +153,52 @@ static void computeDEA(const mat &data,
     }
 }
 
-// Simply computes a PCA for the given matrix of counts
-static void PCA(const mat &counts,
-                const bool scale,
-                const bool center,
-                mat &results)
-{
-    RInside *R = RInside::instancePtr();
-    Q_ASSERT(R != nullptr);
-    try {
-        (*R)["counts"] = counts;
-        (*R)["scale"] = scale;
-        (*R)["center"] = center;
-        const std::string call = "pcs = prcomp(counts, center=center, scale.=scale);"
-                                 "out = predict(pcs);"
-                                 "out[,1:2];";
-        results = Rcpp::as<mat>(R->parseEval(call));
-        qDebug() << "Computed PCA " << results.n_rows;
-        Q_ASSERT(results.n_rows == counts.n_rows);
-    } catch (const std::exception &e) {
-        qDebug() << "Error doing R PCA " << e.what();
-    } catch (...) {
-        qDebug() << "Unknown error computing R PCA";
-    }
-}
-
-// Classifies spots based on gene expression (tSNE or PCA + KMeans or HClust)
-static void spotClassification(const mat &counts,
-                               const bool tsne,
+// Classifies spots based on their reduced coordinates (KMeans or HClust)
+// If init_colors (one per spot) is given the KMeans centers are initialized with the
+// centroids of each color
+static void spotClassification(const mat &coordinates,
                                const bool kmeans,
                                const int num_clusters,
-                               const int inital_dim,
-                               const int no_dims,
-                               const int perplexity,
-                               const int max_iter,
-                               const double theta,
-                               const bool scale,
-                               const bool center,
-                               std::vector<int> &colors,
-                               mat &results)
+                               const std::vector<int> &init_colors,
+                               std::vector<int> &colors)
 {
+    ST_PROFILE_SCOPE("RInterface::spotClassification");
+    QMutexLocker locker(&mutex());
     RInside *R = RInside::instancePtr();
     Q_ASSERT(R != nullptr);
     try {
-        const std::string R_libs = "suppressMessages(library(BiocParallel));"
-                                   "register(MulticoreParam(4));"
-                                   "suppressMessages(library(Rtsne));";
-        R->parseEvalQ(R_libs);
-        (*R)["counts"] = counts;
+        (*R)["coordinates"] = coordinates;
         (*R)["k"] = num_clusters;
-        (*R)["DIM"] = no_dims;
-        (*R)["inital_dim"] = inital_dim;
-        (*R)["perplexity"] = perplexity;
-        (*R)["max_iter"] = max_iter;
-        (*R)["theta"] = theta;
-        (*R)["do_tsne"] = tsne;
+        (*R)["init"] = init_colors;
         (*R)["do_kmeans"] = kmeans;
-        (*R)["scale"] = scale;
-        (*R)["center"] = center;
-        const std::string call1 = "if (do_tsne) {"
-                                  "    tsne_out = Rtsne(counts, dims=DIM,"
-                                  "      theta=theta, check_duplicates=FALSE, pca=TRUE,"
-                                  "      initial_dims=inital_dim, perplexity=perplexity,"
-                                  "      max_iter=max_iter, verbose=FALSE);"
-                                  "    tsne_out = tsne_out$Y[,1:DIM];"
-                                  "} else {"
-                                  "    pcs = prcomp(counts, center=center, scale.=scale);"
-                                  "    tsne_out = predict(pcs);"
-                                  "    tsne_out = tsne_out[,1:DIM];"
-                                  "}";
-        const std::string call2 = "if (do_kmeans) {\n"
-                                  "    fit = kmeans(tsne_out, k)$cluster;"
-                                  "} else {\n"
-                                  "    h = hclust(dist(tsne_out), method='ward.D2');\n"
-                                  "    fit = cutree(h, k=k);\n"
-                                  "}\n"
-                                  "if (!0 %in% fit) {\n"
-                                  "    fit = fit - 1;\n"
-                                  "}";
-        results = Rcpp::as<mat>(R->parseEval(call1));
-        colors = Rcpp::as<std::vector<int>>(R->parseEval(call2));
+        const std::string call = "if (do_kmeans && length(init) == nrow(coordinates)) {\n"
+                                 "    centers = do.call(rbind, lapply(split(seq_len(nrow(coordinates)), init),"
+                                 "      function(i) colMeans(coordinates[i,,drop=FALSE])));\n"
+                                 "    fit = kmeans(coordinates, centers)$cluster;"
+                                 "} else if (do_kmeans) {\n"
+                                 "    fit = kmeans(coordinates, k)$cluster;"
+                                 "} else {\n"
+                                 "    h = hclust(dist(coordinates), method='ward.D2');\n"
+                                 "    fit = cutree(h, k=k);\n"
+                                 "}\n"
+                                 "if (!0 %in% fit) {\n"
+                                 "    fit = fit - 1;\n"
+                                 "}";
+        colors = Rcpp::as<std::vector<int>>(R->parseEval(call));
         qDebug() << "Computed Spot colors " << colors.size();
-        Q_ASSERT(colors.size() == counts.n_rows);
-    } catch (const std::exception &e) {
-        qDebug() << "Error doing R dimensionality reduction " << e.what();
-    } catch (...) {
-        qDebug() << "Unknown error computing R dimensionality reduction";
-    }
-}
-
-// Estimates an approximate number of spot classes (different spots types based on gene expression)
-static unsigned computeSpotClasses(const mat &counts)
-{
-    RInside *R = RInside::instancePtr();
-    Q_ASSERT(R != nullptr);
-    Q_ASSERT(!counts.empty());
-    unsigned clusters = 0;
-    try {
-        const std::string R_libs = "suppressMessages(library(BiocParallel));"
-                                   "register(MulticoreParam(4));"
-                                   "suppressMessages(library(scran))";
-        R->parseEvalQ(R_libs);
-        (*R)["counts"] = counts;
-        const std::string call = "clusters = quickCluster(as.matrix(t(counts)), min.size=dim(counts)[1] / 10);"
-                                 "clusters = length(unique(clusters[clusters != 0]))";
-        clusters = Rcpp::as<double>(R->parseEval(call));
-        qDebug() << "Computed R clusters with quickClust " << clusters;
+        Q_ASSERT(colors.size() == coordinates.n_rows);
     } catch (const std::exception &e) {
-        qDebug() << "Error computing R clusters with quickClust " << e.what();
-        return clusters;
+        qDebug() << "Error doing R spot classification " << e.what();
     } catch (...) {
-        qDebug() << "Unknown error computing R clusters with quickClust";
-        return clusters;
+        qDebug() << "Unknown error computing R spot classification";
     }
-    return clusters;
 }
 
 // Computes size factors using the DESEq2 method (one factor per spot)
 static rowvec computeDESeqFactors(const mat &counts)
 {
+    ST_PROFILE_SCOPE("RInterface::computeDESeqFactors");
+    QMutexLocker locker(&mutex());
     RInside *R = RInside::instancePtr();
     Q_ASSERT(R != nullptr);
     rowvec factors(counts.n_rows);
@@ -291,6 +236,8 @@ static rowvec computeDESeqFactors(const mat &counts)
 // Computes size factors using the SCRAN method (one factor per spot)
 static rowvec computeScranFactors(const mat &counts, const bool do_cluster)
 {
+    ST_PROFILE_SCOPE("RInterface::computeScranFactors");
+    QMutexLocker locker(&mutex());
     Q_UNUSED(do_cluster);
     RInside *R = RInside::instancePtr();
     Q_ASSERT(R != nullptr);
@@ -0,0 +1,61 @@
+#ifndef SNAPSHOTBUFFER_H
+#define SNAPSHOTBUFFER_H
+
+#include <QAtomicInt>
+
+// A lock-free triple buffer that passes the latest value from one producer thread
+// to one consumer thread (for instance the intermediate results of a long computation)
+// The producer never waits for the consumer and the consumer always gets the most
+// recent value, values that were not taken in time are simply overwritten
+template <typename T>
+class SnapshotBuffer
+{
+public:
+    SnapshotBuffer()
+        : m_shared(2)
+        , m_write(0)
+        , m_read(1)
+    {
+    }
+
+    // Stores a new value (producer thread only)
+    void publish(const T &value)
+    {
+        m_buffers[m_write] = value;
+        // the written buffer is exchanged by the shared one and marked as new
+        m_write = m_shared.fetchAndStoreOrdered(m_write | new_value) & index_mask;
+    }
+
+    // Copies the most recent value to value if it was published after the
+    // last call (consumer thread only), it returns false otherwise
+    bool take(T &value)
+    {
+        if ((m_shared.loadAcquire() & new_value) == 0) {
+            return false;
+        }
+        m_read = m_shared.fetchAndStoreOrdered(m_read) & index_mask;
+        value = m_buffers[m_read];
+        return true;
+    }
+
+    // Discards the value that was not taken if any
+    // (neither the producer nor the consumer can be active)
+    void clear()
+    {
+        m_shared.storeRelease(m_shared.loadAcquire() & index_mask);
+    }
+
+private:
+    // the shared index holds the buffer index and a flag for new values
+    static const int index_mask = 3;
+    static const int new_value = 4;
+
+    T m_buffers[3];
+    QAtomicInt m_shared;
+    int m_write;
+    int m_read;
+
+    Q_DISABLE_COPY(SnapshotBuffer)
+};
+
+#endif // SNAPSHOTBUFFER_H
@@ -0,0 +1,452 @@
+#include "TSNE.h"
+
+#include "math/Common.h"
+#include "math/GraphClustering.h"
+#include "math/PCA.h"
+
+#include <QDebug>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace
+{
+
+// the optimization parameters (the same as Rtsne)
+const double learning_rate = 200.0;
+const double initial_momentum = 0.5;
+const double final_momentum = 0.8;
+const int momentum_switch_iter = 250;
+const double exaggeration = 12.0;
+const int stop_lying_iter = 250;
+const double min_gain = 0.01;
+// fixed seed so the same data always gives the same embedding
+const unsigned random_seed = 42;
+// the binary search of the bandwidth of each observation
+const int max_search_steps = 200;
+const double search_tolerance = 1e-5;
+// the points of deeper nodes of the quad tree are considered duplicates
+const int max_tree_depth = 32;
+
+// the symmetric input similarities P stored as compressed rows
+struct Similarities {
+    std::vector<uword> offsets;
+    std::vector<uword> columns;
+    std::vector<double> values;
+};
+
+// Computes the input similarities on the nearest neighbours of each row of X
+// (the bandwidth of each row is adjusted to the given perplexity)
+void computeSimilarities(const mat &X, const double perplexity, Similarities &P)
+{
+    const uword n = X.n_rows;
+    const uword k = std::min(n - 1, static_cast<uword>(3.0 * perplexity));
+    const umat neighbours = GraphClustering::approximateNeighbours(X, k);
+    const mat columns = X.t();
+    const uword dims = columns.n_rows;
+    const double target_entropy = std::log(perplexity);
+
+    // conditional similarities p(j|i), k for each row
+    std::vector<double> conditional(n * k);
+    const auto blocks = STMath::splitRange<uword>(n, 64);
+    QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+        std::vector<double> distances(k);
+        for (uword i = block.first; i < block.second; ++i) {
+            const double *a = columns.colptr(i);
+            for (uword m = 0; m < k; ++m) {
+                const double *b = columns.colptr(neighbours.at(m, i));
+                double distance = 0.0;
+                for (uword d = 0; d < dims; ++d) {
+                    distance += (a[d] - b[d]) * (a[d] - b[d]);
+                }
+                distances[m] = distance;
+            }
+            // the entropy does not change when the distances are shifted so the
+            // closest one is subtracted to avoid underflows
+            const double closest = *std::min_element(distances.begin(), distances.end());
+            double *p = conditional.data() + i * k;
+            double beta = 1.0;
+            double min_beta = -std::numeric_limits<double>::max();
+            double max_beta = std::numeric_limits<double>::max();
+            double sum_p = 0.0;
+            for (int step = 0; step < max_search_steps; ++step) {
+                sum_p = 0.0;
+                double weighted = 0.0;
+                for (uword m = 0; m < k; ++m) {
+                    p[m] = std::exp(-beta * (distances[m] - closest));
+                    sum_p += p[m];
+                    weighted += (distances[m] - closest) * p[m];
+                }
+                const double entropy = beta * weighted / sum_p + std::log(sum_p);
+                if (std::abs(entropy - target_entropy) < search_tolerance) {
+                    break;
+                }
+                if (entropy > target_entropy) {
+                    min_beta = beta;
+                    beta = max_beta == std::numeric_limits<double>::max()
+                            ? beta * 2.0 : (beta + max_beta) / 2.0;
+                } else {
+                    max_beta = beta;
+                    beta = min_beta == -std::numeric_limits<double>::max()
+                            ? beta / 2.0 : (beta + min_beta) / 2.0;
+                }
+            }
+            for (uword m = 0; m < k; ++m) {
+                p[m] /= sum_p;
+            }
+        }
+    });
+
+    // P = (p(j|i) + p(i|j)) / 2n, each p(j|i) goes to the rows i and j
+    std::vector<uword> degrees(n + 1, 0);
+    for (uword i = 0; i < n; ++i) {
+        degrees[i + 1] += k;
+        for (uword m = 0; m < k; ++m) {
+            ++degrees[neighbours.at(m, i) + 1];
+        }
+    }
+    std::partial_sum(degrees.begin(), degrees.end(), degrees.begin());
+    std::vector<std::pair<uword, double>> entries(degrees[n]);
+    std::vector<uword> positions(degrees.begin(), degrees.end() - 1);
+    for (uword i = 0; i < n; ++i) {
+        for (uword m = 0; m < k; ++m) {
+            const uword j = neighbours.at(m, i);
+            const double value = conditional[i * k + m];
+            entries[positions[i]++] = std::make_pair(j, value);
+            entries[positions[j]++] = std::make_pair(i, value);
+        }
+    }
+
+    // the entries of each row are sorted and the duplicates added
+    const double normalization = 1.0 / (2.0 * n);
+    std::vector<uword> unique(n, 0);
+    QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+        for (uword i = block.first; i < block.second; ++i) {
+            const auto begin = entries.begin() + degrees[i];
+            const auto end = entries.begin() + degrees[i + 1];
+            std::sort(begin, end, [](const std::pair<uword, double> &a,
+                                     const std::pair<uword, double> &b) {
+                return a.first < b.first;
+            });
+            auto last = begin;
+            for (auto it = begin; it != end; ++it) {
+                if (it != begin && it->first == last->first) {
+                    last->second += it->second;
+                } else {
+                    if (it != begin) {
+                        ++last;
+                    }
+                    *last = *it;
+                }
+            }
+            unique[i] = begin == end ? 0 : (last - begin) + 1;
+        }
+    });
+
+    P.offsets.assign(n + 1, 0);
+    for (uword i = 0; i < n; ++i) {
+        P.offsets[i + 1] = P.offsets[i] + unique[i];
+    }
+    P.columns.resize(P.offsets[n]);
+    P.values.resize(P.offsets[n]);
+    for (uword i = 0; i < n; ++i) {
+        for (uword e = 0; e < unique[i]; ++e) {
+            const auto &entry = entries[degrees[i] + e];
+            P.columns[P.offsets[i] + e] = entry.first;
+            P.values[P.offsets[i] + e] = entry.second * normalization;
+        }
+    }
+}
+
+// A quad tree of the embedding that stores the center of mass of each cell
+// so the repulsive forces of far away cells are computed at once (Barnes-Hut)
+class QuadTree
+{
+public:
+    // the coordinates are interleaved (x0, y0, x1, y1...)
+    explicit QuadTree(const std::vector<double> &Y)
+    {
+        const uword n = Y.size() / 2;
+        double min_x = std::numeric_limits<double>::max();
+        double min_y = min_x;
+        double max_x = -min_x;
+        double max_y = -min_x;
+        for (uword i = 0; i < n; ++i) {
+            min_x = std::min(min_x, Y[2 * i]);
+            max_x = std::max(max_x, Y[2 * i]);
+            min_y = std::min(min_y, Y[2 * i + 1]);
+            max_y = std::max(max_y, Y[2 * i + 1]);
+        }
+        Node root;
+        root.center_x = (min_x + max_x) / 2.0;
+        root.center_y = (min_y + max_y) / 2.0;
+        root.half_width = std::max(max_x - min_x, max_y - min_y) / 2.0 + 1e-5;
+        m_nodes.reserve(4 * n + 1);
+        m_nodes.push_back(root);
+        for (uword i = 0; i < n; ++i) {
+            insert(Y[2 * i], Y[2 * i + 1]);
+        }
+    }
+
+    // Adds the repulsive forces on the point (x, y) (part of the tree) and the
+    // sum of the unnormalized similarities q to the other points
+    void repulsion(const double x,
+                   const double y,
+                   const double theta_squared,
+                   double &force_x,
+                   double &force_y,
+                   double &sum_q) const
+    {
+        // depth first (each internal node visited adds its 4 children)
+        int stack[3 * max_tree_depth + 8];
+        int size = 0;
+        stack[size++] = 0;
+        while (size > 0) {
+            const Node &node = m_nodes[stack[--size]];
+            if (node.count == 0) {
+                continue;
+            }
+            const double dx = x - node.mass_x;
+            const double dy = y - node.mass_y;
+            const double distance = dx * dx + dy * dy;
+            const double width = 2.0 * node.half_width;
+            const bool leaf = node.children < 0;
+            if (leaf || width * width < theta_squared * distance) {
+                double mass = node.count;
+                if (leaf && distance == 0.0) {
+                    // the leaf contains the point itself
+                    mass -= 1.0;
+                }
+                const double q = 1.0 / (1.0 + distance);
+                sum_q += mass * q;
+                const double factor = mass * q * q;
+                force_x += factor * dx;
+                force_y += factor * dy;
+            } else {
+                for (int c = 0; c < 4; ++c) {
+                    stack[size++] = node.children + c;
+                }
+            }
+        }
+    }
+
+private:
+    struct Node {
+        double center_x = 0.0;
+        double center_y = 0.0;
+        double half_width = 0.0;
+        double mass_x = 0.0;
+        double mass_y = 0.0;
+        double count = 0.0;
+        int children = -1;
+    };
+
+    int child(const Node &node, const double x, const double y) const
+    {
+        return node.children + (x >= node.center_x ? 1 : 0) + (y >= node.center_y ? 2 : 0);
+    }
+
+    void subdivide(const int index)
+    {
+        const int first = static_cast<int>(m_nodes.size());
+        const double half_width = m_nodes[index].half_width / 2.0;
+        for (int c = 0; c < 4; ++c) {
+            Node node;
+            node.half_width = half_width;
+            node.center_x = m_nodes[index].center_x + ((c & 1) ? half_width : -half_width);
+            node.center_y = m_nodes[index].center_y + ((c & 2) ? half_width : -half_width);
+            m_nodes.push_back(node);
+        }
+        m_nodes[index].children = first;
+    }
+
+    void insert(const double x, const double y)
+    {
+        int index = 0;
+        for (int depth = 0;; ++depth) {
+            Node &node = m_nodes[index];
+            const double count = node.count;
+            const double mass_x = node.mass_x;
+            const double mass_y = node.mass_y;
+            node.mass_x = (mass_x * count + x) / (count + 1.0);
+            node.mass_y = (mass_y * count + y) / (count + 1.0);
+            node.count = count + 1.0;
+            if (node.children < 0) {
+                // the points of a leaf are all at its center of mass
+                if (count == 0.0 || (mass_x == x && mass_y == y) || depth >= max_tree_depth) {
+                    return;
+                }
+                subdivide(index);
+                Node &moved = m_nodes[child(m_nodes[index], mass_x, mass_y)];
+                moved.mass_x = mass_x;
+                moved.mass_y = mass_y;
+                moved.count = count;
+            }
+            index = child(m_nodes[index], x, y);
+        }
+    }
+
+    std::vector<Node> m_nodes;
+};
+
+} // namespace
+
+TSNE::TSNE()
+    : m_stop(0)
+{
+}
+
+TSNE::~TSNE()
+{
+}
+
+bool TSNE::compute(const mat &counts,
+                   const int inital_dim,
+                   const double perplexity,
+                   const double theta,
+                   const int max_iter,
+                   const int snapshot_interval,
+                   mat &results)
+{
+    results.clear();
+    const uword n = counts.n_rows;
+    if (n == 0 || perplexity <= 0.0 || 3.0 * perplexity > n - 1) {
+        qDebug() << "t-SNE perplexity is too large for the number of observations";
+        return false;
+    }
+
+    // the input is reduced with PCA (like Rtsne) and normalized to avoid numerical problems
+    mat X;
+    if (inital_dim > 0 && static_cast<uword>(inital_dim) < counts.n_cols) {
+        if (!PCA::compute(counts, inital_dim, true, false, X)) {
+            return false;
+        }
+    } else {
+        X = counts;
+    }
+    X.each_row() -= mean(X, 0);
+    const double max_value = abs(X).max();
+    if (max_value > 0.0) {
+        X /= max_value;
+    }
+
+    Similarities P;
+    computeSimilarities(X, perplexity, P);
+
+    // random initial embedding (interleaved coordinates) and optimization state
+    std::mt19937 generator(random_seed);
+    std::normal_distribution<double> normal(0.0, 1e-4);
+    std::vector<double> Y(2 * n);
+    for (double &value : Y) {
+        value = normal(generator);
+    }
+    std::vector<double> update(2 * n, 0.0);
+    std::vector<double> gains(2 * n, 1.0);
+    std::vector<double> attraction(2 * n);
+    std::vector<double> repulsion(2 * n);
+    std::vector<double> sums_q(n);
+    const double theta_squared = theta * theta;
+    const auto blocks = STMath::splitRange<uword>(n, 64);
+
+    Snapshot snapshot;
+    snapshot.embedding.set_size(n, 2);
+    for (int iter = 0; iter < max_iter && !isStopped(); ++iter) {
+        const double momentum = iter < momentum_switch_iter ? initial_momentum : final_momentum;
+        const double factor = iter < stop_lying_iter ? exaggeration : 1.0;
+
+        // the attractive (neighbours) and repulsive (tree) forces of each point
+        const QuadTree tree(Y);
+        QtConcurrent::blockingMap(blocks, [&](const QPair<uword, uword> &block) {
+            for (uword i = block.first; i < block.second; ++i) {
+                const double x = Y[2 * i];
+                const double y = Y[2 * i + 1];
+                double attraction_x = 0.0;
+                double attraction_y = 0.0;
+                for (uword e = P.offsets[i]; e < P.offsets[i + 1]; ++e) {
+                    const uword j = P.columns[e];
+                    const double dx = x - Y[2 * j];
+                    const double dy = y - Y[2 * j + 1];
+                    const double value = P.values[e] / (1.0 + dx * dx + dy * dy);
+                    attraction_x += value * dx;
+                    attraction_y += value * dy;
+                }
+                attraction[2 * i] = attraction_x;
+                attraction[2 * i + 1] = attraction_y;
+                double repulsion_x = 0.0;
+                double repulsion_y = 0.0;
+                double sum_q = 0.0;
+                tree.repulsion(x, y, theta_squared, repulsion_x, repulsion_y, sum_q);
+                repulsion[2 * i] = repulsion_x;
+                repulsion[2 * i + 1] = repulsion_y;
+                sums_q[i] = sum_q;
+            }
+        });
+        double sum_q = std::accumulate(sums_q.begin(), sums_q.end(), 0.0);
+        if (sum_q <= 0.0) {
+            sum_q = 1.0;
+        }
+
+        // gradient descent with momentum and adaptive gains
+        double mean_x = 0.0;
+        double mean_y = 0.0;
+        for (uword d = 0; d < 2 * n; ++d) {
+            const double gradient = factor * attraction[d] - repulsion[d] / sum_q;
+            gains[d] = (gradient > 0.0) != (update[d] > 0.0) ? gains[d] + 0.2 : gains[d] * 0.8;
+            gains[d] = std::max(gains[d], min_gain);
+            update[d] = momentum * update[d] - learning_rate * gains[d] * gradient;
+            Y[d] += update[d];
+            if (d % 2 == 0) {
+                mean_x += Y[d];
+            } else {
+                mean_y += Y[d];
+            }
+        }
+        mean_x /= n;
+        mean_y /= n;
+        for (uword i = 0; i < n; ++i) {
+            Y[2 * i] -= mean_x;
+            Y[2 * i + 1] -= mean_y;
+        }
+
+        if (snapshot_interval > 0 && (iter + 1) % snapshot_interval == 0) {
+            for (uword i = 0; i < n; ++i) {
+                snapshot.embedding.at(i, 0) = Y[2 * i];
+                snapshot.embedding.at(i, 1) = Y[2 * i + 1];
+            }
+            snapshot.iteration = iter + 1;
+            m_snapshots.publish(snapshot);
+        }
+    }
+
+    results.set_size(n, 2);
+    for (uword i = 0; i < n; ++i) {
+        results.at(i, 0) = Y[2 * i];
+        results.at(i, 1) = Y[2 * i + 1];
+    }
+    return true;
+}
+
+void TSNE::stop()
+{
+    m_stop.storeRelease(1);
+}
+
+bool TSNE::isStopped() const
+{
+    return m_stop.loadAcquire() != 0;
+}
+
+bool TSNE::snapshot(Snapshot &snapshot)
+{
+    return m_snapshots.take(snapshot);
+}
+
+void TSNE::reset()
+{
+    m_stop.storeRelease(0);
+    m_snapshots.clear();
+}
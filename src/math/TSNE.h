@@ -0,0 +1,64 @@
+#ifndef TSNE_H
+#define TSNE_H
+
+#include "math/SnapshotBuffer.h"
+
+#include <QAtomicInt>
+
+#include <armadillo>
+
+using namespace arma;
+
+// Native (in-process) Barnes-Hut t-SNE (van der Maaten 2014) to compute 2D embeddings
+// The input similarities are computed on the approximate nearest neighbours of each
+// observation and the repulsive forces are approximated with a quad tree
+// The optimization publishes the embedding every few iterations so it can be shown
+// while it converges and it can be stopped at any time from another thread
+class TSNE
+{
+
+public:
+    // an intermediate embedding (one row per observation) and its iteration
+    struct Snapshot {
+        mat embedding;
+        int iteration = 0;
+    };
+
+    TSNE();
+    ~TSNE();
+
+    // Computes the 2D embedding of the matrix of counts (rows are observations)
+    // The data is first reduced to inital_dim principal components (centered)
+    // theta is the Barnes-Hut accuracy (0 is exact) and the embedding is published
+    // every snapshot_interval iterations (see snapshot())
+    // results will contain the last embedding (also when the optimization was stopped)
+    // It returns false if there was an error (e.g. the perplexity is too big for the data)
+    bool compute(const mat &counts,
+                 const int inital_dim,
+                 const double perplexity,
+                 const double theta,
+                 const int max_iter,
+                 const int snapshot_interval,
+                 mat &results);
+
+    // Requests the running computation to stop after the current iteration (thread safe)
+    void stop();
+
+    // True if stop() was called since the last reset()
+    bool isStopped() const;
+
+    // Gets the last published embedding if there is a new one since the last call
+    // It must always be called from the same thread (usually the GUI thread)
+    bool snapshot(Snapshot &snapshot);
+
+    // Clears the stop request and the pending snapshot (not while computing)
+    void reset();
+
+private:
+    QAtomicInt m_stop;
+    SnapshotBuffer<Snapshot> m_snapshots;
+
+    Q_DISABLE_COPY(TSNE)
+};
+
+#endif // TSNE_H
@@ -0,0 +1,172 @@
+#include "TissueMask.h"
+
+#include "math/Common.h"
+
+#include <QImage>
+#include <QtConcurrent>
+#include <QtAlgorithms>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// minimum number of sampled rows processed by each concurrent task
+static const int min_rows_stripe = 16;
+
+TissueMask::TissueMask()
+    : m_width(0)
+    , m_height(0)
+    , m_step(1)
+    , m_threshold(127)
+    , m_words_per_row(0)
+    , m_bits()
+{
+}
+
+TissueMask::~TissueMask()
+{
+}
+
+TissueMask TissueMask::compute(const QImage &image, const int step, const int threshold)
+{
+    TissueMask mask;
+    if (image.isNull() || step < 1) {
+        return mask;
+    }
+
+    const QImage gray_scale = image.format() == QImage::Format_Grayscale8
+            ? image : image.convertToFormat(QImage::Format_Grayscale8);
+
+    mask.m_step = step;
+    mask.m_threshold = qBound(0, threshold, 255);
+    mask.m_width = (gray_scale.width() + step - 1) / step;
+    mask.m_height = (gray_scale.height() + step - 1) / step;
+    mask.m_words_per_row = (mask.m_width + 63) / 64;
+    mask.m_bits = QVector<quint64>(mask.m_words_per_row * mask.m_height, 0);
+
+    // split the sampled rows into stripes (one per task)
+    const auto stripes = STMath::splitRange(mask.m_height, min_rows_stripe);
+
+    // the stripes write to disjoint words of the mask so no locking is needed
+    quint64 *bits = mask.m_bits.data();
+    QtConcurrent::blockingMap(stripes, [&](const QPair<int, int> &stripe) {
+        mask.computeRows(gray_scale, stripe.first, stripe.second, bits);
+    });
+
+    return mask;
+}
+
+void TissueMask::computeRows(const QImage &gray_scale,
+                             const int row_begin,
+                             const int row_end,
+                             quint64 *bits) const
+{
+    const quint8 threshold = static_cast<quint8>(m_threshold);
+#ifdef __SSE2__
+    // SSE2 has only signed byte comparisons so both sides are shifted by 128
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold ^ 0x80));
+#endif
+    for (int row = row_begin; row < row_end; ++row) {
+        const uchar *line = gray_scale.constScanLine(row * m_step);
+        quint64 *row_bits = bits + row * m_words_per_row;
+        int column = 0;
+        if (m_step == 1) {
+#ifdef __SSE2__
+            // 16 pixels per iteration, the 16 bits always fall in the same word
+            for (; column + 16 <= m_width; column += 16) {
+                const __m128i pixels
+                    = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + column));
+                const __m128i above = _mm_cmpgt_epi8(_mm_xor_si128(pixels, bias), limit);
+                const quint64 word = static_cast<quint16>(_mm_movemask_epi8(above));
+                row_bits[column >> 6] |= word << (column & 63);
+            }
+#endif
+            for (; column < m_width; ++column) {
+                row_bits[column >> 6] |= static_cast<quint64>(line[column] > threshold)
+                                         << (column & 63);
+            }
+        } else {
+            for (; column < m_width; ++column) {
+                row_bits[column >> 6] |= static_cast<quint64>(line[column * m_step] > threshold)
+                                         << (column & 63);
+            }
+        }
+    }
+}
+
+bool TissueMask::isNull() const
+{
+    return m_bits.isEmpty();
+}
+
+int TissueMask::width() const
+{
+    return m_width;
+}
+
+int TissueMask::height() const
+{
+    return m_height;
+}
+
+int TissueMask::step() const
+{
+    return m_step;
+}
+
+bool TissueMask::contains(const int column, const int row) const
+{
+    if (column < 0 || row < 0 || column >= m_width || row >= m_height) {
+        return false;
+    }
+    const quint64 word = m_bits.at(row * m_words_per_row + (column >> 6));
+    return (word >> (column & 63)) & 1;
+}
+
+bool TissueMask::containsPixel(const QPointF &point) const
+{
+    if (point.x() < 0 || point.y() < 0) {
+        return false;
+    }
+    return contains(static_cast<int>(point.x()) / m_step, static_cast<int>(point.y()) / m_step);
+}
+
+int TissueMask::count() const
+{
+    int total = 0;
+    for (const quint64 word : m_bits) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
+
+QList<QPointF> TissueMask::points() const
+{
+    QList<QPointF> points;
+    points.reserve(count());
+    for (int row = 0; row < m_height; ++row) {
+        const quint64 *row_bits = m_bits.constData() + row * m_words_per_row;
+        for (int index = 0; index < m_words_per_row; ++index) {
+            // iterate only the set bits of each word
+            quint64 word = row_bits[index];
+            while (word != 0) {
+                const int column = index * 64 + static_cast<int>(qCountTrailingZeroBits(word));
+                points.append(QPointF(column * m_step, row * m_step));
+                word &= word - 1;
+            }
+        }
+    }
+    return points;
+}
+
+const QVector<quint64> &TissueMask::bits() const
+{
+    return m_bits;
+}
+
+int TissueMask::wordsPerRow() const
+{
+    return m_words_per_row;
+}
@@ -0,0 +1,70 @@
+#ifndef TISSUEMASK_H
+#define TISSUEMASK_H
+
+#include <QVector>
+#include <QList>
+#include <QPointF>
+
+class QImage;
+
+// TissueMask is a compact binary mask of the tissue area of an image
+// The image is converted to grayscale once and thresholded scanline by scanline
+// (using SIMD when available) in parallel stripes of rows. The mask is stored as one
+// bit per sampled pixel (rows are padded to 64 bits) so it can be queried cheaply
+// by other tissue detection features
+class TissueMask
+{
+
+public:
+    TissueMask();
+    ~TissueMask();
+
+    // computes the mask of the image sampling one pixel every step pixels
+    // a pixel is inside the tissue if its gray value is above the threshold (0-255)
+    static TissueMask compute(const QImage &image,
+                              const int step = 1,
+                              const int threshold = 127);
+
+    // true if the mask has not been computed
+    bool isNull() const;
+
+    // the size of the mask (number of sampled columns and rows)
+    int width() const;
+    int height() const;
+
+    // the sampling step used (in image pixels)
+    int step() const;
+
+    // true if the sample (column, row) is inside the tissue
+    bool contains(const int column, const int row) const;
+
+    // true if the image point (in pixels) falls in a sample inside the tissue
+    bool containsPixel(const QPointF &point) const;
+
+    // the total number of samples inside the tissue
+    int count() const;
+
+    // the positions (in image pixels) of the samples inside the tissue (row by row)
+    QList<QPointF> points() const;
+
+    // the raw bits of the mask and the number of 64 bits words per row
+    const QVector<quint64> &bits() const;
+    int wordsPerRow() const;
+
+private:
+    // thresholds the sampled rows [row_begin, row_end) of the gray scale image
+    // into bits (each stripe of rows writes to its own words so it is thread safe)
+    void computeRows(const QImage &gray_scale,
+                     const int row_begin,
+                     const int row_end,
+                     quint64 *bits) const;
+
+    int m_width;
+    int m_height;
+    int m_step;
+    int m_threshold;
+    int m_words_per_row;
+    QVector<quint64> m_bits;
+};
+
+#endif // TISSUEMASK_H
@@ -7,13 +7,16 @@
 #include <QDateTime>
 
 #include "data/Dataset.h"
+#include "profiling/MemoryAccounting.h"
 #include <set>
 
-static const int COLUMN_NUMBER = 3;
+static const int COLUMN_NUMBER = 4;
 
 DatasetItemModel::DatasetItemModel(QObject *parent)
     : QAbstractTableModel(parent)
 {
+    connect(&MemoryAccounting::instance(), &MemoryAccounting::usageChanged,
+            this, &DatasetItemModel::slotMemoryChanged);
 }
 
 DatasetItemModel::~DatasetItemModel()
@@ -41,11 +44,39 @@ QVariant DatasetItemModel::data(const QModelIndex &index, int role) const
             return item.statTissue();
         case Species:
             return item.statSpecies();
+        case Memory: {
+            // only the opened datasets hold memory
+            const MemoryAccounting &accounting = MemoryAccounting::instance();
+            const qint64 bytes = accounting.usage(MemoryAccounting::Datasets, item.name()).total()
+                    + accounting.usage(MemoryAccounting::Caches, item.name()).total()
+                    + accounting.usage(MemoryAccounting::Textures, item.name()).total();
+            return bytes > 0 ? MemoryAccounting::formatBytes(bytes) : QString();
+        }
        default:
             return QVariant(QVariant::Invalid);
         }
     }
 
+    if (role == Qt::ToolTipRole && index.column() == Memory) {
+        const Dataset &item = m_datasets_reference.at(index.row());
+        const MemoryAccounting &accounting = MemoryAccounting::instance();
+        const auto counts = accounting.usage(MemoryAccounting::Datasets, item.name());
+        const auto caches = accounting.usage(MemoryAccounting::Caches, item.name());
+        const auto textures = accounting.usage(MemoryAccounting::Textures, item.name());
+        if (counts.total() + caches.total() + textures.total() == 0) {
+            return QVariant(QVariant::Invalid);
+        }
+        return tr("Data: %1\nCaches: %2\nTissue image: %3 (GPU %4)")
+                .arg(MemoryAccounting::formatBytes(counts.total()))
+                .arg(MemoryAccounting::formatBytes(caches.total()))
+                .arg(MemoryAccounting::formatBytes(textures.cpu_bytes))
+                .arg(MemoryAccounting::formatBytes(textures.gpu_bytes));
+    }
+
+    if (role == Qt::TextAlignmentRole && index.column() == Memory) {
+        return Qt::AlignRight;
+    }
+
     if (role == Qt::ForegroundRole && index.column() == Name) {
         return QColor(0, 155, 60);
     }
@@ -63,6 +94,9 @@ QVariant DatasetItemModel::headerData(int section, Qt::Orientation orientation,
             return tr("Tissue name");
         case Species:
             return tr("Species name");
+        case Memory:
+            return tr("The memory held by the dataset when it is opened (data, caches and "
+                      "tissue image)");
         default:
             return QVariant(QVariant::Invalid);
         }
@@ -76,6 +110,8 @@ QVariant DatasetItemModel::headerData(int section, Qt::Orientation orientation,
             return tr("Tissue");
         case Species:
             return tr("Species");
+        case Memory:
+            return tr("Memory");
         default:
             return QVariant(QVariant::Invalid);
         }
@@ -86,6 +122,7 @@ QVariant DatasetItemModel::headerData(int section, Qt::Orientation orientation,
         case Name:
         case Tissue:
         case Species:
+        case Memory:
             return Qt::AlignLeft;
         default:
             return QVariant(QVariant::Invalid);
@@ -140,3 +177,10 @@ void DatasetItemModel::clear()
     m_datasets_reference.clear();
     endResetModel();
 }
+
+void DatasetItemModel::slotMemoryChanged()
+{
+    if (!m_datasets_reference.empty()) {
+        emit dataChanged(index(0, Memory), index(m_datasets_reference.size() - 1, Memory));
+    }
+}
@@ -21,6 +21,7 @@ public:
         Name = 0,
         Tissue = 1,
         Species = 2,
+        Memory = 3,
     };
 
     explicit DatasetItemModel(QObject *parent = 0);
@@ -43,6 +44,10 @@ public:
     // Clear the current model
     void clear();
 
+private slots:
+    // the memory accounted for the datasets has changed
+    void slotMemoryChanged();
+
 private:
     QList<Dataset> m_datasets_reference;
 
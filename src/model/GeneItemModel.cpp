@@ -6,13 +6,14 @@
 #include <QStringList>
 #include <QItemSelection>
 
-#include "data/Gene.h"
 #include "data/Dataset.h"
 
 static const int COLUMN_NUMBER = 5;
 
 GeneItemModel::GeneItemModel(QObject *parent)
-    : QAbstractTableModel(parent)
+    : LazyTableModel(parent)
+    , m_data()
+    , m_count_display()
 {
 }
 
@@ -22,14 +23,15 @@ GeneItemModel::~GeneItemModel()
 
 QVariant GeneItemModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || m_items_reference.empty()) {
+    if (!index.isValid() || m_data.isNull()) {
         return QVariant(QVariant::Invalid);
     }
 
-    const auto item = m_items_reference.at(index.row());
+    const auto &items = m_data->genes();
+    const int gene = item(index.row());
 
     if ((role == Qt::DisplayRole || role == Qt::UserRole) && index.column() == Name) {
-        return item->name();
+        return items.name(gene);
     }
 
     if (role == Qt::ForegroundRole && index.column() == Name) {
@@ -37,19 +39,23 @@ QVariant GeneItemModel::data(const QModelIndex &index, int role) const
     }
 
     if ((role == Qt::CheckStateRole || role == Qt::UserRole) && index.column() == Show) {
-        return item->visible() ? Qt::Checked : Qt::Unchecked;
+        return items.visible(gene) ? Qt::Checked : Qt::Unchecked;
     }
 
     if (role == Qt::DecorationRole && index.column() == Color) {
-        return item->color();
+        return items.color(gene);
     }
 
-    if ((role == Qt::DisplayRole || role == Qt::UserRole) && index.column() == Count) {
-        return item->totalCount();
+    if (role == Qt::DisplayRole && index.column() == Count) {
+        return m_count_display.at(gene);
+    }
+
+    if (role == Qt::UserRole && index.column() == Count) {
+        return items.totalCount(gene);
     }
 
     if ((role == Qt::DisplayRole || role == Qt::UserRole) && index.column() == CutOff) {
-        return item->cut_off();
+        return items.cut_off(gene);
     }
 
     if (role == Qt::TextAlignmentRole) {
@@ -74,11 +80,13 @@ QVariant GeneItemModel::data(const QModelIndex &index, int role) const
 
 bool GeneItemModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (index.isValid() && role == Qt::EditRole && index.column() == CutOff) {
-        auto item = m_items_reference.at(index.row());
+    if (index.isValid() && !m_data.isNull() && role == Qt::EditRole && index.column() == CutOff) {
+        auto &items = m_data->genes();
         const float new_cutoff = value.toFloat();
-        if (item->cut_off() != new_cutoff && new_cutoff >= 0.0) {
-            item->cut_off(new_cutoff);
+        const int gene = item(index.row());
+        if (items.cut_off(gene) != new_cutoff && new_cutoff >= 0.0) {
+            items.setCutOff(gene, new_cutoff);
+            invalidateColumn(CutOff);
             emit dataChanged(index, index);
             emit signalGeneCutOffChanged();
             return true;
@@ -146,11 +154,6 @@ QVariant GeneItemModel::headerData(int section, Qt::Orientation orientation, int
     return QVariant(QVariant::Invalid);
 }
 
-int GeneItemModel::rowCount(const QModelIndex &parent) const
-{
-    return parent.isValid() ? 0 : m_items_reference.size();
-}
-
 int GeneItemModel::columnCount(const QModelIndex &parent) const
 {
     return parent.isValid() ? 0 : COLUMN_NUMBER;
@@ -158,7 +161,7 @@ int GeneItemModel::columnCount(const QModelIndex &parent) const
 
 Qt::ItemFlags GeneItemModel::flags(const QModelIndex &index) const
 {
-    Qt::ItemFlags defaultFlags = QAbstractTableModel::flags(index);
+    Qt::ItemFlags defaultFlags = LazyTableModel::flags(index);
 
     if (!index.isValid()) {
         return defaultFlags;
@@ -180,59 +183,118 @@ Qt::ItemFlags GeneItemModel::flags(const QModelIndex &index) const
     return defaultFlags;
 }
 
+QVector<int> GeneItemModel::findGenes(const QString &text) const
+{
+    if (m_data.isNull()) {
+        return QVector<int>();
+    }
+    QVector<int> rows = m_data->geneSearchIndex().findSubstring(text);
+    for (auto &gene : rows) {
+        gene = row(gene);
+    }
+    return rows;
+}
+
+void GeneItemModel::sort(int column, Qt::SortOrder order)
+{
+    // the visibility and the colors can be changed outside of the table
+    invalidateColumn(Show);
+    invalidateColumn(Color);
+    LazyTableModel::sort(column, order);
+}
+
 void GeneItemModel::loadDataset(const Dataset &dataset)
 {
-    Q_UNUSED(dataset)
     beginResetModel();
-    m_items_reference = dataset.data()->genes();
+    m_data = dataset.data();
+    const auto &items = m_data->genes();
+    m_count_display.resize(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        m_count_display[i] = QString::number(items.totalCount(i));
+    }
+    resetItems(items.size());
     endResetModel();
 }
 
 void GeneItemModel::clear()
 {
     beginResetModel();
-    m_items_reference.clear();
+    m_data.clear();
+    m_count_display.clear();
+    resetItems(0);
     endResetModel();
 }
 
 void GeneItemModel::setVisibility(const QItemSelection &selection, bool visible)
 {
-    if (m_items_reference.empty()) {
+    if (m_data.isNull()) {
         return;
     }
+    auto &items = m_data->genes();
 
-    // get unique indexes from the user selection
+    // get unique rows from the user selection (by ranges to not expand every cell)
     QSet<int> rows;
-    for (const auto &index : selection.indexes()) {
-        rows.insert(index.row());
+    for (const auto &range : selection) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            rows.insert(row);
+        }
     }
 
-    // update the genes
+    // update the genes (all at once)
+    QVector<int> genes;
     for (const auto &row : rows) {
-        auto gene = m_items_reference.at(row);
-        if (gene->visible() != visible) {
-            gene->visible(visible);
+        const int gene = item(row);
+        if (items.visible(gene) != visible) {
+            genes.push_back(gene);
         }
     }
+    if (!genes.empty()) {
+        items.setVisible(genes, visible);
+    }
 }
 
 void GeneItemModel::setColor(const QItemSelection &selection, const QColor &color)
 {
-    if (m_items_reference.empty()) {
+    if (m_data.isNull()) {
         return;
     }
+    auto &items = m_data->genes();
 
-    // get unique indexes from the user selection
+    // get unique rows from the user selection (by ranges to not expand every cell)
     QSet<int> rows;
-    for (const auto &index : selection.indexes()) {
-        rows.insert(index.row());
+    for (const auto &range : selection) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            rows.insert(row);
+        }
     }
 
-    // update the genes
+    // update the genes (all at once)
+    QVector<int> genes;
     for (const auto &row : rows) {
-        auto gene = m_items_reference.at(row);
-        if (color.isValid() && gene->color() != color) {
-            gene->color(color);
+        const int gene = item(row);
+        if (color.isValid() && items.color(gene) != color) {
+            genes.push_back(gene);
         }
     }
+    if (!genes.empty()) {
+        items.setColor(genes, color);
+    }
+}
+
+bool GeneItemModel::lessThan(const int column, const int lhs, const int rhs) const
+{
+    const auto &items = m_data->genes();
+    switch (column) {
+    case Show:
+        return items.visible(lhs) < items.visible(rhs);
+    case Name:
+        return QString::compare(items.name(lhs), items.name(rhs), Qt::CaseInsensitive) < 0;
+    case Count:
+        return items.totalCount(lhs) < items.totalCount(rhs);
+    case CutOff:
+        return items.cut_off(lhs) < items.cut_off(rhs);
+    case Color:
+        return items.rgba(lhs) < items.rgba(rhs);
+    }
+    return lhs < rhs;
 }
@@ -1,7 +1,7 @@
 #ifndef GENEFITEMMODEL_H
 #define GENEFITEMMODEL_H
 
-#include <QAbstractTableModel>
+#include "model/LazyTableModel.h"
 #include "data/STData.h"
 
 class QModelIndex;
@@ -13,7 +13,7 @@ class Dataset;
 // Wrapper model class for the gene data (specific to a dataset).
 // Primarily used to enumerate the genes in the cell view (genes table)
 // and allow the user to interact with individual genes.
-class GeneItemModel : public QAbstractTableModel
+class GeneItemModel : public LazyTableModel
 {
     Q_OBJECT
     Q_ENUMS(Column)
@@ -24,7 +24,6 @@ public:
     explicit GeneItemModel(QObject *parent = 0);
     virtual ~GeneItemModel();
 
-    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
@@ -34,6 +33,8 @@ public:
                         Qt::Orientation orientation,
                         int role = Qt::DisplayRole) const override;
 
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
     Qt::ItemFlags flags(const QModelIndex &index) const override;
 
     // this function will set to visible the genes included in the selection
@@ -44,6 +45,10 @@ public:
     // and emit a signal with the modified genes
     void setColor(const QItemSelection &selection, const QColor &color);
 
+    // returns the rows of the genes whose name contains the text (case insensitive)
+    // (the rows that are not fetched yet are not returned, see fetchAll())
+    QVector<int> findGenes(const QString &text) const;
+
     // reload the model's data from the dataset (genes)
     void loadDataset(const Dataset &dataset);
 
@@ -56,8 +61,14 @@ signals:
     // to notify that the user has changed a gene's cut-off
     void signalGeneCutOffChanged();
 
+protected:
+    bool lessThan(const int column, const int lhs, const int rhs) const override;
+
 private:
-    STData::GeneListType m_items_reference;
+    // the dataset whose genes are shown (each row shows a gene, see item())
+    QSharedPointer<STData> m_data;
+    // cached display strings of the total counts
+    QVector<QString> m_count_display;
 
     Q_DISABLE_COPY(GeneItemModel)
 };
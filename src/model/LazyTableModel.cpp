@@ -0,0 +1,150 @@
+#include "LazyTableModel.h"
+
+#include <algorithm>
+#include <numeric>
+
+// number of rows fetched at once
+static const int FETCH_BATCH_SIZE = 1000;
+
+LazyTableModel::LazyTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_fetched(0)
+    , m_sort_column(-1)
+    , m_sort_order(Qt::AscendingOrder)
+    , m_items()
+    , m_rows()
+    , m_column_orders()
+{
+}
+
+LazyTableModel::~LazyTableModel()
+{
+}
+
+int LazyTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_fetched;
+}
+
+bool LazyTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_fetched < m_items.size();
+}
+
+void LazyTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    const int to_fetch = std::min(FETCH_BATCH_SIZE, m_items.size() - m_fetched);
+    beginInsertRows(QModelIndex(), m_fetched, m_fetched + to_fetch - 1);
+    m_fetched += to_fetch;
+    endInsertRows();
+}
+
+void LazyTableModel::fetchAll()
+{
+    if (m_fetched == m_items.size()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_fetched, m_items.size() - 1);
+    m_fetched = m_items.size();
+    endInsertRows();
+}
+
+void LazyTableModel::sort(int column, Qt::SortOrder order)
+{
+    m_sort_column = column;
+    m_sort_order = order;
+    if (m_items.empty()) {
+        return;
+    }
+
+    const QVector<int> items = itemsOrder(column, order);
+    QVector<int> rows(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        rows[items.at(i)] = i;
+    }
+
+    // the rows referenced by the views (selections) must be fetched in the new order
+    const QModelIndexList old_indexes = persistentIndexList();
+    int last_row = m_fetched - 1;
+    for (const auto &index : old_indexes) {
+        last_row = std::max(last_row, rows.at(m_items.at(index.row())));
+    }
+    if (last_row >= m_fetched) {
+        beginInsertRows(QModelIndex(), m_fetched, last_row);
+        m_fetched = last_row + 1;
+        endInsertRows();
+    }
+
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(),
+                                QAbstractItemModel::VerticalSortHint);
+    QModelIndexList new_indexes;
+    new_indexes.reserve(old_indexes.size());
+    for (const auto &index : old_indexes) {
+        new_indexes.push_back(createIndex(rows.at(m_items.at(index.row())), index.column()));
+    }
+    m_items = items;
+    m_rows = rows;
+    changePersistentIndexList(old_indexes, new_indexes);
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+}
+
+int LazyTableModel::item(const int row) const
+{
+    return m_items.at(row);
+}
+
+int LazyTableModel::row(const int item) const
+{
+    return item >= 0 && item < m_rows.size() ? m_rows.at(item) : -1;
+}
+
+void LazyTableModel::resetItems(const int count)
+{
+    m_column_orders.clear();
+    m_items.resize(count);
+    std::iota(m_items.begin(), m_items.end(), 0);
+    if (m_sort_column != -1 && count > 0) {
+        m_items = itemsOrder(m_sort_column, m_sort_order);
+    }
+    m_rows.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_rows[m_items.at(i)] = i;
+    }
+    m_fetched = std::min(FETCH_BATCH_SIZE, count);
+}
+
+void LazyTableModel::invalidateColumn(const int column)
+{
+    m_column_orders.remove(column);
+}
+
+const QVector<int> &LazyTableModel::columnOrder(const int column)
+{
+    auto it = m_column_orders.find(column);
+    if (it == m_column_orders.end()) {
+        QVector<int> order(m_items.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [=] (const int lhs, const int rhs) {
+            return lessThan(column, lhs, rhs);
+        });
+        it = m_column_orders.insert(column, order);
+    }
+    return it.value();
+}
+
+QVector<int> LazyTableModel::itemsOrder(const int column, const Qt::SortOrder order)
+{
+    if (column < 0 || column >= columnCount()) {
+        QVector<int> items(m_items.size());
+        std::iota(items.begin(), items.end(), 0);
+        return items;
+    }
+    QVector<int> items = columnOrder(column);
+    if (order == Qt::DescendingOrder) {
+        std::reverse(items.begin(), items.end());
+    }
+    return items;
+}
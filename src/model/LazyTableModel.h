@@ -0,0 +1,63 @@
+#ifndef LAZYTABLEMODEL_H
+#define LAZYTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QVector>
+
+// Base table model for the items (genes or spots) of a dataset.
+// The rows are fetched in batches (canFetchMore/fetchMore) so the views only
+// create what is shown, and the model is sorted by itself: the sort order of each
+// column is computed once (with lessThan()) and cached until the column changes.
+// Each row shows an item (the index of the gene/spot in the dataset), item() and
+// row() map one to the other in the current sort order.
+class LazyTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit LazyTableModel(QObject *parent = 0);
+    virtual ~LazyTableModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // fetches all the rows that are not fetched yet (for instance to filter them)
+    void fetchAll();
+
+    // the item shown in the row
+    int item(const int row) const;
+    // the row of the item (-1 if the item does not exist)
+    int row(const int item) const;
+
+protected:
+    // sets the number of items (in the current sort order) and fetches the first rows
+    // it must be called between beginResetModel() and endResetModel()
+    void resetItems(const int count);
+
+    // discards the cached sort order of the column (when its values change)
+    void invalidateColumn(const int column);
+
+    // true if item lhs goes before item rhs when the column is sorted in ascending order
+    virtual bool lessThan(const int column, const int lhs, const int rhs) const = 0;
+
+private:
+    // the items sorted in ascending order by the column (cached)
+    const QVector<int> &columnOrder(const int column);
+    // the items in the given sort order (identity if no column)
+    QVector<int> itemsOrder(const int column, const Qt::SortOrder order);
+
+    int m_fetched;
+    int m_sort_column;
+    Qt::SortOrder m_sort_order;
+    // row -> item and item -> row
+    QVector<int> m_items;
+    QVector<int> m_rows;
+    QHash<int, QVector<int>> m_column_orders;
+
+    Q_DISABLE_COPY(LazyTableModel)
+};
+
+#endif // LAZYTABLEMODEL_H
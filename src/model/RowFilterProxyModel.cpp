@@ -0,0 +1,38 @@
+#include "RowFilterProxyModel.h"
+
+RowFilterProxyModel::RowFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_filter_enabled(false)
+    , m_rows()
+{
+}
+
+RowFilterProxyModel::~RowFilterProxyModel()
+{
+}
+
+void RowFilterProxyModel::setRowFilter(const QVector<int> &rows)
+{
+    const int row_count = sourceModel() != nullptr ? sourceModel()->rowCount() : 0;
+    m_rows.fill(false, row_count);
+    for (const int row : rows) {
+        if (row >= 0 && row < row_count) {
+            m_rows.setBit(row);
+        }
+    }
+    m_filter_enabled = true;
+    invalidateFilter();
+}
+
+void RowFilterProxyModel::clearRowFilter()
+{
+    m_filter_enabled = false;
+    m_rows.clear();
+    invalidateFilter();
+}
+
+bool RowFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+{
+    Q_UNUSED(source_parent)
+    return !m_filter_enabled || (source_row < m_rows.size() && m_rows.testBit(source_row));
+}
@@ -0,0 +1,33 @@
+#ifndef ROWFILTERPROXYMODEL_H
+#define ROWFILTERPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QBitArray>
+
+// Sorting proxy model whose filter is a precomputed set of rows of the source model
+// (for instance the result of a search index) so the filter is never evaluated on the
+// contents of the rows
+class RowFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit RowFilterProxyModel(QObject *parent = 0);
+    virtual ~RowFilterProxyModel();
+
+    // only the given rows of the source model will be accepted
+    void setRowFilter(const QVector<int> &rows);
+    // all the rows of the source model will be accepted
+    void clearRowFilter();
+
+protected:
+    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+
+private:
+    bool m_filter_enabled;
+    QBitArray m_rows;
+
+    Q_DISABLE_COPY(RowFilterProxyModel)
+};
+
+#endif // ROWFILTERPROXYMODEL_H
@@ -6,13 +6,14 @@
 #include <QStringList>
 #include <QItemSelection>
 
-#include "data/Spot.h"
 #include "data/Dataset.h"
 
 static const int COLUMN_NUMBER = 4;
 
 SpotItemModel::SpotItemModel(QObject *parent)
-    : QAbstractTableModel(parent)
+    : LazyTableModel(parent)
+    , m_data()
+    , m_count_display()
 {
 }
 
@@ -67,11 +68,6 @@ QVariant SpotItemModel::headerData(int section, Qt::Orientation orientation, int
     return QVariant(QVariant::Invalid);
 }
 
-int SpotItemModel::rowCount(const QModelIndex &parent) const
-{
-    return parent.isValid() ? 0 : m_items_reference.size();
-}
-
 int SpotItemModel::columnCount(const QModelIndex &parent) const
 {
     return parent.isValid() ? 0 : COLUMN_NUMBER;
@@ -79,14 +75,15 @@ int SpotItemModel::columnCount(const QModelIndex &parent) const
 
 QVariant SpotItemModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || m_items_reference.empty()) {
+    if (!index.isValid() || m_data.isNull()) {
         return QVariant(QVariant::Invalid);
     }
 
-    const auto item = m_items_reference.at(index.row());
+    const auto &items = m_data->spots();
+    const int spot = item(index.row());
 
     if ((role == Qt::DisplayRole || role == Qt::UserRole) && index.column() == Name) {
-        return item->name();
+        return items.name(spot);
     }
 
     if (role == Qt::ForegroundRole && index.column() == Name) {
@@ -94,15 +91,19 @@ QVariant SpotItemModel::data(const QModelIndex &index, int role) const
     }
 
     if ((role == Qt::CheckStateRole || role == Qt::UserRole) && index.column() == Show) {
-        return item->visible() ? Qt::Checked : Qt::Unchecked;
+        return items.visible(spot) ? Qt::Checked : Qt::Unchecked;
     }
 
-    if ((role == Qt::DisplayRole || role == Qt::UserRole) && index.column() == Count) {
-        return item->totalCount();
+    if (role == Qt::DisplayRole && index.column() == Count) {
+        return m_count_display.at(spot);
+    }
+
+    if (role == Qt::UserRole && index.column() == Count) {
+        return items.totalCount(spot);
     }
 
     if (role == Qt::DecorationRole && index.column() == Color) {
-        return item->color();
+        return items.color(spot);
     }
 
     if (role == Qt::TextAlignmentRole) {
@@ -125,7 +126,7 @@ QVariant SpotItemModel::data(const QModelIndex &index, int role) const
 
 Qt::ItemFlags SpotItemModel::flags(const QModelIndex &index) const
 {
-    Qt::ItemFlags defaultFlags = QAbstractTableModel::flags(index);
+    Qt::ItemFlags defaultFlags = LazyTableModel::flags(index);
 
     if (!index.isValid()) {
         return defaultFlags;
@@ -145,59 +146,104 @@ Qt::ItemFlags SpotItemModel::flags(const QModelIndex &index) const
     return defaultFlags;
 }
 
+void SpotItemModel::sort(int column, Qt::SortOrder order)
+{
+    // the visibility and the colors can be changed outside of the table
+    invalidateColumn(Show);
+    invalidateColumn(Color);
+    LazyTableModel::sort(column, order);
+}
+
 void SpotItemModel::loadDataset(const Dataset &dataset)
 {
-    Q_UNUSED(dataset)
     beginResetModel();
-    m_items_reference = dataset.data()->spots();
+    m_data = dataset.data();
+    const auto &items = m_data->spots();
+    m_count_display.resize(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        m_count_display[i] = QString::number(items.totalCount(i));
+    }
+    resetItems(items.size());
     endResetModel();
 }
 
 void SpotItemModel::clear()
 {
     beginResetModel();
-    m_items_reference.clear();
+    m_data.clear();
+    m_count_display.clear();
+    resetItems(0);
     endResetModel();
 }
 
 void SpotItemModel::setVisibility(const QItemSelection &selection, bool visible)
 {
-    if (m_items_reference.empty()) {
+    if (m_data.isNull()) {
         return;
     }
+    auto &items = m_data->spots();
 
-    // get unique indexes from the user selection
+    // get unique rows from the user selection (by ranges to not expand every cell)
     QSet<int> rows;
-    for (const auto &index : selection.indexes()) {
-        rows.insert(index.row());
+    for (const auto &range : selection) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            rows.insert(row);
+        }
     }
 
-    // update the spots
+    // update the spots (all at once)
+    QVector<int> spots;
     for (const auto &row : rows) {
-        auto spot = m_items_reference.at(row);
-        if (spot->visible() != visible) {
-            spot->visible(visible);
+        const int spot = item(row);
+        if (items.visible(spot) != visible) {
+            spots.push_back(spot);
         }
     }
+    if (!spots.empty()) {
+        items.setVisible(spots, visible);
+    }
 }
 
 void SpotItemModel::setColor(const QItemSelection &selection, const QColor &color)
 {
-    if (m_items_reference.empty()) {
+    if (m_data.isNull()) {
         return;
     }
+    auto &items = m_data->spots();
 
-    // get unique indexes from the user selection
+    // get unique rows from the user selection (by ranges to not expand every cell)
     QSet<int> rows;
-    for (const auto &index : selection.indexes()) {
-        rows.insert(index.row());
+    for (const auto &range : selection) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            rows.insert(row);
+        }
     }
 
-    // update the spots
+    // update the spots (all at once)
+    QVector<int> spots;
     for (const auto &row : rows) {
-        auto spot = m_items_reference.at(row);
-        if (color.isValid() && spot->color() != color) {
-            spot->color(color);
+        const int spot = item(row);
+        if (color.isValid() && items.color(spot) != color) {
+            spots.push_back(spot);
         }
     }
+    if (!spots.empty()) {
+        items.setColor(spots, color);
+    }
+}
+
+bool SpotItemModel::lessThan(const int column, const int lhs, const int rhs) const
+{
+    const auto &items = m_data->spots();
+    switch (column) {
+    case Show:
+        return items.visible(lhs) < items.visible(rhs);
+    case Name:
+        return QString::compare(items.name(lhs), items.name(rhs), Qt::CaseInsensitive) < 0;
+    case Count:
+        return items.totalCount(lhs) < items.totalCount(rhs);
+    case Color:
+        return items.rgba(lhs) < items.rgba(rhs);
+    }
+    return lhs < rhs;
 }
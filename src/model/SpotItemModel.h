@@ -1,7 +1,7 @@
 #ifndef SPOTITEMMODEL_H
 #define SPOTITEMMODEL_H
 
-#include <QAbstractTableModel>
+#include "model/LazyTableModel.h"
 #include "data/STData.h"
 
 class QModelIndex;
@@ -13,7 +13,7 @@ class Dataset;
 // Wrapper model class for the spot data (specific to a dataset).
 // Primarily used to enumerate the spots in the cell view (spots table)
 // and allow the user to interact with individual spots.
-class SpotItemModel : public QAbstractTableModel
+class SpotItemModel : public LazyTableModel
 {
     Q_OBJECT
     Q_ENUMS(Column)
@@ -27,9 +27,10 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation,
                         int role = Qt::DisplayRole) const override;
     // Basic functionality:
-    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
     Qt::ItemFlags flags(const QModelIndex& index) const override;
 
     // this function will set to visible the spots included in the selection
@@ -50,8 +51,14 @@ public slots:
 
 signals:
 
+protected:
+    bool lessThan(const int column, const int lhs, const int rhs) const override;
+
 private:
-    STData::SpotListType m_items_reference;
+    // the dataset whose spots are shown (each row shows a spot, see item())
+    QSharedPointer<STData> m_data;
+    // cached display strings of the total counts
+    QVector<QString> m_count_display;
 
     Q_DISABLE_COPY(SpotItemModel)
 };
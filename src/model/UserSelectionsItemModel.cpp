@@ -1,12 +1,13 @@
 #include "UserSelectionsItemModel.h"
 #include "data/UserSelection.h"
+#include "profiling/MemoryAccounting.h"
 #include <QDebug>
 #include <QItemSelection>
 #include <QDateTime>
 #include <QColor>
 #include <set>
 
-static const int COLUMN_NUMBER = 4;
+static const int COLUMN_NUMBER = 5;
 
 UserSelectionsItemModel::UserSelectionsItemModel(QObject *parent)
     : QAbstractTableModel(parent)
@@ -34,11 +35,17 @@ QVariant UserSelectionsItemModel::data(const QModelIndex &index, int role) const
             return QString::number(item.totalGenes());
         case NSpots:
             return QString::number(item.totalSpots());
+        case Memory:
+            return MemoryAccounting::formatBytes(item.memoryUsage());
         default:
             return QVariant(QVariant::Invalid);
         }
     }
 
+    if (role == Qt::ToolTipRole && index.column() == Memory && item.isView()) {
+        return tr("The counts are shared with the dataset");
+    }
+
     if (role == Qt::ForegroundRole && index.column() == Name) {
         return QColor(0, 155, 60);
     }
@@ -47,6 +54,7 @@ QVariant UserSelectionsItemModel::data(const QModelIndex &index, int role) const
         switch (index.column()) {
         case NGenes:
         case NSpots:
+        case Memory:
             return Qt::AlignRight;
         default:
             return QVariant(QVariant::Invalid);
@@ -70,6 +78,8 @@ QVariant UserSelectionsItemModel::headerData(int section,
             return tr("Genes");
         case NSpots:
             return tr("Spots");
+        case Memory:
+            return tr("Memory");
         default:
             return QVariant(QVariant::Invalid);
         }
@@ -85,6 +95,9 @@ QVariant UserSelectionsItemModel::headerData(int section,
             return tr("The number of unique genes in the selection");
         case NSpots:
             return tr("The total number of spots in the selection");
+        case Memory:
+            return tr("The memory held by the selection (the selections made in a dataset "
+                      "share its counts)");
         default:
             return QVariant(QVariant::Invalid);
         }
@@ -96,6 +109,7 @@ QVariant UserSelectionsItemModel::headerData(int section,
         case Dataset:
         case NGenes:
         case NSpots:
+        case Memory:
             return Qt::AlignLeft;
         default:
             return QVariant(QVariant::Invalid);
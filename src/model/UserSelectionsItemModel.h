@@ -21,6 +21,7 @@ public:
         Dataset = 1,
         NGenes = 2,
         NSpots = 3,
+        Memory = 4,
     };
 
     explicit UserSelectionsItemModel(QObject *parent = 0);
@@ -0,0 +1,407 @@
+#include "MemoryAccounting.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QSettings>
+
+#include <algorithm>
+
+namespace
+{
+
+// the settings group and keys of the budgets (in the order of the categories)
+const QString BUDGETS_GROUP = QStringLiteral("MemoryBudgets");
+const char *const BUDGET_KEYS[MemoryAccounting::CATEGORIES]
+        = {"Datasets", "Selections", "Caches", "Textures"};
+// the caches can use up to 512 MB by default, the rest has no budget
+const qint64 DEFAULT_CACHES_BUDGET = 512LL * 1024 * 1024;
+const qint64 MEGABYTE = 1024 * 1024;
+
+// an estimate of the memory of a string (the element of the container, the header of the
+// data and the characters), the strings shared by several containers are counted by each
+template <typename Container>
+qint64 stringsMemory(const Container &strings)
+{
+    qint64 bytes = 0;
+    for (const QString &string : strings) {
+        bytes += sizeof(QString) + sizeof(QArrayData) + (string.size() + 1) * sizeof(QChar);
+    }
+    return bytes;
+}
+
+}
+
+MemoryAccounting::Usage::Usage(const qint64 cpu, const qint64 gpu)
+    : cpu_bytes(cpu)
+    , gpu_bytes(gpu)
+{
+}
+
+qint64 MemoryAccounting::Usage::total() const
+{
+    return cpu_bytes + gpu_bytes;
+}
+
+MemoryAccounting::Usage &MemoryAccounting::Usage::operator+=(const Usage &other)
+{
+    cpu_bytes += other.cpu_bytes;
+    gpu_bytes += other.gpu_bytes;
+    return *this;
+}
+
+MemoryAccounting::MemoryAccounting()
+    : QObject()
+    , m_mutex()
+    , m_accounts()
+    , m_caches()
+    , m_clock(0)
+    , m_enforcement_pending(false)
+{
+    for (int i = 0; i < CATEGORIES; ++i) {
+        m_budgets[i] = 0;
+        m_exceeded[i] = false;
+    }
+    m_budgets[Caches] = DEFAULT_CACHES_BUDGET;
+
+    // the budgets are enforced in the thread of the application
+    const QCoreApplication *application = QCoreApplication::instance();
+    if (application != nullptr && thread() != application->thread()) {
+        moveToThread(application->thread());
+    }
+}
+
+MemoryAccounting::~MemoryAccounting()
+{
+}
+
+MemoryAccounting &MemoryAccounting::instance()
+{
+    static MemoryAccounting accounting;
+    return accounting;
+}
+
+void MemoryAccounting::account(const void *owner,
+                               const Category category,
+                               const QString &name,
+                               const Usage &usage)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = std::find_if(m_accounts.begin(), m_accounts.end(),
+                               [&](const Account &account) {
+                                   return account.owner == owner
+                                           && account.category == category
+                                           && account.name == name;
+                               });
+        if (it != m_accounts.end()) {
+            it->usage = usage;
+        } else {
+            m_accounts.push_back({owner, category, name, usage});
+        }
+    }
+    emit usageChanged();
+    scheduleEnforcement();
+}
+
+void MemoryAccounting::release(const void *owner)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        const auto is_owner = [owner](const auto &item) { return item.owner == owner; };
+        m_accounts.erase(std::remove_if(m_accounts.begin(), m_accounts.end(), is_owner),
+                         m_accounts.end());
+        m_caches.erase(std::remove_if(m_caches.begin(), m_caches.end(), is_owner),
+                       m_caches.end());
+    }
+    emit usageChanged();
+}
+
+void MemoryAccounting::registerCache(const void *owner,
+                                     const QString &name,
+                                     const QString &cache,
+                                     const std::function<qint64()> &size,
+                                     const std::function<void()> &evict)
+{
+    const qint64 bytes = size();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_caches.push_back({owner, name, cache, size, evict, bytes, ++m_clock});
+    }
+    emit usageChanged();
+    scheduleEnforcement();
+}
+
+void MemoryAccounting::touchCache(const void *owner, const QString &cache)
+{
+    QMutexLocker locker(&m_mutex);
+    for (Cache &item : m_caches) {
+        if (item.owner == owner && item.cache == cache) {
+            item.used = ++m_clock;
+        }
+    }
+}
+
+void MemoryAccounting::updateCache(const void *owner, const QString &cache)
+{
+    // the cache is measured without the lock (the owner may use the accounting)
+    std::function<qint64()> size;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const Cache &item : m_caches) {
+            if (item.owner == owner && item.cache == cache) {
+                size = item.size;
+            }
+        }
+    }
+    if (!size) {
+        return;
+    }
+    const qint64 bytes = size();
+    {
+        QMutexLocker locker(&m_mutex);
+        for (Cache &item : m_caches) {
+            if (item.owner == owner && item.cache == cache) {
+                item.bytes = bytes;
+                item.used = ++m_clock;
+            }
+        }
+    }
+    emit usageChanged();
+    scheduleEnforcement();
+}
+
+MemoryAccounting::Usage MemoryAccounting::usage(const Category category,
+                                                const QString &name) const
+{
+    QMutexLocker locker(&m_mutex);
+    Usage usage;
+    for (const Account &account : m_accounts) {
+        if (account.category == category && account.name == name) {
+            usage += account.usage;
+        }
+    }
+    if (category == Caches) {
+        for (const Cache &cache : m_caches) {
+            if (cache.name == name) {
+                usage.cpu_bytes += cache.bytes;
+            }
+        }
+    }
+    return usage;
+}
+
+MemoryAccounting::Usage MemoryAccounting::total(const Category category) const
+{
+    QMutexLocker locker(&m_mutex);
+    Usage usage;
+    for (const Account &account : m_accounts) {
+        if (account.category == category) {
+            usage += account.usage;
+        }
+    }
+    if (category == Caches) {
+        for (const Cache &cache : m_caches) {
+            usage.cpu_bytes += cache.bytes;
+        }
+    }
+    return usage;
+}
+
+qint64 MemoryAccounting::budget(const Category category) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_budgets[category];
+}
+
+void MemoryAccounting::setBudget(const Category category, const qint64 bytes)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_budgets[category] = std::max<qint64>(bytes, 0);
+    }
+    scheduleEnforcement();
+}
+
+void MemoryAccounting::loadBudgets(QSettings &settings)
+{
+    settings.beginGroup(BUDGETS_GROUP);
+    for (int i = 0; i < CATEGORIES; ++i) {
+        const Category category = static_cast<Category>(i);
+        const qint64 megabytes = settings.value(BUDGET_KEYS[i],
+                                                budget(category) / MEGABYTE).toLongLong();
+        setBudget(category, megabytes * MEGABYTE);
+    }
+    settings.endGroup();
+}
+
+void MemoryAccounting::saveBudgets(QSettings &settings) const
+{
+    settings.beginGroup(BUDGETS_GROUP);
+    for (int i = 0; i < CATEGORIES; ++i) {
+        settings.setValue(BUDGET_KEYS[i], budget(static_cast<Category>(i)) / MEGABYTE);
+    }
+    settings.endGroup();
+}
+
+QString MemoryAccounting::categoryName(const Category category)
+{
+    switch (category) {
+    case Datasets:
+        return tr("Datasets");
+    case Selections:
+        return tr("Selections");
+    case Caches:
+        return tr("Caches");
+    case Textures:
+        return tr("Tissue images");
+    default:
+        return QString();
+    }
+}
+
+QString MemoryAccounting::formatBytes(const qint64 bytes)
+{
+    if (bytes < 1024) {
+        return tr("%1 B").arg(bytes);
+    } else if (bytes < MEGABYTE) {
+        return tr("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    } else if (bytes < 1024 * MEGABYTE) {
+        return tr("%1 MB").arg(bytes / static_cast<double>(MEGABYTE), 0, 'f', 1);
+    }
+    return tr("%1 GB").arg(bytes / (1024.0 * MEGABYTE), 0, 'f', 2);
+}
+
+qint64 MemoryAccounting::stringsMemoryUsage(const QList<QString> &strings)
+{
+    return stringsMemory(strings);
+}
+
+qint64 MemoryAccounting::stringsMemoryUsage(const QVector<QString> &strings)
+{
+    return stringsMemory(strings);
+}
+
+qint64 MemoryAccounting::enforceBudgets()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_enforcement_pending = false;
+    }
+
+    const auto exceeded = [this](const Category category) {
+        const qint64 bytes = budget(category);
+        return bytes > 0 && total(category).total() > bytes;
+    };
+
+    // the datasets and the selections cannot be released so the caches are evicted
+    // when they exceed their budgets, except the caches of the datasets (they would be
+    // computed again as soon as the dataset is used, the user is only warned)
+    qint64 released = 0;
+    qint64 bytes = 0;
+    if (exceeded(Datasets) || exceeded(Selections)) {
+        while ((bytes = evictLeastRecentlyUsed(false)) > 0) {
+            released += bytes;
+        }
+    }
+    while (exceeded(Caches) && (bytes = evictLeastRecentlyUsed(true)) > 0) {
+        released += bytes;
+    }
+
+    for (int i = 0; i < CATEGORIES; ++i) {
+        const Category category = static_cast<Category>(i);
+        const bool is_exceeded = exceeded(category);
+        bool notify = false;
+        {
+            QMutexLocker locker(&m_mutex);
+            notify = is_exceeded && !m_exceeded[i];
+            m_exceeded[i] = is_exceeded;
+        }
+        if (notify) {
+            emit budgetExceeded(category, total(category).total(), budget(category));
+        }
+    }
+
+    if (released > 0) {
+        emit usageChanged();
+    }
+    return released;
+}
+
+qint64 MemoryAccounting::evictCaches()
+{
+    qint64 released = 0;
+    qint64 bytes = 0;
+    while ((bytes = evictLeastRecentlyUsed(true)) > 0) {
+        released += bytes;
+    }
+    if (released > 0) {
+        emit usageChanged();
+    }
+    return released;
+}
+
+qint64 MemoryAccounting::evictLeastRecentlyUsed(const bool datasets)
+{
+    // the cache is evicted without the lock (the owner may use the accounting)
+    std::function<qint64()> size;
+    std::function<void()> evict;
+    const void *owner = nullptr;
+    QString name;
+    qint64 bytes = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        const Cache *oldest = nullptr;
+        for (const Cache &cache : m_caches) {
+            if (!datasets && ownsDataset(cache.owner)) {
+                continue;
+            }
+            if (cache.bytes > 0 && (oldest == nullptr || cache.used < oldest->used)) {
+                oldest = &cache;
+            }
+        }
+        if (oldest == nullptr) {
+            return 0;
+        }
+        size = oldest->size;
+        evict = oldest->evict;
+        owner = oldest->owner;
+        name = oldest->cache;
+        bytes = oldest->bytes;
+    }
+    evict();
+    // the size after the eviction is stored (the cache may keep some memory)
+    const qint64 remaining = size();
+    {
+        QMutexLocker locker(&m_mutex);
+        for (Cache &cache : m_caches) {
+            if (cache.owner == owner && cache.cache == name) {
+                cache.bytes = remaining;
+            }
+        }
+    }
+    // the eviction stops at a cache that does not release its memory
+    const qint64 released = bytes - remaining;
+    return std::max<qint64>(released, 0);
+}
+
+bool MemoryAccounting::ownsDataset(const void *owner) const
+{
+    for (const Account &account : m_accounts) {
+        if (account.owner == owner && account.category == Datasets) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MemoryAccounting::scheduleEnforcement()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_enforcement_pending) {
+            return;
+        }
+        m_enforcement_pending = true;
+    }
+    QMetaObject::invokeMethod(this, "enforceBudgets", Qt::QueuedConnection);
+}
@@ -0,0 +1,152 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <QObject>
+#include <QMutex>
+#include <QString>
+#include <QList>
+#include <QVector>
+
+#include <functional>
+
+class QSettings;
+
+// MemoryAccounting keeps track of the memory held by the datasets, the selections, the
+// recomputable caches and the tissue image textures so it can be shown to the user and kept
+// within the configured budgets.
+// The owners of the memory account it (an estimate of the bytes in main memory and in the GPU)
+// under a category and a name (the dataset or the selection) and release it when they are
+// destroyed. The recomputable caches are registered with a function that returns their
+// size and a function that drops them, the least recently used caches are evicted when a
+// budget is exceeded. The size of a cache is stored when it is registered, built again or
+// evicted (the queries do not measure the caches). The accounts can be changed from any
+// thread but the caches are evicted in the thread of the application (the owners of the
+// caches live there)
+class MemoryAccounting : public QObject
+{
+    Q_OBJECT
+    Q_ENUMS(Category)
+
+public:
+    enum Category {
+        Datasets = 0,
+        Selections = 1,
+        Caches = 2,
+        Textures = 3
+    };
+
+    static const int CATEGORIES = 4;
+
+    // bytes in main memory and in the GPU
+    struct Usage {
+        explicit Usage(const qint64 cpu = 0, const qint64 gpu = 0);
+        qint64 total() const;
+        Usage &operator+=(const Usage &other);
+
+        qint64 cpu_bytes;
+        qint64 gpu_bytes;
+    };
+
+    // the accounting of the application
+    static MemoryAccounting &instance();
+
+    // sets the memory held by the owner under the category and the name
+    void account(const void *owner,
+                 const Category category,
+                 const QString &name,
+                 const Usage &usage);
+    // removes the accounts and the caches of the owner
+    void release(const void *owner);
+
+    // registers a recomputable cache of the owner (accounted as Caches under the name)
+    // size returns its current size (bytes) and evict drops it, the cache is measured now
+    void registerCache(const void *owner,
+                       const QString &name,
+                       const QString &cache,
+                       const std::function<qint64()> &size,
+                       const std::function<void()> &evict);
+    // marks a cache as used (the least recently used caches are evicted first)
+    // it only updates the use of the cache so it can be called from the hot paths
+    void touchCache(const void *owner, const QString &cache);
+    // measures a cache that has been built again and marks it as used
+    // it must be called by the owner (in the thread that built the cache)
+    void updateCache(const void *owner, const QString &cache);
+
+    // the memory of the category held under the name and the total of the category
+    Usage usage(const Category category, const QString &name) const;
+    Usage total(const Category category) const;
+
+    // the budget (bytes) of each category, 0 means no budget
+    qint64 budget(const Category category) const;
+    void setBudget(const Category category, const qint64 bytes);
+    // the budgets are stored in megabytes in the settings
+    void loadBudgets(QSettings &settings);
+    void saveBudgets(QSettings &settings) const;
+
+    // the name of the category to be shown to the user
+    static QString categoryName(const Category category);
+    // the bytes formatted to be shown to the user (KB, MB or GB)
+    static QString formatBytes(const qint64 bytes);
+    // an estimate of the memory held by a list of strings
+    static qint64 stringsMemoryUsage(const QList<QString> &strings);
+    static qint64 stringsMemoryUsage(const QVector<QString> &strings);
+
+public slots:
+    // evicts the least recently used caches while a budget is exceeded (the caches are
+    // evicted in favour of the datasets and the selections too, except the caches owned by
+    // a dataset) and it returns the bytes released, budgetExceeded() is emitted when a
+    // category still exceeds its budget
+    qint64 enforceBudgets();
+    // evicts all the caches and it returns the bytes released
+    qint64 evictCaches();
+
+signals:
+    // the accounts or the caches have changed (it can be emitted from any thread)
+    void usageChanged();
+    // the category exceeds its budget (emitted once until it is within the budget again)
+    void budgetExceeded(MemoryAccounting::Category category, qint64 bytes, qint64 budget);
+
+private:
+    MemoryAccounting();
+    ~MemoryAccounting();
+
+    struct Account {
+        const void *owner;
+        Category category;
+        QString name;
+        Usage usage;
+    };
+
+    struct Cache {
+        const void *owner;
+        QString name;
+        QString cache;
+        std::function<qint64()> size;
+        std::function<void()> evict;
+        // the size when it was built or evicted
+        qint64 bytes;
+        // the use of the cache (greater is more recent)
+        quint64 used;
+    };
+
+    // evicts the least recently used cache that holds memory (the caches of the owners
+    // of datasets only if datasets is true), it returns the bytes released
+    qint64 evictLeastRecentlyUsed(const bool datasets);
+    // true if the owner has an account of a dataset (it must be called with the lock)
+    bool ownsDataset(const void *owner) const;
+    // enforces the budgets in the thread of the application (coalesced)
+    void scheduleEnforcement();
+
+    // guards the accounts, the caches and the budgets
+    mutable QMutex m_mutex;
+    QVector<Account> m_accounts;
+    QVector<Cache> m_caches;
+    qint64 m_budgets[CATEGORIES];
+    bool m_exceeded[CATEGORIES];
+    quint64 m_clock;
+    bool m_enforcement_pending;
+
+    Q_DISABLE_COPY(MemoryAccounting)
+};
+
+#endif // MEMORYACCOUNTING_H
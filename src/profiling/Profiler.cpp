@@ -0,0 +1,277 @@
+#include "Profiler.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+// the number of events of each thread that are kept until they are collected
+const quint64 BUFFER_SIZE = 1 << 14;
+// the number of collected events that are kept
+const int HISTORY_SIZE = 1 << 17;
+
+// The events of one thread, written only by the thread and read by collect()
+// The thread writes the event and then publishes it by increasing the count so the
+// events below the count can be read without a lock, an event read while the thread
+// overwrites it (the reader is a whole buffer behind) is discarded
+// Once the thread has finished and its events have been collected the buffer is
+// given to the next thread that records events
+struct ThreadBuffer {
+    ThreadBuffer()
+        : thread(-1)
+        , events(BUFFER_SIZE)
+        , written(0)
+        , read(0)
+        , released(false)
+    {
+    }
+
+    // the index of the thread that owns the buffer (see threadName())
+    int thread;
+    std::vector<Profiler::Event> events;
+    // the number of events written (by the thread)
+    std::atomic<quint64> written;
+    // the number of events read (by collect())
+    quint64 read;
+    // the thread has finished (guarded by the mutex of the registry)
+    bool released;
+};
+
+struct Registry {
+    Registry()
+        : clock()
+        , mutex()
+        , buffers()
+        , names()
+        , history()
+        , first(0)
+    {
+        clock.start();
+    }
+
+    QElapsedTimer clock;
+    // guards the list of buffers, the names of the threads and the history
+    QMutex mutex;
+    // the buffers of the running threads and the released ones (reused by new threads,
+    // e.g. the threads of the pools expire after some idle time)
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    // the name of every thread that recorded events (the history refers to them)
+    QStringList names;
+    // circular history of the collected events (first is the oldest one once it is full)
+    QVector<Profiler::Event> history;
+    int first;
+};
+
+Registry &registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+// releases the buffer of a thread when the thread finishes
+struct BufferOwner {
+    BufferOwner()
+        : buffer(nullptr)
+    {
+    }
+
+    ~BufferOwner()
+    {
+        if (buffer != nullptr) {
+            Registry &instance = registry();
+            QMutexLocker locker(&instance.mutex);
+            buffer->released = true;
+        }
+    }
+
+    ThreadBuffer *buffer;
+};
+
+// the buffer of the calling thread (it is registered the first time)
+ThreadBuffer &threadBuffer()
+{
+    thread_local BufferOwner owner;
+    if (owner.buffer == nullptr) {
+        Registry &instance = registry();
+        QMutexLocker locker(&instance.mutex);
+        const int thread = instance.names.size();
+        QString name = QThread::currentThread()->objectName();
+        if (name.isEmpty()) {
+            const QCoreApplication *application = QCoreApplication::instance();
+            const bool main = application != nullptr
+                    && QThread::currentThread() == application->thread();
+            name = main ? QString("main") : QString("thread %1").arg(thread);
+        }
+        instance.names.push_back(name);
+        // a released buffer whose events have all been collected is reused
+        for (const auto &buffer : instance.buffers) {
+            if (buffer->released
+                    && buffer->read == buffer->written.load(std::memory_order_acquire)) {
+                owner.buffer = buffer.get();
+                break;
+            }
+        }
+        if (owner.buffer == nullptr) {
+            instance.buffers.emplace_back(new ThreadBuffer());
+            owner.buffer = instance.buffers.back().get();
+        }
+        owner.buffer->thread = thread;
+        owner.buffer->written.store(0, std::memory_order_relaxed);
+        owner.buffer->read = 0;
+        owner.buffer->released = false;
+    }
+    return *owner.buffer;
+}
+
+QByteArray jsonString(const char *text)
+{
+    QByteArray escaped("\"");
+    for (const char *c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            escaped.append('\\');
+        }
+        escaped.append(*c);
+    }
+    escaped.append('"');
+    return escaped;
+}
+
+}
+
+qint64 Profiler::now()
+{
+    return registry().clock.nsecsElapsed();
+}
+
+void Profiler::record(const char *name, const Type type, const qint64 time_ns,
+                      const qint64 value)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    const quint64 written = buffer.written.load(std::memory_order_relaxed);
+    // the index of the thread is set when the events are collected
+    buffer.events[written % BUFFER_SIZE] = {name, type, -1, time_ns, value};
+    buffer.written.store(written + 1, std::memory_order_release);
+}
+
+int Profiler::collect()
+{
+    Registry &instance = registry();
+    QMutexLocker locker(&instance.mutex);
+    int lost = 0;
+    for (const auto &buffer : instance.buffers) {
+        const quint64 written = buffer->written.load(std::memory_order_acquire);
+        if (written - buffer->read > BUFFER_SIZE) {
+            lost += static_cast<int>(written - buffer->read - BUFFER_SIZE);
+            buffer->read = written - BUFFER_SIZE;
+        }
+        const int thread = buffer->thread;
+        for (quint64 i = buffer->read; i < written; ++i) {
+            Event event = buffer->events[i % BUFFER_SIZE];
+            // the event has been overwritten while it was read
+            if (buffer->written.load(std::memory_order_acquire) - i >= BUFFER_SIZE) {
+                ++lost;
+                continue;
+            }
+            event.thread = thread;
+            if (instance.history.size() < HISTORY_SIZE) {
+                instance.history.push_back(event);
+            } else {
+                instance.history[instance.first] = event;
+                instance.first = (instance.first + 1) % HISTORY_SIZE;
+            }
+        }
+        buffer->read = written;
+    }
+    return lost;
+}
+
+QVector<Profiler::Event> Profiler::events()
+{
+    Registry &instance = registry();
+    QMutexLocker locker(&instance.mutex);
+    QVector<Event> events;
+    events.reserve(instance.history.size());
+    for (int i = 0; i < instance.history.size(); ++i) {
+        events.push_back(instance.history.at((instance.first + i) % instance.history.size()));
+    }
+    return events;
+}
+
+void Profiler::clear()
+{
+    Registry &instance = registry();
+    QMutexLocker locker(&instance.mutex);
+    instance.history.clear();
+    instance.first = 0;
+}
+
+int Profiler::threadBuffers()
+{
+    Registry &instance = registry();
+    QMutexLocker locker(&instance.mutex);
+    return static_cast<int>(instance.buffers.size());
+}
+
+QString Profiler::threadName(const int thread)
+{
+    Registry &instance = registry();
+    QMutexLocker locker(&instance.mutex);
+    if (thread < 0 || thread >= instance.names.size()) {
+        return QString();
+    }
+    return instance.names.at(thread);
+}
+
+bool Profiler::writeChromeTrace(const QString &filename)
+{
+    collect();
+    const QVector<Event> recorded = events();
+
+    // the trace event format: complete events ("X") for the timers and counter events
+    // ("C") for the counters, the times are in microseconds
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    QVector<bool> threads;
+    for (const Event &event : recorded) {
+        if (event.thread >= threads.size()) {
+            threads.resize(event.thread + 1);
+        }
+        threads[event.thread] = true;
+    }
+    bool first = true;
+    for (int thread = 0; thread < threads.size(); ++thread) {
+        if (threads.at(thread)) {
+            json += QByteArray(first ? "" : ",\n")
+                    + "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                    + QByteArray::number(thread) + ",\"args\":{\"name\":"
+                    + jsonString(threadName(thread).toUtf8().constData()) + "}}";
+            first = false;
+        }
+    }
+    for (const Event &event : recorded) {
+        json += QByteArray(first ? "" : ",\n") + "{\"name\":" + jsonString(event.name)
+                + ",\"pid\":1,\"tid\":" + QByteArray::number(event.thread)
+                + ",\"ts\":" + QByteArray::number(event.time_ns / 1000.0, 'f', 3);
+        if (event.type == Timer) {
+            json += ",\"ph\":\"X\",\"dur\":" + QByteArray::number(event.value / 1000.0, 'f', 3)
+                    + "}";
+        } else {
+            json += ",\"ph\":\"C\",\"args\":{\"value\":" + QByteArray::number(event.value)
+                    + "}}";
+        }
+        first = false;
+    }
+    json += "\n]}\n";
+
+    QFile file(filename);
+    return file.open(QIODevice::WriteOnly) && file.write(json) == json.size();
+}
@@ -0,0 +1,106 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+
+#include "options_cmake.h"
+
+// Timing instrumentation of the hot paths (loading, rendering data, R calls, textures, paint)
+// The instrumented code records timers (ST_PROFILE_SCOPE) and counters (ST_PROFILE_COUNTER)
+// in a ring buffer of its thread, recording takes no lock and does not allocate (the names
+// must be string literals) so it can be left in the hot paths. The events are collected from
+// the buffers of all the threads into a history of the recent events (collect() is called by
+// the profiler panel) that can be exported as a Chrome trace (chrome://tracing or Perfetto)
+// If a buffer is full the oldest events of the thread are overwritten, the buffer of a
+// finished thread is reused by a new thread once its events have been collected
+// The instrumentation is removed at compile time when ENABLE_PROFILING is off
+class Profiler
+{
+
+public:
+    enum Type {
+        Timer,
+        Counter
+    };
+
+    struct Event {
+        // a string literal
+        const char *name;
+        Type type;
+        // the index of the thread that recorded the event (see threadName())
+        int thread;
+        // the start of the timer or the time of the counter (nanoseconds since the start)
+        qint64 time_ns;
+        // the duration of the timer (nanoseconds) or the value of the counter
+        qint64 value;
+    };
+
+    // nanoseconds since the profiler was started
+    static qint64 now();
+
+    // records an event in the buffer of the calling thread
+    static void record(const char *name, const Type type, const qint64 time_ns,
+                       const qint64 value);
+
+    // moves the recorded events of all the threads to the history
+    // it returns the number of events lost because the buffers were full
+    static int collect();
+
+    // the collected events (the most recent ones) in the order they were collected
+    static QVector<Event> events();
+
+    // removes the collected events
+    static void clear();
+
+    // the number of buffers allocated for the threads (running or released)
+    static int threadBuffers();
+
+    // the name of a thread that recorded events
+    static QString threadName(const int thread);
+
+    // writes the collected events as a Chrome trace (JSON), it returns false if the file
+    // could not be written
+    static bool writeChromeTrace(const QString &filename);
+
+    // records the time of a scope
+    class ScopedTimer
+    {
+
+    public:
+        explicit ScopedTimer(const char *name)
+            : m_name(name)
+            , m_start(now())
+        {
+        }
+
+        ~ScopedTimer() { record(m_name, Timer, m_start, now() - m_start); }
+
+    private:
+        const char *m_name;
+        qint64 m_start;
+
+        Q_DISABLE_COPY(ScopedTimer)
+    };
+
+private:
+    Profiler() = delete;
+};
+
+#define ST_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ST_PROFILE_CONCAT(a, b) ST_PROFILE_CONCAT_IMPL(a, b)
+
+#if ENABLE_PROFILING
+// times the rest of the enclosing scope
+#define ST_PROFILE_SCOPE(name) \
+    const Profiler::ScopedTimer ST_PROFILE_CONCAT(st_profile_scope_, __LINE__)(name)
+// records the value of a counter
+#define ST_PROFILE_COUNTER(name, value) \
+    Profiler::record(name, Profiler::Counter, Profiler::now(), static_cast<qint64>(value))
+#else
+#define ST_PROFILE_SCOPE(name) static_cast<void>(0)
+#define ST_PROFILE_COUNTER(name, value) static_cast<void>(0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,134 @@
+#include <QtTest/QTest>
+#include <QGraphicsScene>
+#include <QScatterSeries>
+#include <QPainter>
+
+#include "analysis/ScatterPlotItem.h"
+
+#include "tst_scatterplotitemtest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// a dense cloud of red points (a 100x100 grid) covering the whole plot area
+QVector<QPointF> cloudPoints()
+{
+    QVector<QPointF> points;
+    for (int x = 0; x <= 100; ++x) {
+        for (int y = 0; y <= 100; ++y) {
+            points.append(QPointF(x, y));
+        }
+    }
+    return points;
+}
+
+// renders the chart (at the origin of the scene) into an image
+QImage renderChart(QGraphicsScene &scene, const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    scene.render(&painter, QRectF(QPointF(0, 0), size), QRectF(QPointF(0, 0), size));
+    painter.end();
+    return image;
+}
+
+}
+
+ScatterPlotItemTest::ScatterPlotItemTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ScatterPlotItemTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void ScatterPlotItemTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void ScatterPlotItemTest::testHighlightOnTop()
+{
+    const QSize size(400, 400);
+    QGraphicsScene scene;
+    QChart *chart = new QChart();
+    scene.addItem(chart);
+    chart->setPos(0, 0);
+    chart->resize(size);
+    chart->legend()->hide();
+
+    // the series (and its axes) that maps the points
+    QScatterSeries *series = new QScatterSeries();
+    series->setMarkerSize(0.0);
+    series->setColor(Qt::transparent);
+    series->setBorderColor(Qt::transparent);
+    *series << QPointF(0, 0) << QPointF(100, 100);
+    chart->addSeries(series);
+    chart->createDefaultAxes();
+
+    ScatterPlotItem *item = new ScatterPlotItem(chart);
+    const QVector<QPointF> points = cloudPoints();
+    item->setPoints(points, QVector<QRgb>(points.size(), QColor(Qt::red).rgba()));
+    item->setMarkerSize(10.0);
+    item->setSeries(series);
+    const QPointF highlight(50.0, 50.0);
+    item->setHighlight(highlight, Qt::darkMagenta, 8.0);
+    QCoreApplication::sendPostedEvents();
+    QCoreApplication::processEvents();
+
+    const QImage image = renderChart(scene, size);
+    const QPoint center = chart->mapToPosition(highlight, series).toPoint();
+    QVERIFY(chart->plotArea().contains(center));
+    // the marker of the highlighted point is over the points
+    QCOMPARE(QColor(image.pixel(center)), QColor(Qt::darkMagenta));
+    QCOMPARE(QColor(image.pixel(center + QPoint(2, 2))), QColor(Qt::darkMagenta));
+    QCOMPARE(QColor(image.pixel(center - QPoint(2, 2))), QColor(Qt::darkMagenta));
+    // and the cloud of points is around it
+    QCOMPARE(QColor(image.pixel(center + QPoint(10, 0))), QColor(Qt::red));
+    QCOMPARE(QColor(image.pixel(center - QPoint(0, 10))), QColor(Qt::red));
+}
+
+void ScatterPlotItemTest::testClearHighlight()
+{
+    const QSize size(400, 400);
+    QGraphicsScene scene;
+    QChart *chart = new QChart();
+    scene.addItem(chart);
+    chart->setPos(0, 0);
+    chart->resize(size);
+    chart->legend()->hide();
+
+    QScatterSeries *series = new QScatterSeries();
+    series->setMarkerSize(0.0);
+    series->setColor(Qt::transparent);
+    series->setBorderColor(Qt::transparent);
+    *series << QPointF(0, 0) << QPointF(100, 100);
+    chart->addSeries(series);
+    chart->createDefaultAxes();
+
+    ScatterPlotItem *item = new ScatterPlotItem(chart);
+    const QVector<QPointF> points = cloudPoints();
+    item->setPoints(points, QVector<QRgb>(points.size(), QColor(Qt::red).rgba()));
+    item->setMarkerSize(10.0);
+    item->setSeries(series);
+    const QPointF highlight(50.0, 50.0);
+    item->setHighlight(highlight, Qt::darkMagenta, 8.0);
+    item->clearHighlight();
+    QCoreApplication::sendPostedEvents();
+    QCoreApplication::processEvents();
+
+    const QImage image = renderChart(scene, size);
+    const QPoint center = chart->mapToPosition(highlight, series).toPoint();
+    QCOMPARE(QColor(image.pixel(center)), QColor(Qt::red));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::ScatterPlotItemTest)
+#include "tst_scatterplotitemtest.moc"
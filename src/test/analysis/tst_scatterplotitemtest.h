@@ -0,0 +1,26 @@
+#ifndef TST_SCATTERPLOTITEMTEST_H
+#define TST_SCATTERPLOTITEMTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class ScatterPlotItemTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScatterPlotItemTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testHighlightOnTop();
+    void testClearHighlight();
+};
+
+} // namespace unit //
+
+#endif // TST_SCATTERPLOTITEMTEST_H //
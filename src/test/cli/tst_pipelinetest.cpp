@@ -0,0 +1,156 @@
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFile>
+#include <QDir>
+
+#include "cli/Pipeline.h"
+#include "data/STData.h"
+
+#include "tst_pipelinetest.h"
+
+namespace unit
+{
+
+// a data frame of 4 spots and 3 genes (the last spot and gene have no counts)
+static STData::STDataFrame dataFrame()
+{
+    STData::STDataFrame data;
+    data.genes = {"Actb", "Gapdh", "Pcp4"};
+    data.spots = {"1x1", "2x1", "3x2", "4x4"};
+    data.counts = {{1, 5, 0},
+                   {2, 0, 0},
+                   {7, 3, 0},
+                   {0, 0, 0}};
+    return data;
+}
+
+static bool writeFile(const QString &filename, const QByteArray &content)
+{
+    QFile file(filename);
+    return file.open(QIODevice::WriteOnly) && file.write(content) == content.size();
+}
+
+PipelineTest::PipelineTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void PipelineTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void PipelineTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void PipelineTest::testParseConfig()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(QDir(dir.path()).mkpath("second"));
+    // the files of an info.json are relative to it and the config overrides it
+    QVERIFY(writeFile(dir.filePath("second/info.json"),
+                      "{\"name\": \"second\", \"data\": \"counts.tsv\", "
+                      "\"aligment\": \"alignment.txt\", \"tissue\": \"brain\"}"));
+    const QByteArray config = "{\"output\": \"results\", \"threads\": 2,"
+                              " \"datasets\": [{\"data\": \"first.tsv\"},"
+                              "                {\"info\": \"second/info.json\","
+                              "                 \"tissue\": \"heart\"}],"
+                              " \"filter\": {\"genes_threshold\": 1},"
+                              " \"normalization\": \"TPM\", \"log_scale\": true,"
+                              " \"clustering\": {\"method\": \"graph\", \"reduction\": \"pca\","
+                              "                \"clusters\": 3}}";
+    QVERIFY(writeFile(dir.filePath("config.json"), config));
+
+    const Pipeline::Settings settings = Pipeline::parseConfig(dir.filePath("config.json"));
+    const QDir base(dir.path());
+    QCOMPARE(settings.output, base.filePath("results"));
+    QCOMPARE(settings.threads, 2);
+    QCOMPARE(settings.inputs.size(), 2);
+    QCOMPARE(settings.inputs.at(0).name, QString("first"));
+    QCOMPARE(settings.inputs.at(0).data, base.filePath("first.tsv"));
+    QCOMPARE(settings.inputs.at(1).name, QString("second"));
+    QCOMPARE(settings.inputs.at(1).data, base.filePath("second/counts.tsv"));
+    QCOMPARE(settings.inputs.at(1).alignment, base.filePath("second/alignment.txt"));
+    QCOMPARE(settings.inputs.at(1).tissue, QString("heart"));
+    QCOMPARE(settings.genes_threshold, 1);
+    QCOMPARE(settings.spots_threshold, 5);
+    QCOMPARE(settings.normalization, SettingsWidget::TPM);
+    QVERIFY(settings.log_scale);
+    QCOMPARE(settings.clustering, Pipeline::Graph);
+    QCOMPARE(settings.reduction, Pipeline::PCAReduction);
+    QCOMPARE(settings.clusters, 3);
+    QVERIFY(settings.export_cache);
+    Pipeline pipeline(settings);
+    QVERIFY(!pipeline.needsR());
+}
+
+void PipelineTest::testInvalidConfig()
+{
+    const QDir base = QDir::current();
+    const auto parse = [&](const QByteArray &json) {
+        Pipeline::parseConfig(QJsonDocument::fromJson(json).object(), base);
+    };
+    QVERIFY_EXCEPTION_THROWN(parse("{\"datasets\": [{\"data\": \"a.tsv\"}]}"),
+                             std::runtime_error);
+    QVERIFY_EXCEPTION_THROWN(parse("{\"output\": \"out\", \"datasets\": []}"),
+                             std::runtime_error);
+    QVERIFY_EXCEPTION_THROWN(parse("{\"output\": \"out\", \"datasets\": [{\"data\": \"a.tsv\"},"
+                                   " {\"data\": \"other/a.tsv\"}]}"),
+                             std::runtime_error);
+    QVERIFY_EXCEPTION_THROWN(parse("{\"output\": \"out\", \"datasets\": [{\"data\": \"a.tsv\"}],"
+                                   " \"normalization\": \"none\"}"),
+                             std::runtime_error);
+    QVERIFY_EXCEPTION_THROWN(parse("{\"output\": \"out\", \"datasets\": [{\"data\": \"a.tsv\"}],"
+                                   " \"filter\": {\"reads_threshold\": -1}}"),
+                             std::runtime_error);
+}
+
+void PipelineTest::testRun()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(STData::save(dir.filePath("dataset.tsv"), dataFrame()));
+
+    Pipeline::Settings settings;
+    settings.output = dir.filePath("results");
+    settings.genes_threshold = 0;
+    settings.spots_threshold = 0;
+    settings.normalization = SettingsWidget::REL;
+    Pipeline::Input input;
+    input.name = "dataset";
+    input.data = dir.filePath("dataset.tsv");
+    settings.inputs.push_back(input);
+
+    Pipeline pipeline(settings);
+    const QJsonArray reports = pipeline.run([](const QString &) {});
+    QCOMPARE(reports.size(), 1);
+    const QJsonObject report = reports.at(0).toObject();
+    QVERIFY(!report.contains("error"));
+    QCOMPARE(report.value("spots").toInt(), 3);
+    QCOMPARE(report.value("genes").toInt(), 2);
+    QVERIFY(QFile::exists(dir.filePath("results/report.json")));
+    QVERIFY(QFile::exists(dir.filePath("results/dataset/info.json")));
+
+    // the cache has the spots and genes with counts
+    const STData::STDataFrame cache = STData::read(dir.filePath("results/dataset/dataset.stdf"));
+    QCOMPARE(cache.spots, QList<QString>({"1x1", "2x1", "3x2"}));
+    QCOMPARE(cache.genes, QList<QString>({"Actb", "Gapdh"}));
+    QCOMPARE(cache.counts(2, 0), 7.0);
+
+    // the counts of each spot are relative to its total
+    const STData::STDataFrame normalized
+            = STData::read(dir.filePath("results/dataset/processed/normalized.stdf"));
+    QCOMPARE(normalized.spots.size(), 3);
+    QVERIFY(std::abs(arma::accu(normalized.counts.row(2)) - 1.0) < 1e-6);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::PipelineTest)
+#include "tst_pipelinetest.moc"
@@ -0,0 +1,27 @@
+#ifndef TST_PIPELINETEST_H
+#define TST_PIPELINETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class PipelineTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PipelineTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testParseConfig();
+    void testInvalidConfig();
+    void testRun();
+};
+
+} // namespace unit //
+
+#endif // TST_PIPELINETEST_H //
@@ -0,0 +1,159 @@
+#include <QtTest/QTest>
+
+#include "color/ColorMap.h"
+#include "color/HeatMap.h"
+
+#include "tst_colormaptest.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace unit
+{
+
+// the presets of QCPColorGradient (gpGrayscale to gpHues)
+static const int num_presets = QCPColorGradient::gpHues + 1;
+
+// a range that is not a multiple of the number of levels
+static const double range_min = -3.7;
+static const double range_max = 12.9;
+
+// values inside and outside of the range, including the bounds of the levels
+static std::vector<double> testValues(const double min, const double max)
+{
+    std::vector<double> values;
+    for (int level = 0; level < Color::ColorMap::levels; ++level) {
+        values.push_back(min + level * (max - min) / (Color::ColorMap::levels - 1));
+    }
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> distribution(min - (max - min), max + (max - min));
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(distribution(generator));
+    }
+    values.push_back(min);
+    values.push_back(max);
+    values.push_back(std::nextafter(max, min));
+    values.push_back(std::nextafter(min, max));
+    return values;
+}
+
+ColorMapTest::ColorMapTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ColorMapTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void ColorMapTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void ColorMapTest::testGradientColors()
+{
+    // the colors of the tables are the ones of the gradients
+    const std::vector<double> values = testValues(range_min, range_max);
+    const QCPRange range(range_min, range_max);
+    for (int preset = 0; preset < num_presets; ++preset) {
+        const auto gradient_preset = static_cast<QCPColorGradient::GradientPreset>(preset);
+        QCPColorGradient gradient(gradient_preset);
+        const Color::ColorMap &color_map = Color::ColorMap::get(gradient_preset);
+        for (const double value : values) {
+            // the periodic gradients wrap the values out of the range
+            if (gradient.periodic() && !range.contains(value)) {
+                continue;
+            }
+            QCOMPARE(color_map.color(value, range_min, range_max), gradient.color(value, range));
+        }
+    }
+}
+
+void ColorMapTest::testClamping()
+{
+    const Color::ColorMap &color_map = Color::ColorMap::get(QCPColorGradient::gpHot);
+    const QRgb lowest = color_map.color(range_min, range_min, range_max);
+    const QRgb highest = color_map.color(range_max, range_min, range_max);
+    QVERIFY(lowest != highest);
+    QCOMPARE(color_map.color(range_min - 1.0, range_min, range_max), lowest);
+    QCOMPARE(color_map.color(-1e300, range_min, range_max), lowest);
+    QCOMPARE(color_map.color(range_max + 1.0, range_min, range_max), highest);
+    QCOMPARE(color_map.color(1e300, range_min, range_max), highest);
+    QCOMPARE(color_map.color(std::numeric_limits<double>::infinity(), range_min, range_max),
+             highest);
+    // NaN values give the first color
+    QCOMPARE(color_map.color(std::numeric_limits<double>::quiet_NaN(), range_min, range_max),
+             lowest);
+}
+
+void ColorMapTest::testEmptyRange()
+{
+    // empty ranges give the first color
+    const Color::ColorMap &color_map = Color::ColorMap::get(QCPColorGradient::gpSpectrum);
+    const QRgb lowest = color_map.color(0.0, 0.0, 1.0);
+    const std::vector<double> values = {-1.0, 0.0, 1.0, 5.0, 5.0, 6.0,
+                                        std::numeric_limits<double>::infinity()};
+    std::vector<QRgb> colors(values.size());
+    for (const double max : {5.0, 4.0}) {
+        color_map.map(values.data(), values.size(), 5.0, max, colors.data());
+        for (uint i = 0; i < values.size(); ++i) {
+            QCOMPARE(color_map.color(values[i], 5.0, max), lowest);
+            QCOMPARE(colors[i], lowest);
+        }
+    }
+}
+
+void ColorMapTest::testMap()
+{
+    // the batched (SIMD) mapping gives the same colors as the scalar one for any
+    // number of values (the tails) and any alignment
+    std::vector<double> values = testValues(range_min, range_max);
+    values.push_back(std::numeric_limits<double>::quiet_NaN());
+    values.push_back(-std::numeric_limits<double>::infinity());
+    values.push_back(std::numeric_limits<double>::infinity());
+    std::vector<QRgb> colors(values.size());
+    for (const auto preset : {QCPColorGradient::gpHot, QCPColorGradient::gpSpectrum}) {
+        const Color::ColorMap &color_map = Color::ColorMap::get(preset);
+        for (int offset = 0; offset < 3; ++offset) {
+            for (int count = 0; count <= 9; ++count) {
+                std::fill(colors.begin(), colors.end(), 0);
+                color_map.map(values.data() + values.size() - count - offset, count,
+                              range_min, range_max, colors.data());
+                for (int i = 0; i < count; ++i) {
+                    QCOMPARE(colors[i],
+                             color_map.color(values[values.size() - count - offset + i],
+                                             range_min, range_max));
+                }
+            }
+        }
+        color_map.map(values.data(), values.size(), range_min, range_max, colors.data());
+        for (uint i = 0; i < values.size(); ++i) {
+            QCOMPARE(colors[i], color_map.color(values[i], range_min, range_max));
+        }
+    }
+}
+
+void ColorMapTest::testHeatMap()
+{
+    // the colors of the rendering are the ones of the gradients
+    const float min = 2.5f;
+    const float max = 17.25f;
+    const QCPRange range(min, max);
+    for (const auto preset : {QCPColorGradient::gpHot, QCPColorGradient::gpSpectrum}) {
+        QCPColorGradient gradient(preset);
+        for (const double value : testValues(min, max)) {
+            const float float_value = static_cast<float>(value);
+            QCOMPARE(Color::createCMapColor(float_value, min, max, preset),
+                     QColor(gradient.color(float_value, range)));
+        }
+    }
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::ColorMapTest)
+#include "tst_colormaptest.moc"
@@ -0,0 +1,29 @@
+#ifndef TST_COLORMAPTEST_H
+#define TST_COLORMAPTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class ColorMapTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ColorMapTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testGradientColors();
+    void testClamping();
+    void testEmptyRange();
+    void testMap();
+    void testHeatMap();
+};
+
+} // namespace unit //
+
+#endif // TST_COLORMAPTEST_H //
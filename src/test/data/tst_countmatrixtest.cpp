@@ -0,0 +1,106 @@
+#include <QtTest/QTest>
+
+#include "data/CountMatrix.h"
+
+#include "tst_countmatrixtest.h"
+
+Q_DECLARE_METATYPE(CountMatrix::Storage)
+
+namespace unit
+{
+
+// a sparse matrix of small integer counts like the ones of a dataset
+static mat randomCounts(const uword n_rows, const uword n_cols)
+{
+    arma_rng::set_seed(42);
+    mat counts = floor(randu<mat>(n_rows, n_cols) * 20.0);
+    counts.elem(find(randu<mat>(n_rows, n_cols) < 0.8)).zeros();
+    return counts;
+}
+
+CountMatrixTest::CountMatrixTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void CountMatrixTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void CountMatrixTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void CountMatrixTest::testStorage()
+{
+    QCOMPARE(CountMatrix::storageFor(mat({{0, 1}, {65535, 3}})), CountMatrix::UInt16);
+    QCOMPARE(CountMatrix::storageFor(mat({{0, 1}, {65536, 3}})), CountMatrix::UInt32);
+    QCOMPARE(CountMatrix::storageFor(mat({{0, 1.5}, {2, 3}})), CountMatrix::Float);
+    QCOMPARE(CountMatrix::storageFor(mat({{0, -1}, {2, 3}})), CountMatrix::Float);
+    QCOMPARE(CountMatrix::storageFor(mat({{0, 0.1}, {2, 3}})), CountMatrix::Double);
+
+    const mat counts = randomCounts(100, 50);
+    const CountMatrix compact(counts);
+    QCOMPARE(compact.storage(), CountMatrix::UInt16);
+    QCOMPARE(compact.n_rows(), counts.n_rows);
+    QCOMPARE(compact.n_cols(), counts.n_cols);
+    QCOMPARE(compact.memoryUsage(), static_cast<size_t>(counts.n_elem * 2));
+    QVERIFY(approx_equal(compact.toMat(), counts, "absdiff", 0.0));
+}
+
+void CountMatrixTest::testKernels_data()
+{
+    QTest::addColumn<CountMatrix::Storage>("storage");
+    QTest::newRow("uint16") << CountMatrix::UInt16;
+    QTest::newRow("uint32") << CountMatrix::UInt32;
+    QTest::newRow("float") << CountMatrix::Float;
+    QTest::newRow("double") << CountMatrix::Double;
+}
+
+void CountMatrixTest::testKernels()
+{
+    QFETCH(CountMatrix::Storage, storage);
+    const mat counts = randomCounts(200, 80);
+    const CountMatrix matrix(counts, storage);
+    QCOMPARE(matrix.storage(), storage);
+
+    QVERIFY(approx_equal(matrix.sumColumns(), rowvec(sum(counts, 0)), "absdiff", 1e-9));
+    const mat above = counts % conv_to<mat>::from(counts > 5);
+    QVERIFY(approx_equal(matrix.sumRows(5), colvec(sum(above, 1)), "absdiff", 1e-9));
+    QVERIFY(all(matrix.nonZeroColumns(5) == urowvec(sum(counts > 5, 0))));
+    QVERIFY(all(matrix.nonZeroRows() == ucolvec(sum(counts > 0, 1))));
+
+    const uvec rows = {3, 10, 150};
+    const uvec cols = matrix.columnsWithCounts(rows);
+    const rowvec rows_sums = sum(counts.rows(rows), 0);
+    QCOMPARE(cols.n_elem, static_cast<uword>(accu(rows_sums > 0)));
+    QVERIFY(approx_equal(matrix.submat(rows, cols), mat(counts.submat(rows, cols)),
+                         "absdiff", 0.0));
+    QVERIFY(approx_equal(matrix.columns(cols), mat(counts.cols(cols)), "absdiff", 0.0));
+}
+
+void CountMatrixTest::benchmarkFilter_data()
+{
+    testKernels_data();
+}
+
+void CountMatrixTest::benchmarkFilter()
+{
+    // the sums and non-zero counts of the filtering of the rendering data
+    // (reported with the memory used by each storage)
+    QFETCH(CountMatrix::Storage, storage);
+    const CountMatrix matrix(randomCounts(4000, 2000), storage);
+    qDebug() << "Memory used by the counts:" << matrix.memoryUsage() << "bytes";
+    QBENCHMARK {
+        const urowvec genes = matrix.nonZeroColumns(1);
+        const colvec reads = matrix.sumRows(1);
+        QVERIFY(genes.n_elem > 0 && reads.n_elem > 0);
+    }
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::CountMatrixTest)
+#include "tst_countmatrixtest.moc"
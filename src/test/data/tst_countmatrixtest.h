@@ -0,0 +1,29 @@
+#ifndef TST_COUNTMATRIXTEST_H
+#define TST_COUNTMATRIXTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class CountMatrixTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CountMatrixTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testStorage();
+    void testKernels_data();
+    void testKernels();
+    void benchmarkFilter_data();
+    void benchmarkFilter();
+};
+
+} // namespace unit //
+
+#endif // TST_COUNTMATRIXTEST_H //
@@ -0,0 +1,110 @@
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+#include <QFile>
+
+#include "data/DataFrameWriter.h"
+
+#include "tst_dataframewritertest.h"
+
+namespace unit
+{
+
+// a data frame of 3 spots and 4 genes with integer and non-integer counts
+static STData::STDataFrame dataFrame()
+{
+    STData::STDataFrame data;
+    data.genes = {"Actb", "Gapdh", "Mt-Co1", "Pcp4"};
+    data.spots = {"1x1", "2x1", "10x20"};
+    data.counts = {{0, 1, 250, 0},
+                   {0.5, 0, 0, 12345678},
+                   {0, 0, 0.1, -3}};
+    return data;
+}
+
+static QString format(const double value)
+{
+    char out[32];
+    const int size = DataFrameWriter::formatNumber(value, out);
+    return QString::fromLatin1(out, size);
+}
+
+DataFrameWriterTest::DataFrameWriterTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void DataFrameWriterTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void DataFrameWriterTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void DataFrameWriterTest::testFormatNumber()
+{
+    QCOMPARE(format(0), QString("0"));
+    QCOMPARE(format(7), QString("7"));
+    QCOMPARE(format(-42), QString("-42"));
+    QCOMPARE(format(123456789), QString("123456789"));
+    QCOMPARE(format(0.5), QString("0.5"));
+    QCOMPARE(format(static_cast<float>(0.1)), QString("0.1"));
+    QCOMPARE(format(1.0 / 3.0).toFloat(), static_cast<float>(1.0 / 3.0));
+}
+
+void DataFrameWriterTest::testTSV()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("selection.tsv");
+    QCOMPARE(DataFrameWriter::format(filename), DataFrameWriter::TSV);
+    QVERIFY(STData::save(filename, dataFrame()));
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("\tActb\tGapdh\tMt-Co1\tPcp4\n"
+                                        "1x1\t0\t1\t250\t0\n"
+                                        "2x1\t0.5\t0\t0\t12345678\n"
+                                        "10x20\t0\t0\t0.1\t-3\n"));
+
+    const auto data = STData::read(filename);
+    QCOMPARE(data.genes, dataFrame().genes);
+    QCOMPARE(data.spots, dataFrame().spots);
+    QVERIFY(arma::approx_equal(data.counts, dataFrame().counts, "reldiff", 1e-6));
+}
+
+void DataFrameWriterTest::testBinary()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("selection.stdf");
+    QCOMPARE(DataFrameWriter::format(filename), DataFrameWriter::Binary);
+    QVERIFY(STData::save(filename, dataFrame()));
+
+    const auto data = STData::read(filename);
+    QCOMPARE(data.genes, dataFrame().genes);
+    QCOMPARE(data.spots, dataFrame().spots);
+    QVERIFY(arma::approx_equal(data.counts, dataFrame().counts, "reldiff", 1e-6));
+}
+
+void DataFrameWriterTest::testCancel()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("selection.tsv");
+    int calls = 0;
+    QVERIFY(!STData::save(filename, dataFrame(), [&calls](const int spots) {
+        ++calls;
+        return spots == 0;
+    }));
+    QCOMPARE(calls, 1);
+    // nothing is left when the export is cancelled
+    QVERIFY(!QFile::exists(filename));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::DataFrameWriterTest)
+#include "tst_dataframewritertest.moc"
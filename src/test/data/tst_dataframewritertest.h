@@ -0,0 +1,28 @@
+#ifndef TST_DATAFRAMEWRITERTEST_H
+#define TST_DATAFRAMEWRITERTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class DataFrameWriterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DataFrameWriterTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testFormatNumber();
+    void testTSV();
+    void testBinary();
+    void testCancel();
+};
+
+} // namespace unit //
+
+#endif // TST_DATAFRAMEWRITERTEST_H //
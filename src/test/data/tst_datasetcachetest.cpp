@@ -0,0 +1,134 @@
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+#include <QFile>
+
+#include "data/DatasetCache.h"
+#include "data/STData.h"
+#include "profiling/MemoryAccounting.h"
+
+#include "tst_datasetcachetest.h"
+
+namespace unit
+{
+
+// a dataset (without image) with a matrix of 3 spots and 2 genes
+static void dataset(const QTemporaryDir &dir, const QString &name, Dataset &dataset)
+{
+    STData::STDataFrame data;
+    data.genes = {"Actb", "Gapdh"};
+    data.spots = {"1x1", "2x1", "3x2"};
+    data.counts = {{1, 5}, {2, 1}, {7, 3}};
+    const QString filename = dir.filePath(name + ".tsv");
+    QVERIFY(STData::save(filename, data));
+    dataset.name(name);
+    dataset.dataFile(filename);
+}
+
+DatasetCacheTest::DatasetCacheTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void DatasetCacheTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void DatasetCacheTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void DatasetCacheTest::testOpen()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Dataset first;
+    dataset(dir, "first", first);
+    Dataset second;
+    dataset(dir, "second", second);
+
+    DatasetCache cache;
+    const auto data = cache.open(first).data;
+    QVERIFY(!data.isNull());
+    QCOMPARE(data->spots().size(), 3);
+    QVERIFY(cache.open(second).data != data);
+    // the datasets opened before are not parsed again
+    QVERIFY(cache.contains(first));
+    QCOMPARE(cache.open(first).data, data);
+
+    // the dataset is parsed again when its files change
+    QVERIFY(QFile::copy(first.dataFile(), dir.filePath("copy.tsv")));
+    first.dataFile(dir.filePath("copy.tsv"));
+    QVERIFY(!cache.contains(first));
+    QVERIFY(cache.open(first).data != data);
+
+    cache.close();
+    cache.remove("first");
+    QVERIFY(!cache.contains(first));
+}
+
+void DatasetCacheTest::testPrefetch()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Dataset first;
+    dataset(dir, "first", first);
+    Dataset second;
+    dataset(dir, "second", second);
+
+    DatasetCache cache;
+    cache.prefetch(QList<Dataset>() << first << second);
+    QVERIFY(cache.contains(first));
+    QVERIFY(cache.contains(second));
+    // the prefetched dataset is opened once it has been parsed
+    const auto data = cache.open(second).data;
+    QVERIFY(!data.isNull());
+    QCOMPARE(data->genes().size(), 2);
+    QCOMPARE(cache.open(second).data, data);
+}
+
+void DatasetCacheTest::testError()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Dataset missing;
+    missing.name("missing");
+    missing.dataFile(dir.filePath("missing.tsv"));
+
+    DatasetCache cache;
+    QVERIFY_EXCEPTION_THROWN(cache.open(missing), std::runtime_error);
+    // the errors are not cached
+    QVERIFY(!cache.contains(missing));
+    cache.prefetch(QList<Dataset>() << missing);
+    QVERIFY_EXCEPTION_THROWN(cache.open(missing), std::runtime_error);
+}
+
+void DatasetCacheTest::testEviction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Dataset first;
+    dataset(dir, "first", first);
+    Dataset second;
+    dataset(dir, "second", second);
+
+    MemoryAccounting &accounting = MemoryAccounting::instance();
+    const qint64 budget = accounting.budget(MemoryAccounting::Caches);
+    accounting.setBudget(MemoryAccounting::Caches, 1);
+
+    DatasetCache cache;
+    cache.open(first);
+    cache.open(second);
+    accounting.enforceBudgets();
+    // the closed dataset is evicted and the open one is kept
+    QVERIFY(!cache.contains(first));
+    QVERIFY(cache.contains(second));
+
+    accounting.setBudget(MemoryAccounting::Caches, budget);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::DatasetCacheTest)
+#include "tst_datasetcachetest.moc"
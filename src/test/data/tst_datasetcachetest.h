@@ -0,0 +1,28 @@
+#ifndef TST_DATASETCACHETEST_H
+#define TST_DATASETCACHETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class DatasetCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DatasetCacheTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testOpen();
+    void testPrefetch();
+    void testError();
+    void testEviction();
+};
+
+} // namespace unit //
+
+#endif // TST_DATASETCACHETEST_H //
@@ -0,0 +1,80 @@
+#include <QtTest/QTest>
+
+#include "data/GeneSearchIndex.h"
+
+#include "tst_genesearchindextest.h"
+
+namespace unit
+{
+
+static const QVector<QString> GENES = {"Actb", "ACTA2", "Gapdh", "xActb", "Mt-Co1", "mt-Nd1"};
+
+GeneSearchIndexTest::GeneSearchIndexTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void GeneSearchIndexTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void GeneSearchIndexTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void GeneSearchIndexTest::testPrefix()
+{
+    GeneSearchIndex index;
+    index.build(GENES);
+    QCOMPARE(index.size(), GENES.size());
+    QCOMPARE(index.findPrefix("act"), QVector<int>({0, 1}));
+    QCOMPARE(index.findPrefix("MT-"), QVector<int>({4, 5}));
+    QCOMPARE(index.findPrefix("Actb2"), QVector<int>());
+    QCOMPARE(index.findPrefix("").size(), GENES.size());
+}
+
+void GeneSearchIndexTest::testSubstring()
+{
+    GeneSearchIndex index;
+    index.build(GENES);
+    QCOMPARE(index.findSubstring("ctb"), QVector<int>({0, 3}));
+    QCOMPARE(index.findSubstring("D"), QVector<int>({2, 5}));
+    QCOMPARE(index.findSubstring("-co1"), QVector<int>({4}));
+    QCOMPARE(index.findSubstring("zzz"), QVector<int>());
+}
+
+void GeneSearchIndexTest::testLiterals()
+{
+    QCOMPARE(GeneSearchIndex::literalPrefix(QRegExp("Act.*")), QString("Act"));
+    QCOMPARE(GeneSearchIndex::literalPrefix(QRegExp("^Ac?t.*")), QString("A"));
+    QCOMPARE(GeneSearchIndex::literalPrefix(QRegExp("Mt\\-.*")), QString("Mt-"));
+    QCOMPARE(GeneSearchIndex::literalPrefix(QRegExp("Actb|Gapdh")), QString());
+    QCOMPARE(GeneSearchIndex::literalPrefix(QRegExp("\\d+")), QString());
+    QCOMPARE(GeneSearchIndex::literalSubstring(
+                 QRegExp("*ct?2*", Qt::CaseInsensitive, QRegExp::WildcardUnix)), QString("ct"));
+    QCOMPARE(GeneSearchIndex::literalSubstring(
+                 QRegExp("a*gapd*", Qt::CaseInsensitive, QRegExp::WildcardUnix)), QString("gapd"));
+}
+
+void GeneSearchIndexTest::testMatches()
+{
+    GeneSearchIndex index;
+    index.build(GENES);
+    QCOMPARE(index.findMatches(QRegExp("act*", Qt::CaseInsensitive, QRegExp::WildcardUnix)),
+             QVector<int>({0, 1}));
+    QCOMPARE(index.findMatches(QRegExp("act*", Qt::CaseSensitive, QRegExp::WildcardUnix)),
+             QVector<int>());
+    QCOMPARE(index.findMatches(QRegExp("*ctb", Qt::CaseSensitive, QRegExp::WildcardUnix)),
+             QVector<int>({0, 3}));
+    QCOMPARE(index.findMatches(QRegExp("mt-.*1", Qt::CaseInsensitive)), QVector<int>({4, 5}));
+    QCOMPARE(index.findMatches(QRegExp("Actb|Gapdh")), QVector<int>({0, 2}));
+    QCOMPARE(index.findMatches(QRegExp("Act", Qt::CaseSensitive, QRegExp::FixedString)),
+             QVector<int>());
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::GeneSearchIndexTest)
+#include "tst_genesearchindextest.moc"
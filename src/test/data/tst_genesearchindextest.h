@@ -0,0 +1,28 @@
+#ifndef TST_GENESEARCHINDEXTEST_H
+#define TST_GENESEARCHINDEXTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class GeneSearchIndexTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GeneSearchIndexTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testPrefix();
+    void testSubstring();
+    void testLiterals();
+    void testMatches();
+};
+
+} // namespace unit //
+
+#endif // TST_GENESEARCHINDEXTEST_H //
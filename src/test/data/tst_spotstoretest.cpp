@@ -0,0 +1,84 @@
+#include <QtTest/QTest>
+
+#include <cstring>
+
+#include "data/SpotStore.h"
+
+#include "tst_spotstoretest.h"
+
+namespace unit
+{
+
+typedef SpotStore::SpotType SpotType;
+
+SpotStoreTest::SpotStoreTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void SpotStoreTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void SpotStoreTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void SpotStoreTest::testParseCoordinates()
+{
+    SpotType coordinates;
+    QVERIFY(SpotStore::parseCoordinates("10x20", coordinates));
+    QCOMPARE(coordinates, SpotType(10, 20));
+    QVERIFY(SpotStore::parseCoordinates(" 10.5x-2.25 ", coordinates));
+    QCOMPARE(coordinates, SpotType(10.5, -2.25));
+    // the prefix of the merged selections
+    QVERIFY(SpotStore::parseCoordinates("3_7x8", coordinates));
+    QCOMPARE(coordinates, SpotType(7, 8));
+    QVERIFY(!SpotStore::parseCoordinates("10", coordinates));
+    QVERIFY(!SpotStore::parseCoordinates("10x", coordinates));
+    QVERIFY(!SpotStore::parseCoordinates("10x20y", coordinates));
+    QVERIFY(!SpotStore::parseCoordinates("Actb", coordinates));
+    QCOMPARE(SpotStore::getCoordinates(SpotStore::getSpot(SpotType(31.5, 4))),
+             SpotType(31.5, 4));
+}
+
+void SpotStoreTest::testParseNumber()
+{
+    const char *text = "1.5e2\t-0.125\t.5";
+    const char *end = text + std::strlen(text);
+    const char *it = text;
+    float value = 0;
+    QVERIFY(SpotStore::parseNumber(it, end, value));
+    QCOMPARE(value, 150.0f);
+    QCOMPARE(*it, '\t');
+    ++it;
+    QVERIFY(SpotStore::parseNumber(it, end, value));
+    QCOMPARE(value, -0.125f);
+    ++it;
+    QVERIFY(SpotStore::parseNumber(it, end, value));
+    QCOMPARE(value, 0.5f);
+    QVERIFY(it == end);
+    QVERIFY(!SpotStore::parseNumber(it, end, value));
+}
+
+void SpotStoreTest::testKeys()
+{
+    QVERIFY(SpotStore::key(SpotType(1, 2)) != SpotStore::key(SpotType(2, 1)));
+    QCOMPARE(SpotStore::key(SpotType(-0.0f, 0)), SpotStore::key(SpotType(0, 0)));
+
+    SpotStore spots;
+    spots.append("1x2", SpotType(10, 20), 5);
+    spots.append("2x1", SpotType(20, 10), 3);
+    QCOMPARE(SpotStore::key(spots.coordinates(1)), SpotStore::key(SpotType(2, 1)));
+    QCOMPARE(spots.coordinates(1), SpotType(2, 1));
+    QCOMPARE(spots.adj_coordinates(1), SpotType(20, 10));
+    spots.clear();
+    QCOMPARE(spots.size(), 0);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::SpotStoreTest)
+#include "tst_spotstoretest.moc"
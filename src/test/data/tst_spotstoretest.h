@@ -0,0 +1,27 @@
+#ifndef TST_SPOTSTORETEST_H
+#define TST_SPOTSTORETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class SpotStoreTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SpotStoreTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testParseCoordinates();
+    void testParseNumber();
+    void testKeys();
+};
+
+} // namespace unit //
+
+#endif // TST_SPOTSTORETEST_H //
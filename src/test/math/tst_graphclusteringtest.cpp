@@ -0,0 +1,223 @@
+#include <QtTest/QTest>
+
+#include "math/GraphClustering.h"
+
+#include "tst_graphclusteringtest.h"
+
+#include <map>
+#include <set>
+#include <utility>
+
+namespace unit
+{
+
+// an unweighted graph with the given edges
+static GraphClustering::Graph makeGraph(const uword n,
+                                        const std::vector<std::pair<uword, uword>> &edges)
+{
+    std::vector<std::vector<uword>> adjacency(n);
+    for (const auto &edge : edges) {
+        adjacency[edge.first].push_back(edge.second);
+        adjacency[edge.second].push_back(edge.first);
+    }
+    GraphClustering::Graph graph;
+    graph.offsets.push_back(0);
+    for (const auto &targets : adjacency) {
+        graph.targets.insert(graph.targets.end(), targets.begin(), targets.end());
+        graph.weights.insert(graph.weights.end(), targets.size(), 1.0);
+        graph.offsets.push_back(graph.targets.size());
+    }
+    return graph;
+}
+
+// two cliques of 5 nodes (0..4 and 5..9) and 3 isolated nodes (10..12)
+static GraphClustering::Graph disconnectedGraph()
+{
+    std::vector<std::pair<uword, uword>> edges;
+    for (uword first = 0; first < 10; first += 5) {
+        for (uword i = first; i < first + 5; ++i) {
+            for (uword j = i + 1; j < first + 5; ++j) {
+                edges.emplace_back(i, j);
+            }
+        }
+    }
+    return makeGraph(13, edges);
+}
+
+// n_blobs groups of n_spots spots (rows) far apart from each other, each group
+// expresses its own block of genes
+static mat blobs(const uword n_blobs, const uword n_spots, const uword n_genes)
+{
+    arma_rng::set_seed(1);
+    mat counts = randn<mat>(n_blobs * n_spots, n_genes) + 10.0;
+    const uword block = n_genes / n_blobs;
+    for (uword b = 0; b < n_blobs; ++b) {
+        counts.submat(b * n_spots, b * block, (b + 1) * n_spots - 1, (b + 1) * block - 1)
+                += 100.0;
+    }
+    return counts;
+}
+
+// the number of different labels
+static unsigned countLabels(const std::vector<int> &labels)
+{
+    return std::set<int>(labels.begin(), labels.end()).size();
+}
+
+// true if the spots of each cluster belong to the same blob
+static bool pureClusters(const std::vector<int> &labels, const uword n_spots)
+{
+    std::map<int, uword> blob_of_cluster;
+    for (uword i = 0; i < labels.size(); ++i) {
+        const auto inserted = blob_of_cluster.insert(std::make_pair(labels[i], i / n_spots));
+        if (inserted.first->second != i / n_spots) {
+            return false;
+        }
+    }
+    return true;
+}
+
+GraphClusteringTest::GraphClusteringTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void GraphClusteringTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void GraphClusteringTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void GraphClusteringTest::testNearestNeighbours()
+{
+    const mat points = {0.0, 1.0, 3.0, 7.0, 15.0};
+    const umat neighbours = GraphClustering::nearestNeighbours(points.t(), 2);
+    const umat expected = {{1, 0, 1, 2, 3}, {2, 2, 0, 1, 2}};
+    QCOMPARE(neighbours.n_rows, uword(2));
+    QCOMPARE(neighbours.n_cols, uword(5));
+    QVERIFY(all(vectorise(neighbours == expected)));
+
+    // there are not as many neighbours as requested
+    QCOMPARE(GraphClustering::nearestNeighbours(points.t(), 10).n_rows, uword(4));
+}
+
+void GraphClusteringTest::testApproximateNeighbours()
+{
+    // big enough to use the random projection trees
+    arma_rng::set_seed(1);
+    const mat points = randn<mat>(6000, 5);
+    const uword k = 10;
+    const umat exact = GraphClustering::nearestNeighbours(points, k);
+    const umat approximate = GraphClustering::approximateNeighbours(points, k);
+    QCOMPARE(approximate.n_rows, k);
+    QCOMPARE(approximate.n_cols, points.n_rows);
+
+    // most of the exact neighbours are found
+    uword found = 0;
+    for (uword i = 0; i < points.n_rows; ++i) {
+        const std::set<uword> expected(exact.colptr(i), exact.colptr(i) + k);
+        for (uword l = 0; l < k; ++l) {
+            QVERIFY(approximate.at(l, i) != i);
+            found += expected.count(approximate.at(l, i));
+        }
+    }
+    QVERIFY(found > 0.8 * exact.n_elem);
+}
+
+void GraphClusteringTest::testSeparatedBlobs()
+{
+    const uword n_spots = 100;
+    const mat counts = blobs(3, n_spots, 60);
+    std::vector<int> labels;
+
+    // the blobs are the clusters
+    QCOMPARE(GraphClustering::graphClusters(counts, 3, labels), 3u);
+    QCOMPARE(labels.size(), static_cast<size_t>(counts.n_rows));
+    QVERIFY(pureClusters(labels, n_spots));
+    QCOMPARE(countLabels(labels), 3u);
+
+    // the blobs may be split but they are never mixed
+    const unsigned clusters = GraphClustering::graphClusters(counts, 10, labels);
+    QVERIFY(clusters >= 3);
+    QVERIFY(clusters <= 10);
+    QVERIFY(pureClusters(labels, n_spots));
+}
+
+void GraphClusteringTest::testEstimateClusters()
+{
+    const uword n_spots = 100;
+    const mat counts = blobs(3, n_spots, 60);
+    std::vector<int> labels;
+
+    // each cluster has at least a tenth of the spots
+    const unsigned clusters = GraphClustering::estimateClusters(counts, labels);
+    QVERIFY(clusters >= 3);
+    QVERIFY(clusters <= 10);
+    QCOMPARE(countLabels(labels), clusters);
+    QVERIFY(pureClusters(labels, n_spots));
+
+    // too few spots
+    QCOMPARE(GraphClustering::estimateClusters(counts.row(0), labels), 0u);
+    QVERIFY(labels.empty());
+}
+
+void GraphClusteringTest::testMergeDisconnected()
+{
+    const GraphClustering::Graph graph = disconnectedGraph();
+    std::vector<int> labels;
+    // each clique is a community and each isolated node is alone
+    QCOMPARE(GraphClustering::louvain(graph, 1.0, labels), 5u);
+    const std::vector<int> communities = labels;
+
+    // the isolated nodes are not connected to any community
+    QCOMPARE(GraphClustering::mergeSmallCommunities(graph, 0, 2, labels), 2u);
+    QCOMPARE(countLabels(labels), 2u);
+    QVERIFY(*std::max_element(labels.begin(), labels.end()) < 2);
+    QVERIFY(labels[0] != labels[5]);
+    for (uword node = 1; node < 5; ++node) {
+        QCOMPARE(labels[node], labels[0]);
+        QCOMPARE(labels[node + 5], labels[5]);
+    }
+
+    // also when they are too small
+    labels = communities;
+    QCOMPARE(GraphClustering::mergeSmallCommunities(graph, 4, 10, labels), 2u);
+    QVERIFY(labels[0] != labels[5]);
+
+    labels = communities;
+    QCOMPARE(GraphClustering::mergeSmallCommunities(graph, 0, 1, labels), 1u);
+    QCOMPARE(countLabels(labels), 1u);
+    QCOMPARE(labels[12], 0);
+}
+
+void GraphClusteringTest::testMaxClusters()
+{
+    // two groups and some isolated spots, each one far from everything else
+    mat counts = blobs(2, 100, 40);
+    counts.resize(counts.n_rows + 6, counts.n_cols);
+    for (uword i = 0; i < 6; ++i) {
+        counts.row(200 + i).fill(10.0);
+        counts.at(200 + i, (i * 7) % counts.n_cols) = 1000.0 * (i + 1);
+    }
+
+    std::vector<int> labels;
+    for (unsigned max_clusters : {2u, 3u}) {
+        const unsigned clusters = GraphClustering::graphClusters(counts, max_clusters, labels);
+        QVERIFY(clusters > 0);
+        QVERIFY(clusters <= max_clusters);
+        QCOMPARE(labels.size(), static_cast<size_t>(counts.n_rows));
+        QVERIFY(*std::min_element(labels.begin(), labels.end()) == 0);
+        QVERIFY(*std::max_element(labels.begin(), labels.end())
+                < static_cast<int>(max_clusters));
+        QCOMPARE(countLabels(labels), clusters);
+    }
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::GraphClusteringTest)
+#include "tst_graphclusteringtest.moc"
@@ -0,0 +1,30 @@
+#ifndef TST_GRAPHCLUSTERINGTEST_H
+#define TST_GRAPHCLUSTERINGTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class GraphClusteringTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GraphClusteringTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testNearestNeighbours();
+    void testApproximateNeighbours();
+    void testSeparatedBlobs();
+    void testEstimateClusters();
+    void testMergeDisconnected();
+    void testMaxClusters();
+};
+
+} // namespace unit //
+
+#endif // TST_GRAPHCLUSTERINGTEST_H //
@@ -0,0 +1,84 @@
+#include <QtTest/QTest>
+
+#include "math/PCA.h"
+
+#include "tst_pcatest.h"
+
+namespace unit
+{
+
+// the exact scores of the centered matrix (signs can differ)
+static mat exactScores(const mat &counts, const int no_components)
+{
+    mat centered = counts;
+    centered.each_row() -= mean(counts, 0);
+    mat U;
+    vec s;
+    mat V;
+    svd_econ(U, s, V, centered);
+    mat scores = U.cols(0, no_components - 1);
+    scores.each_row() %= s.head(no_components).t();
+    return scores;
+}
+
+// a non-negative low rank matrix with some noise
+static mat lowRankMatrix(const uword n_rows, const uword n_cols)
+{
+    arma_rng::set_seed(1);
+    mat counts = abs(randn<mat>(n_rows, 3)) * abs(randn<mat>(3, n_cols)) * 10.0;
+    counts += randu<mat>(n_rows, n_cols) * 0.01;
+    return counts;
+}
+
+PCATest::PCATest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void PCATest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void PCATest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void PCATest::testSmallMatrix()
+{
+    // two observations give one non-zero component
+    mat counts = {{1.0, 2.0, 3.0}, {3.0, 2.0, 1.0}};
+    mat results;
+    QVERIFY(PCA::compute(counts, 2, true, false, results));
+    QCOMPARE(results.n_rows, counts.n_rows);
+    QCOMPARE(results.n_cols, uword(2));
+    QVERIFY(std::abs(results.at(0, 0) + results.at(1, 0)) < 1e-9);
+    QVERIFY(std::abs(std::abs(results.at(0, 0)) - std::sqrt(2.0)) < 1e-9);
+    QVERIFY(std::abs(results.at(0, 1)) < 1e-9);
+}
+
+void PCATest::testRandomizedDense()
+{
+    const mat counts = lowRankMatrix(300, 120);
+    mat results;
+    QVERIFY(PCA::compute(counts, 2, true, false, results));
+    const mat expected = exactScores(counts, 2);
+    QVERIFY(approx_equal(abs(results), abs(expected), "absdiff", 1e-4));
+}
+
+void PCATest::testRandomizedSparse()
+{
+    mat counts = lowRankMatrix(300, 120);
+    counts.elem(find(counts < 5.0)).zeros();
+    mat dense_results;
+    mat sparse_results;
+    QVERIFY(PCA::compute(counts, 2, true, false, dense_results));
+    QVERIFY(PCA::compute(sp_mat(counts), 2, true, false, sparse_results));
+    QVERIFY(approx_equal(dense_results, sparse_results, "absdiff", 1e-6));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::PCATest)
+#include "tst_pcatest.moc"
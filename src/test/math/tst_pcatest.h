@@ -0,0 +1,27 @@
+#ifndef TST_PCATEST_H
+#define TST_PCATEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class PCATest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PCATest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testSmallMatrix();
+    void testRandomizedDense();
+    void testRandomizedSparse();
+};
+
+} // namespace unit //
+
+#endif // TST_PCATEST_H //
@@ -0,0 +1,96 @@
+#include <QtTest/QTest>
+
+#include <random>
+
+#include "math/PointIndex.h"
+
+#include "tst_pointindextest.h"
+
+namespace unit
+{
+
+// a grid of 3x3 points (index = x + 3 * y) and a duplicated point
+static const QVector<QPointF> POINTS = {QPointF(0, 0), QPointF(1, 0), QPointF(2, 0),
+                                        QPointF(0, 1), QPointF(1, 1), QPointF(2, 1),
+                                        QPointF(0, 2), QPointF(1, 2), QPointF(2, 2),
+                                        QPointF(1, 1)};
+
+PointIndexTest::PointIndexTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void PointIndexTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void PointIndexTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void PointIndexTest::testPointsIn()
+{
+    PointIndex index;
+    QCOMPARE(index.pointsIn(QRectF(0, 0, 2, 2)), QVector<int>());
+    index.build(POINTS);
+    QCOMPARE(index.size(), POINTS.size());
+    QCOMPARE(index.pointsIn(QRectF(0, 0, 1, 1)), QVector<int>({0, 1, 3, 4, 9}));
+    QCOMPARE(index.pointsIn(QRectF(1.5, -1, 1, 10)), QVector<int>({2, 5, 8}));
+    QCOMPARE(index.pointsIn(QRectF(2, 2, -2, -1)), QVector<int>({3, 4, 5, 6, 7, 8, 9}));
+    QCOMPARE(index.pointsIn(QRectF(3, 3, 1, 1)), QVector<int>());
+}
+
+void PointIndexTest::testNearest()
+{
+    PointIndex index;
+    QCOMPARE(index.nearest(QPointF(0, 0), 1.0), -1);
+    index.build(POINTS);
+    QCOMPARE(index.nearest(QPointF(0.1, 1.8), 1.0), 6);
+    // the duplicated point gives the lowest index
+    QCOMPARE(index.nearest(QPointF(1.2, 1.1), 1.0), 4);
+    QCOMPARE(index.nearest(QPointF(5, 5), 1.0), -1);
+    // the distance on y counts ten times more than on x
+    QCOMPARE(index.nearest(QPointF(1.4, 0.05), 1.0, 1.0, 10.0), 1);
+    QCOMPARE(index.nearest(QPointF(1.4, 0.05), 0.1, 1.0, 10.0), -1);
+}
+
+void PointIndexTest::testRandomPoints()
+{
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> uniform(-100.0, 100.0);
+    QVector<QPointF> points;
+    for (int i = 0; i < 5000; ++i) {
+        points.push_back(QPointF(uniform(generator), uniform(generator)));
+    }
+    PointIndex index;
+    index.build(points);
+    for (int query = 0; query < 100; ++query) {
+        const QPointF pos(uniform(generator), uniform(generator));
+        const QRectF rect(pos, QSizeF(20.0, 10.0));
+        const qreal max_distance = 5.0;
+        QVector<int> expected_points;
+        int expected_nearest = -1;
+        qreal expected_distance = max_distance * max_distance;
+        for (int i = 0; i < points.size(); ++i) {
+            const QPointF &point = points.at(i);
+            if (rect.contains(point)) {
+                expected_points.push_back(i);
+            }
+            const QPointF delta = point - pos;
+            const qreal distance = QPointF::dotProduct(delta, delta);
+            if (distance < expected_distance) {
+                expected_distance = distance;
+                expected_nearest = i;
+            }
+        }
+        QCOMPARE(index.pointsIn(rect), expected_points);
+        QCOMPARE(index.nearest(pos, max_distance), expected_nearest);
+    }
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::PointIndexTest)
+#include "tst_pointindextest.moc"
@@ -0,0 +1,27 @@
+#ifndef TST_POINTINDEXTEST_H
+#define TST_POINTINDEXTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class PointIndexTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PointIndexTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testPointsIn();
+    void testNearest();
+    void testRandomPoints();
+};
+
+} // namespace unit //
+
+#endif // TST_POINTINDEXTEST_H //
@@ -0,0 +1,180 @@
+#include <QtTest/QTest>
+#include <QImage>
+
+#include "math/TissueMask.h"
+
+#include "tst_tissuemasktest.h"
+
+#include <random>
+
+namespace unit
+{
+
+// a gray scale image with random values (the values around the middle of the range
+// are more frequent to test the thresholds and the signed comparisons)
+static QImage randomImage(const int width, const int height, const unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> values(0, 255);
+    std::uniform_int_distribution<int> middle(125, 130);
+    QImage image(width, height, QImage::Format_Grayscale8);
+    for (int y = 0; y < height; ++y) {
+        uchar *line = image.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            line[x] = static_cast<uchar>(x % 3 == 0 ? middle(generator) : values(generator));
+        }
+    }
+    return image;
+}
+
+// compares the mask with a scalar thresholding of the gray scale image
+static bool sameAsReference(const TissueMask &mask,
+                            const QImage &gray_scale,
+                            const int step,
+                            const int threshold,
+                            QString &error)
+{
+    const int width = (gray_scale.width() + step - 1) / step;
+    const int height = (gray_scale.height() + step - 1) / step;
+    if (mask.width() != width || mask.height() != height || mask.step() != step) {
+        error = QString("size %1x%2 step %3").arg(mask.width()).arg(mask.height()).arg(step);
+        return false;
+    }
+    QList<QPointF> points;
+    for (int row = 0; row < height; ++row) {
+        const uchar *line = gray_scale.constScanLine(row * step);
+        for (int column = 0; column < width; ++column) {
+            const bool inside = line[column * step] > threshold;
+            if (mask.contains(column, row) != inside) {
+                error = QString("sample %1,%2").arg(column).arg(row);
+                return false;
+            }
+            if (inside) {
+                points.append(QPointF(column * step, row * step));
+            }
+        }
+        // the padding bits of the row are not set
+        const int padding = width % 64;
+        if (padding != 0) {
+            const quint64 last = mask.bits().at(row * mask.wordsPerRow() + width / 64);
+            if ((last >> padding) != 0) {
+                error = QString("padding of row %1").arg(row);
+                return false;
+            }
+        }
+    }
+    if (mask.count() != points.size() || mask.points() != points) {
+        error = QString("points");
+        return false;
+    }
+    return true;
+}
+
+TissueMaskTest::TissueMaskTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void TissueMaskTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void TissueMaskTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void TissueMaskTest::testEmpty()
+{
+    QVERIFY(TissueMask().isNull());
+    QVERIFY(TissueMask::compute(QImage()).isNull());
+    QVERIFY(TissueMask::compute(randomImage(10, 10, 1), 0).isNull());
+}
+
+void TissueMaskTest::testSizes()
+{
+    // odd widths, the tails of the 16 pixels blocks, the 64 bits words
+    // and the boundaries of the stripes of rows
+    const QList<int> widths = {1, 7, 15, 16, 17, 31, 63, 64, 65, 79, 127, 128, 129, 201};
+    const QList<int> heights = {1, 15, 16, 17, 33, 100, 257};
+    const QList<int> steps = {1, 2, 3, 7};
+    unsigned seed = 1;
+    for (const int width : widths) {
+        for (const int height : heights) {
+            const QImage image = randomImage(width, height, seed++);
+            for (const int step : steps) {
+                const TissueMask mask = TissueMask::compute(image, step, 127);
+                QString error;
+                QVERIFY2(sameAsReference(mask, image, step, 127, error),
+                         qPrintable(QString("%1x%2 step %3: %4")
+                                    .arg(width).arg(height).arg(step).arg(error)));
+            }
+        }
+    }
+}
+
+void TissueMaskTest::testThresholds()
+{
+    // the thresholds around the sign bit and the extremes
+    const QImage image = randomImage(83, 40, 7);
+    for (const int threshold : {0, 1, 126, 127, 128, 129, 200, 254, 255}) {
+        for (const int step : {1, 2}) {
+            const TissueMask mask = TissueMask::compute(image, step, threshold);
+            QString error;
+            QVERIFY2(sameAsReference(mask, image, step, threshold, error),
+                     qPrintable(QString("threshold %1 step %2: %3")
+                                .arg(threshold).arg(step).arg(error)));
+        }
+    }
+    // nothing is above the maximum gray value
+    QCOMPARE(TissueMask::compute(image, 1, 255).count(), 0);
+    // the threshold is clamped
+    QCOMPARE(TissueMask::compute(image, 1, 1000).count(), 0);
+    QCOMPARE(TissueMask::compute(image, 1, -5).count(),
+             TissueMask::compute(image, 1, 0).count());
+}
+
+void TissueMaskTest::testColorImage()
+{
+    // the color images are converted to gray scale
+    QImage image(70, 35, QImage::Format_RGB32);
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<int> values(0, 255);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            image.setPixel(x, y, qRgb(values(generator), values(generator), values(generator)));
+        }
+    }
+    const QImage gray_scale = image.convertToFormat(QImage::Format_Grayscale8);
+    for (const int step : {1, 4}) {
+        const TissueMask mask = TissueMask::compute(image, step, 100);
+        QString error;
+        QVERIFY2(sameAsReference(mask, gray_scale, step, 100, error), qPrintable(error));
+    }
+}
+
+void TissueMaskTest::testQueries()
+{
+    QImage image(10, 6, QImage::Format_Grayscale8);
+    image.fill(0);
+    image.scanLine(2)[4] = 255;
+    image.scanLine(5)[9] = 255;
+    const TissueMask mask = TissueMask::compute(image, 2, 127);
+    QCOMPARE(mask.width(), 5);
+    QCOMPARE(mask.height(), 3);
+    QCOMPARE(mask.count(), 1);
+    QVERIFY(mask.contains(2, 1));
+    QVERIFY(!mask.contains(4, 2));
+    QVERIFY(!mask.contains(-1, 0));
+    QVERIFY(!mask.contains(5, 0));
+    QVERIFY(mask.containsPixel(QPointF(4.5, 3.9)));
+    QVERIFY(!mask.containsPixel(QPointF(6.0, 2.0)));
+    QVERIFY(!mask.containsPixel(QPointF(-0.5, 2.0)));
+    QCOMPARE(mask.points(), QList<QPointF>() << QPointF(4, 2));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::TissueMaskTest)
+#include "tst_tissuemasktest.moc"
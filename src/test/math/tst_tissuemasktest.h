@@ -0,0 +1,29 @@
+#ifndef TST_TISSUEMASKTEST_H
+#define TST_TISSUEMASKTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class TissueMaskTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TissueMaskTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testEmpty();
+    void testSizes();
+    void testThresholds();
+    void testColorImage();
+    void testQueries();
+};
+
+} // namespace unit //
+
+#endif // TST_TISSUEMASKTEST_H //
@@ -0,0 +1,201 @@
+#include <QtTest/QTest>
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "math/TSNE.h"
+#include "math/SnapshotBuffer.h"
+
+#include "tst_tsnetest.h"
+
+#include <algorithm>
+
+namespace unit
+{
+
+// two groups of n_spots observations (rows) far apart from each other
+static mat twoBlobs(const uword n_spots, const uword n_genes)
+{
+    arma_rng::set_seed(1);
+    mat counts = randn<mat>(2 * n_spots, n_genes);
+    counts.rows(n_spots, 2 * n_spots - 1) += 20.0;
+    return counts;
+}
+
+TSNETest::TSNETest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void TSNETest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void TSNETest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void TSNETest::testSnapshotBuffer()
+{
+    SnapshotBuffer<int> buffer;
+    int value = 0;
+    QVERIFY(!buffer.take(value));
+
+    // only the most recent value is taken and only once
+    buffer.publish(1);
+    buffer.publish(2);
+    QVERIFY(buffer.take(value));
+    QCOMPARE(value, 2);
+    QVERIFY(!buffer.take(value));
+
+    buffer.publish(3);
+    QVERIFY(buffer.take(value));
+    QCOMPARE(value, 3);
+
+    // the value not taken is discarded
+    buffer.publish(4);
+    buffer.clear();
+    QVERIFY(!buffer.take(value));
+    QCOMPARE(value, 3);
+}
+
+void TSNETest::testSnapshotBufferThreads()
+{
+    SnapshotBuffer<std::vector<int>> buffer;
+    const int count = 100000;
+    QFuture<void> producer = QtConcurrent::run([&buffer]() {
+        for (int i = 1; i <= count; ++i) {
+            // each value is consistent (all the elements are the same)
+            buffer.publish(std::vector<int>(8, i));
+        }
+    });
+
+    // the values are taken in order and never torn
+    std::vector<int> value;
+    int last = 0;
+    bool consistent = true;
+    while (last < count) {
+        // nothing is pending if the producer had finished before an empty take
+        const bool finished = producer.isFinished();
+        if (buffer.take(value)) {
+            consistent = consistent && value.front() > last
+                    && std::count(value.begin(), value.end(), value.front()) == 8;
+            last = value.front();
+        } else if (finished) {
+            break;
+        }
+    }
+    producer.waitForFinished();
+    QVERIFY(consistent);
+    QCOMPARE(last, count);
+}
+
+void TSNETest::testShape()
+{
+    const mat counts = twoBlobs(50, 20);
+    TSNE tsne;
+    mat results;
+    QVERIFY(tsne.compute(counts, 10, 10.0, 0.5, 250, 0, results));
+    QCOMPARE(results.n_rows, counts.n_rows);
+    QCOMPARE(results.n_cols, uword(2));
+    QVERIFY(results.is_finite());
+
+    // the perplexity is too big for the number of observations
+    QVERIFY(!tsne.compute(counts, 10, 50.0, 0.5, 250, 0, results));
+    QVERIFY(results.is_empty());
+}
+
+void TSNETest::testDeterminism()
+{
+    // the seed is fixed so the same data gives the same embedding
+    const mat counts = twoBlobs(50, 20);
+    TSNE tsne;
+    mat first;
+    mat second;
+    QVERIFY(tsne.compute(counts, 10, 10.0, 0.5, 250, 0, first));
+    QVERIFY(tsne.compute(counts, 10, 10.0, 0.5, 250, 0, second));
+    QVERIFY(all(vectorise(first == second)));
+}
+
+void TSNETest::testSeparation()
+{
+    const uword n_spots = 60;
+    const mat counts = twoBlobs(n_spots, 20);
+    TSNE tsne;
+    mat results;
+    QVERIFY(tsne.compute(counts, 10, 10.0, 0.5, 500, 0, results));
+
+    // the closest observation of each one in the embedding belongs to the same group
+    uword same = 0;
+    for (uword i = 0; i < results.n_rows; ++i) {
+        vec distances = sum(square(results.each_row() - results.row(i)), 1);
+        distances.at(i) = datum::inf;
+        same += (distances.index_min() < n_spots) == (i < n_spots);
+    }
+    QCOMPARE(same, results.n_rows);
+
+    // and the groups are far apart compared to their spread
+    const mat first_group = results.rows(0, n_spots - 1);
+    const mat second_group = results.rows(n_spots, 2 * n_spots - 1);
+    const rowvec first = mean(first_group, 0);
+    const rowvec second = mean(second_group, 0);
+    const double spread
+            = std::max(mean(sqrt(sum(square(first_group.each_row() - first), 1))),
+                       mean(sqrt(sum(square(second_group.each_row() - second), 1))));
+    QVERIFY(norm(first - second) > 2.0 * spread);
+}
+
+void TSNETest::testStop()
+{
+    const mat counts = twoBlobs(60, 20);
+    const int max_iter = 1000000;
+    TSNE tsne;
+    mat results;
+    QFuture<bool> future = QtConcurrent::run([&]() {
+        return tsne.compute(counts, 10, 10.0, 0.5, max_iter, 1, results);
+    });
+
+    // the embedding is published while it converges (the computation is stopped
+    // before checking so it does not outlive the test)
+    TSNE::Snapshot snapshot;
+    QList<int> iterations;
+    bool shaped = true;
+    QElapsedTimer timer;
+    timer.start();
+    while (iterations.size() < 2 && !timer.hasExpired(30000)) {
+        if (tsne.snapshot(snapshot)) {
+            iterations.append(snapshot.iteration);
+            shaped = shaped && snapshot.embedding.n_rows == counts.n_rows
+                    && snapshot.embedding.n_cols == 2;
+        }
+        QThread::msleep(1);
+    }
+    tsne.stop();
+    const bool computed = future.result();
+    QCOMPARE(iterations.size(), 2);
+    QVERIFY(shaped);
+    QVERIFY(iterations.first() > 0);
+    QVERIFY(iterations.last() > iterations.first());
+
+    // the computation stops with the last embedding
+    QVERIFY(tsne.isStopped());
+    QVERIFY(computed);
+    QCOMPARE(results.n_rows, counts.n_rows);
+    QCOMPARE(results.n_cols, uword(2));
+    QVERIFY(results.is_finite());
+    if (tsne.snapshot(snapshot)) {
+        QVERIFY(snapshot.iteration < max_iter);
+    }
+
+    // nothing is pending after a reset
+    tsne.reset();
+    QVERIFY(!tsne.isStopped());
+    QVERIFY(!tsne.snapshot(snapshot));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::TSNETest)
+#include "tst_tsnetest.moc"
@@ -0,0 +1,30 @@
+#ifndef TST_TSNETEST_H
+#define TST_TSNETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class TSNETest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TSNETest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testSnapshotBuffer();
+    void testSnapshotBufferThreads();
+    void testShape();
+    void testDeterminism();
+    void testSeparation();
+    void testStop();
+};
+
+} // namespace unit //
+
+#endif // TST_TSNETEST_H //
@@ -0,0 +1,189 @@
+#include <QtTest/QTest>
+
+#include "profiling/MemoryAccounting.h"
+
+#include "tst_memoryaccountingtest.h"
+
+namespace unit
+{
+
+MemoryAccountingTest::MemoryAccountingTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void MemoryAccountingTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void MemoryAccountingTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void MemoryAccountingTest::testAccount()
+{
+    MemoryAccounting &accounting = MemoryAccounting::instance();
+    const int first = 0;
+    const int second = 0;
+    accounting.account(&first, MemoryAccounting::Datasets, "dataset",
+                       MemoryAccounting::Usage(100));
+    accounting.account(&first, MemoryAccounting::Textures, "dataset",
+                       MemoryAccounting::Usage(10, 50));
+    accounting.account(&second, MemoryAccounting::Datasets, "dataset",
+                       MemoryAccounting::Usage(30));
+    QCOMPARE(accounting.usage(MemoryAccounting::Datasets, "dataset").cpu_bytes, 130LL);
+    QCOMPARE(accounting.usage(MemoryAccounting::Textures, "dataset").total(), 60LL);
+    QCOMPARE(accounting.usage(MemoryAccounting::Datasets, "other").total(), 0LL);
+
+    // accounting again replaces the usage
+    accounting.account(&first, MemoryAccounting::Datasets, "dataset",
+                       MemoryAccounting::Usage(200));
+    QCOMPARE(accounting.total(MemoryAccounting::Datasets).cpu_bytes, 230LL);
+
+    accounting.release(&first);
+    QCOMPARE(accounting.total(MemoryAccounting::Datasets).cpu_bytes, 30LL);
+    QCOMPARE(accounting.total(MemoryAccounting::Textures).total(), 0LL);
+    accounting.release(&second);
+    QCOMPARE(accounting.total(MemoryAccounting::Datasets).total(), 0LL);
+}
+
+void MemoryAccountingTest::testEviction()
+{
+    MemoryAccounting &accounting = MemoryAccounting::instance();
+    const qint64 budget = accounting.budget(MemoryAccounting::Caches);
+    const int owner = 0;
+    qint64 older = 200;
+    qint64 recent = 100;
+    accounting.registerCache(&owner, "dataset", "older",
+                             [&]() { return older; }, [&]() { older = 0; });
+    accounting.registerCache(&owner, "dataset", "recent",
+                             [&]() { return recent; }, [&]() { recent = 0; });
+    QCOMPARE(accounting.usage(MemoryAccounting::Caches, "dataset").cpu_bytes, 300LL);
+
+    // within the budget nothing is evicted
+    accounting.setBudget(MemoryAccounting::Caches, 1000);
+    QCOMPARE(accounting.enforceBudgets(), 0LL);
+
+    // the least recently used cache is evicted first
+    accounting.touchCache(&owner, "older");
+    accounting.setBudget(MemoryAccounting::Caches, 250);
+    QCOMPARE(accounting.enforceBudgets(), 100LL);
+    QCOMPARE(recent, 0LL);
+    QCOMPARE(older, 200LL);
+
+    // the caches are built again
+    recent = 100;
+    accounting.updateCache(&owner, "recent");
+    QCOMPARE(accounting.enforceBudgets(), 200LL);
+    QCOMPARE(older, 0LL);
+    QCOMPARE(recent, 100LL);
+
+    QCOMPARE(accounting.evictCaches(), 100LL);
+    QCOMPARE(accounting.total(MemoryAccounting::Caches).total(), 0LL);
+
+    accounting.release(&owner);
+    accounting.setBudget(MemoryAccounting::Caches, budget);
+}
+
+void MemoryAccountingTest::testTouch()
+{
+    MemoryAccounting &accounting = MemoryAccounting::instance();
+    const int owner = 0;
+    qint64 bytes = 100;
+    int measured = 0;
+    accounting.registerCache(&owner, "dataset", "cache",
+                             [&]() { ++measured; return bytes; }, [&]() { bytes = 0; });
+    QCOMPARE(measured, 1);
+    int changed = 0;
+    const auto connection = connect(&accounting, &MemoryAccounting::usageChanged,
+                                    [&]() { ++changed; });
+
+    // the queries and the uses do not measure the cache
+    bytes = 300;
+    accounting.touchCache(&owner, "cache");
+    QCOMPARE(accounting.usage(MemoryAccounting::Caches, "dataset").cpu_bytes, 100LL);
+    QCOMPARE(accounting.total(MemoryAccounting::Caches).cpu_bytes, 100LL);
+    QCOMPARE(measured, 1);
+    QCOMPARE(changed, 0);
+
+    // the cache is measured when it is built again
+    accounting.updateCache(&owner, "cache");
+    QCOMPARE(accounting.usage(MemoryAccounting::Caches, "dataset").cpu_bytes, 300LL);
+    QCOMPARE(measured, 2);
+    QCOMPARE(changed, 1);
+
+    // and after it is evicted
+    QCOMPARE(accounting.evictCaches(), 300LL);
+    QCOMPARE(accounting.total(MemoryAccounting::Caches).total(), 0LL);
+
+    disconnect(connection);
+    accounting.release(&owner);
+}
+
+void MemoryAccountingTest::testPressure()
+{
+    MemoryAccounting &accounting = MemoryAccounting::instance();
+    const int owner = 0;
+    const int other = 0;
+    qint64 cache = 50;
+    qint64 other_cache = 20;
+    int exceeded = 0;
+    const auto connection = connect(&accounting, &MemoryAccounting::budgetExceeded,
+                                    [&](MemoryAccounting::Category category,
+                                        qint64 bytes,
+                                        qint64 budget) {
+        QCOMPARE(category, MemoryAccounting::Datasets);
+        QCOMPARE(bytes, 100LL);
+        QCOMPARE(budget, 10LL);
+        ++exceeded;
+    });
+
+    // the caches are evicted when the datasets exceed their budget
+    // but not the caches of the dataset (they would be computed again)
+    accounting.account(&owner, MemoryAccounting::Datasets, "dataset",
+                       MemoryAccounting::Usage(100));
+    accounting.registerCache(&owner, "dataset", "cache",
+                             [&]() { return cache; }, [&]() { cache = 0; });
+    accounting.registerCache(&other, "other", "cache",
+                             [&]() { return other_cache; }, [&]() { other_cache = 0; });
+    accounting.touchCache(&owner, "cache");
+    accounting.setBudget(MemoryAccounting::Datasets, 10);
+    QCOMPARE(accounting.enforceBudgets(), 20LL);
+    QCOMPARE(other_cache, 0LL);
+    QCOMPARE(cache, 50LL);
+    QCOMPARE(exceeded, 1);
+
+    // the user is only warned once and the cache of the dataset is kept when it is used
+    accounting.touchCache(&owner, "cache");
+    QCOMPARE(accounting.enforceBudgets(), 0LL);
+    QCOMPARE(cache, 50LL);
+    QCOMPARE(exceeded, 1);
+
+    // the caches budget still applies to it
+    const qint64 budget = accounting.budget(MemoryAccounting::Caches);
+    accounting.setBudget(MemoryAccounting::Caches, 10);
+    QCOMPARE(accounting.enforceBudgets(), 50LL);
+    QCOMPARE(cache, 0LL);
+    accounting.setBudget(MemoryAccounting::Caches, budget);
+
+    disconnect(connection);
+    accounting.release(&owner);
+    accounting.release(&other);
+    accounting.setBudget(MemoryAccounting::Datasets, 0);
+    QCOMPARE(accounting.enforceBudgets(), 0LL);
+}
+
+void MemoryAccountingTest::testFormat()
+{
+    QCOMPARE(MemoryAccounting::formatBytes(512), QString("512 B"));
+    QCOMPARE(MemoryAccounting::formatBytes(1536), QString("1.5 KB"));
+    QCOMPARE(MemoryAccounting::formatBytes(3 * 1024 * 1024), QString("3.0 MB"));
+    QCOMPARE(MemoryAccounting::formatBytes(2LL * 1024 * 1024 * 1024), QString("2.00 GB"));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::MemoryAccountingTest)
+#include "tst_memoryaccountingtest.moc"
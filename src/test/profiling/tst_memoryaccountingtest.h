@@ -0,0 +1,29 @@
+#ifndef TST_MEMORYACCOUNTINGTEST_H
+#define TST_MEMORYACCOUNTINGTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class MemoryAccountingTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MemoryAccountingTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testAccount();
+    void testEviction();
+    void testTouch();
+    void testPressure();
+    void testFormat();
+};
+
+} // namespace unit //
+
+#endif // TST_MEMORYACCOUNTINGTEST_H //
@@ -0,0 +1,186 @@
+#include <QtTest/QTest>
+#include <QtConcurrent>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <cstring>
+#include <thread>
+
+#include "profiling/Profiler.h"
+
+#include "tst_profilertest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// the collected events with the given name
+QVector<Profiler::Event> eventsNamed(const char *name)
+{
+    QVector<Profiler::Event> events;
+    for (const auto &event : Profiler::events()) {
+        if (std::strcmp(event.name, name) == 0) {
+            events.push_back(event);
+        }
+    }
+    return events;
+}
+
+}
+
+ProfilerTest::ProfilerTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ProfilerTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void ProfilerTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void ProfilerTest::testRecord()
+{
+    Profiler::collect();
+    Profiler::clear();
+    {
+        const Profiler::ScopedTimer timer("scope");
+        QTest::qSleep(2);
+    }
+    Profiler::record("counter", Profiler::Counter, Profiler::now(), 42);
+    // nothing is visible until the events are collected
+    QVERIFY(Profiler::events().empty());
+    QCOMPARE(Profiler::collect(), 0);
+
+    const QVector<Profiler::Event> timers = eventsNamed("scope");
+    QCOMPARE(timers.size(), 1);
+    QCOMPARE(timers.first().type, Profiler::Timer);
+    QVERIFY(timers.first().value >= 2000000);
+    QCOMPARE(Profiler::threadName(timers.first().thread), QString("main"));
+    const QVector<Profiler::Event> counters = eventsNamed("counter");
+    QCOMPARE(counters.size(), 1);
+    QCOMPARE(counters.first().type, Profiler::Counter);
+    QCOMPARE(counters.first().value, qint64(42));
+    QVERIFY(counters.first().time_ns >= timers.first().time_ns + timers.first().value);
+
+    // the events are collected once
+    QCOMPARE(Profiler::collect(), 0);
+    QCOMPARE(Profiler::events().size(), 2);
+    Profiler::clear();
+    QVERIFY(Profiler::events().empty());
+}
+
+void ProfilerTest::testThreads()
+{
+    Profiler::collect();
+    Profiler::clear();
+    Profiler::record("main thread", Profiler::Counter, Profiler::now(), 1);
+    QtConcurrent::run([]() {
+        for (int i = 0; i < 100; ++i) {
+            Profiler::record("worker thread", Profiler::Counter, Profiler::now(), i);
+        }
+    }).waitForFinished();
+    QCOMPARE(Profiler::collect(), 0);
+
+    const QVector<Profiler::Event> main = eventsNamed("main thread");
+    const QVector<Profiler::Event> worker = eventsNamed("worker thread");
+    QCOMPARE(main.size(), 1);
+    QCOMPARE(worker.size(), 100);
+    QVERIFY(main.first().thread != worker.first().thread);
+    // the events of a thread are in the order they were recorded
+    for (int i = 0; i < worker.size(); ++i) {
+        QCOMPARE(worker.at(i).value, qint64(i));
+    }
+    Profiler::clear();
+}
+
+void ProfilerTest::testReuseBuffers()
+{
+    Profiler::collect();
+    Profiler::clear();
+    std::thread([]() { Profiler::record("first thread", Profiler::Counter, 0, 1); }).join();
+    QCOMPARE(Profiler::collect(), 0);
+    const int buffers = Profiler::threadBuffers();
+    // the buffer of a finished thread is reused once its events are collected
+    for (int i = 0; i < 10; ++i) {
+        std::thread([i]() { Profiler::record("next thread", Profiler::Counter, 0, i); }).join();
+        QCOMPARE(Profiler::collect(), 0);
+    }
+    QCOMPARE(Profiler::threadBuffers(), buffers);
+
+    // the threads keep their own index and name
+    const QVector<Profiler::Event> first = eventsNamed("first thread");
+    const QVector<Profiler::Event> next = eventsNamed("next thread");
+    QCOMPARE(first.size(), 1);
+    QCOMPARE(next.size(), 10);
+    for (int i = 0; i < next.size(); ++i) {
+        QCOMPARE(next.at(i).value, qint64(i));
+        QVERIFY(next.at(i).thread != first.first().thread);
+        QVERIFY(Profiler::threadName(next.at(i).thread)
+                != Profiler::threadName(first.first().thread));
+    }
+    Profiler::clear();
+}
+
+void ProfilerTest::testOverflow()
+{
+    Profiler::collect();
+    Profiler::clear();
+    // the oldest events are overwritten when the buffer of the thread is full
+    const int recorded = 100000;
+    for (int i = 0; i < recorded; ++i) {
+        Profiler::record("overflow", Profiler::Counter, Profiler::now(), i);
+    }
+    const int lost = Profiler::collect();
+    const QVector<Profiler::Event> events = eventsNamed("overflow");
+    QVERIFY(lost > 0);
+    QCOMPARE(events.size() + lost, recorded);
+    QCOMPARE(events.last().value, qint64(recorded - 1));
+    QCOMPARE(events.first().value, qint64(lost));
+    Profiler::clear();
+}
+
+void ProfilerTest::testChromeTrace()
+{
+    Profiler::collect();
+    Profiler::clear();
+    Profiler::record("timer \"quoted\"", Profiler::Timer, 1000, 2000);
+    Profiler::record("counter", Profiler::Counter, 5000, 7);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("trace.json");
+    QVERIFY(Profiler::writeChromeTrace(filename));
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+
+    const QJsonArray events = document.object().value("traceEvents").toArray();
+    // the name of the thread and the two events
+    QCOMPARE(events.size(), 3);
+    QCOMPARE(events.at(0).toObject().value("ph").toString(), QString("M"));
+    const QJsonObject timer = events.at(1).toObject();
+    QCOMPARE(timer.value("name").toString(), QString("timer \"quoted\""));
+    QCOMPARE(timer.value("ph").toString(), QString("X"));
+    QCOMPARE(timer.value("ts").toDouble(), 1.0);
+    QCOMPARE(timer.value("dur").toDouble(), 2.0);
+    const QJsonObject counter = events.at(2).toObject();
+    QCOMPARE(counter.value("ph").toString(), QString("C"));
+    QCOMPARE(counter.value("args").toObject().value("value").toInt(), 7);
+    Profiler::clear();
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::ProfilerTest)
+#include "tst_profilertest.moc"
@@ -0,0 +1,29 @@
+#ifndef TST_PROFILERTEST_H
+#define TST_PROFILERTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class ProfilerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProfilerTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testRecord();
+    void testThreads();
+    void testReuseBuffers();
+    void testOverflow();
+    void testChromeTrace();
+};
+
+} // namespace unit //
+
+#endif // TST_PROFILERTEST_H //
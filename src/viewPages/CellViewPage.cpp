@@ -25,6 +25,7 @@
 #include "SettingsWidget.h"
 #include "SettingsStyle.h"
 #include "color/HeatMap.h"
+#include "profiling/MemoryAccounting.h"
 
 #include <algorithm>
 
@@ -85,6 +86,7 @@ CellViewPage::CellViewPage(QSharedPointer<SpotsWidget> spots,
 
 CellViewPage::~CellViewPage()
 {
+    MemoryAccounting::instance().release(m_image.data());
 }
 
 void CellViewPage::clear()
@@ -93,6 +95,7 @@ void CellViewPage::clear()
     m_ui->lasso_selection->setChecked(false);
     m_ui->selection->setChecked(false);
     m_image->clearData();
+    MemoryAccounting::instance().release(m_image.data());
     m_gene_plotter->clearData();
     m_legend->clearData();
     m_ui->view->clearData();
@@ -105,8 +108,8 @@ void CellViewPage::clear()
     m_dataset = Dataset();
 }
 
-void CellViewPage::loadDataset(const Dataset &dataset)
-{    
+void CellViewPage::loadDataset(const Dataset &dataset, const ImageTextureGL::Image &image)
+{
     // reset to default
     clear();
 
@@ -124,9 +127,9 @@ void CellViewPage::loadDataset(const Dataset &dataset)
     // store the dataset
     m_dataset = dataset;
 
-    // create tiles textures from the image (async)
+    // create tiles textures from the image (it is read in the background when prefetched)
     m_image->clearData();
-    const bool result = m_image->createTiles(dataset.imageFile());
+    const bool result = m_image->createTiles(image);
     slotImageLoaded(result);
     //TODO OpenGL cannot create textures on a different thread (FIX THIS)
     //QFutureWatcher<void> watcher;
@@ -139,6 +142,13 @@ void CellViewPage::slotImageLoaded(const bool loaded)
     if (!loaded) {
         QMessageBox::warning(this, tr("Tissue image"), tr("Error loading tissue image"));
     } else {
+        // account the memory of the tiles under the name of the dataset
+        MemoryAccounting::instance().account(m_image.data(),
+                                             MemoryAccounting::Textures,
+                                             m_dataset.name(),
+                                             MemoryAccounting::Usage(
+                                                 m_image->memoryUsage(),
+                                                 m_image->textureMemoryUsage()));
         m_ui->view->setScene(m_image->boundingRect());
         // If the user has not given any transformation matrix
         // we compute a simple transformation matrix using
@@ -182,19 +192,16 @@ void CellViewPage::clearSelections()
 {
     m_dataset.data()->clearSelection();
     m_gene_plotter->slotUpdate();
-    m_ui->view->update();
 }
 
 void CellViewPage::slotGenesUpdate()
 {
     m_gene_plotter->slotUpdate();
-    m_ui->view->update();
 }
 
 void CellViewPage::slotSpotsUpdated()
 {
     m_gene_plotter->slotUpdate();
-    m_ui->view->update();
 }
 
 void CellViewPage::createConnections()
@@ -220,7 +227,6 @@ void CellViewPage::createConnections()
             [=](){
         m_gene_plotter->slotUpdate();
         m_legend->slotUpdate();
-        m_ui->view->update();
     });
 
     // graphic view signals
@@ -317,6 +323,10 @@ void CellViewPage::initRenderer()
     m_legend = QSharedPointer<HeatMapLegendGL>(
                 new HeatMapLegendGL(m_settings->renderingSettings()));
     m_ui->view->addRenderingNode(m_legend);
+
+    // the legend range is known when the rendering data has been computed
+    connect(m_gene_plotter.data(), &GeneRendererGL::signalRenderingDataComputed,
+            m_legend.data(), &HeatMapLegendGL::slotUpdate);
 }
 
 void CellViewPage::slotPrintImage()
@@ -376,7 +386,6 @@ void CellViewPage::slotSelectByRegExp()
         if (selectGenes.isValid()) {
             m_dataset.data()->selectGenes(selectGenes.getRegExp(), selectGenes.selectNonVisible());
             m_gene_plotter->slotUpdate();
-            m_ui->view->update();
         }
     }
 }
@@ -453,7 +462,6 @@ void CellViewPage::slotLoadSpotColorsFile()
         m_dataset.data()->loadSpotColors(spotMap);
         m_spots->update();
         m_gene_plotter->slotUpdate();
-        m_ui->view->update();
     }
 }
 
@@ -516,7 +524,6 @@ void CellViewPage::slotLoadGenes()
         m_dataset.data()->loadGeneColors(geneMap);
         m_genes->update();
         m_gene_plotter->slotUpdate();
-        m_ui->view->update();
     }
 }
 
@@ -526,29 +533,25 @@ void CellViewPage::slotLoadSpotColors()
     m_dataset.data()->loadSpotColors(spot_colors);
     m_spots->update();
     m_gene_plotter->slotUpdate();
-    m_ui->view->update();
 }
 
 void CellViewPage::slotSelectSpotsClustering()
 {
     m_dataset.data()->selectSpots(m_clustering->selectedSpots());
     m_gene_plotter->slotUpdate();
-    m_ui->view->update();
 }
 
 void CellViewPage::slotCreateClusteringSelections()
 {
     // get the map of color -> spots
     const QMultiHash<unsigned, QString> colors_spot = m_clustering->getClustersSpot();
-    // get the data frame
-    auto data = m_dataset.data()->data();
+    // get the data frame (shared with the selections)
+    const auto data = m_dataset.data()->sharedData();
     for(const auto &color : colors_spot.uniqueKeys()) {
         // get the spots for the color
         const QList<QString> &color_spots = colors_spot.values(color);
-        // slice the data frame
-        STData::STDataFrame scliced_data = STData::sliceDataFrameSpots(data, color_spots);
-        // create selection object
-        UserSelection new_selection(scliced_data);
+        // create selection object (a view of the spots in the data frame)
+        UserSelection new_selection(data, color_spots);
         // proposes as selection name as DATASET NAME + color + current timestamp
         new_selection.name(m_dataset.name() + "_" + QString::number(color) + "_"
                            + QDateTime::currentDateTimeUtc().toString());
@@ -561,21 +564,20 @@ void CellViewPage::slotCreateClusteringSelections()
 void CellViewPage::slotCreateSelection()
 {
     // get the selected spots
-    QList<QString> selected_spots =
-            QtConcurrent::blockingFilteredReduced<QList<QString> >(
-                m_dataset.data()->spots(),
-                [] (const auto spot) { return spot->selected(); },
-                [] (auto &list, const auto spot) { list.push_back(spot->name()); });
+    const auto &spots = m_dataset.data()->spots();
+    const QBitArray &selected = spots.selectedBits();
+    QList<QString> selected_spots;
+    for (int i = 0; i < selected.size(); ++i) {
+        if (selected.testBit(i)) {
+            selected_spots.push_back(spots.name(i));
+        }
+    }
     // early out
     if (selected_spots.empty()) {
         return;
     }
-    // get the data frame
-    auto data = m_dataset.data()->data();
-    // slice the data frame
-    STData::STDataFrame scliced_data = STData::sliceDataFrameSpots(data, selected_spots);
-    // create selection object
-    UserSelection new_selection(scliced_data);
+    // create selection object (a view of the spots in the data frame)
+    UserSelection new_selection(m_dataset.data()->sharedData(), selected_spots);
     // proposes as selection name as DATASET NAME plus current timestamp
     new_selection.name(m_dataset.name() + " " + QDateTime::currentDateTimeUtc().toString());
     new_selection.dataset(m_dataset.name());
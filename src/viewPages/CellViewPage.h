@@ -46,8 +46,8 @@ public:
     // clear the loaded dataset and reset settings
     void clear();
 
-    // the user has opened/edit a dataset
-    void loadDataset(const Dataset &dataset);
+    // the user has opened/edit a dataset (the tissue image has already been read)
+    void loadDataset(const Dataset &dataset, const ImageTextureGL::Image &image);
 
     // the user has cleared the selections
     void clearSelections();
@@ -267,6 +267,31 @@ QSharedPointer<Dataset> DatasetPage::getCurrentDataset() const
     return m_open_dataset;
 }
 
+QList<Dataset> DatasetPage::neighbourDatasets(const Dataset &dataset, const int count)
+{
+    // the datasets in the order of the table
+    QSortFilterProxyModel *proxy = datasetsProxyModel();
+    QList<Dataset> datasets;
+    for (int row = 0; row < proxy->rowCount(); ++row) {
+        const QModelIndex index = proxy->mapToSource(proxy->index(row, 0));
+        datasets.append(datasetsModel()->getDatasets(QItemSelection(index, index)));
+    }
+    const int row = datasets.indexOf(dataset);
+    QList<Dataset> neighbours;
+    if (row == -1) {
+        return neighbours;
+    }
+    for (int distance = 1; distance <= count; ++distance) {
+        if (row + distance < datasets.size()) {
+            neighbours.append(datasets.at(row + distance));
+        }
+        if (row - distance >= 0) {
+            neighbours.append(datasets.at(row - distance));
+        }
+    }
+    return neighbours;
+}
+
 void DatasetPage::slotDatasetsUpdated()
 {
     // update model and clear controls
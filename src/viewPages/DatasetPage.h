@@ -34,6 +34,10 @@ public:
     // returns the currently opened dataset
     QSharedPointer<Dataset> getCurrentDataset() const;
 
+    // returns the datasets next to the given one in the table as it is sorted and
+    // filtered (up to count on each side, the closest first)
+    QList<Dataset> neighbourDatasets(const Dataset &dataset, const int count);
+
 public slots:
 
 private slots:
@@ -0,0 +1,278 @@
+#include "ProfilerWidget.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QLabel>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDir>
+#include <QMap>
+#include <QtCharts/QBarSeries>
+#include <QtCharts/QBarSet>
+#include <QtCharts/QBarCategoryAxis>
+
+#include "profiling/Profiler.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+
+// how often the events are collected while the panel is visible
+const int REFRESH_INTERVAL_MS = 1000;
+// the number of bins of the histogram
+const int HISTOGRAM_BINS = 20;
+
+enum Column {
+    Name = 0,
+    Kind,
+    Count,
+    Last,
+    Mean,
+    P95,
+    Max,
+    Columns
+};
+
+// the recent values of a timer (milliseconds) or a counter
+struct Values {
+    Profiler::Type type;
+    QVector<double> values;
+};
+
+QMap<QString, Values> valuesByName(const QVector<Profiler::Event> &events)
+{
+    QMap<QString, Values> values;
+    for (const auto &event : events) {
+        Values &item = values[QString::fromLatin1(event.name)];
+        item.type = event.type;
+        item.values.push_back(event.type == Profiler::Timer ? event.value / 1e6 : event.value);
+    }
+    return values;
+}
+
+// the labels of the bins (their lower bounds), the precision is increased until they are
+// different as the bar axis drops the repeated categories
+QStringList binLabels(const double min, const double width, const int bins)
+{
+    QStringList labels;
+    for (int precision = 3; precision <= 17; ++precision) {
+        labels.clear();
+        for (int i = 0; i < bins; ++i) {
+            labels << QString::number(min + width * i, 'g', precision);
+        }
+        QStringList unique = labels;
+        if (unique.removeDuplicates() == 0) {
+            break;
+        }
+    }
+    return labels;
+}
+
+QTableWidgetItem *numberItem(const double value)
+{
+    QTableWidgetItem *item = new QTableWidgetItem();
+    item->setData(Qt::DisplayRole, value);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+}
+
+ProfilerWidget::ProfilerWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_table(nullptr)
+    , m_histogram(nullptr)
+    , m_status(nullptr)
+    , m_pause(nullptr)
+    , m_timer()
+    , m_lost(0)
+{
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->setContentsMargins(10, 10, 10, 10);
+    QHBoxLayout *controls = new QHBoxLayout();
+
+    m_pause.reset(new QCheckBox(tr("Pause"), this));
+    m_pause->setToolTip(tr("Stop updating the timings"));
+    controls->addWidget(m_pause.data());
+    QPushButton *clearButton = new QPushButton(tr("Clear"), this);
+    clearButton->setToolTip(tr("Remove the recorded timings"));
+    controls->addWidget(clearButton);
+    QPushButton *exportButton = new QPushButton(tr("Export trace..."), this);
+    exportButton->setToolTip(tr("Export the recorded timings as a Chrome trace"));
+    controls->addWidget(exportButton);
+    controls->addStretch();
+    m_status.reset(new QLabel(this));
+    controls->addWidget(m_status.data());
+    layout->addLayout(controls);
+
+    // the statistics of the timers (milliseconds) and counters
+    m_table.reset(new QTableWidget(0, Columns, this));
+    m_table->setHorizontalHeaderLabels({tr("Name"), tr("Kind"), tr("Count"),
+                                        tr("Last"), tr("Mean"), tr("P95"), tr("Max")});
+    m_table->horizontalHeader()->setSectionResizeMode(Name, QHeaderView::Stretch);
+    m_table->verticalHeader()->hide();
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->setSortingEnabled(true);
+    layout->addWidget(m_table.data(), 2);
+
+    // the histogram of the selected timer/counter
+    m_histogram.reset(new QChartView(this));
+    m_histogram->setMinimumHeight(200);
+    m_histogram->chart()->legend()->hide();
+    layout->addWidget(m_histogram.data(), 1);
+
+    setLayout(layout);
+
+#if !ENABLE_PROFILING
+    m_status->setText(tr("The instrumentation is disabled in this build"));
+    m_pause->setEnabled(false);
+#endif
+
+    m_timer.setInterval(REFRESH_INTERVAL_MS);
+    connect(&m_timer, &QTimer::timeout, this, &ProfilerWidget::slotRefresh);
+    connect(clearButton, &QPushButton::clicked, this, &ProfilerWidget::slotClear);
+    connect(exportButton, &QPushButton::clicked, this, &ProfilerWidget::slotExportTrace);
+    connect(m_table.data(), &QTableWidget::itemSelectionChanged,
+            this, &ProfilerWidget::slotUpdateHistogram);
+}
+
+ProfilerWidget::~ProfilerWidget()
+{
+}
+
+void ProfilerWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    slotRefresh();
+    m_timer.start();
+}
+
+void ProfilerWidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_timer.stop();
+}
+
+void ProfilerWidget::slotRefresh()
+{
+    m_lost += Profiler::collect();
+    if (m_pause->isChecked()) {
+        return;
+    }
+
+    // keep the selected row (the rows are sorted by the user)
+    const QList<QTableWidgetItem *> selected = m_table->selectedItems();
+    const QString selected_name = selected.empty() ? QString()
+                                                   : m_table->item(selected.first()->row(),
+                                                                   Name)->text();
+
+    const QMap<QString, Values> values = valuesByName(Profiler::events());
+    m_table->setSortingEnabled(false);
+    m_table->blockSignals(true);
+    m_table->clearContents();
+    m_table->setRowCount(values.size());
+    int row = 0;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it, ++row) {
+        QVector<double> sorted = it.value().values;
+        std::sort(sorted.begin(), sorted.end());
+        const double sum = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+        const int p95 = std::min(sorted.size() - 1, static_cast<int>(sorted.size() * 0.95));
+        const bool timer = it.value().type == Profiler::Timer;
+        m_table->setItem(row, Name, new QTableWidgetItem(it.key()));
+        m_table->setItem(row, Kind, new QTableWidgetItem(timer ? tr("ms") : tr("count")));
+        m_table->setItem(row, Count, numberItem(sorted.size()));
+        m_table->setItem(row, Last, numberItem(it.value().values.last()));
+        m_table->setItem(row, Mean, numberItem(sum / sorted.size()));
+        m_table->setItem(row, P95, numberItem(sorted.at(p95)));
+        m_table->setItem(row, Max, numberItem(sorted.last()));
+    }
+    m_table->setSortingEnabled(true);
+    for (const auto item : m_table->findItems(selected_name, Qt::MatchExactly)) {
+        if (item->column() == Name) {
+            m_table->selectRow(item->row());
+        }
+    }
+    m_table->blockSignals(false);
+    m_status->setText(m_lost > 0 ? tr("%1 events lost").arg(m_lost) : QString());
+    slotUpdateHistogram();
+}
+
+void ProfilerWidget::slotUpdateHistogram()
+{
+    QChart *chart = m_histogram->chart();
+    chart->removeAllSeries();
+    for (QAbstractAxis *axis : chart->axes()) {
+        chart->removeAxis(axis);
+        delete axis;
+    }
+    chart->setTitle(QString());
+
+    const QList<QTableWidgetItem *> selected = m_table->selectedItems();
+    if (selected.empty()) {
+        return;
+    }
+    const QString name = m_table->item(selected.first()->row(), Name)->text();
+    const QMap<QString, Values> values = valuesByName(Profiler::events());
+    if (!values.contains(name)) {
+        return;
+    }
+
+    const Values item = values.value(name);
+    const QVector<double> &times = item.values;
+    const auto range = std::minmax_element(times.begin(), times.end());
+    const double min = *range.first;
+    // all the values are in one bin when they are equal
+    const int n_bins = *range.second > min ? HISTOGRAM_BINS : 1;
+    const double width = n_bins > 1 ? (*range.second - min) / n_bins : 1.0;
+    QVector<int> bins(n_bins, 0);
+    for (const double time : times) {
+        ++bins[std::min(n_bins - 1, static_cast<int>((time - min) / width))];
+    }
+
+    QBarSet *set = new QBarSet(name);
+    for (const int count : bins) {
+        *set << count;
+    }
+    const QStringList categories = binLabels(min, width, n_bins);
+    QBarSeries *series = new QBarSeries();
+    series->append(set);
+    chart->addSeries(series);
+    QBarCategoryAxis *axis = new QBarCategoryAxis();
+    axis->append(categories);
+    chart->createDefaultAxes();
+    chart->setAxisX(axis, series);
+    chart->setTitle(item.type == Profiler::Timer ? tr("%1 (ms)").arg(name) : name);
+}
+
+void ProfilerWidget::slotClear()
+{
+    Profiler::collect();
+    Profiler::clear();
+    m_lost = 0;
+    slotRefresh();
+}
+
+void ProfilerWidget::slotExportTrace()
+{
+    QString filename = QFileDialog::getSaveFileName(this,
+                                                    tr("Export Trace"),
+                                                    QDir::homePath(),
+                                                    tr("Chrome Trace Files (*.json)"));
+    if (filename.isEmpty()) {
+        return;
+    }
+    if (!filename.endsWith(".json", Qt::CaseInsensitive)) {
+        filename.append(".json");
+    }
+    if (!Profiler::writeChromeTrace(filename)) {
+        QMessageBox::critical(this, tr("Export Trace"), tr("Error exporting the trace"));
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef PROFILERWIDGET_H
+#define PROFILERWIDGET_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QtCharts/QChartView>
+
+class QTableWidget;
+class QLabel;
+class QCheckBox;
+
+QT_CHARTS_USE_NAMESPACE
+
+// This widget shows the recent timings and counters of the instrumented hot paths
+// (see profiling/Profiler.h), a table with the statistics of each timer/counter and the
+// histogram of the times of the selected timer. It collects the events periodically
+// while it is visible and it can export them as a Chrome trace
+class ProfilerWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ProfilerWidget(QWidget *parent = 0);
+    virtual ~ProfilerWidget();
+
+public slots:
+
+    // collects the recorded events and updates the table and the histogram
+    void slotRefresh();
+
+private slots:
+
+    void slotClear();
+    void slotExportTrace();
+    void slotUpdateHistogram();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    QScopedPointer<QTableWidget> m_table;
+    QScopedPointer<QChartView> m_histogram;
+    QScopedPointer<QLabel> m_status;
+    QScopedPointer<QCheckBox> m_pause;
+    QTimer m_timer;
+    // the events lost since the panel was cleared (full thread buffers)
+    int m_lost;
+
+    Q_DISABLE_COPY(ProfilerWidget)
+};
+
+#endif // PROFILERWIDGET_H
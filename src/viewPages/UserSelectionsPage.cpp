@@ -5,6 +5,8 @@
 #include <QMessageBox>
 #include <QSortFilterProxyModel>
 #include <QInputDialog>
+#include <QProgressDialog>
+#include <QtConcurrent>
 
 #include "viewPages/SelectionGenesWidget.h"
 #include "viewPages/SelectionSpotsWidget.h"
@@ -15,6 +17,7 @@
 #include "analysis/AnalysisQC.h"
 #include "analysis/AnalysisScatter.h"
 #include "analysis/AnalysisPCA.h"
+#include "profiling/MemoryAccounting.h"
 #include "SettingsStyle.h"
 
 #include "ui_selectionsPage.h"
@@ -24,6 +27,10 @@ using namespace Style;
 UserSelectionsPage::UserSelectionsPage(QWidget *parent)
     : QWidget(parent)
     , m_ui(new Ui::UserSelections())
+    , m_selections()
+    , m_export_watcher()
+    , m_export_progress()
+    , m_export_cancelled(0)
 {
     m_ui->setupUi(this);
 
@@ -63,12 +70,17 @@ UserSelectionsPage::UserSelectionsPage(QWidget *parent)
             this, SLOT(slotEditSelection(QModelIndex)));
     connect(m_ui->selections_tableView, SIGNAL(signalSelectionDelete(QModelIndex)),
             this, SLOT(slotRemoveSelection(QModelIndex)));
+    connect(&m_export_watcher, &QFutureWatcher<bool>::finished,
+            this, &UserSelectionsPage::slotSelectionExported);
 
     clearControls();
 }
 
 UserSelectionsPage::~UserSelectionsPage()
 {
+    m_export_cancelled.store(1);
+    m_export_watcher.waitForFinished();
+    MemoryAccounting::instance().release(this);
 }
 
 void UserSelectionsPage::clean()
@@ -158,6 +170,14 @@ void UserSelectionsPage::selectionsUpdated()
     clearControls();
     selectionsModel()->loadUserSelections(m_selections);
     m_ui->selections_tableView->update();
+
+    // account the memory of the selections
+    MemoryAccounting &accounting = MemoryAccounting::instance();
+    accounting.release(this);
+    for (const auto &selection : m_selections) {
+        accounting.account(this, MemoryAccounting::Selections, selection.name(),
+                           MemoryAccounting::Usage(selection.memoryUsage()));
+    }
 }
 
 void UserSelectionsPage::slotRemoveSelection()
@@ -232,10 +252,16 @@ void UserSelectionsPage::slotExportSelection(QModelIndex index)
 
 void UserSelectionsPage::exportSelection(const UserSelection &selection)
 {
+    // only one export at a time
+    if (m_export_watcher.isRunning()) {
+        return;
+    }
+
     QString filename = QFileDialog::getSaveFileName(this,
                                                     tr("Export Selection"),
                                                     QDir::homePath(),
-                                                    QString("%1").arg(tr("Text Files (*.tsv)")));
+                                                    QString("%1;;%2").arg(tr("Text Files (*.tsv)"))
+                                                    .arg(tr("Binary Files (*.stdf)")));
     // early out
     if (filename.isEmpty()) {
         return;
@@ -248,12 +274,44 @@ void UserSelectionsPage::exportSelection(const UserSelection &selection)
         return;
     }
 
-    // export selection
+    // export selection in the background
+    m_export_progress = new QProgressDialog(tr("Exporting the selection..."), tr("Cancel"),
+                                            0, selection.totalSpots(), this);
+    m_export_progress->setWindowModality(Qt::WindowModal);
+    m_export_progress->setMinimumDuration(500);
+    m_export_progress->setAutoClose(false);
+    connect(this, &UserSelectionsPage::signalExportProgress,
+            m_export_progress.data(), &QProgressDialog::setValue);
+    connect(m_export_progress.data(), &QProgressDialog::canceled,
+            this, [this]() { m_export_cancelled.store(1); });
+    m_export_cancelled.store(0);
+    QFuture<bool> future = QtConcurrent::run(this, &UserSelectionsPage::exportSelectionAsync,
+                                             filename, selection);
+    m_export_watcher.setFuture(future);
+}
+
+bool UserSelectionsPage::exportSelectionAsync(const QString filename,
+                                              const UserSelection selection)
+{
     try {
-        STData::save(filename, selection.data());
+        STData::save(filename, selection.data(), [this](const int spots) {
+            emit signalExportProgress(spots);
+            return m_export_cancelled.load() == 0;
+        });
     } catch (const std::exception &e) {
-        QMessageBox::critical(this, tr("Export Selection"), tr("Error exporting the selection"));
         qDebug() << "There was an error saving the matrix in the selection page " << e.what();
+        return false;
+    }
+    return true;
+}
+
+void UserSelectionsPage::slotSelectionExported()
+{
+    if (!m_export_progress.isNull()) {
+        m_export_progress->deleteLater();
+    }
+    if (!m_export_watcher.result()) {
+        QMessageBox::critical(this, tr("Export Selection"), tr("Error exporting the selection"));
     }
 }
 
@@ -314,7 +372,8 @@ void UserSelectionsPage::slotImportSelection()
     QFileDialog dialog(this, tr("Import selection (can select multiple)"));
     dialog.setDirectory(QDir::homePath());
     dialog.setFileMode(QFileDialog::ExistingFiles);
-    dialog.setNameFilter(QString("%1").arg(tr("TSV Files (*.tsv)")));
+    dialog.setNameFilter(QString("%1;;%2").arg(tr("TSV Files (*.tsv)"))
+                         .arg(tr("Binary Files (*.stdf)")));
     QStringList fileNames;
     if (dialog.exec()) {
         // get all the selected files and iterate
@@ -3,10 +3,14 @@
 
 #include <QWidget>
 #include <QModelIndex>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QAtomicInt>
 #include <memory>
 
 class UserSelectionsItemModel;
 class QSortFilterProxyModel;
+class QProgressDialog;
 class UserSelection;
 
 namespace Ui
@@ -36,6 +40,9 @@ public:
 
 signals:
 
+    // emitted (from the worker thread) with the number of spots exported so far
+    void signalExportProgress(int spots);
+
 public slots:
 
 private slots:
@@ -70,6 +77,8 @@ private slots:
     void slotMerge();
     // to import a selection from a file
     void slotImportSelection();
+    // slot called when the export of a selection has finished
+    void slotSelectionExported();
 
 protected:
     void showEvent(QShowEvent *event);
@@ -80,6 +89,8 @@ private:
     void removeSelections(const QList<UserSelection> &selections);
     void editSelection(const UserSelection &selection);
     void exportSelection(const UserSelection &selection);
+    // writes the selection to the file (runs in a worker thread), it returns false on errors
+    bool exportSelectionAsync(const QString filename, const UserSelection selection);
 
     // internal function to check if the name exists
     bool nameExist(const QString &name);
@@ -97,6 +108,10 @@ private:
     QScopedPointer<Ui::UserSelections> m_ui;
     // the list of selections objects
     QList<UserSelection> m_selections;
+    // the export of a selection runs in the background with a progress dialog
+    QFutureWatcher<bool> m_export_watcher;
+    QPointer<QProgressDialog> m_export_progress;
+    QAtomicInt m_export_cancelled;
 
     Q_DISABLE_COPY(UserSelectionsPage)
 };
@@ -9,8 +9,10 @@
 #include <QRubberBand>
 #include <QOpenGLFramebufferObject>
 #include <QTransform>
+#include <QElapsedTimer>
 
 #include "math/Common.h"
+#include "profiling/Profiler.h"
 
 static const float DEFAULT_ZOOM_ADJUSTMENT_IN_PERCENT = 10.0;
 static const int KEY_OFFSET = 10;
@@ -21,6 +23,12 @@ static const int OPENGL_VERSION_MAJOR = 2;
 static const int OPENGL_VERSION_MINOR = 0;
 static const QColor lasso_color = QColor(0,0,255,90);
 
+CellGLView::FrameTiming::FrameTiming()
+    : paint_ns(0)
+    , nodes_ns()
+{
+}
+
 CellGLView::CellGLView(QWidget *parent)
     : QOpenGLWidget(parent)
     , m_originPanning(-1, -1)
@@ -36,6 +44,8 @@ CellGLView::CellGLView(QWidget *parent)
     , m_zoom_factor(1.0)
     , m_rotate_factor(0.0)
     , m_flip_factor(0.0)
+    , m_frame_timing_enabled(false)
+    , m_frame_timing()
 {
     // init projection matrix to identity
     m_projm.setToIdentity();
@@ -112,6 +122,13 @@ void CellGLView::initializeGL()
 
 void CellGLView::paintGL()
 {
+    ST_PROFILE_SCOPE("CellGLView::paintGL");
+    QElapsedTimer timer;
+    if (m_frame_timing_enabled) {
+        timer.start();
+        m_frame_timing.nodes_ns.fill(0, m_nodes.size());
+    }
+
     // clear color buffer
     m_qopengl_functions.glClear(GL_COLOR_BUFFER_BIT);
 
@@ -121,8 +138,10 @@ void CellGLView::paintGL()
     painter.setRenderHint(QPainter::Antialiasing, true);
 
     // render nodes
-    for (auto node : m_nodes) {
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        const auto &node = m_nodes.at(i);
         if (node->visible()) {
+            const qint64 node_start = m_frame_timing_enabled ? timer.nsecsElapsed() : 0;
             QTransform local_transform = nodeTransformations(node);
             if (node->transformable()) {
                 local_transform *= sceneTransformations();
@@ -133,6 +152,11 @@ void CellGLView::paintGL()
                         reinterpret_cast<const GLfloat *>(QMatrix4x4(local_transform).constData()));
             node->draw(m_qopengl_functions, painter);
             painter.resetTransform();
+            if (m_frame_timing_enabled) {
+                // the OpenGL commands are asynchronous
+                m_qopengl_functions.glFinish();
+                m_frame_timing.nodes_ns[i] = timer.nsecsElapsed() - node_start;
+            }
         }
     }
 
@@ -143,6 +167,11 @@ void CellGLView::paintGL()
     }
 
     m_qopengl_functions.glLoadIdentity();
+
+    if (m_frame_timing_enabled) {
+        m_qopengl_functions.glFinish();
+        m_frame_timing.paint_ns = timer.nsecsElapsed();
+    }
 }
 
 void CellGLView::resizeGL(int width, int height)
@@ -261,6 +290,17 @@ float CellGLView::maxZoom() const
     return qMin(max_zoom_x, max_zoom_y);
 }
 
+void CellGLView::setFrameTimingEnabled(const bool enabled)
+{
+    m_frame_timing_enabled = enabled;
+    m_frame_timing = FrameTiming();
+}
+
+const CellGLView::FrameTiming &CellGLView::lastFrameTiming() const
+{
+    return m_frame_timing;
+}
+
 const QImage CellGLView::grabPixmapGL()
 {
     //TODO this doesn't grab the non OpenGL stuff
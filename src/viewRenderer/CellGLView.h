@@ -3,6 +3,7 @@
 
 #include <QOpenGLWidget>
 #include <QPointer>
+#include <QVector>
 
 #include "GraphicItemGL.h"
 #include "SelectionEvent.h"
@@ -37,6 +38,15 @@ class CellGLView : public QOpenGLWidget
 
 public:
 
+    // The time spent rendering a frame (only measured when the frame timing is enabled)
+    struct FrameTiming {
+        FrameTiming();
+        // the time of paintGL() (nanoseconds)
+        qint64 paint_ns;
+        // the time of the draw() of each node in the rendering order (0 if not visible)
+        QVector<qint64> nodes_ns;
+    };
+
     explicit CellGLView(QWidget *parent = 0);
     virtual ~CellGLView();
 
@@ -55,6 +65,12 @@ public:
     void setViewPort(const QRectF &viewport);
     void setScene(const QRectF &scene);
 
+    // measures the time of each frame, the OpenGL commands are finished after each node
+    // so the times are the ones of the nodes (it slows the rendering down, so it is off
+    // by default and only meant for profiling)
+    void setFrameTimingEnabled(const bool enabled);
+    const FrameTiming &lastFrameTiming() const;
+
 public slots:
 
     // TODO slots should have the prefix "slot"
@@ -137,6 +153,10 @@ private:
     // scene viewport projection
     QMatrix4x4 m_projm;
 
+    // frame timing
+    bool m_frame_timing_enabled;
+    FrameTiming m_frame_timing;
+
     // a cross platform wrapper around OpenGL functions
     GraphicItemGL::QOpenGLFunctionsVersion m_qopengl_functions;
 
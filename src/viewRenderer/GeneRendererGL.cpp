@@ -10,6 +10,25 @@
 #include "math/RInterface.h"
 
 #include "color/HeatMap.h"
+#include "color/ColorMap.h"
+#include "profiling/Profiler.h"
+
+// true if the rendering data computed with both settings is the same
+// (intensity and size are only used when drawing)
+static bool sameRenderingData(const SettingsWidget::Rendering &lhs,
+                              const SettingsWidget::Rendering &rhs)
+{
+    return lhs.reads_threshold == rhs.reads_threshold
+            && lhs.genes_threshold == rhs.genes_threshold
+            && lhs.spots_threshold == rhs.spots_threshold
+            && lhs.ind_reads_threshold == rhs.ind_reads_threshold
+            && lhs.visual_mode == rhs.visual_mode
+            && lhs.normalization_mode == rhs.normalization_mode
+            && lhs.visual_type_mode == rhs.visual_type_mode
+            && lhs.gene_cutoff == rhs.gene_cutoff
+            && lhs.spike_in == rhs.spike_in
+            && lhs.size_factors == rhs.size_factors;
+}
 
 // hash function for QColor for use in QSet / QHash
 QT_BEGIN_NAMESPACE
@@ -23,6 +42,15 @@ GeneRendererGL::GeneRendererGL(SettingsWidget::Rendering &rendering_settings, QO
     : GraphicItemGL(parent)
     , m_rendering_settings(rendering_settings)
     , m_initialized(false)
+    , m_update_timer()
+    , m_computed(false)
+    , m_computed_revision(0)
+    , m_computed_settings()
+    , m_watcher()
+    , m_requested_revision(0)
+    , m_requested_settings()
+    , m_generation(0)
+    , m_requested_generation(0)
 {
     setVisualOption(GraphicItemGL::Transformable, true);
     setVisualOption(GraphicItemGL::Visible, true);
@@ -32,30 +60,110 @@ GeneRendererGL::GeneRendererGL(SettingsWidget::Rendering &rendering_settings, QO
     setVisualOption(GraphicItemGL::RubberBandable, true);
     setAnchor(GraphicItemGL::Anchor::None);
 
+    m_update_timer.setSingleShot(true);
+    m_update_timer.setInterval(0);
+    connect(&m_update_timer, &QTimer::timeout, this, &GeneRendererGL::slotComputeRenderingData);
+    connect(&m_watcher, &QFutureWatcher<STData::RenderingResult>::finished,
+            this, &GeneRendererGL::slotRenderingDataComputed);
+
     // initialize variables
     clearData();
 }
 
 GeneRendererGL::~GeneRendererGL()
 {
+    cancelComputation();
+    m_watcher.waitForFinished();
 }
 
 void GeneRendererGL::clearData()
 {
     m_initialized = false;
+    m_computed = false;
+    m_update_timer.stop();
+    cancelComputation();
 }
 
 void GeneRendererGL::slotUpdate()
 {
-    if (m_initialized) {
-        m_geneData->computeRenderingData(m_rendering_settings);
+    if (m_initialized && !m_update_timer.isActive()) {
+        m_update_timer.start();
+    }
+}
+
+void GeneRendererGL::slotComputeRenderingData()
+{
+    if (!m_initialized) {
+        return;
     }
+    const quint64 revision = m_geneData->revision();
+    if (m_watcher.isRunning()) {
+        // the running computation is stale if the data or the settings changed since it started
+        if (m_requested_revision != revision
+                || !sameRenderingData(m_requested_settings, m_rendering_settings)) {
+            cancelComputation();
+        }
+        return;
+    }
+    if (m_computed && m_computed_revision == revision
+            && sameRenderingData(m_computed_settings, m_rendering_settings)) {
+        emit updated();
+        return;
+    }
+    // the snapshot is taken here (GUI thread) and computed in the worker thread
+    m_requested_revision = revision;
+    m_requested_settings = m_rendering_settings;
+    m_requested_generation = m_generation.load();
+    const STData::RenderingInput input = m_geneData->renderingInput(m_rendering_settings);
+    QFuture<STData::RenderingResult> future =
+            QtConcurrent::run(this, &GeneRendererGL::computeRenderingDataAsync,
+                              m_geneData, input, m_requested_generation);
+    m_watcher.setFuture(future);
+}
+
+STData::RenderingResult GeneRendererGL::computeRenderingDataAsync(QSharedPointer<STData> data,
+                                                                  const STData::RenderingInput input,
+                                                                  const int generation)
+{
+    return data->computeRenderingData(input, [this, generation]() {
+        return m_generation.load() != generation;
+    });
+}
+
+void GeneRendererGL::cancelComputation()
+{
+    m_generation.ref();
+}
+
+void GeneRendererGL::slotRenderingDataComputed()
+{
+    if (!m_initialized) {
+        return;
+    }
+    const STData::RenderingResult result = m_watcher.result();
+    const bool stale = result.cancelled
+            || m_requested_generation != m_generation.load()
+            || m_requested_revision != m_geneData->revision();
+    if (stale) {
+        // compute the latest request
+        slotComputeRenderingData();
+        return;
+    }
+    m_geneData->applyRenderingData(result, m_rendering_settings);
+    // computing the rendering data updates the selected spots
+    m_computed_revision = m_geneData->revision();
+    m_computed_settings = result.settings;
+    m_computed = true;
+    emit signalRenderingDataComputed();
+    emit updated();
 }
 
 void GeneRendererGL::attachData(QSharedPointer<STData> data)
 {
+    cancelComputation();
     m_geneData = data;
     m_initialized = true;
+    m_computed = false;
     m_border = m_geneData->getBorder();
 }
 
@@ -66,37 +174,52 @@ void GeneRendererGL::draw(QOpenGLFunctionsVersion &qopengl_functions, QPainter &
     if (!m_initialized) {
         return;
     }
-
-    const bool is_dynamic =
-            m_rendering_settings.visual_mode == SettingsWidget::VisualMode::DynamicRange;
-    const bool do_values = m_rendering_settings.visual_mode != SettingsWidget::VisualMode::Normal;
-
-    const auto &spots = m_geneData->spots();
-    const auto &visibles = m_geneData->renderingVisible();
-    const auto &colors = m_geneData->renderingColors();
-    const auto &selecteds = m_geneData->renderingSelected();
-    const auto &values = m_geneData->renderingValues();
+    ST_PROFILE_SCOPE("GeneRendererGL::draw");
+
+    // the rendering data may have been computed with other settings (while a newer
+    // computation is running) so the modes and the legend range are the ones it used
+    const SettingsWidget::Rendering &settings = m_computed_settings;
+    const bool is_dynamic = settings.visual_mode == SettingsWidget::VisualMode::DynamicRange;
+    const bool do_values = settings.visual_mode != SettingsWidget::VisualMode::Normal;
+
+    // the packed rendering data (no spot objects are accessed while drawing)
+    const RenderingBuffer &buffer = m_geneData->renderingBuffer();
+    const QVector<float> &xs = buffer.x();
+    const QVector<float> &ys = buffer.y();
+    const QVector<QRgb> &colors = buffer.colors();
+    const QVector<double> &values = buffer.values();
     const float size = m_rendering_settings.size / 2;
     const float size_selected = size / 4;
     const float size_non_visible = size / 2;
-    const double min_value = m_rendering_settings.legend_min;
-    const double max_value = m_rendering_settings.legend_max;
+    const double min_value = settings.legend_min;
+    const double max_value = settings.legend_max;
     const float intensity = m_rendering_settings.intensity;
 
+    // the color map colors of all the spots are computed at once (lookup table)
+    const bool do_cmap = settings.visual_mode == SettingsWidget::VisualMode::HeatMap
+            || settings.visual_mode == SettingsWidget::VisualMode::ColorRange;
+    QVector<QRgb> cmap_colors;
+    if (do_cmap) {
+        cmap_colors.resize(values.size());
+        const auto &color_map
+                = Color::ColorMap::get(Color::visualModeColorMap(settings.visual_mode));
+        color_map.map(values.constData(), values.size(), min_value, max_value, cmap_colors.data());
+    }
+
+    ST_PROFILE_COUNTER("GeneRendererGL::spots", buffer.size());
     QPen pen;
     painter.setBrush(Qt::NoBrush);
-    for (int i = 0; i < spots.size(); ++i) {
-        const bool visible = visibles.at(i);
-        const auto spot  = spots.at(i)->adj_coordinates();
-        const double x = spot.first;
-        const double y = spot.second;
-        if (visible) {
-            const bool selected = selecteds.at(i);
-            const double value = values.at(i);
-            QColor color = colors.at(i);
-            if (do_values && !spots.at(i)->visible()) {
-                color = Color::adjustVisualMode(color, value, min_value,
-                                                max_value, m_rendering_settings.visual_mode);
+    for (int i = 0; i < buffer.size(); ++i) {
+        const double x = xs.at(i);
+        const double y = ys.at(i);
+        if (buffer.visible(i)) {
+            const bool spot_color = buffer.spotColor(i);
+            QColor color = QColor::fromRgba(colors.at(i));
+            if (do_cmap && !spot_color) {
+                color = QColor(cmap_colors.at(i));
+            } else if (do_values && !spot_color) {
+                color = Color::adjustVisualMode(color, values.at(i), min_value,
+                                                max_value, settings.visual_mode);
             }
             if (!is_dynamic) {
                 color.setAlphaF(intensity);
@@ -105,7 +228,7 @@ void GeneRendererGL::draw(QOpenGLFunctionsVersion &qopengl_functions, QPainter &
             pen.setWidthF(size);
             painter.setPen(pen);
             painter.drawEllipse(QRectF(x, y, size, size));
-            if (selected) {
+            if (buffer.selected(i)) {
                 pen.setColor(Qt::white);
                 pen.setWidthF(size_selected);
                 painter.setPen(pen);
@@ -129,5 +252,4 @@ void GeneRendererGL::setSelectionArea(const SelectionEvent &event)
 {
     m_geneData->selectSpots(event);
     slotUpdate();
-    emit updated();
 }
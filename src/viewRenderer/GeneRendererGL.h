@@ -4,6 +4,9 @@
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLBuffer>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QAtomicInt>
 
 #include "data/STData.h"
 #include "viewPages/SettingsWidget.h"
@@ -32,11 +35,25 @@ public:
 
 public slots:
 
-    // update the rendering data
+    // requests an update of the rendering data, the requests made during the same
+    // event loop cycle are coalesced into one and the rendering data is only
+    // computed again if the data or the rendering settings have changed
+    // The rendering data is computed in a worker thread, if a computation is running
+    // it is cancelled and the latest request is computed when it stops
     void slotUpdate();
 
+private slots:
+
+    // starts the computation of the rendering data (if needed) or notifies the views
+    void slotComputeRenderingData();
+    // swaps the computed rendering data in (if it is not stale) and notifies the views
+    void slotRenderingDataComputed();
+
 signals:
 
+    // the computed rendering data (and the legend range) has been swapped in
+    void signalRenderingDataComputed();
+
 protected:
     // override method that returns the drawing size of this element
     const QRectF boundingRect() const override;
@@ -48,6 +65,13 @@ private:
     // compiles and loads the shaders
     void setupShaders();
 
+    // computes the rendering data of the snapshot (runs in a worker thread)
+    STData::RenderingResult computeRenderingDataAsync(QSharedPointer<STData> data,
+                                                      const STData::RenderingInput input,
+                                                      const int generation);
+    // cancels the running computation (its result will be discarded)
+    void cancelComputation();
+
     // bounding rect area
     QRectF m_border;
 
@@ -63,6 +87,23 @@ private:
     // true when the rendering data has been initialized
     bool m_initialized;
 
+    // coalesces the update requests
+    QTimer m_update_timer;
+
+    // the data revision and settings used to compute the current rendering data
+    bool m_computed;
+    quint64 m_computed_revision;
+    SettingsWidget::Rendering m_computed_settings;
+
+    // the computation running in the worker thread (only one at a time)
+    QFutureWatcher<STData::RenderingResult> m_watcher;
+    // the data revision and settings of the running computation
+    quint64 m_requested_revision;
+    SettingsWidget::Rendering m_requested_settings;
+    // increased to cancel the running computation (latest request wins)
+    QAtomicInt m_generation;
+    int m_requested_generation;
+
     Q_DISABLE_COPY(GeneRendererGL)
 };
 
@@ -1,6 +1,9 @@
 #include "ImageTextureGL.h"
 
 #include <QOpenGLTexture>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPainter>
 #include <QImage>
 #include <QtConcurrent>
 #include <QFuture>
@@ -10,11 +13,29 @@
 #include <QImageReader>
 #include <cmath>
 
+#include "profiling/Profiler.h"
+
 static const int tile_width = 512;
 static const int tile_height = 512;
+// the size of the atlas pages if the OpenGL context supports it
+static const int atlas_max_size = 4096;
+// the pages hold the same number of tiles per row and per column
+static_assert(tile_width == tile_height, "the tiles must be square");
+// the vertices have the position and the texture coordinates (x, y, s, t)
+static const int vertex_components = 4;
+static const int vertices_per_tile = 4;
 
 ImageTextureGL::ImageTextureGL(QObject *parent)
     : GraphicItemGL(parent)
+    , m_pages()
+    , m_vertex_buffer(QOpenGLBuffer::VertexBuffer)
+    , m_columns(0)
+    , m_rows(0)
+    , m_page_columns(0)
+    , m_tiles_per_page(0)
+    , m_draw_firsts()
+    , m_draw_counts()
+    , m_bounds()
     , m_isInitialized(false)
     , m_iscaled(false)
 {
@@ -34,147 +55,234 @@ ImageTextureGL::~ImageTextureGL()
 void ImageTextureGL::clearData()
 {
     clearTextures();
-    m_textures_indices.clear();
-    m_texture_coords.clear();
+    m_columns = 0;
+    m_rows = 0;
+    m_page_columns = 0;
+    m_tiles_per_page = 0;
     m_isInitialized = false;
 }
 
 void ImageTextureGL::clearTextures()
 {
-    for (QOpenGLTexture *texture : m_textures) {
-        if (texture != nullptr) {
-            texture->destroy();
+    for (const Page &page : m_pages) {
+        if (page.texture != nullptr) {
+            page.texture->destroy();
+            delete page.texture;
         }
-        texture = nullptr;
     }
-    m_textures.clear();
+    m_pages.clear();
+    if (m_vertex_buffer.isCreated()) {
+        m_vertex_buffer.destroy();
+    }
 }
 
 void ImageTextureGL::draw(QOpenGLFunctionsVersion &qopengl_functions, QPainter &painter)
 {
-    Q_UNUSED(painter);
-
     if (!m_isInitialized) {
         return;
     }
+    ST_PROFILE_SCOPE("ImageTextureGL::draw");
+
+    // the visible part of the image (the painter has the transformation of the node)
+    const QRectF visible
+            = painter.worldTransform().inverted().mapRect(QRectF(painter.viewport())) & m_bounds;
+    if (visible.isEmpty()) {
+        return;
+    }
+    const int first_column = static_cast<int>(visible.left()) / tile_width;
+    const int last_column = std::min(static_cast<int>(visible.right()) / tile_width, m_columns - 1);
+    const int first_row = static_cast<int>(visible.top()) / tile_height;
+    const int last_row = std::min(static_cast<int>(visible.bottom()) / tile_height, m_rows - 1);
+    ST_PROFILE_COUNTER("ImageTextureGL::tiles",
+                       (last_column - first_column + 1) * (last_row - first_row + 1));
 
     qopengl_functions.glEnable(GL_TEXTURE_2D);
+    m_vertex_buffer.bind();
     {
-        qopengl_functions.glVertexPointer(2, GL_FLOAT, 0, m_textures_indices.constData());
-        qopengl_functions.glTexCoordPointer(2, GL_FLOAT, 0, m_texture_coords.constData());
+        const GLsizei stride = vertex_components * sizeof(GLfloat);
+        qopengl_functions.glVertexPointer(2, GL_FLOAT, stride, nullptr);
+        qopengl_functions.glTexCoordPointer(2, GL_FLOAT, stride,
+                                            reinterpret_cast<const void *>(2 * sizeof(GLfloat)));
         qopengl_functions.glEnableClientState(GL_VERTEX_ARRAY);
         qopengl_functions.glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
-        for (int i = 0; i < m_textures.size(); ++i) {
-            QOpenGLTexture *texture = m_textures[i];
-            Q_ASSERT(texture != nullptr);
-            texture->bind();
-            qopengl_functions.glDrawArrays(GL_TRIANGLE_FAN, i * 4, 4);
-            texture->release();
+        // the visible tiles of each page are drawn with one call (a range of vertices
+        // per row of tiles)
+        for (int page_row = first_row / m_tiles_per_page;
+             page_row <= last_row / m_tiles_per_page; ++page_row) {
+            for (int page_column = first_column / m_tiles_per_page;
+                 page_column <= last_column / m_tiles_per_page; ++page_column) {
+                const Page &page = m_pages.at(page_row * m_page_columns + page_column);
+                const int column = std::max(first_column, page.column) - page.column;
+                const int columns
+                        = std::min(last_column, page.column + page.columns - 1) - page.column
+                        - column + 1;
+                const int row_end = std::min(last_row, page.row + page.rows - 1) - page.row;
+                m_draw_firsts.clear();
+                m_draw_counts.clear();
+                for (int row = std::max(first_row, page.row) - page.row; row <= row_end; ++row) {
+                    m_draw_firsts.append(page.first
+                                         + (row * page.columns + column) * vertices_per_tile);
+                    m_draw_counts.append(columns * vertices_per_tile);
+                }
+                Q_ASSERT(page.texture != nullptr);
+                page.texture->bind();
+                qopengl_functions.glMultiDrawArrays(GL_QUADS,
+                                                    m_draw_firsts.constData(),
+                                                    m_draw_counts.constData(),
+                                                    m_draw_firsts.size());
+            }
         }
+        qopengl_functions.glBindTexture(GL_TEXTURE_2D, 0);
 
         qopengl_functions.glDisableClientState(GL_VERTEX_ARRAY);
         qopengl_functions.glDisableClientState(GL_TEXTURE_COORD_ARRAY);
     }
+    m_vertex_buffer.release();
     qopengl_functions.glDisable(GL_TEXTURE_2D);
 }
 
 QFuture<void> ImageTextureGL::createTextures(const QString &imagefile)
 {
-    return QtConcurrent::run(this, &ImageTextureGL::createTiles, imagefile);
+    bool (ImageTextureGL::*create)(const QString &) = &ImageTextureGL::createTiles;
+    return QtConcurrent::run(this, create, imagefile);
 }
 
 void ImageTextureGL::createGrid(const QImage &image, const int offset)
 {
-    const QImage gray_scale = image.convertToFormat(QImage::Format_Grayscale8);
-    const int x_pixels = gray_scale.width();
-    const int y_pixels = gray_scale.height();
-    m_grid_points.clear();
-    for (int x = 0; x < x_pixels; x+=offset) {
-        for (int y = 0; y < y_pixels; y+=offset) {
-            const float value = gray_scale.pixelColor(x,y).valueF();
-            if (value > 0.5) {
-               m_grid_points.append(QPointF(x,y));
-            }
-        }
-    }
+    m_tissue_mask = TissueMask::compute(image, offset);
+    m_grid_points = m_tissue_mask.points();
 }
 
 bool ImageTextureGL::createTiles(const QString &imagefile)
 {
     QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool created = createTiles(readImage(imagefile));
+    QGuiApplication::restoreOverrideCursor();
+    return created;
+}
+
+ImageTextureGL::Image ImageTextureGL::readImage(const QString &imagefile)
+{
+    ST_PROFILE_SCOPE("ImageTextureGL::readImage");
     // image buffer reader
     QImageReader imageReader(imagefile);
     // scale image to half for big images
+    Image image;
     QSize imageSize = imageReader.size();
     if (imageSize.width() >= 10000 || imageSize.height() >= 10000) {
         imageSize /= 2;
         imageReader.setScaledSize(imageSize);
-        m_iscaled = true;
-    } else {
-        m_iscaled = false;
+        image.scaled = true;
     }
     // parse the image
-    QImage image;
-    const bool read_ok = imageReader.read(&image);
+    const bool read_ok = imageReader.read(&image.image);
     if (!read_ok) {
         qDebug() << "Tissue image cannot be opened/read" << imageReader.errorString();
-        QGuiApplication::restoreOverrideCursor();
+        image.image = QImage();
+    }
+    return image;
+}
+
+bool ImageTextureGL::createTiles(const Image &tissue_image)
+{
+    ST_PROFILE_SCOPE("ImageTextureGL::createTiles");
+    const QImage &image = tissue_image.image;
+    if (image.isNull()) {
         return false;
     }
 
+    // the tiles of a previous image are replaced
+    clearTextures();
+    m_iscaled = tissue_image.scaled;
     m_bounds = image.rect();
 
-    // compute tiles size and numbers
-    const int width = imageSize.width();
-    const int height = imageSize.height();
-    const int xCount = std::ceil(width / static_cast<float>(tile_width));
-    const int yCount = std::ceil(height / static_cast<float>(tile_height));
-    const int count = xCount * yCount;
+    // compute tiles and pages size and numbers
+    const int width = image.width();
+    const int height = image.height();
+    const int atlas_size = atlasSize();
+    m_columns = std::ceil(width / static_cast<float>(tile_width));
+    m_rows = std::ceil(height / static_cast<float>(tile_height));
+    m_tiles_per_page = atlas_size / tile_width;
+    m_page_columns = std::ceil(width / static_cast<float>(atlas_size));
+    const int page_rows = std::ceil(height / static_cast<float>(atlas_size));
+    const int count = m_page_columns * page_rows;
 
-    // create tiles and their textures
+    // create the pages and the vertices of their tiles
+    QVector<GLfloat> vertices;
+    vertices.reserve(m_columns * m_rows * vertices_per_tile * vertex_components);
     for (int i = 0; i < count; ++i) {
+        const int x = atlas_size * (i % m_page_columns);
+        const int y = atlas_size * (i / m_page_columns);
+        const int page_width = std::min(width - x, atlas_size);
+        const int page_height = std::min(height - y, atlas_size);
+        addPage(image.copy(x, y, page_width, page_height), x, y, vertices);
+    }
 
-        // texture sizes
-        const int x = tile_width * (i % xCount);
-        const int y = tile_height * (i / xCount);
-        const int texture_width = std::min(width - x, tile_width);
-        const int texture_height = std::min(height - y, tile_height);
-
-        // create sub image and add texture
-        // TODO an ideal solution would  be to extract the clip rect part of the image
-        // from the imageReader to avoid loading the whole image into memory
-        // but the setClipRect option would only work one time, after calling read()
-        // the buffer is cleaned
-        addTexture(image.copy(x, y, texture_width, texture_height), x, y);
+    // upload the vertices of all the tiles
+    if (!m_vertex_buffer.isCreated() && !m_vertex_buffer.create()) {
+        qDebug() << "The vertex buffer of the tissue image cannot be created";
+        clearData();
+        return false;
     }
+    m_vertex_buffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_vertex_buffer.bind();
+    m_vertex_buffer.allocate(vertices.constData(), vertices.size() * sizeof(GLfloat));
+    m_vertex_buffer.release();
 
-    QGuiApplication::restoreOverrideCursor();
     m_isInitialized = true;
     return true;
 }
 
-void ImageTextureGL::addTexture(const QImage &image, const int x, const int y)
+void ImageTextureGL::addPage(const QImage &image, const int x, const int y,
+                             QVector<GLfloat> &vertices)
 {
+    ST_PROFILE_SCOPE("ImageTextureGL::addPage");
     const float width = static_cast<float>(image.width());
     const float height = static_cast<float>(image.height());
 
-    m_textures_indices.append(QVector2D(x, y));
-    m_textures_indices.append(QVector2D(x + width, y));
-    m_textures_indices.append(QVector2D(x + width, y + height));
-    m_textures_indices.append(QVector2D(x, y + height));
+    Page page;
+    page.column = x / tile_width;
+    page.row = y / tile_height;
+    page.columns = std::ceil(width / tile_width);
+    page.rows = std::ceil(height / tile_height);
+    page.first = vertices.size() / vertex_components;
+
+    // the tiles of the page (row by row) with their part of the texture
+    for (int row = 0; row < page.rows; ++row) {
+        for (int column = 0; column < page.columns; ++column) {
+            const float left = column * tile_width;
+            const float top = row * tile_height;
+            const float right = std::min(left + tile_width, width);
+            const float bottom = std::min(top + tile_height, height);
+            const float corners[vertices_per_tile][2]
+                    = {{left, top}, {right, top}, {right, bottom}, {left, bottom}};
+            for (const auto &corner : corners) {
+                vertices.append(x + corner[0]);
+                vertices.append(y + corner[1]);
+                vertices.append(corner[0] / width);
+                vertices.append(corner[1] / height);
+            }
+        }
+    }
 
-    m_texture_coords.append(QVector2D(0.0, 0.0));
-    m_texture_coords.append(QVector2D(1.0, 0.0));
-    m_texture_coords.append(QVector2D(1.0, 1.0));
-    m_texture_coords.append(QVector2D(0.0, 1.0));
+    page.texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
+    page.texture->setData(image);
+    page.texture->setMinificationFilter(QOpenGLTexture::LinearMipMapNearest);
+    page.texture->setMagnificationFilter(QOpenGLTexture::Linear);
+    page.texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    m_pages.append(page);
+}
 
-    QOpenGLTexture *texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
-    texture->setData(image);
-    texture->setMinificationFilter(QOpenGLTexture::LinearMipMapNearest);
-    texture->setMagnificationFilter(QOpenGLTexture::Linear);
-    texture->setWrapMode(QOpenGLTexture::ClampToEdge);
-    m_textures.append(texture);
+int ImageTextureGL::atlasSize()
+{
+    GLint max_size = atlas_max_size;
+    const QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (context != nullptr) {
+        context->functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    }
+    const int size = std::min(static_cast<int>(max_size), atlas_max_size);
+    return std::max(size - size % tile_width, tile_width);
 }
 
 const QList<QPointF>& ImageTextureGL::getGrid() const
@@ -182,6 +290,11 @@ const QList<QPointF>& ImageTextureGL::getGrid() const
     return m_grid_points;
 }
 
+const TissueMask &ImageTextureGL::getTissueMask() const
+{
+    return m_tissue_mask;
+}
+
 const QRectF ImageTextureGL::boundingRect() const
 {
     return m_bounds;
@@ -196,3 +309,21 @@ bool ImageTextureGL::scaled() const
 {
     return m_iscaled;
 }
+
+qint64 ImageTextureGL::memoryUsage() const
+{
+    return static_cast<qint64>(m_tissue_mask.bits().capacity()) * sizeof(quint64)
+            + static_cast<qint64>(m_grid_points.size()) * (sizeof(void *) + sizeof(QPointF));
+}
+
+qint64 ImageTextureGL::textureMemoryUsage() const
+{
+    // the textures are RGBA8 and the mipmaps add a third of the base level
+    qint64 bytes = 0;
+    for (const Page &page : m_pages) {
+        bytes += static_cast<qint64>(page.texture->width()) * page.texture->height() * 4;
+    }
+    const qint64 vertices = static_cast<qint64>(m_columns) * m_rows * vertices_per_tile
+            * vertex_components * sizeof(GLfloat);
+    return bytes + bytes / 3 + vertices;
+}
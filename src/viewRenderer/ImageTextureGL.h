@@ -2,21 +2,30 @@
 #define IMAGETEXTUREGL_H
 
 #include "GraphicItemGL.h"
-#include <QVector2D>
+#include "math/TissueMask.h"
 #include <QFuture>
+#include <QImage>
+#include <QOpenGLBuffer>
 
-class QImage;
 class QOpenGLTexture;
 class QByteArray;
 
 // This class represents a tiled image to be rendered using textures. This class
 // is used to render the cell tissue image which has a high resolution
-// The tiling and creation of the textures is performed concurrently
+// The image is split into a few large textures (atlas pages) that are divided in tiles,
+// the vertices of the tiles are stored in a vertex buffer and only the tiles that are
+// visible are drawn (with one draw call per visible page)
 class ImageTextureGL : public GraphicItemGL
 {
     Q_OBJECT
 
 public:
+    // a tissue image read into memory (big images are scaled down to half)
+    struct Image {
+        QImage image;
+        bool scaled = false;
+    };
+
     explicit ImageTextureGL(QObject *parent = 0);
     virtual ~ImageTextureGL();
 
@@ -33,13 +42,27 @@ public:
     // will split the image given as input into small textures of fixed size
     // returns true if the parsing and creation of tiles was correct
     bool createTiles(const QString &imagefile);
+    // the same with an image already read (see readImage())
+    bool createTiles(const Image &image);
+
+    // reads the image file (it can be called from any thread, the textures must be
+    // created in the thread of the OpenGL context), the image is null if it failed
+    static Image readImage(const QString &imagefile);
 
     // return a grid of points computed from the image (inside the tissue)
     const QList<QPointF>& getGrid() const;
 
+    // return the tissue mask computed from the image (sampled with the grid offset)
+    const TissueMask &getTissueMask() const;
+
     // true if the image has been scaled down
     bool scaled() const;
 
+    // an estimate of the memory used by the tiles (bytes), in main memory (the tissue mask
+    // and the grid) and in the GPU (the textures with their mipmaps and the vertices)
+    qint64 memoryUsage() const;
+    qint64 textureMemoryUsage() const;
+
 public slots:
 
 protected:
@@ -52,20 +75,43 @@ private:
     // internal function to create a grid of of the image (inside tissue)
     void createGrid(const QImage &image, const int offset);
 
-    // internal functions to create a texture from an image and add it to the
-    // rendering list
-    void addTexture(const QImage &image, const int x = 0, const int y = 0);
+    // a texture with a region of the image and the range of its tiles in the vertex buffer
+    struct Page {
+        QOpenGLTexture *texture;
+        // the first tile of the page in the image (tile column and row)
+        int column;
+        int row;
+        // the number of tiles of the page
+        int columns;
+        int rows;
+        // the first vertex of the tiles of the page (row by row)
+        int first;
+    };
+
+    // internal function to create a page from a region of the image and add the vertices
+    // of its tiles (position and texture coordinates) to the vertices
+    void addPage(const QImage &image, const int x, const int y, QVector<GLfloat> &vertices);
 
     // internal function to remove and clean textures
     void clearTextures();
-    void clearNodes();
 
-    QVector<QOpenGLTexture *> m_textures;
-    QVector<QVector2D> m_textures_indices;
-    QVector<QVector2D> m_texture_coords;
+    // the size of the pages (a multiple of the tile size that the OpenGL context supports)
+    static int atlasSize();
+
+    QVector<Page> m_pages;
+    QOpenGLBuffer m_vertex_buffer;
+    // the number of tiles of the image and of pages per row
+    int m_columns;
+    int m_rows;
+    int m_page_columns;
+    int m_tiles_per_page;
+    // the ranges of vertices drawn for a page (reused between frames)
+    QVector<GLint> m_draw_firsts;
+    QVector<GLsizei> m_draw_counts;
     QRectF m_bounds;
     bool m_isInitialized;
     QList<QPointF> m_grid_points;
+    TissueMask m_tissue_mask;
     bool m_iscaled;
 
     Q_DISABLE_COPY(ImageTextureGL)
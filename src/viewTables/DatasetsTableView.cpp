@@ -40,6 +40,7 @@ DatasetsTableView::DatasetsTableView(QWidget *parent)
     horizontalHeader()->setSectionResizeMode(DatasetItemModel::Name, QHeaderView::Stretch);
     horizontalHeader()->setSectionResizeMode(DatasetItemModel::Tissue, QHeaderView::Stretch);
     horizontalHeader()->setSectionResizeMode(DatasetItemModel::Species, QHeaderView::Stretch);
+    horizontalHeader()->setSectionResizeMode(DatasetItemModel::Memory, QHeaderView::Stretch);
     verticalHeader()->hide();
 
     model()->submit(); // support for caching (speed up)
@@ -8,30 +8,26 @@
 #include <QColorDialog>
 
 #include "model/GeneItemModel.h"
+#include "model/RowFilterProxyModel.h"
 
 GenesTableView::GenesTableView(QWidget *parent)
     : QTableView(parent)
     , m_sortProxyModel(nullptr)
+    , m_name_filter()
 {
     // model
     GeneItemModel *data_model = new GeneItemModel(this);
 
-    // sorting model
-    m_sortProxyModel.reset(new QSortFilterProxyModel(this));
+    // filter model (the search by name is done with the gene search index of the dataset)
+    // the sorting is done by the model itself (it caches the order of each column)
+    m_sortProxyModel.reset(new RowFilterProxyModel(this));
     m_sortProxyModel->setSourceModel(data_model);
-    m_sortProxyModel->setSortCaseSensitivity(Qt::CaseInsensitive);
-    m_sortProxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    // this is important because sort proxy will use the column 0 by default
-    m_sortProxyModel->setFilterKeyColumn(GeneItemModel::Name);
-    m_sortProxyModel->setSortRole(Qt::UserRole);
     setModel(m_sortProxyModel.data());
 
     // settings for the table
-    setSortingEnabled(true);
     setShowGrid(true);
     setWordWrap(true);
     setAlternatingRowColors(true);
-    sortByColumn(GeneItemModel::Name, Qt::AscendingOrder);
 
     setFrameShape(QFrame::StyledPanel);
     setFrameShadow(QFrame::Sunken);
@@ -53,7 +49,11 @@ GenesTableView::GenesTableView(QWidget *parent)
     horizontalHeader()->setSectionResizeMode(GeneItemModel::CutOff, QHeaderView::Fixed);
     horizontalHeader()->resizeSection(GeneItemModel::Show, 50);
     horizontalHeader()->setSortIndicatorShown(true);
+    horizontalHeader()->setSectionsClickable(true);
     verticalHeader()->hide();
+    connect(horizontalHeader(), &QHeaderView::sortIndicatorChanged,
+            data_model, &GeneItemModel::sort);
+    horizontalHeader()->setSortIndicator(GeneItemModel::Name, Qt::AscendingOrder);
 
     model()->submit(); // support for caching (speed up)
 
@@ -61,6 +61,14 @@ GenesTableView::GenesTableView(QWidget *parent)
     setContextMenuPolicy(Qt::CustomContextMenu);
     connect(this, &GenesTableView::customContextMenuRequested,
             this, &GenesTableView::customMenuRequested);
+
+    // the rows of the search are different when a dataset is loaded or the genes are sorted
+    connect(data_model, &GeneItemModel::modelReset, this, [=]() { setNameFilter(m_name_filter); });
+    connect(data_model, &GeneItemModel::layoutChanged, this, [=]() {
+        if (!m_name_filter.isEmpty()) {
+            setNameFilter(m_name_filter);
+        }
+    });
 }
 
 GenesTableView::~GenesTableView()
@@ -75,7 +83,20 @@ QItemSelection GenesTableView::getItemSelection() const
 
 void GenesTableView::setNameFilter(const QString &str)
 {
-    m_sortProxyModel->setFilterFixedString(str);
+    m_name_filter = str;
+    if (str.isEmpty()) {
+        m_sortProxyModel->clearRowFilter();
+    } else {
+        // the genes found can be in rows that are not fetched yet
+        getModel()->fetchAll();
+        m_sortProxyModel->setRowFilter(getModel()->findGenes(str));
+    }
+}
+
+void GenesTableView::selectAll()
+{
+    getModel()->fetchAll();
+    QTableView::selectAll();
 }
 
 void GenesTableView::customMenuRequested(const QPoint &pos)
@@ -5,6 +5,7 @@
 #include <QPointer>
 
 class QSortFilterProxyModel;
+class RowFilterProxyModel;
 class GeneItemModel;
 
 // An abstraction of QTableView for the genes table
@@ -33,6 +34,9 @@ public slots:
     // slot used to set a search on the table by name
     void setNameFilter(const QString &str);
 
+    // selects all the rows (the rows that are not fetched yet are fetched)
+    void selectAll() override;
+
 private slots:
 
     // slot to handle when the user right clicks
@@ -41,7 +45,9 @@ private slots:
 private:
 
     // references to the proxy model
-    QScopedPointer<QSortFilterProxyModel> m_sortProxyModel;
+    QScopedPointer<RowFilterProxyModel> m_sortProxyModel;
+    // the current search on the table (re-applied when the genes change)
+    QString m_name_filter;
 
     Q_DISABLE_COPY(GenesTableView)
 };
@@ -15,22 +15,18 @@ SpotsTableView::SpotsTableView(QWidget *parent)
     // model
     SpotItemModel *data_model = new SpotItemModel(this);
 
-    // sorting model
+    // filter model (the sorting is done by the model itself, it caches the order of each column)
     m_sortProxyModel.reset(new QSortFilterProxyModel(this));
     m_sortProxyModel->setSourceModel(data_model);
-    m_sortProxyModel->setSortCaseSensitivity(Qt::CaseInsensitive);
     m_sortProxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    // this is important because sort proxy will use the column 0 by default
+    // this is important because the proxy will filter the column 0 by default
     m_sortProxyModel->setFilterKeyColumn(SpotItemModel::Name);
-    m_sortProxyModel->setSortRole(Qt::UserRole);
     setModel(m_sortProxyModel.data());
 
     // settings for the table
-    setSortingEnabled(true);
     setShowGrid(true);
     setWordWrap(true);
     setAlternatingRowColors(true);
-    sortByColumn(SpotItemModel::Name, Qt::AscendingOrder);
 
     setFrameShape(QFrame::StyledPanel);
     setFrameShadow(QFrame::Sunken);
@@ -50,7 +46,11 @@ SpotsTableView::SpotsTableView(QWidget *parent)
     horizontalHeader()->setSectionResizeMode(SpotItemModel::Show, QHeaderView::Fixed);
     horizontalHeader()->resizeSection(SpotItemModel::Show, 50);
     horizontalHeader()->setSortIndicatorShown(true);
+    horizontalHeader()->setSectionsClickable(true);
     verticalHeader()->hide();
+    connect(horizontalHeader(), &QHeaderView::sortIndicatorChanged,
+            data_model, &SpotItemModel::sort);
+    horizontalHeader()->setSortIndicator(SpotItemModel::Name, Qt::AscendingOrder);
 
     model()->submit(); // support for caching (speed up)
 
@@ -72,9 +72,19 @@ QItemSelection SpotsTableView::getItemSelection() const
 
 void SpotsTableView::setNameFilter(const QString &str)
 {
+    // the spots found can be in rows that are not fetched yet
+    if (!str.isEmpty()) {
+        getModel()->fetchAll();
+    }
     m_sortProxyModel->setFilterFixedString(str);
 }
 
+void SpotsTableView::selectAll()
+{
+    getModel()->fetchAll();
+    QTableView::selectAll();
+}
+
 void SpotsTableView::customMenuRequested(const QPoint &pos)
 {
     const QModelIndex index = indexAt(pos);
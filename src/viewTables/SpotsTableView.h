@@ -33,6 +33,9 @@ public slots:
     // slot used to set a search on the table by name
     void setNameFilter(const QString &str);
 
+    // selects all the rows (the rows that are not fetched yet are fetched)
+    void selectAll() override;
+
 private slots:
 
     // slot to handle when the user right clicks
@@ -42,6 +42,8 @@ UserSelectionTableView::UserSelectionTableView(QWidget *parent)
                                              QHeaderView::Stretch);
     horizontalHeader()->setSectionResizeMode(UserSelectionsItemModel::NSpots,
                                              QHeaderView::Stretch);
+    horizontalHeader()->setSectionResizeMode(UserSelectionsItemModel::Memory,
+                                             QHeaderView::Stretch);
     horizontalHeader()->setSortIndicatorShown(true);
     verticalHeader()->hide();
 